@@ -124,6 +124,22 @@ struct IntrinsicBase
       return this->cam2ima( X.head<2>()/X(2) );
   }
 
+  /**
+   * @brief Batched projection of 3D points into the camera plane (Apply pose, disto (if any) and Intrinsics)
+   * @param[in] pose The pose
+   * @param[in] pts3D The 3d points, one per column
+   * @param[out] out_pts2D The 2d projections in the camera plane
+   * @param[in] applyDistortion If true apply distortion if any
+   */
+  inline void projectBatch(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& out_pts2D, bool applyDistortion = true) const
+  {
+    const Mat3X X = (pose.rotation() * pts3D).colwise() + pose.translation(); // apply pose
+    out_pts2D = X.topRows<2>().array().rowwise() / X.row(2).array();
+    if (applyDistortion && this->have_disto()) // apply disto
+      this->addDistortionBatch(out_pts2D, out_pts2D);
+    this->cam2imaBatch(out_pts2D, out_pts2D); // apply intrinsics
+  }
+
   inline Vec3 backproject(const geometry::Pose3& pose, const Vec2& pt2D, double depth, bool applyUndistortion = true) const
   {
     Vec2 pt2DCam;
@@ -161,13 +177,9 @@ struct IntrinsicBase
   inline Mat2X residuals(const geometry::Pose3& pose, const Mat3X& X, const Mat2X& x) const
   {
     assert(X.cols() == x.cols());
-    const std::size_t numPts = x.cols();
-    Mat2X residuals = Mat2X::Zero(2, numPts);
-    for(std::size_t i = 0; i < numPts; ++i)
-    {
-      residuals.col(i) = residual(pose, X.col(i), x.col(i));
-    }
-    return residuals;
+    Mat2X proj;
+    projectBatch(pose, X, proj);
+    return x - proj;
   }
 
   /**
@@ -321,6 +333,83 @@ struct IntrinsicBase
    */
   virtual Vec2 get_d_pixel(const Vec2& p) const = 0;
 
+  // Batched versions of the per-point virtual members.
+  // Each call processes all the columns of the input matrix with a single virtual dispatch,
+  // the camera models override them with loops over contiguous data.
+  // The output matrix can be the input matrix.
+
+  /**
+   * @brief Transform points from the camera plane to the image plane
+   * @param[in] pts Points from the camera plane, one per column
+   * @param[out] out_pts Image plane points
+   */
+  virtual void cam2imaBatch(const Mat2X& pts, Mat2X& out_pts) const
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = cam2ima(pts.col(i));
+  }
+
+  /**
+   * @brief Transform points from the image plane to the camera plane
+   * @param[in] pts Points from the image plane, one per column
+   * @param[out] out_pts Camera plane points
+   */
+  virtual void ima2camBatch(const Mat2X& pts, Mat2X& out_pts) const
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = ima2cam(pts.col(i));
+  }
+
+  /**
+   * @brief Add the distortion field to points (that are in normalized camera frame)
+   * @param[in] pts The points, one per column
+   * @param[out] out_pts The points with added distortion field
+   */
+  virtual void addDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = add_disto(pts.col(i));
+  }
+
+  /**
+   * @brief Remove the distortion to camera points (that are in normalized camera frame)
+   * @param[in] pts The points, one per column
+   * @param[out] out_pts The points with removed distortion field
+   */
+  virtual void removeDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = remove_disto(pts.col(i));
+  }
+
+  /**
+   * @brief Return the undistorted pixels (with removed distortion)
+   * @param[in] pts The pixels, one per column
+   * @param[out] out_pts The undistorted pixels
+   */
+  virtual void getUndistortedPixelsBatch(const Mat2X& pts, Mat2X& out_pts) const
+  {
+    ima2camBatch(pts, out_pts);
+    removeDistortionBatch(out_pts, out_pts);
+    cam2imaBatch(out_pts, out_pts);
+  }
+
+  /**
+   * @brief Return the distorted pixels (with added distortion)
+   * @param[in] pts The undistorted pixels, one per column
+   * @param[out] out_pts The distorted pixels
+   */
+  virtual void getDistortedPixelsBatch(const Mat2X& pts, Mat2X& out_pts) const
+  {
+    ima2camBatch(pts, out_pts);
+    addDistortionBatch(out_pts, out_pts);
+    cam2imaBatch(out_pts, out_pts);
+  }
+
   /**
    * @brief Normalize a given unit pixel error to the camera plane
    * @param[in] value Given unit pixel error
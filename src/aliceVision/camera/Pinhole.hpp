@@ -92,6 +92,16 @@ class Pinhole : public IntrinsicBase
     return ( p -  principal_point() ) / focal();
   }
 
+  void cam2imaBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    out_pts = (focal() * pts).colwise() + principal_point();
+  }
+
+  void ima2camBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    out_pts = (pts.colwise() - principal_point()) / focal();
+  }
+
   virtual bool have_disto() const override {  return false; }
 
   virtual Vec2 add_disto(const Vec2& p) const override { return p; }
@@ -194,6 +204,22 @@ class Pinhole : public IntrinsicBase
   /// Return the distorted pixel (with added distortion)
   virtual Vec2 get_d_pixel(const Vec2& p) const override {return p;}
 
+  void getUndistortedPixelsBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    if(have_disto())
+      IntrinsicBase::getUndistortedPixelsBatch(pts, out_pts);
+    else
+      out_pts = pts;
+  }
+
+  void getDistortedPixelsBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    if(have_disto())
+      IntrinsicBase::getDistortedPixelsBatch(pts, out_pts);
+    else
+      out_pts = pts;
+  }
+
   /**
    * @brief Rescale intrinsics to reflect a rescale of the camera image
    * @param factor a scale factor
@@ -46,10 +46,24 @@ class PinholeBrownT2 : public Pinhole
     // Heikkila J (2000) Geometric Camera Calibration Using Circular Control Points.
     // IEEE Trans. Pattern Anal. Mach. Intell., 22:1066-1077
 
+    // Newton iterations with the analytic jacobian of the distortion,
+    // the fixed point iterations are used as a fallback if Newton does not converge.
     virtual Vec2 remove_disto(const Vec2 & p) const override{
         const double epsilon = 1e-8; //criteria to stop the iteration
         Vec2 p_u = p;
 
+        for(int i = 0; i < 20; ++i)
+        {
+            Eigen::Matrix2d jacobian;
+            const Vec2 residual = addDistoAndJacobian(_distortionParams, p_u, jacobian) - p;
+            if(residual.lpNorm<1>() <= epsilon)
+                return p_u;
+            if(std::abs(jacobian.determinant()) < 1e-12)
+                break;
+            p_u -= jacobian.inverse() * residual;
+        }
+
+        p_u = p;
         while((add_disto(p_u)-p).lpNorm<1>() > epsilon)//manhattan distance between the two points
         {
             p_u = p - distoFunction(_distortionParams, p_u);
@@ -58,6 +72,20 @@ class PinholeBrownT2 : public Pinhole
         return p_u;
     }
 
+    void addDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+    {
+      out_pts.resize(2, pts.cols());
+      for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+        out_pts.col(i) = pts.col(i) + distoFunction(_distortionParams, pts.col(i));
+    }
+
+    void removeDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+    {
+      out_pts.resize(2, pts.cols());
+      for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+        out_pts.col(i) = PinholeBrownT2::remove_disto(pts.col(i));
+    }
+
     /// Return the un-distorted pixel (with removed distortion)
     virtual Vec2 get_ud_pixel(const Vec2& p) const override
     {
@@ -85,6 +113,27 @@ class PinholeBrownT2 : public Pinhole
         Vec2 d(p(0) * k_diff + t_x, p(1) * k_diff + t_y);
         return d;
     }
+
+    /// Distorted point and its jacobian with respect to the undistorted point
+    static Vec2 addDistoAndJacobian(const std::vector<double> & params, const Vec2 & p, Eigen::Matrix2d & jacobian)
+    {
+        const double k1 = params[0], k2 = params[1], k3 = params[2], t1 = params[3], t2 = params[4];
+        const double x = p(0), y = p(1);
+        const double r2 = x*x + y*y;
+        const double r4 = r2 * r2;
+        const double r6 = r4 * r2;
+        const double k_diff = (k1*r2 + k2*r4 + k3*r6);
+        // derivative of k_diff with respect to r2, times 2
+        const double k_r = 2 * k1 + 4 * k2 * r2 + 6 * k3 * r4;
+
+        jacobian(0, 0) = 1. + k_diff + k_r * x * x + 6 * t2 * x + 2 * t1 * y;
+        jacobian(0, 1) = k_r * x * y + 2 * t2 * y + 2 * t1 * x;
+        jacobian(1, 0) = k_r * x * y + 2 * t1 * x + 2 * t2 * y;
+        jacobian(1, 1) = 1. + k_diff + k_r * y * y + 6 * t1 * y + 2 * t2 * x;
+
+        return Vec2(x * (1. + k_diff) + t2 * (r2 + 2 * x * x) + 2 * t1 * x * y,
+                    y * (1. + k_diff) + t1 * (r2 + 2 * y * y) + 2 * t2 * x * y);
+    }
 };
 
 } // namespace camera
@@ -57,6 +57,20 @@ public:
     return  p * coef;
   }
 
+  void addDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = PinholeFisheye1::add_disto(pts.col(i));
+  }
+
+  void removeDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = PinholeFisheye1::remove_disto(pts.col(i));
+  }
+
   /// Return the un-distorted pixel (with removed distortion)
   virtual Vec2 get_ud_pixel(const Vec2& p) const override
   {
@@ -44,6 +44,65 @@ namespace radial_distortion{
     return .5*(lowerbound+upbound);
   }
 
+  /**
+   * @brief Solve by Newton iterations the undistorted radius r such that r (1 + k1 r^2 + k2 r^4 + ...) = sqrt(r2)
+   * @param[in] params radial distortion parameters (k1, k2, ...)
+   * @param[in] r2 targeted squared radius
+   * @param[out] out_r2 squared undistorted radius
+   * @return false if the iterations leave the monotonic part of the distortion function or do not converge,
+   *         the caller should fallback to bisection_Radius_Solve
+   */
+  inline bool newton_Radius_Solve(
+    const std::vector<double> & params,
+    double r2,
+    double & out_r2,
+    double epsilon = 1e-12, // criteria to stop the iterations
+    int maxIterations = 20)
+  {
+    const double rd = std::sqrt(r2);
+    double r = rd;
+    for (int i = 0; i < maxIterations; ++i)
+    {
+      const double r_2 = r * r;
+      double r_2k = 1.;
+      double value = 1.;
+      double derivative = 1.;
+      for (std::size_t k = 0; k < params.size(); ++k)
+      {
+        r_2k *= r_2;
+        value += params[k] * r_2k;
+        derivative += (2 * k + 3) * params[k] * r_2k;
+      }
+      if (derivative <= 0.)
+        return false;
+
+      const double step = (r * value - rd) / derivative;
+      r -= step;
+      if (r < 0.)
+        return false;
+      if (std::abs(step) < epsilon * (1. + rd))
+      {
+        out_r2 = r * r;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Solve the p' squared radius such that Square(disto(radius(p'))) = r^2,
+  /// using Newton iterations and bisection as a fallback
+  template <class Disto_Functor>
+  double solve_Radius(
+    const std::vector<double> & params, // radial distortion parameters
+    double r2, // targeted radius
+    Disto_Functor & functor)
+  {
+    double r2_undisto;
+    if (newton_Radius_Solve(params, r2, r2_undisto))
+      return r2_undisto;
+    return bisection_Radius_Solve(params, r2, functor);
+  }
+
 } // namespace radial_distortion
 
 /// Implement a Pinhole camera with a 1 radial distortion coefficient.
@@ -86,10 +145,24 @@ class PinholeRadialK1 : public Pinhole
     const double r2 = p(0)*p(0) + p(1)*p(1);
     const double radius = (r2 == 0) ?
       1. :
-      ::sqrt(radial_distortion::bisection_Radius_Solve(_distortionParams, r2, distoFunctor) / r2);
+      ::sqrt(radial_distortion::solve_Radius(_distortionParams, r2, distoFunctor) / r2);
     return radius * p;
   }
 
+  void addDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    const double k1 = _distortionParams.at(0);
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = pts.colwise().squaredNorm().array();
+    out_pts = (pts.array().rowwise() * (1. + k1 * r2)).matrix();
+  }
+
+  void removeDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = PinholeRadialK1::remove_disto(pts.col(i));
+  }
+
   /**
    * @brief Assuming the distortion is a function of radius, estimate the 
    * maximal undistorted radius for a range of distorted radius.
@@ -169,12 +242,26 @@ class PinholeRadialK3 : public Pinhole
     // Minimize disto(radius(p')^2) == actual Squared(radius(p))
 
     const double r2 = p(0)*p(0) + p(1)*p(1);
-    const double radius = (r2 == 0) ? //1. : ::sqrt(bisectionSolve(_distortionParams, r2) / r2);
+    const double radius = (r2 == 0) ?
       1. :
-      ::sqrt(radial_distortion::bisection_Radius_Solve(_distortionParams, r2, distoFunctor) / r2);
+      ::sqrt(radial_distortion::solve_Radius(_distortionParams, r2, distoFunctor) / r2);
     return radius * p;
   }
 
+  void addDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    const double k1 = _distortionParams[0], k2 = _distortionParams[1], k3 = _distortionParams[2];
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = pts.colwise().squaredNorm().array();
+    out_pts = (pts.array().rowwise() * (1. + r2 * (k1 + r2 * (k2 + r2 * k3)))).matrix();
+  }
+
+  void removeDistortionBatch(const Mat2X& pts, Mat2X& out_pts) const override
+  {
+    out_pts.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out_pts.col(i) = PinholeRadialK3::remove_disto(pts.col(i));
+  }
+
   /// Return the un-distorted pixel (with removed distortion)
   virtual Vec2 get_ud_pixel(const Vec2& p) const override
   {
@@ -0,0 +1,271 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/Sampler.hpp>
+#include <aliceVision/camera/cameraCommon.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace camera {
+
+/**
+ * @brief Remap table from the undistorted image to the distorted image of a camera.
+ *
+ * The distorted position of each output pixel is computed once for a given intrinsic and
+ * image size, then the table can be applied to all the images sharing this intrinsic
+ * without any evaluation of the distortion model.
+ * The table can be saved to disk to be shared between processes.
+ */
+class UndistortionMap
+{
+public:
+
+  /**
+   * @brief Compute the remap table of an intrinsic
+   * @param[in] intrinsic The camera intrinsic
+   * @param[in] width The width of the images to undistort
+   * @param[in] height The height of the images to undistort
+   * @param[in] correctPrincipalPoint Move the principal point to the image center
+   */
+  void compute(const IntrinsicBase& intrinsic, int width, int height, bool correctPrincipalPoint = false)
+  {
+    _intrinsicType = intrinsic.getType();
+    _intrinsicParams = intrinsic.getParams();
+    _correctPrincipalPoint = correctPrincipalPoint;
+    _width = width;
+    _height = height;
+    _x.resize(std::size_t(width) * height);
+    _y.resize(std::size_t(width) * height);
+
+    const Vec2 center(width * 0.5, height * 0.5);
+    Vec2 ppCorrection(0.0, 0.0);
+
+    if(correctPrincipalPoint && isPinhole(intrinsic.getType()))
+      ppCorrection = dynamic_cast<const Pinhole&>(intrinsic).principal_point() - center;
+
+    #pragma omp parallel for
+    for(int j = 0; j < height; ++j)
+    {
+      // compute coordinates with distortion for the whole row
+      Mat2X row_pix(2, width);
+      row_pix.row(0) = Eigen::RowVectorXd::LinSpaced(width, 0, width - 1);
+      row_pix.row(1).setConstant(j);
+      intrinsic.getDistortedPixelsBatch(row_pix, row_pix);
+      row_pix.colwise() += ppCorrection;
+
+      const std::size_t rowOffset = std::size_t(j) * width;
+      for(int i = 0; i < width; ++i)
+      {
+        _x[rowOffset + i] = static_cast<float>(row_pix(0, i));
+        _y[rowOffset + i] = static_cast<float>(row_pix(1, i));
+      }
+    }
+
+    initIndexes();
+  }
+
+  /**
+   * @brief Check if the remap table has been computed for this intrinsic and image size
+   */
+  bool isCompatible(const IntrinsicBase& intrinsic, int width, int height, bool correctPrincipalPoint = false) const
+  {
+    return _width == width &&
+           _height == height &&
+           _correctPrincipalPoint == correctPrincipalPoint &&
+           _intrinsicType == intrinsic.getType() &&
+           _intrinsicParams == intrinsic.getParams();
+  }
+
+  /**
+   * @brief Undistort an image with the remap table
+   * @param[in] imageIn The distorted image, of the size of the remap table
+   * @param[out] image_ud The undistorted image
+   * @param[in] fillcolor The color of the pixels outside of the distorted image
+   */
+  template <typename T>
+  void apply(const image::Image<T>& imageIn, image::Image<T>& image_ud, T fillcolor) const
+  {
+    if(imageIn.Width() != _width || imageIn.Height() != _height)
+      throw std::invalid_argument("The image size (" + std::to_string(imageIn.Width()) + "x" + std::to_string(imageIn.Height()) + ") "
+                                  "does not match the undistortion map size (" + std::to_string(_width) + "x" + std::to_string(_height) + ").");
+
+    typedef image::RealPixel<T> RealPixel;
+    typedef typename RealPixel::real_type RealType;
+
+    image_ud.resize(_width, _height, true, fillcolor);
+    const image::Sampler2d<image::SamplerLinear> sampler;
+    const T* src = imageIn.data();
+
+    #pragma omp parallel for
+    for(int j = 0; j < _height; ++j)
+    {
+      const std::size_t rowOffset = std::size_t(j) * _width;
+      T* dst = image_ud.data() + rowOffset;
+
+      for(int i = 0; i < _width; ++i)
+      {
+        const std::size_t k = rowOffset + i;
+        const int index = _index[k];
+
+        if(index >= 0)
+        {
+          // the 4 neighbors are inside the image: direct bilinear interpolation
+          const double dx = _x[k] - std::floor(_x[k]);
+          const double dy = _y[k] - std::floor(_y[k]);
+          const RealType top = RealPixel::convert_to_real(src[index]) * (1.0 - dx) + RealPixel::convert_to_real(src[index + 1]) * dx;
+          const RealType bottom = RealPixel::convert_to_real(src[index + _width]) * (1.0 - dx) + RealPixel::convert_to_real(src[index + _width + 1]) * dx;
+          dst[i] = RealPixel::convert_from_real(RealType(top * (1.0 - dy) + bottom * dy));
+        }
+        else if(index == border)
+        {
+          dst[i] = sampler(imageIn, _y[k], _x[k]);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Save the remap table in a binary file
+   * @return true if the file has been written
+   */
+  bool save(const std::string& filepath) const
+  {
+    std::ofstream file(filepath, std::ios::binary);
+    if(!file)
+      return false;
+
+    const std::int32_t header[] = {magic, version, static_cast<std::int32_t>(_intrinsicType),
+                                   static_cast<std::int32_t>(_intrinsicParams.size()),
+                                   _width, _height, _correctPrincipalPoint};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(_intrinsicParams.data()), _intrinsicParams.size() * sizeof(double));
+    file.write(reinterpret_cast<const char*>(_x.data()), _x.size() * sizeof(float));
+    file.write(reinterpret_cast<const char*>(_y.data()), _y.size() * sizeof(float));
+    return bool(file);
+  }
+
+  /**
+   * @brief Load a remap table from a binary file written by save()
+   * @return true if the remap table has been loaded
+   */
+  bool load(const std::string& filepath)
+  {
+    std::ifstream file(filepath, std::ios::binary);
+    if(!file)
+      return false;
+
+    std::int32_t header[7];
+    if(!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+       header[0] != magic || header[1] != version ||
+       header[3] < 0 || header[4] < 0 || header[5] < 0)
+    {
+      ALICEVISION_LOG_WARNING("Invalid undistortion map file: " << filepath);
+      return false;
+    }
+
+    _intrinsicType = static_cast<EINTRINSIC>(header[2]);
+    _intrinsicParams.resize(header[3]);
+    _width = header[4];
+    _height = header[5];
+    _correctPrincipalPoint = (header[6] != 0);
+    _x.resize(std::size_t(_width) * _height);
+    _y.resize(std::size_t(_width) * _height);
+
+    file.read(reinterpret_cast<char*>(_intrinsicParams.data()), _intrinsicParams.size() * sizeof(double));
+    file.read(reinterpret_cast<char*>(_x.data()), _x.size() * sizeof(float));
+    file.read(reinterpret_cast<char*>(_y.data()), _y.size() * sizeof(float));
+    if(!file)
+    {
+      ALICEVISION_LOG_WARNING("Truncated undistortion map file: " << filepath);
+      *this = UndistortionMap();
+      return false;
+    }
+
+    initIndexes();
+    return true;
+  }
+
+  int width() const { return _width; }
+  int height() const { return _height; }
+  bool empty() const { return _x.empty(); }
+
+  /// memory used by the remap table in bytes
+  std::size_t memorySize() const
+  {
+    return _x.size() * sizeof(float) + _y.size() * sizeof(float) + _index.size() * sizeof(int);
+  }
+
+private:
+
+  /// index of the pixels outside of the distorted image
+  static const int outside = -1;
+  /// index of the pixels on the border of the distorted image, interpolated with the sampler
+  static const int border = -2;
+
+  static const std::int32_t magic = 0x4d555641; // "AVUM"
+  static const std::int32_t version = 1;
+
+  /// compute the index of the top-left neighbor of each distorted position
+  void initIndexes()
+  {
+    _index.resize(_x.size());
+
+    #pragma omp parallel for
+    for(int j = 0; j < _height; ++j)
+    {
+      const std::size_t rowOffset = std::size_t(j) * _width;
+      for(int i = 0; i < _width; ++i)
+      {
+        const std::size_t k = rowOffset + i;
+        const float x = _x[k];
+        const float y = _y[k];
+
+        // same test as image::Image::Contains on the distorted position
+        const int xi = static_cast<int>(x);
+        const int yi = static_cast<int>(y);
+        if(!(0 <= xi && xi < _width && 0 <= yi && yi < _height))
+        {
+          _index[k] = outside;
+          continue;
+        }
+
+        const int x0 = static_cast<int>(std::floor(x));
+        const int y0 = static_cast<int>(std::floor(y));
+        if(x0 >= 0 && y0 >= 0 && x0 + 1 < _width && y0 + 1 < _height)
+          _index[k] = y0 * _width + x0;
+        else
+          _index[k] = border;
+      }
+    }
+  }
+
+  EINTRINSIC _intrinsicType = PINHOLE_CAMERA_START;
+  std::vector<double> _intrinsicParams;
+  bool _correctPrincipalPoint = false;
+  int _width = 0;
+  int _height = 0;
+  /// distorted position of each undistorted pixel
+  std::vector<float> _x;
+  std::vector<float> _y;
+  /// top-left neighbor in the distorted image or outside / border
+  std::vector<int> _index;
+};
+
+} // namespace camera
+} // namespace aliceVision
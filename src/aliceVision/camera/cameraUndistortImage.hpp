@@ -52,17 +52,23 @@ void UndistortImage(
 
     #pragma omp parallel for
     for (int j = 0; j < imageIn.Height(); ++j)
+    {
+      // compute coordinates with distortion for the whole row
+      Mat2X row_pix(2, imageIn.Width());
+      row_pix.row(0) = Eigen::RowVectorXd::LinSpaced(imageIn.Width(), 0, imageIn.Width() - 1);
+      row_pix.row(1).setConstant(j);
+      intrinsicPtr->getDistortedPixelsBatch(row_pix, row_pix);
+      row_pix.colwise() += ppCorrection;
+
       for (int i = 0; i < imageIn.Width(); ++i)
       {
-        const Vec2 undisto_pix(i,j);
-
-        // compute coordinates with distortion
-        const Vec2 disto_pix = intrinsicPtr->get_d_pixel(undisto_pix) + ppCorrection;
+        const Vec2 disto_pix = row_pix.col(i);
 
         // pick pixel if it is in the image domain
         if ( imageIn.Contains(disto_pix(1), disto_pix(0)) )
           image_ud( j, i ) = sampler(imageIn, disto_pix(1), disto_pix(0));
       }
+    }
   }
 }
 
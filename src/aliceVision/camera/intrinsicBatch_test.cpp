@@ -0,0 +1,181 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#define BOOST_TEST_MODULE intrinsicBatch
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+namespace {
+
+std::vector<std::shared_ptr<IntrinsicBase>> createCameras()
+{
+  return {
+    std::make_shared<Pinhole>(1000, 1000, 1000, 500, 500),
+    std::make_shared<PinholeRadialK1>(1000, 1000, 1000, 500, 500, 0.1),
+    std::make_shared<PinholeRadialK3>(1000, 1000, 1000, 500, 500, -0.245539, 0.255195, 0.163773),
+    std::make_shared<PinholeBrownT2>(1000, 1000, 1000, 500, 500, -0.054, 0.014, 0.006, 0.001, -0.001),
+    std::make_shared<PinholeFisheye>(1000, 1000, 1000, 500, 500, -0.054, 0.014, 0.006, 0.001),
+    std::make_shared<PinholeFisheye1>(1000, 1000, 1000, 500, 500, 0.1)
+  };
+}
+
+/// random pixels inside the image domain
+Mat2X randomPixels(std::size_t nbPoints)
+{
+  return (Mat2X::Random(2, nbPoints) * 800. / 2.).colwise() + Vec2(500, 500);
+}
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - For each camera model, compare the batched functions with the per-point functions
+// - The batched functions must support an output matrix aliasing the input matrix
+//-----------------
+BOOST_AUTO_TEST_CASE(intrinsicBatch_consistency)
+{
+  const std::size_t nbPoints = 500;
+  const double epsilon = 1e-8;
+
+  for(const auto& cam : createCameras())
+  {
+    const Mat2X pixels = randomPixels(nbPoints);
+
+    Mat2X camPts, imaPts, distoPts, undistoPts, udPixels, dPixels;
+    cam->ima2camBatch(pixels, camPts);
+    cam->cam2imaBatch(camPts, imaPts);
+    cam->addDistortionBatch(camPts, distoPts);
+    cam->removeDistortionBatch(camPts, undistoPts);
+    cam->getUndistortedPixelsBatch(pixels, udPixels);
+    cam->getDistortedPixelsBatch(pixels, dPixels);
+
+    for(std::size_t i = 0; i < nbPoints; ++i)
+    {
+      const Vec2 camPt = cam->ima2cam(pixels.col(i));
+      EXPECT_MATRIX_NEAR(camPt, camPts.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(Vec2(cam->cam2ima(camPt)), imaPts.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(Vec2(cam->add_disto(camPt)), distoPts.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(Vec2(cam->remove_disto(camPt)), undistoPts.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(Vec2(cam->get_ud_pixel(pixels.col(i))), udPixels.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(Vec2(cam->get_d_pixel(pixels.col(i))), dPixels.col(i), epsilon);
+    }
+
+    // in place
+    Mat2X inPlace = pixels;
+    cam->getUndistortedPixelsBatch(inPlace, inPlace);
+    EXPECT_MATRIX_NEAR(udPixels, inPlace, epsilon);
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Project random 3D points in front of a random pose
+// - Compare projectBatch and residuals with the per-point projection
+//-----------------
+BOOST_AUTO_TEST_CASE(intrinsicBatch_project)
+{
+  const std::size_t nbPoints = 500;
+  const double epsilon = 1e-8;
+
+  const geometry::Pose3 pose(RotationAroundY(0.1) * RotationAroundX(-0.05), Vec3(0.1, -0.2, -1.0));
+  Mat3X pts3D = Mat3X::Random(3, nbPoints) * 0.3;
+  pts3D.row(2).array() += 2.0;
+
+  for(const auto& cam : createCameras())
+  {
+    for(bool applyDistortion : {true, false})
+    {
+      Mat2X proj;
+      cam->projectBatch(pose, pts3D, proj, applyDistortion);
+      BOOST_CHECK_EQUAL(proj.cols(), nbPoints);
+
+      for(std::size_t i = 0; i < nbPoints; ++i)
+        EXPECT_MATRIX_NEAR(cam->project(pose, pts3D.col(i), applyDistortion), proj.col(i), epsilon);
+    }
+
+    const Mat2X observations = randomPixels(nbPoints);
+    const Mat2X residuals = cam->residuals(pose, pts3D, observations);
+    for(std::size_t i = 0; i < nbPoints; ++i)
+      EXPECT_MATRIX_NEAR(cam->residual(pose, pts3D.col(i), observations.col(i)), residuals.col(i), epsilon);
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Solve the undistorted radius of a PinholeRadialK3 with Newton and bisection
+// - Assert that both solvers agree
+// - Check that remove_disto of the PinholeBrownT2 is the inverse of add_disto
+//-----------------
+BOOST_AUTO_TEST_CASE(intrinsicBatch_undistortionSolvers)
+{
+  const std::vector<double> params = {-0.245539, 0.255195, 0.163773};
+  const auto functor = [](const std::vector<double>& p, double r2)
+  {
+    return r2 * Square(1. + r2 * (p[0] + r2 * (p[1] + r2 * p[2])));
+  };
+
+  for(int i = 1; i <= 100; ++i)
+  {
+    const double r2 = Square(i * 0.01);
+    double r2Newton;
+    BOOST_CHECK(radial_distortion::newton_Radius_Solve(params, r2, r2Newton));
+    BOOST_CHECK_SMALL(r2Newton - radial_distortion::bisection_Radius_Solve(params, r2, functor), 1e-6);
+  }
+
+  const PinholeBrownT2 cam(1000, 1000, 1000, 500, 500, -0.054, 0.014, 0.006, 0.001, -0.001);
+  const Mat2X pixels = randomPixels(500);
+  for(Mat2X::Index i = 0; i < pixels.cols(); ++i)
+  {
+    const Vec2 ptCamera = cam.ima2cam(pixels.col(i));
+    EXPECT_MATRIX_NEAR(ptCamera, cam.add_disto(cam.remove_disto(ptCamera)), 1e-8);
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Undistort a full image worth of pixels per camera model
+// - Report the throughput of the per-point and the batched functions
+//-----------------
+BOOST_AUTO_TEST_CASE(intrinsicBatch_throughput)
+{
+  const std::size_t nbPoints = 1000 * 1000;
+  const Mat2X pixels = randomPixels(nbPoints);
+
+  for(const auto& cam : createCameras())
+  {
+    Mat2X perPoint(2, nbPoints);
+    Mat2X batch;
+
+    const auto startPerPoint = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < nbPoints; ++i)
+      perPoint.col(i) = cam->get_ud_pixel(pixels.col(i));
+    const auto startBatch = std::chrono::steady_clock::now();
+    cam->getUndistortedPixelsBatch(pixels, batch);
+    const auto end = std::chrono::steady_clock::now();
+
+    BOOST_CHECK_SMALL((perPoint - batch).cwiseAbs().maxCoeff(), 1e-8);
+
+    const double perPointSec = std::chrono::duration<double>(startBatch - startPerPoint).count();
+    const double batchSec = std::chrono::duration<double>(end - startBatch).count();
+    BOOST_TEST_MESSAGE(EINTRINSIC_enumToString(cam->getType()) << " undistortion: "
+                       << nbPoints / perPointSec * 1e-6 << " Mpixels/s per point, "
+                       << nbPoints / batchSec * 1e-6 << " Mpixels/s batched");
+  }
+}
@@ -0,0 +1,155 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+
+#define BOOST_TEST_MODULE undistortionMap
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+image::Image<image::RGBfColor> createImage(int width, int height)
+{
+  image::Image<image::RGBfColor> img(width, height);
+  for(int j = 0; j < height; ++j)
+    for(int i = 0; i < width; ++i)
+      img(j, i) = image::RGBfColor(std::sin(i * 0.05f), std::cos(j * 0.03f), (i + j) / float(width + height));
+  return img;
+}
+
+float maxDifference(const image::Image<image::RGBfColor>& a, const image::Image<image::RGBfColor>& b)
+{
+  float maxDiff = 0.f;
+  for(int j = 0; j < a.Height(); ++j)
+    for(int i = 0; i < a.Width(); ++i)
+      maxDiff = std::max(maxDiff, (a(j, i) - b(j, i)).cwiseAbs().maxCoeff());
+  return maxDiff;
+}
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - Undistort an image with UndistortImage and with an UndistortionMap
+// - Assert that both images are identical for each distortion model
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_apply)
+{
+  const int width = 320;
+  const int height = 240;
+  const image::Image<image::RGBfColor> img = createImage(width, height);
+
+  const std::vector<std::shared_ptr<IntrinsicBase>> cameras = {
+    std::make_shared<PinholeRadialK1>(width, height, 300, 160, 120, -0.1),
+    std::make_shared<PinholeRadialK3>(width, height, 300, 162, 118, -0.245539, 0.255195, 0.163773),
+    std::make_shared<PinholeBrownT2>(width, height, 300, 160, 120, -0.054, 0.014, 0.006, 0.001, -0.001),
+    std::make_shared<PinholeFisheye>(width, height, 300, 160, 120, -0.054, 0.014, 0.006, 0.001)
+  };
+
+  for(const auto& cam : cameras)
+  {
+    for(bool correctPrincipalPoint : {false, true})
+    {
+      image::Image<image::RGBfColor> expected, undistorted;
+      UndistortImage(img, cam.get(), expected, image::FBLACK, correctPrincipalPoint);
+
+      UndistortionMap map;
+      map.compute(*cam, width, height, correctPrincipalPoint);
+      BOOST_CHECK(map.isCompatible(*cam, width, height, correctPrincipalPoint));
+      map.apply(img, undistorted, image::FBLACK);
+
+      BOOST_CHECK_EQUAL(undistorted.Width(), width);
+      BOOST_CHECK_EQUAL(undistorted.Height(), height);
+      BOOST_CHECK_SMALL(maxDifference(expected, undistorted), 1e-5f);
+    }
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Save and load an UndistortionMap
+// - Assert that the loaded map gives the same result and is only compatible with the same intrinsic
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_saveLoad)
+{
+  const int width = 200;
+  const int height = 150;
+  const image::Image<image::RGBfColor> img = createImage(width, height);
+  const PinholeRadialK3 cam(width, height, 200, 100, 75, -0.2, 0.1, 0.0);
+
+  UndistortionMap map;
+  map.compute(cam, width, height);
+
+  const std::string filepath = (fs::temp_directory_path() / fs::unique_path("undistortionMap_%%%%%%.bin")).string();
+  BOOST_REQUIRE(map.save(filepath));
+
+  UndistortionMap loaded;
+  BOOST_REQUIRE(loaded.load(filepath));
+  fs::remove(filepath);
+
+  BOOST_CHECK(loaded.isCompatible(cam, width, height));
+  BOOST_CHECK(!loaded.isCompatible(cam, width / 2, height / 2));
+  BOOST_CHECK(!loaded.isCompatible(PinholeRadialK3(width, height, 200, 100, 75, -0.21, 0.1, 0.0), width, height));
+
+  image::Image<image::RGBfColor> a, b;
+  map.apply(img, a, image::FBLACK);
+  loaded.apply(img, b, image::FBLACK);
+  BOOST_CHECK_EQUAL(maxDifference(a, b), 0.f);
+
+  // image size mismatch
+  BOOST_CHECK_THROW(loaded.apply(createImage(width / 2, height), b, image::FBLACK), std::invalid_argument);
+
+  // invalid file
+  BOOST_CHECK(!loaded.load(filepath));
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Undistort several images sharing the same intrinsic
+// - Report the time spent with UndistortImage and with a cached UndistortionMap
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_throughput)
+{
+  const int width = 1920;
+  const int height = 1080;
+  const int nbImages = 5;
+  const image::Image<image::RGBfColor> img = createImage(width, height);
+  const PinholeRadialK3 cam(width, height, 1500, 960, 540, -0.245539, 0.255195, 0.163773);
+
+  image::Image<image::RGBfColor> expected, undistorted;
+
+  const auto startDirect = std::chrono::steady_clock::now();
+  for(int i = 0; i < nbImages; ++i)
+    UndistortImage(img, &cam, expected, image::FBLACK);
+  const auto startMap = std::chrono::steady_clock::now();
+  UndistortionMap map;
+  map.compute(cam, width, height);
+  const auto startApply = std::chrono::steady_clock::now();
+  for(int i = 0; i < nbImages; ++i)
+    map.apply(img, undistorted, image::FBLACK);
+  const auto end = std::chrono::steady_clock::now();
+
+  BOOST_CHECK_SMALL(maxDifference(expected, undistorted), 1e-5f);
+
+  const double directMs = std::chrono::duration<double, std::milli>(startMap - startDirect).count() / nbImages;
+  const double computeMs = std::chrono::duration<double, std::milli>(startApply - startMap).count();
+  const double applyMs = std::chrono::duration<double, std::milli>(end - startApply).count() / nbImages;
+  BOOST_TEST_MESSAGE("Undistortion of a " << width << "x" << height << " image: " << directMs << " ms direct, "
+                     << applyMs << " ms with the map (computed once in " << computeMs << " ms)");
+}
@@ -6,6 +6,7 @@
 
 #include "RefineRc.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <aliceVision/mvsData/Point2d.hpp>
@@ -232,6 +233,8 @@ DepthSimMap* RefineRc::optimizeDepthSimMapCUDA(DepthSimMap* depthPixSizeMapVis,
 
 bool RefineRc::refinerc(bool checkIfExists)
 {
+    ALICEVISION_PERF_ZONE("depthMap.refine");
+
     const IndexT viewId = _sp->mp->getViewId(_rc);
 
     if(_sp->mp->verbose)
@@ -130,6 +130,19 @@ public:
   {
     setConfigurationPreset(EImageDescriberPreset_stringToEnum(preset));
   }
+
+  /**
+   * @brief Get the maximum number of regions kept by the describer
+   * @return the maximum number of regions (0: no limit)
+   */
+  virtual std::size_t getMaxNbFeatures() const { return 0; }
+
+  /**
+   * @brief Set the maximum number of regions kept by the describer,
+   *        overridden by the next configuration preset
+   * @param[in] maxNbFeatures The maximum number of regions (0: no limit)
+   */
+  virtual void setMaxNbFeatures(std::size_t maxNbFeatures) {}
   
   /**
    * @brief Detect regions on the 8-bit image and compute their attributes (description)
@@ -262,7 +262,9 @@ public:
     assert(genericRegions);
     assert(j < genericRegions->RegionCount());
 
-    const This * regionsT = dynamic_cast<const This*>(genericRegions);
+    assert(dynamic_cast<const This*>(genericRegions) != nullptr);
+
+    const This * regionsT = static_cast<const This*>(genericRegions);
     static typename SquaredMetric<T, regionType>::Metric metric;
     return metric(this->_vec_descs[i].getData(), regionsT->_vec_descs[j].getData(), DescriptorT::static_size);
   }
@@ -0,0 +1,376 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TiledImageDescriber.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace aliceVision {
+namespace feature {
+
+std::vector<ImageTile> computeImageTiles(int width, int height, int tileSize, int tileOverlap)
+{
+  if(tileSize <= 0)
+    throw std::invalid_argument("Invalid tile size: " + std::to_string(tileSize));
+
+  const int nbTilesX = (width + tileSize - 1) / tileSize;
+  const int nbTilesY = (height + tileSize - 1) / tileSize;
+
+  std::vector<ImageTile> tiles;
+  tiles.reserve(nbTilesX * nbTilesY);
+
+  // tiles of similar sizes, to avoid thin tiles on the last row / column
+  for(int ty = 0; ty < nbTilesY; ++ty)
+  {
+    const int y0 = (ty * height) / nbTilesY;
+    const int y1 = ((ty + 1) * height) / nbTilesY;
+
+    for(int tx = 0; tx < nbTilesX; ++tx)
+    {
+      const int x0 = (tx * width) / nbTilesX;
+      const int x1 = ((tx + 1) * width) / nbTilesX;
+
+      ImageTile tile;
+      tile.x = x0;
+      tile.y = y0;
+      tile.width = x1 - x0;
+      tile.height = y1 - y0;
+      tile.extX = std::max(0, x0 - tileOverlap);
+      tile.extY = std::max(0, y0 - tileOverlap);
+      tile.extWidth = std::min(width, x1 + tileOverlap) - tile.extX;
+      tile.extHeight = std::min(height, y1 + tileOverlap) - tile.extY;
+      tiles.push_back(tile);
+    }
+  }
+  return tiles;
+}
+
+std::unique_ptr<Regions> selectRegions(const Regions& regions,
+                                       int width,
+                                       int height,
+                                       std::size_t maxNbFeatures,
+                                       std::size_t gridSize)
+{
+  const FeatRegions<SIOPointFeature>* sioRegions = dynamic_cast<const FeatRegions<SIOPointFeature>*>(&regions);
+  if(sioRegions == nullptr)
+    throw std::runtime_error("Cannot select regions without scale information.");
+
+  const std::vector<SIOPointFeature>& features = sioRegions->Features();
+
+  // sort features by scale to guarantee best points are kept
+  std::vector<std::size_t> sortedIndexes(features.size());
+  std::iota(sortedIndexes.begin(), sortedIndexes.end(), 0);
+  std::stable_sort(sortedIndexes.begin(), sortedIndexes.end(), [&](std::size_t a, std::size_t b){ return features[a].scale() > features[b].scale(); });
+
+  std::vector<std::size_t> selectedIndexes;
+
+  if(maxNbFeatures == 0 || features.size() <= maxNbFeatures)
+  {
+    selectedIndexes.swap(sortedIndexes);
+  }
+  else
+  {
+    // grid filtering of the keypoints to ensure a global repartition
+    const std::size_t nbCells = std::max(std::size_t(1), gridSize);
+    const std::size_t keypointsPerCell = std::max(std::size_t(1), maxNbFeatures / (nbCells * nbCells));
+    const double regionWidth = width / static_cast<double>(nbCells);
+    const double regionHeight = height / static_cast<double>(nbCells);
+
+    std::vector<std::size_t> countFeatPerCell(nbCells * nbCells, 0);
+    std::vector<std::size_t> rejectedIndexes;
+    selectedIndexes.reserve(maxNbFeatures);
+
+    for(const std::size_t i : sortedIndexes)
+    {
+      const SIOPointFeature& feature = features.at(i);
+      const std::size_t cellX = std::min(static_cast<std::size_t>(std::max(0.0, feature.x() / regionWidth)), nbCells - 1);
+      const std::size_t cellY = std::min(static_cast<std::size_t>(std::max(0.0, feature.y() / regionHeight)), nbCells - 1);
+
+      std::size_t& count = countFeatPerCell.at(cellX * nbCells + cellY);
+      ++count;
+
+      if(count > keypointsPerCell || selectedIndexes.size() >= maxNbFeatures)
+        rejectedIndexes.push_back(i);
+      else
+        selectedIndexes.push_back(i);
+    }
+
+    // if we don't have enough features (empty cells in the grid for example),
+    // we add the best other ones, without repartition constraint.
+    const std::size_t remainingElements = std::min(rejectedIndexes.size(), maxNbFeatures - selectedIndexes.size());
+    selectedIndexes.insert(selectedIndexes.end(), rejectedIndexes.begin(), rejectedIndexes.begin() + remainingElements);
+
+    // keep the output sorted by scale
+    std::stable_sort(selectedIndexes.begin(), selectedIndexes.end(), [&](std::size_t a, std::size_t b){ return features[a].scale() > features[b].scale(); });
+  }
+
+  std::unique_ptr<Regions> outRegions(regions.EmptyClone());
+  for(const std::size_t i : selectedIndexes)
+    regions.CopyRegion(i, outRegions.get());
+
+  return outRegions;
+}
+
+TiledImageDescriber::TiledImageDescriber(const std::shared_ptr<ImageDescriber>& imageDescriber,
+                                         const TiledExtractionParams& params)
+  : _imageDescriber(imageDescriber)
+  , _params(params)
+{
+  if(!_imageDescriber)
+    throw std::invalid_argument("Tiled extraction needs an image describer.");
+  if(_params.tileSize <= 0 || _params.tileOverlap < 0)
+    throw std::invalid_argument("Invalid tiled extraction parameters (tile size: " + std::to_string(_params.tileSize) +
+                                ", overlap: " + std::to_string(_params.tileOverlap) + ").");
+
+  disableDescriberSelection();
+}
+
+void TiledImageDescriber::disableDescriberSelection()
+{
+  // the selection per tile would keep up to the budget in each tile
+  // and hide the best regions of the whole image to the global selection
+  _maxNbFeatures = (_params.maxNbFeatures > 0) ? _params.maxNbFeatures : _imageDescriber->getMaxNbFeatures();
+  _imageDescriber->setMaxNbFeatures(0);
+}
+
+int TiledImageDescriber::getNbParallelTiles() const
+{
+  // GPU describers process a single image at a time
+  if(_imageDescriber->useCuda())
+    return 1;
+
+  // threads available to the current thread: the cores left to this image when several images are extracted in parallel
+  const int nbThreads = omp_get_max_threads();
+  return (_params.maxParallelTiles > 0) ? std::min(_params.maxParallelTiles, nbThreads) : nbThreads;
+}
+
+std::size_t TiledImageDescriber::getMemoryConsumption(std::size_t width, std::size_t height) const
+{
+  const std::vector<ImageTile> tiles = computeImageTiles(width, height, _params.tileSize, _params.tileOverlap);
+
+  if(tiles.size() <= 1)
+    return _imageDescriber->getMemoryConsumption(width, height);
+
+  std::size_t maxTileMemory = 0;
+  for(const ImageTile& tile : tiles)
+    maxTileMemory = std::max(maxTileMemory, _imageDescriber->getMemoryConsumption(tile.extWidth, tile.extHeight));
+
+  const std::size_t nbParallelTiles = std::min(tiles.size(), static_cast<std::size_t>(getNbParallelTiles()));
+
+  // the full resolution image and the tiles extracted in parallel
+  return width * height * sizeof(float) + nbParallelTiles * maxTileMemory;
+}
+
+bool TiledImageDescriber::describe(const image::Image<unsigned char>& image,
+                                   std::unique_ptr<Regions>& regions,
+                                   const image::Image<unsigned char>* mask)
+{
+  return describeTiles(image, regions, mask);
+}
+
+bool TiledImageDescriber::describe(const image::Image<float>& image,
+                                   std::unique_ptr<Regions>& regions,
+                                   const image::Image<unsigned char>* mask)
+{
+  return describeTiles(image, regions, mask);
+}
+
+template <typename T>
+bool TiledImageDescriber::describeTiles(const image::Image<T>& image,
+                                        std::unique_ptr<Regions>& regions,
+                                        const image::Image<unsigned char>* mask)
+{
+  const int width = image.Width();
+  const int height = image.Height();
+  const std::vector<ImageTile> tiles = computeImageTiles(width, height, _params.tileSize, _params.tileOverlap);
+
+  // the image fits in a single tile
+  if(tiles.size() <= 1)
+  {
+    if(!_imageDescriber->describe(image, regions, mask))
+      return false;
+    if(_maxNbFeatures > 0 && regions->RegionCount() > _maxNbFeatures)
+      regions = selectRegions(*regions, width, height, _maxNbFeatures, _params.gridSize);
+    return true;
+  }
+
+  const int nbParallelTiles = std::min(static_cast<int>(tiles.size()), getNbParallelTiles());
+
+  // the threads of the image are split between the tiles (nested parallel regions of the describer)
+  const int nbThreadsPerTile = std::max(1, omp_get_max_threads() / nbParallelTiles);
+
+  ALICEVISION_LOG_DEBUG("Tiled extraction: " << tiles.size() << " tiles (" << nbParallelTiles << " in parallel).");
+
+  std::vector<std::unique_ptr<Regions>> regionsPerTile(tiles.size());
+  std::vector<char> tileSucceeded(tiles.size(), 0);
+  std::string errorMessage;
+
+  #pragma omp parallel for num_threads(nbParallelTiles) schedule(dynamic)
+  for(int t = 0; t < static_cast<int>(tiles.size()); ++t)
+  {
+    omp_set_num_threads(nbThreadsPerTile);
+
+    const ImageTile& tile = tiles.at(t);
+
+    try
+    {
+      const image::Image<T> tileImage(typename image::Image<T>::Base(image.block(tile.extY, tile.extX, tile.extHeight, tile.extWidth)));
+
+      image::Image<unsigned char> tileMask;
+      if(mask)
+        tileMask = typename image::Image<unsigned char>::Base(mask->block(tile.extY, tile.extX, tile.extHeight, tile.extWidth));
+
+      std::unique_ptr<Regions>& tileRegions = regionsPerTile.at(t);
+      tileSucceeded.at(t) = _imageDescriber->describe(tileImage, tileRegions, mask ? &tileMask : nullptr);
+
+      if(!tileSucceeded.at(t) || !tileRegions)
+        continue;
+
+      FeatRegions<SIOPointFeature>* sioRegions = dynamic_cast<FeatRegions<SIOPointFeature>*>(tileRegions.get());
+      if(sioRegions == nullptr)
+        throw std::runtime_error("Tiled extraction is not available for " + EImageDescriberType_enumToString(getDescriberType()) + " regions.");
+
+      // tile coordinates to image coordinates
+      for(SIOPointFeature& feature : sioRegions->Features())
+      {
+        feature.x() += tile.extX;
+        feature.y() += tile.extY;
+      }
+    }
+    catch(const std::exception& e)
+    {
+      #pragma omp critical
+      errorMessage = e.what();
+    }
+  }
+
+  if(!errorMessage.empty())
+    throw std::runtime_error(errorMessage);
+
+  for(std::size_t t = 0; t < tiles.size(); ++t)
+  {
+    if(!tileSucceeded.at(t))
+    {
+      ALICEVISION_LOG_WARNING("Tiled extraction: cannot describe the tile " << t << ".");
+      return false;
+    }
+  }
+
+  // keep the features inside the core area of their tile
+  struct TileFeature
+  {
+    std::size_t tileIndex;
+    std::size_t featureIndex;
+    bool duplicate;
+  };
+
+  std::vector<TileFeature> tileFeatures;
+  for(std::size_t t = 0; t < tiles.size(); ++t)
+  {
+    const ImageTile& tile = tiles.at(t);
+    const std::vector<SIOPointFeature>& features = getSIOPointFeatures(*regionsPerTile.at(t));
+
+    for(std::size_t i = 0; i < features.size(); ++i)
+    {
+      const SIOPointFeature& feature = features.at(i);
+      if(feature.x() >= tile.x && feature.x() < tile.x + tile.width &&
+         feature.y() >= tile.y && feature.y() < tile.y + tile.height)
+        tileFeatures.push_back({t, i, false});
+    }
+  }
+
+  // remove the duplicates at the seams: the same feature detected on both sides of a seam
+  // with a small localization difference (different tiles, same position, scale and orientation)
+  const float tolerance = std::max(_params.seamTolerance, 1e-3f);
+  std::unordered_map<long long, std::vector<std::size_t>> seamFeaturesPerCell;
+  const auto cellKey = [&](float x, float y)
+  {
+    return static_cast<long long>(std::floor(y / tolerance)) * (static_cast<long long>(width / tolerance) + 3) +
+           static_cast<long long>(std::floor(x / tolerance));
+  };
+
+  std::vector<std::size_t> seamFeatures;
+  for(std::size_t f = 0; f < tileFeatures.size(); ++f)
+  {
+    const ImageTile& tile = tiles.at(tileFeatures.at(f).tileIndex);
+    const SIOPointFeature& feature = getSIOPointFeatures(*regionsPerTile.at(tileFeatures.at(f).tileIndex)).at(tileFeatures.at(f).featureIndex);
+
+    // distance to the inner seams (image borders are not seams)
+    const bool nearSeam = (tile.x > 0 && feature.x() - tile.x < tolerance) ||
+                          (tile.x + tile.width < width && tile.x + tile.width - feature.x() < tolerance) ||
+                          (tile.y > 0 && feature.y() - tile.y < tolerance) ||
+                          (tile.y + tile.height < height && tile.y + tile.height - feature.y() < tolerance);
+    if(!nearSeam)
+      continue;
+
+    seamFeatures.push_back(f);
+    seamFeaturesPerCell[cellKey(feature.x(), feature.y())].push_back(f);
+  }
+
+  std::size_t nbDuplicates = 0;
+  for(const std::size_t f : seamFeatures)
+  {
+    TileFeature& tileFeature = tileFeatures.at(f);
+    if(tileFeature.duplicate)
+      continue;
+
+    const SIOPointFeature& feature = getSIOPointFeatures(*regionsPerTile.at(tileFeature.tileIndex)).at(tileFeature.featureIndex);
+
+    for(int dy = -1; dy <= 1; ++dy)
+    {
+      for(int dx = -1; dx <= 1; ++dx)
+      {
+        const auto cellIt = seamFeaturesPerCell.find(cellKey(feature.x() + dx * tolerance, feature.y() + dy * tolerance));
+        if(cellIt == seamFeaturesPerCell.end())
+          continue;
+
+        for(const std::size_t o : cellIt->second)
+        {
+          TileFeature& otherTileFeature = tileFeatures.at(o);
+          if(otherTileFeature.duplicate || otherTileFeature.tileIndex <= tileFeature.tileIndex)
+            continue;
+
+          const SIOPointFeature& other = getSIOPointFeatures(*regionsPerTile.at(otherTileFeature.tileIndex)).at(otherTileFeature.featureIndex);
+
+          const float angleDiff = std::abs(std::remainder(feature.orientation() - other.orientation(), 2.f * static_cast<float>(M_PI)));
+
+          if((feature.coords() - other.coords()).norm() <= tolerance &&
+             std::abs(feature.scale() - other.scale()) <= 0.1f * std::max(feature.scale(), other.scale()) &&
+             angleDiff <= 0.1f)
+          {
+            otherTileFeature.duplicate = true;
+            ++nbDuplicates;
+          }
+        }
+      }
+    }
+  }
+
+  // merge the regions of all tiles
+  std::unique_ptr<Regions> mergedRegions(regionsPerTile.front()->EmptyClone());
+  for(const TileFeature& tileFeature : tileFeatures)
+  {
+    if(!tileFeature.duplicate)
+      regionsPerTile.at(tileFeature.tileIndex)->CopyRegion(tileFeature.featureIndex, mergedRegions.get());
+  }
+  regionsPerTile.clear();
+
+  ALICEVISION_LOG_DEBUG("Tiled extraction: " << mergedRegions->RegionCount() << " regions (" << nbDuplicates << " duplicates removed at the seams).");
+
+  // global selection
+  regions = selectRegions(*mergedRegions, width, height, _maxNbFeatures, _params.gridSize);
+  return true;
+}
+
+} // namespace feature
+} // namespace aliceVision
@@ -0,0 +1,197 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/feature/ImageDescriber.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Tiled extraction parameters
+ */
+struct TiledExtractionParams
+{
+  /// size of the tiles in pixels (without overlap)
+  int tileSize = 4096;
+  /// overlap between neighboring tiles in pixels, features larger than the overlap may be lost at the seams
+  int tileOverlap = 512;
+  /// maximum distance in pixels between two features detected on both sides of a seam to be considered as duplicates
+  float seamTolerance = 2.f;
+  /// maximum number of tiles extracted in parallel (0: number of threads available)
+  int maxParallelTiles = 0;
+  /// maximum number of features on the whole image (0: the maximum number of features of the describer preset)
+  std::size_t maxNbFeatures = 0;
+  /// grid size for the repartition of the selected features
+  std::size_t gridSize = 4;
+};
+
+/**
+ * @brief A tile of an image
+ * @details Features are extracted on the extended area (tile with overlap)
+ *          and only those inside the core area are kept.
+ */
+struct ImageTile
+{
+  /// core area
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  /// extended area (core with overlap, clamped to the image)
+  int extX = 0;
+  int extY = 0;
+  int extWidth = 0;
+  int extHeight = 0;
+};
+
+/**
+ * @brief Split an image into overlapping tiles of similar sizes
+ * @param[in] width The image width
+ * @param[in] height The image height
+ * @param[in] tileSize The maximum size of the tiles (without overlap)
+ * @param[in] tileOverlap The overlap between neighboring tiles
+ * @return tiles, row by row
+ */
+std::vector<ImageTile> computeImageTiles(int width, int height, int tileSize, int tileOverlap);
+
+/**
+ * @brief Select the best regions with a global repartition constraint.
+ * @details Regions are sorted by decreasing scale (like the describers do)
+ *          and at most maxNbFeatures / gridSize^2 regions are kept per grid cell,
+ *          the best rejected regions are added if there is not enough regions.
+ * @param[in] regions The input regions (SIOPointFeature regions)
+ * @param[in] width The image width
+ * @param[in] height The image height
+ * @param[in] maxNbFeatures The maximum number of regions (0: no limit)
+ * @param[in] gridSize The grid size for the repartition
+ * @return the selected regions, sorted by decreasing scale
+ */
+std::unique_ptr<Regions> selectRegions(const Regions& regions,
+                                       int width,
+                                       int height,
+                                       std::size_t maxNbFeatures,
+                                       std::size_t gridSize);
+
+/**
+ * @brief Image describer which extracts the regions of large images tile by tile
+ * @details The image is split into overlapping tiles, described in parallel by another describer
+ *          with a bounded amount of memory per tile. The regions are merged in the image coordinates,
+ *          duplicates at the seams are removed and a global selection is applied.
+ *          The selection of the describer is disabled so that each tile keeps all its regions,
+ *          the global selection uses its budget by default.
+ *          Images smaller than a tile are described directly, with the same global selection.
+ */
+class TiledImageDescriber : public ImageDescriber
+{
+public:
+  /**
+   * @brief TiledImageDescriber constructor
+   * @param[in] imageDescriber The describer used on each tile (must produce SIOPointFeature regions),
+   *            its maximum number of features is disabled
+   * @param[in] params The tiled extraction parameters
+   */
+  TiledImageDescriber(const std::shared_ptr<ImageDescriber>& imageDescriber,
+                      const TiledExtractionParams& params = TiledExtractionParams());
+
+  bool useCuda() const override
+  {
+    return _imageDescriber->useCuda();
+  }
+
+  bool useFloatImage() const override
+  {
+    return _imageDescriber->useFloatImage();
+  }
+
+  EImageDescriberType getDescriberType() const override
+  {
+    return _imageDescriber->getDescriberType();
+  }
+
+  /**
+   * @brief Get the total amount of RAM needed for a
+   * feature extraction of an image of the given dimension.
+   * @note only the tiles extracted in parallel are taken into account
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @return total amount of memory needed
+   */
+  std::size_t getMemoryConsumption(std::size_t width, std::size_t height) const override;
+
+  void setUpRight(bool upRight) override
+  {
+    _imageDescriber->setUpRight(upRight);
+  }
+
+  void setUseCuda(bool useCuda) override
+  {
+    _imageDescriber->setUseCuda(useCuda);
+  }
+
+  void setCudaPipe(int pipe) override
+  {
+    _imageDescriber->setCudaPipe(pipe);
+  }
+
+  void setConfigurationPreset(EImageDescriberPreset preset) override
+  {
+    _imageDescriber->setConfigurationPreset(preset);
+    disableDescriberSelection();
+  }
+
+  std::size_t getMaxNbFeatures() const override
+  {
+    return _maxNbFeatures;
+  }
+
+  void setMaxNbFeatures(std::size_t maxNbFeatures) override
+  {
+    _maxNbFeatures = maxNbFeatures;
+  }
+
+  bool describe(const image::Image<unsigned char>& image,
+                std::unique_ptr<Regions>& regions,
+                const image::Image<unsigned char>* mask = nullptr) override;
+
+  bool describe(const image::Image<float>& image,
+                std::unique_ptr<Regions>& regions,
+                const image::Image<unsigned char>* mask = nullptr) override;
+
+  void allocate(std::unique_ptr<Regions>& regions) const override
+  {
+    _imageDescriber->allocate(regions);
+  }
+
+  const TiledExtractionParams& getParams() const
+  {
+    return _params;
+  }
+
+private:
+  /// number of tiles extracted in parallel
+  int getNbParallelTiles() const;
+
+  /// move the selection of the describer to the global selection
+  void disableDescriberSelection();
+
+  template <typename T>
+  bool describeTiles(const image::Image<T>& image,
+                     std::unique_ptr<Regions>& regions,
+                     const image::Image<unsigned char>* mask);
+
+  std::shared_ptr<ImageDescriber> _imageDescriber;
+  TiledExtractionParams _params;
+  /// maximum number of features of the global selection (0: no limit)
+  std::size_t _maxNbFeatures = 0;
+};
+
+} // namespace feature
+} // namespace aliceVision
@@ -0,0 +1,151 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/feature/TiledImageDescriber.hpp"
+#include "aliceVision/feature/akaze/ImageDescriber_AKAZE.hpp"
+#include "aliceVision/feature/syntheticImage.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#define BOOST_TEST_MODULE TiledImageDescriber
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+std::shared_ptr<ImageDescriber> createAKAZEDescriber()
+{
+  AKAZEOptions options;
+  options.maxTotalKeypoints = 100000; // no grid filtering
+  return std::make_shared<ImageDescriber_AKAZE>(AKAZEParams(options, AKAZE_MSURF));
+}
+
+BOOST_AUTO_TEST_CASE(TiledImageDescriber_tiles)
+{
+  const int width = 1000;
+  const int height = 700;
+  const std::vector<ImageTile> tiles = computeImageTiles(width, height, 300, 50);
+
+  BOOST_CHECK_EQUAL(tiles.size(), 4 * 3);
+
+  // core areas are a partition of the image
+  image::Image<int> coverage(width, height, true, 0);
+  for(const ImageTile& tile : tiles)
+  {
+    BOOST_CHECK_LE(tile.width, 300);
+    BOOST_CHECK_LE(tile.height, 300);
+    BOOST_CHECK_GE(tile.extX, 0);
+    BOOST_CHECK_GE(tile.extY, 0);
+    BOOST_CHECK_LE(tile.extX + tile.extWidth, width);
+    BOOST_CHECK_LE(tile.extY + tile.extHeight, height);
+    coverage.block(tile.y, tile.x, tile.height, tile.width).array() += 1;
+  }
+  BOOST_CHECK_EQUAL(coverage.minCoeff(), 1);
+  BOOST_CHECK_EQUAL(coverage.maxCoeff(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TiledImageDescriber_singleTile)
+{
+  const image::Image<float> image = createSyntheticImage(400, 300);
+  const std::shared_ptr<ImageDescriber> imageDescriber = createAKAZEDescriber();
+
+  std::unique_ptr<Regions> regions;
+  BOOST_CHECK(imageDescriber->describe(image, regions));
+
+  // the image fits in a tile: same output
+  TiledImageDescriber tiledImageDescriber(imageDescriber);
+  std::unique_ptr<Regions> tiledRegions;
+  BOOST_CHECK(tiledImageDescriber.describe(image, tiledRegions));
+
+  BOOST_CHECK_EQUAL(tiledImageDescriber.getDescriberType(), imageDescriber->getDescriberType());
+  BOOST_CHECK_EQUAL(tiledImageDescriber.getMemoryConsumption(400, 300), imageDescriber->getMemoryConsumption(400, 300));
+  BOOST_REQUIRE_EQUAL(tiledRegions->RegionCount(), regions->RegionCount());
+  for(std::size_t i = 0; i < regions->RegionCount(); ++i)
+    BOOST_CHECK(tiledRegions->GetRegionPosition(i) == regions->GetRegionPosition(i));
+}
+
+BOOST_AUTO_TEST_CASE(TiledImageDescriber_extraction)
+{
+  const int width = 1200;
+  const int height = 900;
+  const image::Image<float> image = createSyntheticImage(width, height);
+  const std::shared_ptr<ImageDescriber> imageDescriber = createAKAZEDescriber();
+
+  std::unique_ptr<Regions> regions;
+  BOOST_CHECK(imageDescriber->describe(image, regions));
+
+  TiledExtractionParams params;
+  params.tileSize = 400;
+  params.tileOverlap = 100;
+  TiledImageDescriber tiledImageDescriber(imageDescriber, params);
+
+  std::unique_ptr<Regions> tiledRegions;
+  BOOST_CHECK(tiledImageDescriber.describe(image, tiledRegions));
+
+  const std::vector<SIOPointFeature>& features = getSIOPointFeatures(*regions);
+  const std::vector<SIOPointFeature>& tiledFeatures = getSIOPointFeatures(*tiledRegions);
+
+  ALICEVISION_LOG_INFO("Features: " << features.size() << ", tiled features: " << tiledFeatures.size());
+
+  BOOST_CHECK_GT(tiledFeatures.size(), 0);
+
+  // the features smaller than the overlap are found in the tiled extraction, without duplicates
+  std::size_t nbSmallFeatures = 0;
+  std::size_t nbFound = 0;
+  for(const SIOPointFeature& feature : features)
+  {
+    if(feature.scale() * 10.f > params.tileOverlap)
+      continue;
+    ++nbSmallFeatures;
+
+    std::size_t nbMatches = 0;
+    for(const SIOPointFeature& tiledFeature : tiledFeatures)
+    {
+      if((tiledFeature.coords() - feature.coords()).norm() < 0.5f && tiledFeature.scale() == feature.scale())
+        ++nbMatches;
+    }
+    BOOST_CHECK_LE(nbMatches, 1);
+    nbFound += (nbMatches > 0);
+  }
+  BOOST_CHECK_GT(nbFound, 0.9 * nbSmallFeatures);
+
+  // output sorted by scale
+  for(std::size_t i = 1; i < tiledFeatures.size(); ++i)
+    BOOST_CHECK_GE(tiledFeatures.at(i - 1).scale(), tiledFeatures.at(i).scale());
+
+  // global selection
+  params.maxNbFeatures = 500;
+  TiledImageDescriber tiledImageDescriberMaxFeatures(imageDescriber, params);
+  std::unique_ptr<Regions> selectedRegions;
+  BOOST_CHECK(tiledImageDescriberMaxFeatures.describe(image, selectedRegions));
+  BOOST_CHECK_EQUAL(selectedRegions->RegionCount(), 500);
+
+  // bounded memory per tile
+  params.maxParallelTiles = 1;
+  TiledImageDescriber tiledImageDescriberOneTile(imageDescriber, params);
+  BOOST_CHECK_LT(tiledImageDescriberOneTile.getMemoryConsumption(20000, 15000), imageDescriber->getMemoryConsumption(20000, 15000) / 4);
+}
+
+BOOST_AUTO_TEST_CASE(TiledImageDescriber_describerBudget)
+{
+  const image::Image<float> image = createSyntheticImage(1200, 900);
+
+  AKAZEOptions options;
+  options.maxTotalKeypoints = 300;
+  const std::shared_ptr<ImageDescriber> imageDescriber = std::make_shared<ImageDescriber_AKAZE>(AKAZEParams(options, AKAZE_MSURF));
+
+  TiledExtractionParams params;
+  params.tileSize = 400;
+  params.tileOverlap = 100;
+  TiledImageDescriber tiledImageDescriber(imageDescriber, params);
+
+  // the budget of the describer is applied on the whole image, not per tile
+  BOOST_CHECK_EQUAL(tiledImageDescriber.getMaxNbFeatures(), 300);
+  BOOST_CHECK_EQUAL(imageDescriber->getMaxNbFeatures(), 0);
+
+  std::unique_ptr<Regions> tiledRegions;
+  BOOST_CHECK(tiledImageDescriber.describe(image, tiledRegions));
+  BOOST_CHECK_EQUAL(tiledRegions->RegionCount(), 300);
+}
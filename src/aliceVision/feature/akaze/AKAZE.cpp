@@ -114,6 +114,20 @@ float computeAutomaticContrastFactor(const image::Image<float>& image,
   return gradMax * static_cast<float>(binId) / static_cast<float>(nbBins);
 }
 
+/**
+ * @brief Scratch images of the AKAZE slice computation
+ * @note reused from one slice to the next to avoid allocations
+ */
+struct AKAZESliceBuffers
+{
+  /// smoothed image, also used as diffusivity image
+  image::Image<float> smoothed;
+  /// FED step output
+  image::Image<float> fed;
+  /// second order derivatives
+  image::Image<float> Lxx, Lyy, Lxy;
+};
+
 /**
  * @brief Compute an AKAZE slice
  * @param[in] src Input image for the given octave
@@ -126,6 +140,7 @@ float computeAutomaticContrastFactor(const image::Image<float>& image,
  * @param Lx X derivatives
  * @param Ly Y derivatives
  * @param Lhess Det(Hessian)
+ * @param buffers Scratch images
  */
 void computeAKAZESlice(const image::Image<float>& src,
                        const int p,
@@ -136,13 +151,14 @@ void computeAKAZESlice(const image::Image<float>& src,
                        image::Image<float>& Li,
                        image::Image<float>& Lx,
                        image::Image<float>& Ly,
-                       image::Image<float>& Lhess)
+                       image::Image<float>& Lhess,
+                       AKAZESliceBuffers& buffers)
 {
   const float sigmaCur = sigma(sigma0, p, q, nbSlice);
   const float ratio = 1 << p; //pow(2,p);
   const int sigmaScale = MathTrait<float>::round(sigmaCur * derivativeFactor / ratio);
 
-  image::Image<float> smoothed;
+  image::Image<float>& smoothed = buffers.smoothed;
 
   if(p == 0 && q == 0)
   {
@@ -151,15 +167,14 @@ void computeAKAZESlice(const image::Image<float>& src,
   }
   else
   {
-    // general case
-    image::Image<float> in;
+    // general case, the diffusion is done in place in the evolution image
     if( q == 0 )
     {
-      image::ImageHalfSample(src , in);
+      image::ImageHalfSample(src , Li);
     }
     else
     {
-      in = src;
+      Li = src;
     }
 
     const float sigmaPrev = ( q == 0 ) ? sigma(sigma0, p - 1, nbSlice - 1, nbSlice) : sigma(sigma0, p, q - 1, nbSlice);
@@ -170,7 +185,7 @@ void computeAKAZESlice(const image::Image<float>& src,
     const float total_cycle_time = t_cur - t_prev;
 
     // compute first derivatives (Scharr scale 1, non normalized) for diffusion coef
-    image::ImageGaussianFilter(in , 1.f , smoothed, 0, 0 );
+    image::ImageGaussianFilter(Li , 1.f , smoothed, 0, 0 );
     image::ImageScharrXDerivative(smoothed, Lx, false);
     image::ImageScharrYDerivative(smoothed, Ly, false);
 
@@ -181,27 +196,25 @@ void computeAKAZESlice(const image::Image<float>& src,
     // compute FED cycles
     std::vector<float> tau ;
     image::FEDCycleTimings(total_cycle_time, 0.25f, tau);
-    image::ImageFEDCycle(in, diff, tau);
-    Li = in ; // evolution image
+    image::ImageFEDCycle(Li, diff, tau, buffers.fed);
   }
 
   // compute Hessian response
-  if(p == 0 && q == 0)
-  {
-    smoothed = Li ;
-  }
-  else
+  if(p != 0 || q != 0)
   {
     // add a little smooth to image (for robustness of Scharr derivatives)
     image::ImageGaussianFilter(Li, 1.f, smoothed, 0, 0);
   }
+  const image::Image<float>& hessianInput = (p == 0 && q == 0) ? Li : smoothed;
 
   // compute true first derivatives
-  image::ImageScaledScharrXDerivative(smoothed, Lx, sigmaScale);
-  image::ImageScaledScharrYDerivative(smoothed, Ly, sigmaScale);
+  image::ImageScaledScharrXDerivative(hessianInput, Lx, sigmaScale);
+  image::ImageScaledScharrYDerivative(hessianInput, Ly, sigmaScale);
 
   // second order spatial derivatives
-  image::Image<float> Lxx, Lyy, Lxy;
+  image::Image<float>& Lxx = buffers.Lxx;
+  image::Image<float>& Lyy = buffers.Lyy;
+  image::Image<float>& Lxy = buffers.Lxy;
   image::ImageScaledScharrXDerivative(Lx, Lxx, sigmaScale);
   image::ImageScaledScharrYDerivative(Lx, Lxy, sigmaScale);
   image::ImageScaledScharrYDerivative(Ly, Lyy, sigmaScale);
@@ -210,7 +223,7 @@ void computeAKAZESlice(const image::Image<float>& src,
   Ly *= static_cast<float>(sigmaScale);
 
   // compute Determinant of the Hessian
-  Lhess.resize(Li.Width(), Li.Height());
+  Lhess.resize(Li.Width(), Li.Height(), false);
   const float sigmaSizeQuad = Square(sigmaScale) * Square(sigmaScale);
   Lhess.array() = (Lxx.array() * Lyy.array() - Lxy.array().square()) * sigmaSizeQuad;
 }
@@ -239,7 +252,11 @@ AKAZE::AKAZE(const image::Image<float>& image, const AKAZEOptions& options):
 void AKAZE::computeScaleSpace()
 {
   float contrastFactor = computeAutomaticContrastFactor( _input, 0.7f);
-  image::Image<float> input = _input;
+  AKAZESliceBuffers buffers;
+
+  // no reallocation: the previous slice is used as input of the next one
+  _evolution.clear();
+  _evolution.reserve(_options.nbOctaves * _options.nbSlicePerOctave);
 
   // octave computation
   for(int p = 0; p < _options.nbOctaves; ++p)
@@ -248,15 +265,14 @@ void AKAZE::computeScaleSpace()
 
     for(int q = 0; q < _options.nbSlicePerOctave; ++q)
     {
+      const image::Image<float>& input = _evolution.empty() ? _input : _evolution.back().cur;
+
       _evolution.emplace_back(TEvolution());
       TEvolution& evo = _evolution.back();
 
       // compute Slice at (p,q) index
       computeAKAZESlice(input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
-        evo.cur, evo.Lx, evo.Ly, evo.Lhess);
-
-      // Prepare inputs for next slice
-      input = evo.cur;
+        evo.cur, evo.Lx, evo.Ly, evo.Lhess, buffers);
 
       // DEBUG octave image
 #if DEBUG_OCTAVE
@@ -298,49 +314,49 @@ void detectDuplicates(std::vector<std::pair<AKAZEKeypoint, bool>>& previous,
 
 void AKAZE::featureDetection(std::vector<AKAZEKeypoint>& keypoints) const
 {
-  std::vector<std::vector<std::pair<AKAZEKeypoint, bool>>> ptsPerSlice(_options.nbOctaves * _options.nbSlicePerOctave);
+  const int nbSlices = _options.nbOctaves * _options.nbSlicePerOctave;
+  std::vector<std::vector<std::pair<AKAZEKeypoint, bool>>> ptsPerSlice(nbSlices);
 
+  // slices are independent, balance the work on all of them (the first octaves are the largest)
   #pragma omp parallel for schedule(dynamic)
-  for(int p = 0 ; p < _options.nbOctaves ; ++p)
+  for(int s = 0; s < nbSlices; ++s)
   {
+    const int p = s / _options.nbSlicePerOctave;
+    const int q = s % _options.nbSlicePerOctave;
     const float ratio = static_cast<float>(1 << p);
+    const float sigma_cur = sigma( _options.sigma0 , p , q , _options.nbSlicePerOctave );
+    const image::Image<float>& LDetHess = _evolution[s].Lhess;
 
-    for(int q = 0 ; q < _options.nbSlicePerOctave ; ++q)
-    {
-      const float sigma_cur = sigma( _options.sigma0 , p , q , _options.nbSlicePerOctave );
-      const image::Image<float>& LDetHess = _evolution[_options.nbOctaves * p + q].Lhess;
-
-      // check that the point is under the image limits for the descriptor computation
-      const float borderLimit =
-        MathTrait<float>::round(_options.descFactor * sigma_cur * derivativeFactor / ratio) + 1;
+    // check that the point is under the image limits for the descriptor computation
+    const float borderLimit =
+      MathTrait<float>::round(_options.descFactor * sigma_cur * derivativeFactor / ratio) + 1;
 
-      for(int jx = borderLimit; jx < LDetHess.Height()-borderLimit; ++jx)
+    for(int jx = borderLimit; jx < LDetHess.Height()-borderLimit; ++jx)
+    {
+      for(int ix = borderLimit; ix < LDetHess.Width()-borderLimit; ++ix)
       {
-        for(int ix = borderLimit; ix < LDetHess.Width()-borderLimit; ++ix)
+        const float value = LDetHess(jx, ix);
+
+        // filter the points with the detector threshold
+        if(value > _options.threshold &&
+           value > LDetHess(jx-1, ix)   &&
+           value > LDetHess(jx-1, ix+1) &&
+           value > LDetHess(jx-1, ix-1) &&
+           value > LDetHess(jx  , ix-1) &&
+           value > LDetHess(jx  , ix+1) &&
+           value > LDetHess(jx+1, ix-1) &&
+           value > LDetHess(jx+1, ix)   &&
+           value > LDetHess(jx+1, ix+1))
         {
-          const float value = LDetHess(jx, ix);
-
-          // filter the points with the detector threshold
-          if(value > _options.threshold &&
-             value > LDetHess(jx-1, ix)   &&
-             value > LDetHess(jx-1, ix+1) &&
-             value > LDetHess(jx-1, ix-1) &&
-             value > LDetHess(jx  , ix-1) &&
-             value > LDetHess(jx  , ix+1) &&
-             value > LDetHess(jx+1, ix-1) &&
-             value > LDetHess(jx+1, ix)   &&
-             value > LDetHess(jx+1, ix+1))
-          {
-            AKAZEKeypoint point;
-            point.size = sigma_cur * derivativeFactor ;
-            point.octave = p;
-            point.response = fabs(value);
-            point.x = ix * ratio + 0.5 * (ratio-1);
-            point.y = jx * ratio + 0.5 * (ratio-1);
-            point.angle = 0.0f;
-            point.class_id = p * _options.nbSlicePerOctave + q;
-            ptsPerSlice[_options.nbOctaves * p + q].emplace_back(point, false);
-          }
+          AKAZEKeypoint point;
+          point.size = sigma_cur * derivativeFactor ;
+          point.octave = p;
+          point.response = fabs(value);
+          point.x = ix * ratio + 0.5 * (ratio-1);
+          point.y = jx * ratio + 0.5 * (ratio-1);
+          point.angle = 0.0f;
+          point.class_id = s;
+          ptsPerSlice[s].emplace_back(point, false);
         }
       }
     }
@@ -370,7 +386,7 @@ void AKAZE::featureDetection(std::vector<AKAZEKeypoint>& keypoints) const
 
 void AKAZE::gridFiltering(std::vector<AKAZEKeypoint>& keypoints) const
 {
-  if(keypoints.size() <= _options.maxTotalKeypoints)
+  if(_options.maxTotalKeypoints == 0 || keypoints.size() <= _options.maxTotalKeypoints)
     return;
 
   // sort keypoints by size to guarantee best points are kept
@@ -457,20 +473,23 @@ bool AKAZE::subpixelRefinement(AKAZEKeypoint& keypoint, const image::Image<float
 
 void AKAZE::subpixelRefinement(std::vector<AKAZEKeypoint>& keypoints) const
 {
-  std::vector<AKAZEKeypoint> in_keypoints;
-  in_keypoints.swap(keypoints);
-  keypoints.reserve(in_keypoints.size());
+  std::vector<char> isStable(keypoints.size(), 0);
 
   #pragma omp parallel for schedule(dynamic)
-  for(int i = 0; i < static_cast<int>(in_keypoints.size()); ++i)
+  for(int i = 0; i < static_cast<int>(keypoints.size()); ++i)
   {
-    AKAZEKeypoint& point = in_keypoints[i];
-    if(subpixelRefinement(point, this->_evolution[point.class_id].Lhess))
-    {
-      #pragma omp critical
-      keypoints.emplace_back(point);
-    }
+    AKAZEKeypoint& point = keypoints[i];
+    isStable[i] = subpixelRefinement(point, this->_evolution[point.class_id].Lhess);
+  }
+
+  // keep the stable keypoints in the input order (the output doesn't depend on the number of threads)
+  std::size_t nbStable = 0;
+  for(std::size_t i = 0; i < keypoints.size(); ++i)
+  {
+    if(isStable[i])
+      keypoints[nbStable++] = keypoints[i];
   }
+  keypoints.resize(nbStable);
 }
 
 /// This function computes the angle from the vector given by (X Y). From 0 to 2*Pi
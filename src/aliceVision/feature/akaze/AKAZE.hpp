@@ -54,7 +54,7 @@ struct AKAZEOptions
   float descFactor = 1.0f;
   /// grid size for filtering
   std::size_t gridSize = 4;
-  /// maximum number of keypoints
+  /// maximum number of keypoints (0: no limit)
   std::size_t maxTotalKeypoints = 1000;
 };
 
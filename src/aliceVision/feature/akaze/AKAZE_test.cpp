@@ -0,0 +1,47 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/feature/akaze/ImageDescriber_AKAZE.hpp"
+#include "aliceVision/feature/syntheticImage.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#define BOOST_TEST_MODULE AKAZE
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+BOOST_AUTO_TEST_CASE(AKAZE_Extraction)
+{
+  const image::Image<float> image = createSyntheticImage(800, 600);
+  const int nbThreads = omp_get_max_threads();
+
+  for(const EAKAZE_DESCRIPTOR descriptorType : {AKAZE_MSURF, AKAZE_LIOP, AKAZE_MLDB})
+  {
+    ImageDescriber_AKAZE imageDescriber(AKAZEParams(AKAZEOptions(), descriptorType));
+
+    // reference extraction on a single thread
+    std::unique_ptr<Regions> regionsRef;
+    omp_set_num_threads(1);
+    BOOST_CHECK(imageDescriber.describe(image, regionsRef));
+
+    // multi-threaded extraction
+    std::unique_ptr<Regions> regions;
+    omp_set_num_threads(nbThreads);
+    BOOST_CHECK(imageDescriber.describe(image, regions));
+
+    BOOST_CHECK_GT(regions->RegionCount(), 0);
+    BOOST_CHECK_LE(regions->RegionCount(), AKAZEOptions().maxTotalKeypoints);
+
+    // the output doesn't depend on the number of threads
+    BOOST_REQUIRE_EQUAL(regions->RegionCount(), regionsRef->RegionCount());
+    for(std::size_t i = 0; i < regions->RegionCount(); ++i)
+    {
+      BOOST_CHECK(regions->GetRegionPosition(i) == regionsRef->GetRegionPosition(i));
+      BOOST_CHECK_EQUAL(regions->SquaredDescriptorDistance(i, regionsRef.get(), i), 0.0);
+    }
+  }
+}
@@ -78,8 +78,8 @@ bool ImageDescriber_AKAZE::describe(const image::Image<float>& image,
       regionsCasted->Features().resize(keypoints.size());
       regionsCasted->Descriptors().resize(keypoints.size());
 
-      // init LIOP extractor
-      DescriptorExtractor_LIOP liop_extractor;
+      // init LIOP extractor (shared by all threads)
+      const DescriptorExtractor_LIOP liop_extractor;
 
 #pragma omp parallel for
       for(int i = 0; i < static_cast<int>(keypoints.size()); ++i)
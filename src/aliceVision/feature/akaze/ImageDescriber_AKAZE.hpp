@@ -151,6 +151,24 @@ public:
     }
   }
 
+  /**
+   * @brief Get the maximum number of regions kept by the describer
+   * @return the maximum number of regions (0: no limit)
+   */
+  std::size_t getMaxNbFeatures() const override
+  {
+    return _params.options.maxTotalKeypoints;
+  }
+
+  /**
+   * @brief Set the maximum number of regions kept by the describer
+   * @param[in] maxNbFeatures The maximum number of regions (0: no limit)
+   */
+  void setMaxNbFeatures(std::size_t maxNbFeatures) override
+  {
+    _params.options.maxTotalKeypoints = maxNbFeatures;
+  }
+
   /**
    * @brief Detect regions on the float image and compute their attributes (description)
    * @param[in] image Image.
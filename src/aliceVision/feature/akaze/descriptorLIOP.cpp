@@ -288,7 +288,7 @@ void DescriptorExtractor_LIOP::CreateLIOP_GOrder(
 void DescriptorExtractor_LIOP::extract(
   const image::Image<float>& I,
   const SIOPointFeature& feat,
-  float desc[144])
+  float desc[144]) const
 {
   memset(desc, 0, sizeof(float)*144);
 
@@ -43,10 +43,11 @@ public:
 
   DescriptorExtractor_LIOP();
 
+  /// compute the LIOP descriptor of a feature (thread-safe)
   void extract(
     const image::Image<float> & I,
     const SIOPointFeature & feat,
-    float desc[144]);
+    float desc[144]) const;
 
   void CreateLIOP_GOrder(
     const image::Image<float> & outPatch,
@@ -89,7 +89,8 @@ void ImageDescriber_SIFT_popSIFT::resetConfiguration()
   config.setEdgeLimit(_params._edgeThreshold);
   config.setNormalizationMultiplier(9); // 2^9 = 512
   config.setNormMode(_params._rootSift ? popsift::Config::RootSift : popsift::Config::Classic);
-  config.setFilterMaxExtrema(_params._maxTotalKeypoints);
+  if(_params._maxTotalKeypoints > 0)
+    config.setFilterMaxExtrema(_params._maxTotalKeypoints);
   config.setFilterSorting(popsift::Config::LargestScaleFirst);
 
   _popSift.reset(new PopSift(config, popsift::Config::ExtractingMode, PopSift::FloatImages));
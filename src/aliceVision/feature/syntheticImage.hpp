@@ -0,0 +1,53 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Create a synthetic image to extract features from (unit tests and benchmarks):
+ *        smooth waves and random discs, one disc per 1200 pixels.
+ * @param[in] width The image width
+ * @param[in] height The image height
+ * @param[in] seed The random seed of the discs
+ * @return the grayscale image, in [0, 1]
+ */
+inline image::Image<float> createSyntheticImage(int width, int height, int seed = 42)
+{
+  image::Image<float> image(width, height, true, 0.f);
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> distribution(0.f, 1.f);
+
+  for(int i = 0; i < height; ++i)
+    for(int j = 0; j < width; ++j)
+      image(i, j) = 0.5f + 0.2f * std::sin(j * 0.05f) * std::cos(i * 0.07f);
+
+  const int nbDiscs = width * height / 1200;
+  for(int k = 0; k < nbDiscs; ++k)
+  {
+    const int cx = distribution(generator) * width;
+    const int cy = distribution(generator) * height;
+    const int radius = 2 + distribution(generator) * 12;
+    const float value = distribution(generator);
+
+    for(int i = std::max(0, cy - radius); i < std::min(height, cy + radius); ++i)
+      for(int j = std::max(0, cx - radius); j < std::min(width, cx + radius); ++j)
+        if((i - cy) * (i - cy) + (j - cx) * (j - cx) < radius * radius)
+          image(i, j) = value;
+  }
+  return image;
+}
+
+} // namespace feature
+} // namespace aliceVision
@@ -16,6 +16,7 @@
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 #include "nanoflann.hpp"
@@ -460,6 +461,8 @@ void DelaunayGraphCut::initVertices()
 
 void DelaunayGraphCut::computeDelaunay()
 {
+    ALICEVISION_PERF_ZONE("meshing.delaunay");
+
     ALICEVISION_LOG_DEBUG("computeDelaunay GEOGRAM ...\n");
 
     assert(_verticesCoords.size() == _verticesAttr.size());
@@ -1594,6 +1597,8 @@ float DelaunayGraphCut::weightFcn(float nrc, bool labatutWeights, int  /*ncams*/
 void DelaunayGraphCut::fillGraph(bool fixesSigma, float nPixelSizeBehind, bool allPoints, bool behind,
                                bool labatutWeights, bool fillOut, float distFcnHeight) // fixesSigma=true nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 labatutWeights=0 fillOut=1 distFcnHeight=0
 {
+    ALICEVISION_PERF_ZONE("meshing.fillGraph");
+
     ALICEVISION_LOG_INFO("Computing s-t graph weights.");
     long t1 = clock();
 
@@ -2462,6 +2467,8 @@ void DelaunayGraphCut::createDensePointCloudFromPrecomputedDensePoints(Point3d h
 
 void DelaunayGraphCut::createDensePointCloud(Point3d hexah[8], const StaticVector<int>& cams, const sfmData::SfMData* sfmData, const FuseParams* depthMapsFuseParams)
 {
+  ALICEVISION_PERF_ZONE("meshing.densePointCloud");
+
   assert(sfmData != nullptr || depthMapsFuseParams != nullptr);
 
   ALICEVISION_LOG_INFO("Creating dense point cloud.");
@@ -2547,6 +2554,8 @@ void DelaunayGraphCut::reconstructGC(const Point3d* hexah)
 
 void DelaunayGraphCut::maxflow()
 {
+    ALICEVISION_PERF_ZONE("meshing.maxflow");
+
     long t_maxflow = clock();
 
     ALICEVISION_LOG_INFO("Maxflow: start allocation.");
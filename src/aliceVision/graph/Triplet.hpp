@@ -13,6 +13,8 @@
 #include <lemon/list_graph.h>
 
 #include <algorithm>
+#include <iterator>
+#include <tuple>
 #include <vector>
 
 namespace aliceVision {
@@ -119,29 +121,72 @@ bool List_Triplets(const GraphT & g, std::vector< Triplet > & vec_triplets)
   return (!vec_triplets.empty());
 }
 
-/// Return triplets contained in the graph build from IterablePairs
+/// Return triplets contained in the graph build from IterablePairs, in ascending order.
+/// The nodes are processed in parallel (dynamic scheduling): each node lists the triplets
+/// where it has the smallest id, by intersecting its sorted neighbors of larger id with the ones of these neighbors.
 template <typename IterablePairs>
 inline std::vector< graph::Triplet > tripletListing(
   const IterablePairs & pairs)
 {
-  std::vector< graph::Triplet > vec_triplets;
+  // node ids, the positions in this sorted vector are used as node indexes
+  std::vector<IndexT> nodeIds;
+  for (const auto & pair : pairs)
+  {
+    nodeIds.push_back(pair.first);
+    nodeIds.push_back(pair.second);
+  }
+  std::sort(nodeIds.begin(), nodeIds.end());
+  nodeIds.erase(std::unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
+
+  const auto nodeIndex = [&nodeIds](IndexT id)
+  {
+    return static_cast<int>(std::lower_bound(nodeIds.begin(), nodeIds.end(), id) - nodeIds.begin());
+  };
 
-  indexedGraph putativeGraph(pairs);
+  // sorted neighbors of larger index of each node
+  std::vector< std::vector<int> > largerNeighbors(nodeIds.size());
+  for (const auto & pair : pairs)
+  {
+    const int a = nodeIndex(pair.first);
+    const int b = nodeIndex(pair.second);
+    if (a != b)
+      largerNeighbors[std::min(a, b)].push_back(std::max(a, b));
+  }
+  for (std::vector<int> & neighbors : largerNeighbors)
+  {
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+  }
 
-  graph::List_Triplets<indexedGraph::GraphT>(putativeGraph.g, vec_triplets);
+  std::vector< graph::Triplet > vec_triplets;
 
-  //Change triplets to ImageIds
-  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  #pragma omp parallel
   {
-    graph::Triplet & triplet = vec_triplets[i];
-    IndexT I = triplet.i, J = triplet.j , K = triplet.k;
-    I = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(I)];
-    J = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(J)];
-    K = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(K)];
-    IndexT triplet_[3] = { I, J, K };
-    std::sort(&triplet_[0], &triplet_[3]);
-    triplet = graph::Triplet(triplet_[0],triplet_[1],triplet_[2]);
+    std::vector< graph::Triplet > threadTriplets;
+    std::vector<int> commonNeighbors;
+
+    #pragma omp for schedule(dynamic)
+    for (int i = 0; i < (int)nodeIds.size(); ++i)
+    {
+      const std::vector<int> & neighborsI = largerNeighbors[i];
+      for (auto itJ = neighborsI.begin(); itJ != neighborsI.end(); ++itJ)
+      {
+        const std::vector<int> & neighborsJ = largerNeighbors[*itJ];
+        commonNeighbors.clear();
+        std::set_intersection(itJ + 1, neighborsI.end(), neighborsJ.begin(), neighborsJ.end(), std::back_inserter(commonNeighbors));
+        for (const int k : commonNeighbors)
+          threadTriplets.emplace_back(nodeIds[i], nodeIds[*itJ], nodeIds[k]);
+      }
+    }
+
+    #pragma omp critical
+    vec_triplets.insert(vec_triplets.end(), threadTriplets.begin(), threadTriplets.end());
   }
+
+  std::sort(vec_triplets.begin(), vec_triplets.end(), [](const graph::Triplet & a, const graph::Triplet & b)
+  {
+    return std::make_tuple(a.i, a.j, a.k) < std::make_tuple(b.i, b.j, b.k);
+  });
   return vec_triplets;
 }
 
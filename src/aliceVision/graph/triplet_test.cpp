@@ -8,6 +8,9 @@
 #include "aliceVision/graph/Triplet.hpp"
 
 #include <iostream>
+#include <random>
+#include <set>
+#include <tuple>
 #include <vector>
 
 #define BOOST_TEST_MODULE tripletFinder
@@ -268,3 +271,38 @@ BOOST_AUTO_TEST_CASE(test_for_triplet) {
     BOOST_CHECK_EQUAL(4, vec_triplets.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(test_tripletListing) {
+
+  // random graph with non contiguous node ids
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> nodeDistribution(0, 59);
+
+  std::set< std::pair<aliceVision::IndexT, aliceVision::IndexT> > pairs;
+  while(pairs.size() < 400)
+  {
+    const aliceVision::IndexT a = 3 * nodeDistribution(generator) + 7;
+    const aliceVision::IndexT b = 3 * nodeDistribution(generator) + 7;
+    if(a != b)
+      pairs.insert(std::make_pair(std::min(a, b), std::max(a, b)));
+  }
+
+  // brute force listing
+  std::vector< std::tuple<aliceVision::IndexT, aliceVision::IndexT, aliceVision::IndexT> > expected;
+  for(const auto& pairIJ : pairs)
+  {
+    for(const auto& pairJK : pairs)
+    {
+      if(pairJK.first == pairIJ.second && pairs.count(std::make_pair(pairIJ.first, pairJK.second)))
+        expected.emplace_back(pairIJ.first, pairIJ.second, pairJK.second);
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+
+  const std::vector< Triplet > triplets = tripletListing(pairs);
+
+  BOOST_CHECK(!expected.empty());
+  BOOST_REQUIRE_EQUAL(triplets.size(), expected.size());
+  for(std::size_t i = 0; i < triplets.size(); ++i)
+    BOOST_CHECK(std::make_tuple(triplets[i].i, triplets[i].j, triplets[i].k) == expected[i]);
+}
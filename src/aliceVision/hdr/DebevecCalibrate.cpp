@@ -13,8 +13,6 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/image/io.hpp>
 
-#include <OpenImageIO/imagebufalgo.h>
-
 
 namespace aliceVision {
 namespace hdr {
@@ -31,13 +29,33 @@ bool DebevecCalibrate::process(const std::vector< std::vector<std::string>> & im
                                const float lambda,
                                rgbCurve &response)
 {
-  const int nbGroups = imagePathsGroups.size();
-  const int nbImages = imagePathsGroups.front().size();
-  const int samplesPerImage = nbPoints / (nbGroups*nbImages);
+  std::vector<std::vector<ImageSamples>> samples;
+  extractSamples(samples, imagePathsGroups, times, nbPoints, calibrationDownscale, fisheye, image::EImageColorSpace::SRGB);
+
+  return process(samples, channelQuantization, times, weight, lambda, response);
+}
+
+bool DebevecCalibrate::process(const std::vector<std::vector<ImageSamples>> &samples,
+                               const std::size_t channelQuantization,
+                               const std::vector<std::vector<float>> &times,
+                               const rgbCurve &weight,
+                               const float lambda,
+                               rgbCurve &response)
+{
+  const int nbGroups = samples.size();
 
   // Always 3 channels for the input images
   static const std::size_t channelsCount = 3;
 
+  // Number of unknown irradiances (one per sample position) and of equations
+  std::size_t nbSamples = 0;
+  std::size_t nbEquations = 0;
+  for(const std::vector<ImageSamples>& groupSamples : samples)
+  {
+    nbSamples += groupSamples.front().colors.size();
+    nbEquations += groupSamples.front().colors.size() * groupSamples.size();
+  }
+
   // Initialize response
   response = rgbCurve(channelQuantization);
 
@@ -49,122 +67,42 @@ bool DebevecCalibrate::process(const std::vector< std::vector<std::string>> & im
   for(unsigned int channel=0; channel < channelsCount; ++channel)
   {
     Vec & b = b_array[channel];
-    b = Vec::Zero(nbPoints + channelQuantization + 1);
+    b = Vec::Zero(nbEquations + channelQuantization + 1);
     std::vector<T> & tripletList = tripletList_array[channel];
-    tripletList.reserve(2 * nbPoints + 1 + 3 * channelQuantization);
+    tripletList.reserve(2 * nbEquations + 1 + 3 * channelQuantization);
   }
 
   size_t count = 0;
+  size_t sampleOffset = 0;
   for (unsigned int g = 0; g < nbGroups; g++)
   {
-    const std::vector<std::string > &imagePaths = imagePathsGroups[g];
-    std::vector<image::Image<image::RGBfColor>> ldrImagesGroup(imagePaths.size());
- 
-    for (int i = 0; i < imagePaths.size(); i++)
-    {
-      image::readImage(imagePaths[i], ldrImagesGroup[i], image::EImageColorSpace::SRGB);
-      if (calibrationDownscale != 1.0f)
-      {
-          image::Image<image::RGBfColor>& img = ldrImagesGroup[i];
-          unsigned int w = img.Width();
-          unsigned int h = img.Height();
-          unsigned int nw = (unsigned int)(floor(float(w) / calibrationDownscale));
-          unsigned int nh = (unsigned int)(floor(float(h) / calibrationDownscale));
-
-          image::Image<image::RGBfColor> rescaled(nw, nh);
-
-          oiio::ImageSpec imageSpecResized(nw, nh, 3, oiio::TypeDesc::FLOAT);
-          oiio::ImageSpec imageSpecOrigin(w, h, 3, oiio::TypeDesc::FLOAT);
-          oiio::ImageBuf bufferOrigin(imageSpecOrigin, img.data());
-          oiio::ImageBuf bufferResized(imageSpecResized, rescaled.data());
-          oiio::ImageBufAlgo::resample(bufferResized, bufferOrigin);
-
-          const oiio::ImageBuf inBuf(oiio::ImageSpec(w, h, 3, oiio::TypeDesc::FLOAT), img.data());
-          oiio::ImageBuf outBuf(oiio::ImageSpec(nw, nh, 3, oiio::TypeDesc::FLOAT), rescaled.data());
-
-          oiio::ImageBufAlgo::resize(outBuf, inBuf);
-          img.swap(rescaled);
-      }
-    }
-
+    const std::vector<ImageSamples>& groupSamples = samples[g];
     const std::vector<float> & ldrTimes = times[g];
-    const std::size_t width = ldrImagesGroup.front().Width();
-    const std::size_t height = ldrImagesGroup.front().Height();
+    const std::size_t nbGroupSamples = groupSamples.front().colors.size();
 
-    // If images are fisheye, we take only pixels inside a disk with a radius of image's minimum side
-    if(fisheye)
+    for(unsigned int j=0; j<groupSamples.size(); ++j)
     {
-      const std::size_t minSize = std::min(width, height) * 0.97;
-      const Vec2i center(width/2, height/2);
+      const std::vector<image::Rgb<double>>& colors = groupSamples[j].colors;
+      const float time = std::log(ldrTimes.at(j));
 
-      const int xMin = std::ceil(center(0) - minSize/2);
-      const int yMin = std::ceil(center(1) - minSize/2);
-      const int xMax = std::floor(center(0) + minSize/2);
-      const int yMax = std::floor(center(1) + minSize/2);
-      const std::size_t maxDist2 = pow(minSize * 0.5, 2);
-
-      const int step = std::ceil(minSize / sqrt(samplesPerImage));
-      for(unsigned int j=0; j<nbImages; ++j)
+      for(std::size_t i=0; i<nbGroupSamples; ++i)
       {
-        int countValidPixels = 0;
-        
-        const image::Image<image::RGBfColor> &image = ldrImagesGroup.at(j);
-        const float time = std::log(ldrTimes.at(j));
-        for(int y = yMin; y < yMax-step; y+=step)
+        for (int channel = 0; channel < channelsCount; channel++)
         {
-          for(int x = xMin; x < xMax-step; x+=step)
-          {
-            std::size_t dist2 = pow(center(0)-x, 2) + pow(center(1)-y, 2);
-
-            if(dist2 > maxDist2)
-            {
-                continue;
-            }
-
-            for (int channel = 0; channel < channelsCount; channel++)
-            {
-              float sample = clamp(image(y, x)(channel), 0.f, 1.f);
-              float w_ij = weight(sample, channel);
-              std::size_t index = std::round(sample * (channelQuantization - 1));
-
-              tripletList_array[channel].push_back(T(count, index, w_ij));
-              tripletList_array[channel].push_back(T(count, channelQuantization + g * samplesPerImage + countValidPixels, -w_ij));
-
-              b_array[channel](count) = w_ij * time;
-            }
-
-            count += 1;
-            countValidPixels += 1;
-          }
-        }
-      }
-    }
-    else
-    {
-      const int step = std::floor(width*height / samplesPerImage);
-      for(unsigned int j=0; j<nbImages; ++j)
-      {
-        const image::Image<image::RGBfColor> &image = ldrImagesGroup.at(j);
-        const float time = std::log(ldrTimes.at(j));
-        
-        for(unsigned int i=0; i<samplesPerImage; ++i)
-        {
-          for (int channel = 0; channel < channelsCount; channel++)
-          {
-            float sample = clamp(image(step*i)(channel), 0.f, 1.f);
-            float w_ij = weight(sample, channel);
-            std::size_t index = std::round(sample * (channelQuantization - 1));
-
-            tripletList_array[channel].push_back(T(count, index, w_ij));
-            tripletList_array[channel].push_back(T(count, channelQuantization + g*samplesPerImage + i, -w_ij));
+          float sample = clamp(float(colors[i](channel)), 0.f, 1.f);
+          float w_ij = weight(sample, channel);
+          std::size_t index = std::round(sample * (channelQuantization - 1));
 
-            b_array[channel](count) = w_ij * time;
-          }
+          tripletList_array[channel].push_back(T(count, index, w_ij));
+          tripletList_array[channel].push_back(T(count, channelQuantization + sampleOffset + i, -w_ij));
 
-          count += 1;
+          b_array[channel](count) = w_ij * time;
         }
+
+        count += 1;
       }
     }
+    sampleOffset += nbGroupSamples;
   }
 
   // fix the curve by setting its middle value to zero
@@ -190,7 +128,7 @@ bool DebevecCalibrate::process(const std::vector< std::vector<std::string>> & im
 
   for (int channel = 0; channel < channelsCount; channel ++)
   {
-    sMat A(count, channelQuantization + samplesPerImage * nbGroups);
+    sMat A(count, channelQuantization + nbSamples);
     A.setFromTriplets(tripletList_array[channel].begin(), tripletList_array[channel].end());
     b_array[channel].conservativeResize(count);
 
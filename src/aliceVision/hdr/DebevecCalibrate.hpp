@@ -7,6 +7,7 @@
 #pragma once
 #include <aliceVision/image/all.hpp>
 #include "rgbCurve.hpp"
+#include "sampling.hpp"
 #include <aliceVision/numeric/numeric.hpp>
 #include <Eigen/SparseQR>
 
@@ -37,6 +38,22 @@ public:
                const float lambda,
                rgbCurve &response);
 
+  /**
+   * @brief Calibrate the response from the samples of the LDR images groups (see extractSamples)
+   * @param[in] samples The sRGB samples of each bracket of each group, at the same positions in all the brackets of a group
+   * @param[in] channel quantization
+   * @param[in] exposure times
+   * @param[in] calibration weight function
+   * @param[in] lambda (parameter of smoothness)
+   * @param[out] camera response function
+   */
+  bool process(const std::vector<std::vector<ImageSamples>> &samples,
+               const std::size_t channelQuantization,
+               const std::vector<std::vector<float>> &times,
+               const rgbCurve &weight,
+               const float lambda,
+               rgbCurve &response);
+
 };
 
 } // namespace hdr
@@ -28,9 +28,18 @@ void GrossbergCalibrate::process(const std::vector<std::vector<std::string>>& im
                                  const bool fisheye,
                                  rgbCurve &response)
 {
-    const int nbGroups = imagePathsGroups.size();
-    const int nbImages = imagePathsGroups.front().size();
-    const int samplesPerImage = nbPoints / (nbGroups*nbImages);
+    std::vector<std::vector<ImageSamples>> samples;
+    extractSamples(samples, imagePathsGroups, times, nbPoints, 1, fisheye, image::EImageColorSpace::SRGB);
+
+    process(samples, channelQuantization, times, response);
+}
+
+void GrossbergCalibrate::process(const std::vector<std::vector<ImageSamples>>& samples,
+                                 const std::size_t channelQuantization,
+                                 const std::vector< std::vector<float> > &times,
+                                 rgbCurve &response)
+{
+    const int nbGroups = samples.size();
 
     //set channels count always RGB
     static const std::size_t channels = 3;
@@ -94,117 +103,44 @@ void GrossbergCalibrate::process(const std::vector<std::vector<std::string>>& im
         H.col(i) = Eigen::Map<Vec>(hCurves[i].data(), channelQuantization);
     }
 
-    Mat A = Mat::Zero(samplesPerImage*(nbImages-1)*nbGroups*channels, _dimension);
-    Vec b = Vec::Zero(samplesPerImage*(nbImages-1)*nbGroups*channels);
-
-    if(fisheye)
-    {
-      int count = 0;
-
-      for(unsigned int g=0; g<nbGroups; ++g)
-      {
-        const std::vector<std::string > &imagePaths = imagePathsGroups[g];
-        std::vector<image::Image<image::RGBfColor>> ldrImagesGroup(imagePaths.size());
-
-        for (int i = 0; i < imagePaths.size(); i++)
-        {
-            image::readImage(imagePaths[i], ldrImagesGroup[i], image::EImageColorSpace::SRGB);
-        }
-
-        const std::vector<float> &ldrTimes= times[g];
+    // one equation per pair of consecutive brackets, per sample and per channel
+    std::size_t nbEquations = 0;
+    for(const std::vector<ImageSamples>& groupSamples : samples)
+      nbEquations += groupSamples.front().colors.size() * (groupSamples.size() - 1) * channels;
 
-        const std::size_t width = ldrImagesGroup.front().Width();
-        const std::size_t height = ldrImagesGroup.front().Height();
+    Mat A = Mat::Zero(nbEquations, _dimension);
+    Vec b = Vec::Zero(nbEquations);
 
-        const std::size_t minSize = std::min(width, height) * 0.97;
-        const Vec2i center(width/2, height/2);
-
-        const int xMin = std::ceil(center(0) - minSize/2);
-        const int yMin = std::ceil(center(1) - minSize/2);
-        const int xMax = std::floor(center(0) + minSize/2);
-        const int yMax = std::floor(center(1) + minSize/2);
-        const std::size_t maxDist2 = pow(minSize * 0.5, 2);
-
-        ALICEVISION_LOG_TRACE("filling A and b matrices");
-
-        for(unsigned int channel=0; channel<channels; ++channel)
-        {
-          const int step = std::ceil(minSize / sqrt(samplesPerImage));
-          for(unsigned int j=0; j<nbImages-1; ++j)
-          {
-            const image::Image<image::RGBfColor> &image1 = ldrImagesGroup.at(j);
-            const image::Image<image::RGBfColor> &image2 = ldrImagesGroup.at(j+1);
-            const double k = ldrTimes.at(j+1)/ldrTimes.at(j);
+    ALICEVISION_LOG_TRACE("filling A and b matrices");
 
-            // fill A and b matrices with the equations
-            for(int y = yMin; y <= yMax-step; y+=step)
-            {
-              for(int x = xMin; x <= xMax-step; x+=step)
-              {
-                std::size_t dist2 = pow(center(0)-x, 2) + pow(center(1)-y, 2);
-                if(dist2 > maxDist2)
-                  continue;
-
-                double sample1 = clamp(image1(y, x)(channel), 0.f, 1.f);
-                double sample2 = clamp(image2(y, x)(channel), 0.f, 1.f);
-
-                std::size_t index1 = std::round((channelQuantization-1) * sample1);
-                std::size_t index2 = std::round((channelQuantization-1) * sample2);
-
-                b(count) = response.getCurve(channel).at(index2) - k * response.getCurve(channel).at(index1);
-                for(unsigned int i=0; i<_dimension; ++i)
-                  A(count, i) = k * H(index1, i) - H(index2, i);
-
-                count += 1;
-              }
-            }
-          }
-        }
-      }
-
-      A.conservativeResize(count, Eigen::NoChange_t::NoChange);
-      b.conservativeResize(count);
-    }
-    else
+    std::size_t count = 0;
+    for(unsigned int g=0; g<nbGroups; ++g)
     {
-      for(unsigned int g=0; g<nbGroups; ++g)
-      {
-        const std::vector<std::string > &imagePaths = imagePathsGroups[g];
-        std::vector<image::Image<image::RGBfColor>> ldrImagesGroup(imagePaths.size());
+      const std::vector<ImageSamples>& groupSamples = samples[g];
+      const std::vector<float> &ldrTimes= times[g];
 
-        for (int i = 0; i < imagePaths.size(); i++)
+      for(unsigned int channel=0; channel<channels; ++channel)
+      {
+        for(unsigned int j=0; j<groupSamples.size()-1; ++j)
         {
-            ALICEVISION_LOG_INFO("Load " << imagePaths[i]);
-            image::readImage(imagePaths[i], ldrImagesGroup[i], image::EImageColorSpace::SRGB);
-        }
-
-        const std::vector<float> &ldrTimes= times[g];
+          const std::vector<image::Rgb<double>>& colors1 = groupSamples[j].colors;
+          const std::vector<image::Rgb<double>>& colors2 = groupSamples[j+1].colors;
+          const double k = ldrTimes.at(j+1)/ldrTimes.at(j);
 
-        const std::size_t width = ldrImagesGroup.front().Width();
-        const std::size_t height = ldrImagesGroup.front().Height();
-
-        for(unsigned int channel=0; channel<channels; ++channel)
-        {
-          const int step = std::floor(width*height / samplesPerImage);
-          for(unsigned int j=0; j<nbImages-1; ++j)
+          // fill A and b matrices with the equations
+          for(std::size_t l=0; l<colors1.size(); ++l)
           {
-            const image::Image<image::RGBfColor> &image1 = ldrImagesGroup.at(j);
-            const image::Image<image::RGBfColor> &image2 = ldrImagesGroup.at(j+1);
-            const double k = ldrTimes.at(j+1)/ldrTimes.at(j);
+            double sample1 = clamp(colors1[l](channel), 0.0, 1.0);
+            double sample2 = clamp(colors2[l](channel), 0.0, 1.0);
 
-            // fill A and b matrices with the equations
-            for(unsigned int l=0; l<samplesPerImage; ++l)
-            {
-                double sample1 = std::max(0.f, std::min(1.f, image1(step*l)(channel)));
-                double sample2 = std::max(0.f, std::min(1.f, image2(step*l)(channel)));
+            std::size_t index1 = std::round((channelQuantization-1) * sample1);
+            std::size_t index2 = std::round((channelQuantization-1) * sample2);
 
-                std::size_t index1 = std::round((channelQuantization-1) * sample1);
-                std::size_t index2 = std::round((channelQuantization-1) * sample2);
+            b(count) = response.getCurve(channel).at(index2) - k * response.getCurve(channel).at(index1);
+            for(unsigned int i=0; i<_dimension; ++i)
+              A(count, i) = k * H(index1, i) - H(index2, i);
 
-                b(g*channels*(nbImages-1)*samplesPerImage + channel*(nbImages-1)*samplesPerImage + j*samplesPerImage + l) = response.getCurve(channel).at(index2) - k * response.getCurve(channel).at(index1);
-                for(unsigned int i=0; i<_dimension; ++i)
-                  A(g*channels*(nbImages-1)*samplesPerImage + channel*(nbImages-1)*samplesPerImage + j*samplesPerImage + l, i) = k * H(index1, i) - H(index2, i);
-            }
+            count += 1;
           }
         }
       }
@@ -10,6 +10,7 @@
 #include <aliceVision/numeric/numeric.hpp>
 #include "emorCurve.hpp"
 #include "rgbCurve.hpp"
+#include "sampling.hpp"
 
 namespace aliceVision {
 namespace hdr {
@@ -36,6 +37,18 @@ public:
                const bool fisheye,
                rgbCurve &response);
 
+  /**
+   * @brief Calibrate the response from the samples of the LDR images groups (see extractSamples)
+   * @param[in] samples The sRGB samples of each bracket of each group, at the same positions in all the brackets of a group
+   * @param[in] channel quantization
+   * @param[in] exposure times
+   * @param[out] camera response function
+   */
+  void process(const std::vector<std::vector<ImageSamples>>& samples,
+               const std::size_t channelQuantization,
+               const std::vector< std::vector<float> > &times,
+               rgbCurve &response);
+
 private:
   /// Dimension of the response ie number of basis vectors to calculate the response function
   unsigned int _dimension;
@@ -136,8 +136,18 @@ void LaguerreBACalibration::process(
 {
     ALICEVISION_LOG_DEBUG("Extract color samples");
     std::vector<std::vector<ImageSamples>> samples;
-    extractSamples(samples, imagePathsGroups, cameraExposures, nbPoints, imageDownscale, fisheye);
+    extractSamples(samples, imagePathsGroups, cameraExposures, nbPoints, imageDownscale, fisheye, EImageColorSpace::LINEAR);
 
+    process(samples, channelQuantization, cameraExposures, refineExposures, response);
+}
+
+void LaguerreBACalibration::process(
+                                const std::vector<std::vector<ImageSamples>>& samples,
+                                const std::size_t channelQuantization,
+                                std::vector<std::vector<float>>& cameraExposures,
+                                bool refineExposures,
+                                rgbCurve &response)
+{
     ALICEVISION_LOG_DEBUG("Create exposure list");
     std::map<std::pair<int, float>, double> exposures;
     for(int i = 0; i < cameraExposures.size(); ++i)
@@ -147,7 +157,7 @@ void LaguerreBACalibration::process(
         {
             const auto& exp = camExp[j];
 
-            ALICEVISION_LOG_TRACE(" * " << imagePathsGroups[i][j] << ": " << exp);
+            ALICEVISION_LOG_TRACE(" * group " << i << ", bracket " << j << ": " << exp);
 
             // TODO: camId
             exposures[std::make_pair(0, exp)] = exp;
@@ -218,7 +228,7 @@ void LaguerreBACalibration::process(
     // Convert selected samples into residual blocks
     for (int g = 0; g < samples.size(); ++g)
     {
-        std::vector<ImageSamples>& hdrSamples = samples[g];
+        const std::vector<ImageSamples>& hdrSamples = samples[g];
 
         ALICEVISION_LOG_TRACE("Group: " << g << ", hdr brakets: " << hdrSamples.size() << ", nb color samples: " << hdrSamples[0].colors.size());
 
@@ -10,6 +10,7 @@
 #include <aliceVision/numeric/numeric.hpp>
 #include "emorCurve.hpp"
 #include "rgbCurve.hpp"
+#include "sampling.hpp"
 
 namespace aliceVision {
 namespace hdr {
@@ -49,6 +50,21 @@ public:
       bool fisheye,
       bool refineExposures,
       rgbCurve &response);
+
+  /**
+   * @brief Calibrate the response from the samples of the LDR images groups (see extractSamples)
+   * @param[in] samples The linear samples of each bracket of each group, at the same positions in all the brackets of a group
+   * @param[in] channel quantization
+   * @param[in,out] exposure times, refined if refineExposures is enabled
+   * @param[in] refine the exposure times
+   * @param[out] camera response function
+   */
+  void process(
+      const std::vector<std::vector<ImageSamples>>& samples,
+      const std::size_t channelQuantization,
+      std::vector<std::vector<float>>& cameraExposures,
+      bool refineExposures,
+      rgbCurve &response);
 };
 
 } // namespace hdr
@@ -10,6 +10,8 @@
 #include <limits>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <stdexcept>
 
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
@@ -42,6 +44,52 @@ inline float sigmoidInv(float zeroVal, float endVal, float sigwidth, float sigMi
     return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + expf(10.0f * ((sigMid - xval) / sigwidth))));
 }
 
+namespace {
+
+/**
+ * @brief Flattened copy of a curve channel, evaluated inline with the same interpolation as rgbCurve::operator()
+ */
+struct CurveLUT
+{
+  CurveLUT(const rgbCurve& curve, std::size_t channel)
+    : values(curve.getCurve(channel))
+    , size(static_cast<float>(values.size()))
+    , maxIndex(values.size() - 2)
+  {}
+
+  inline float operator()(float sample) const
+  {
+    float infIndex;
+    const float fractionalPart = std::modf(std::max(0.f, std::min(1.f, sample)) * size - 2, &infIndex);
+    const std::size_t index = std::min(maxIndex, static_cast<std::size_t>(std::max(0.f, infIndex)));
+    return fractionalPart * values[index] + (1.0f - fractionalPart) * values[index + 1];
+  }
+
+  std::vector<float> values;
+  float size;
+  std::size_t maxIndex;
+};
+
+/**
+ * @brief The weight and response curves used to merge one exposure
+ */
+struct ExposureLUT
+{
+  std::size_t imageIndex;
+  float invTime;
+  const std::vector<CurveLUT>* weight;
+};
+
+std::vector<CurveLUT> createLUT(const rgbCurve& curve)
+{
+  std::vector<CurveLUT> lut;
+  for(std::size_t channel = 0; channel < 3; ++channel)
+    lut.emplace_back(curve, channel);
+  return lut;
+}
+
+} // namespace
+
 void hdrMerge::process(const std::vector< image::Image<image::RGBfColor> > &images,
                         const std::vector<float> &times,
                         const rgbCurve &weight,
@@ -72,73 +120,61 @@ void hdrMerge::process(const std::vector< image::Image<image::RGBfColor> > &imag
   rgbCurve weightLongestExposure = weight;
   weightLongestExposure.freezeFirstPartValues();
 
-  #pragma omp parallel for
-  for(int y = 0; y < height; ++y)
+  // flattened curves, evaluated without any call per pixel
+  const std::vector<CurveLUT> responseLUT = createLUT(response);
+  const std::vector<CurveLUT> weightLUT = createLUT(weight);
+  const std::vector<CurveLUT> weightShortestExposureLUT = createLUT(weightShortestExposure);
+  const std::vector<CurveLUT> weightLongestExposureLUT = createLUT(weightLongestExposure);
+
+  // weightShortestExposure:          _______
+  //                          _______/
+  //                                0      1
+  // weight:          ____
+  //          _______/    \________
+  //                0      1
+  // weightLongestExposure:  ____________
+  //                                      \_______
+  //                                0      1
+  std::vector<ExposureLUT> exposures;
+  exposures.push_back({0, 1.f / times.front(), &weightShortestExposureLUT});
+  for(std::size_t i = 1; i < images.size() - 1; ++i)
+    exposures.push_back({i, 1.f / times[i], &weightLUT});
+  exposures.push_back({images.size() - 1, 1.f / times.back(), &weightLongestExposureLUT});
+
+  #pragma omp parallel
   {
-    for(int x = 0; x < width; ++x)
+    // weighted sum of the radiance and sum of the weights of the current row, for each channel
+    std::vector<float> wsum(width * 3);
+    std::vector<float> wdiv(width * 3);
+
+    #pragma omp for
+    for(int y = 0; y < height; ++y)
     {
-      //for each pixels
-      image::RGBfColor &radianceColor = radiance(y, x);
+      std::fill(wsum.begin(), wsum.end(), 0.f);
+      std::fill(wdiv.begin(), wdiv.end(), 0.f);
 
-      for(std::size_t channel = 0; channel < 3; ++channel)
+      for(const ExposureLUT& exposure : exposures)
       {
-        double wsum = 0.0;
-        double wdiv = 0.0;
-
-        // Merge shortest exposure
-        {
-            int exposureIndex = 0;
-
-            // for each image
-            const double value = images[exposureIndex](y, x)(channel);
-            const double time = times[exposureIndex];
-            //
-            // weightShortestExposure:          _______
-            //                          _______/
-            //                                0      1
-            double w = std::max(0.001f, weightShortestExposure(value, channel));
+        const float* values = images[exposure.imageIndex](y, 0).data();
+        const std::vector<CurveLUT>& weightCurve = *exposure.weight;
 
-            const double r = response(value, channel);
-
-            wsum += w * r / time;
-            wdiv += w;
-        }
-        // Merge intermediate exposures
-        for(std::size_t i = 1; i < images.size() - 1; ++i)
+        for(std::size_t x = 0; x < width; ++x)
         {
-          // for each image
-          const double value = images[i](y, x)(channel);
-          const double time = times[i];
-          //
-          // weight:          ____
-          //          _______/    \________
-          //                0      1
-          double w = std::max(0.001f, weight(value, channel));
-
-          const double r = response(value, channel);
-          wsum += w * r / time;
-          wdiv += w;
+          for(std::size_t channel = 0; channel < 3; ++channel)
+          {
+            const std::size_t i = x * 3 + channel;
+            const float value = values[i];
+            const float w = std::max(0.001f, weightCurve[channel](value));
+            const float r = responseLUT[channel](value);
+            wsum[i] += w * r * exposure.invTime;
+            wdiv[i] += w;
+          }
         }
-        // Merge longest exposure
-        {
-            int exposureIndex = images.size() - 1;
-
-            // for each image
-            const double value = images[exposureIndex](y, x)(channel);
-            const double time = times[exposureIndex];
-            //
-            // weightLongestExposure:  ____________
-            //                                      \_______
-            //                                0      1
-            double w = std::max(0.001f, weightLongestExposure(value, channel));
-
-            const double r = response(value, channel);
-
-            wsum += w * r / time;
-            wdiv += w;
-        }
-        radianceColor(channel) = wsum / std::max(0.001, wdiv) * targetCameraExposure;
       }
+
+      float* radianceValues = radiance(y, 0).data();
+      for(std::size_t i = 0; i < width * 3; ++i)
+        radianceValues[i] = wsum[i] / std::max(0.001f, wdiv[i]) * targetCameraExposure;
     }
   }
 }
@@ -221,5 +257,114 @@ void hdrMerge::postProcessHighlight(const std::vector< image::Image<image::RGBfC
     }
 }
 
+void hdrMerge::processByBands(std::size_t nbBrackets, int width, int height,
+                              const ReadRowsFunction& readRows,
+                              const WriteRowsFunction& writeRows,
+                              const std::vector<float> &times,
+                              const rgbCurve &weight,
+                              const rgbCurve &response,
+                              float targetCameraExposure,
+                              float highlightCorrectionFactor,
+                              float highlightTargetLux,
+                              int bandHeight)
+{
+  assert(nbBrackets > 0);
+  assert(nbBrackets == times.size());
+  assert(bandHeight > 0);
+
+  // postProcessHighlight filters the clamped pixels of the shortest exposure:
+  // the bands are extended by the filter radius so that their rows get the same result as the full image
+  const int borderRows = (highlightCorrectionFactor > 0.0f) ? highlightBorderRows : 0;
+
+  // rows of the brackets currently in memory: [bufferBegin, bufferEnd)
+  std::vector<image::Image<image::RGBfColor>> brackets(nbBrackets);
+  int bufferBegin = 0;
+  int bufferEnd = 0;
+
+  image::Image<image::RGBfColor> radiance;
+
+  for(int yBegin = 0; yBegin < height; yBegin += bandHeight)
+  {
+    const int yEnd = std::min(height, yBegin + bandHeight);
+    const int extBegin = std::max(0, yBegin - borderRows);
+    const int extEnd = std::min(height, yEnd + borderRows);
+
+    // keep the rows already read and read the new ones
+    const int keepBegin = std::max(extBegin, bufferBegin);
+    const int keepEnd = std::max(keepBegin, std::min(extEnd, bufferEnd));
+
+    for(std::size_t i = 0; i < nbBrackets; ++i)
+    {
+      image::Image<image::RGBfColor> band(width, extEnd - extBegin);
+      if(keepEnd > keepBegin)
+        band.block(keepBegin - extBegin, 0, keepEnd - keepBegin, width) = brackets[i].block(keepBegin - bufferBegin, 0, keepEnd - keepBegin, width);
+      if(extEnd > keepEnd)
+        readRows(i, keepEnd, extEnd, &band(keepEnd - extBegin, 0));
+      brackets[i].swap(band);
+    }
+    bufferBegin = extBegin;
+    bufferEnd = extEnd;
+
+    process(brackets, times, weight, response, radiance, targetCameraExposure);
+
+    if(highlightCorrectionFactor > 0.0f)
+      postProcessHighlight(brackets, times, weight, response, radiance, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
+
+    writeRows(yBegin, yEnd, &radiance(yBegin - extBegin, 0));
+  }
+}
+
+void hdrMerge::processStreaming(const std::vector<std::string> &filepaths,
+                                const std::vector<float> &times,
+                                const rgbCurve &weight,
+                                const rgbCurve &response,
+                                float targetCameraExposure,
+                                float highlightCorrectionFactor,
+                                float highlightTargetLux,
+                                image::EImageColorSpace mergeColorSpace,
+                                const std::string &outputPath,
+                                const oiio::ParamValueList &metadata,
+                                int bandHeight)
+{
+  assert(!filepaths.empty());
+
+  std::vector<std::unique_ptr<image::ImageRowsReader>> readers;
+  for(const std::string& filepath : filepaths)
+  {
+    ALICEVISION_LOG_INFO("Open " << filepath);
+    readers.emplace_back(new image::ImageRowsReader(filepath, mergeColorSpace));
+    if(readers.back()->width() != readers.front()->width() || readers.back()->height() != readers.front()->height())
+      throw std::runtime_error("The bracket '" + filepath + "' does not have the same size as the other brackets of its group.");
+  }
+
+  const int width = readers.front()->width();
+  const int height = readers.front()->height();
+
+  // bands aligned on the output tiles
+  bandHeight = std::max(1, (bandHeight + outputTileSize - 1) / outputTileSize) * outputTileSize;
+
+  image::ImageRowsWriter writer(outputPath, width, height, image::EImageColorSpace::AUTO, metadata, outputTileSize);
+
+  processByBands(filepaths.size(), width, height,
+                 [&](std::size_t bracket, int yBegin, int yEnd, image::RGBfColor* data)
+                 {
+                   readers[bracket]->read(yBegin, yEnd, data);
+                 },
+                 [&](int yBegin, int yEnd, const image::RGBfColor* data)
+                 {
+                   writer.write(yBegin, yEnd, data);
+                 },
+                 times, weight, response, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux, bandHeight);
+
+  writer.close();
+}
+
+std::size_t hdrMerge::streamingMemorySize(std::size_t width, std::size_t nbBrackets, int bandHeight)
+{
+  const std::size_t bandRows = bandHeight + 2 * highlightBorderRows;
+  // brackets bands (and the band being read), radiance and highlight buffers
+  return width * bandRows * (sizeof(image::RGBfColor) * (nbBrackets + 2) + 2 * sizeof(float));
+}
+
 } // namespace hdr
 } // namespace aliceVision
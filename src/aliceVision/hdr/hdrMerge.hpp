@@ -8,6 +8,9 @@
 #include "rgbCurve.hpp"
 #include <aliceVision/image/all.hpp>
 #include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
 
 
 namespace aliceVision {
@@ -36,10 +39,67 @@ public:
       const rgbCurve &weight,
       const rgbCurve &response,
       image::Image<image::RGBfColor> &radiance,
-      float clampedValueCorrection,
       float targetCameraExposure,
-      float highlightMaxLumimance);
+      float highlightCorrectionFactor,
+      float highlightTargetLux);
 
+  /// read the rows [yBegin, yEnd) of a bracket
+  using ReadRowsFunction = std::function<void(std::size_t bracket, int yBegin, int yEnd, image::RGBfColor* data)>;
+  /// write the rows [yBegin, yEnd) of the radiance image
+  using WriteRowsFunction = std::function<void(int yBegin, int yEnd, const image::RGBfColor* data)>;
+
+  /// number of rows needed on each side of a band by postProcessHighlight (3x3 gaussian filter)
+  static const int highlightBorderRows = 1;
+
+  /**
+   * @brief Merge the brackets band by band, with the same result as process and postProcessHighlight.
+   * Each row of the brackets is read once, in increasing order, and each row of the radiance is written once.
+   * The memory used is proportional to the band height instead of the image height.
+   * @param[in] nbBrackets The number of brackets, sorted by exposure
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] readRows Read rows of a bracket
+   * @param[in] writeRows Write rows of the radiance image
+   * @param[in] bandHeight The number of rows merged at once
+   */
+  void processByBands(std::size_t nbBrackets, int width, int height,
+                      const ReadRowsFunction& readRows,
+                      const WriteRowsFunction& writeRows,
+                      const std::vector<float> &times,
+                      const rgbCurve &weight,
+                      const rgbCurve &response,
+                      float targetCameraExposure,
+                      float highlightCorrectionFactor,
+                      float highlightTargetLux,
+                      int bandHeight);
+
+  /**
+   * @brief Merge the bracket files band by band and write the HDR image as it goes
+   * @param[in] filepaths The bracket image paths, sorted by exposure
+   * @param[in] mergeColorSpace The color space of the brackets for the merge
+   * @param[in] outputPath The HDR image path
+   * @param[in] metadata The HDR image metadata
+   * @param[in] bandHeight The number of rows merged at once, rounded to the output tile size
+   */
+  void processStreaming(const std::vector<std::string> &filepaths,
+                        const std::vector<float> &times,
+                        const rgbCurve &weight,
+                        const rgbCurve &response,
+                        float targetCameraExposure,
+                        float highlightCorrectionFactor,
+                        float highlightTargetLux,
+                        image::EImageColorSpace mergeColorSpace,
+                        const std::string &outputPath,
+                        const oiio::ParamValueList &metadata,
+                        int bandHeight);
+
+  /**
+   * @brief Memory used by processByBands in bytes
+   */
+  static std::size_t streamingMemorySize(std::size_t width, std::size_t nbBrackets, int bandHeight);
+
+  /// tile size of the HDR images written by processStreaming
+  static const int outputTileSize = 64;
 };
 
 } // namespace hdr
@@ -0,0 +1,138 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/hdr/hdrMerge.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#define BOOST_TEST_MODULE hdrMerge
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::hdr;
+
+namespace {
+
+/// synthetic brackets of a scene with a saturated area
+std::vector<image::Image<image::RGBfColor>> createBrackets(int width, int height, const std::vector<float>& times)
+{
+  std::vector<image::Image<image::RGBfColor>> brackets;
+  for(float time : times)
+  {
+    image::Image<image::RGBfColor> img(width, height);
+    for(int y = 0; y < height; ++y)
+    {
+      for(int x = 0; x < width; ++x)
+      {
+        const float radiance = 0.05f + (x + 2 * y) / float(width + 2 * height) + ((x - 20) * (x - 20) + (y - 30) * (y - 30) < 100 ? 4.f : 0.f);
+        for(int c = 0; c < 3; ++c)
+          img(y, x)(c) = std::min(1.f, radiance * time * (1.f + 0.1f * c));
+      }
+    }
+    brackets.push_back(img);
+  }
+  return brackets;
+}
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - Merge synthetic brackets on the full image with process and postProcessHighlight
+// - Merge the same brackets band by band with processByBands
+// - Assert that both results are identical and that each row is read and written once
+//-----------------
+BOOST_AUTO_TEST_CASE(hdrMerge_processByBands)
+{
+  const int width = 64;
+  const int height = 61;
+  const std::vector<float> times = {0.25f, 1.f, 4.f};
+  const std::vector<image::Image<image::RGBfColor>> brackets = createBrackets(width, height, times);
+
+  rgbCurve response(1024);
+  response.setLinear();
+  rgbCurve weight(1024);
+  weight.setFunction(EFunctionType::GAUSSIAN);
+
+  const float targetCameraExposure = 1.f;
+  const float highlightTargetLux = 1.f;
+
+  for(float highlightCorrectionFactor : {0.f, 1.f})
+  {
+    hdrMerge merge;
+    image::Image<image::RGBfColor> expected;
+    merge.process(brackets, times, weight, response, expected, targetCameraExposure);
+    if(highlightCorrectionFactor > 0.f)
+      merge.postProcessHighlight(brackets, times, weight, response, expected, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
+
+    for(int bandHeight : {1, 7, 16, height, 2 * height})
+    {
+      image::Image<image::RGBfColor> radiance(width, height, true, image::RGBfColor(-1.f));
+      std::vector<std::vector<int>> nbReads(brackets.size(), std::vector<int>(height, 0));
+      std::vector<int> nbWrites(height, 0);
+
+      merge.processByBands(brackets.size(), width, height,
+                           [&](std::size_t bracket, int yBegin, int yEnd, image::RGBfColor* data)
+                           {
+                             for(int y = yBegin; y < yEnd; ++y)
+                             {
+                               ++nbReads[bracket][y];
+                               std::copy(&brackets[bracket](y, 0), &brackets[bracket](y, 0) + width, data + (y - yBegin) * width);
+                             }
+                           },
+                           [&](int yBegin, int yEnd, const image::RGBfColor* data)
+                           {
+                             for(int y = yBegin; y < yEnd; ++y)
+                             {
+                               ++nbWrites[y];
+                               std::copy(data + (y - yBegin) * width, data + (y - yBegin + 1) * width, &radiance(y, 0));
+                             }
+                           },
+                           times, weight, response, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux, bandHeight);
+
+      for(int y = 0; y < height; ++y)
+      {
+        BOOST_CHECK_EQUAL(nbWrites[y], 1);
+        for(std::size_t i = 0; i < brackets.size(); ++i)
+          BOOST_CHECK_EQUAL(nbReads[i][y], 1);
+      }
+
+      float maxDiff = 0.f;
+      for(int y = 0; y < height; ++y)
+        for(int x = 0; x < width; ++x)
+          maxDiff = std::max(maxDiff, (radiance(y, x) - expected(y, x)).cwiseAbs().maxCoeff());
+      BOOST_CHECK_SMALL(maxDiff, 1e-5f);
+    }
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Merge a single bracket: the radiance is the response divided by the exposure time
+//-----------------
+BOOST_AUTO_TEST_CASE(hdrMerge_singleBracket)
+{
+  const std::vector<float> times = {2.f};
+  const std::vector<image::Image<image::RGBfColor>> brackets = createBrackets(32, 8, times);
+
+  rgbCurve response(1024);
+  response.setLinear();
+  rgbCurve weight(1024);
+  weight.setFunction(EFunctionType::GAUSSIAN);
+
+  hdrMerge merge;
+  image::Image<image::RGBfColor> radiance;
+  merge.process(brackets, times, weight, response, radiance, 1.f);
+
+  for(int y = 0; y < radiance.Height(); ++y)
+    for(int x = 0; x < radiance.Width(); ++x)
+      for(int c = 0; c < 3; ++c)
+        BOOST_CHECK_CLOSE(radiance(y, x)(c), response(brackets[0](y, x)(c), c) / times[0], 1e-3);
+}
@@ -9,7 +9,10 @@
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
 
-#include <OpenImageIO/imagebufalgo.h>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <utility>
 
 
 namespace aliceVision {
@@ -17,101 +20,282 @@ namespace hdr {
 
 using namespace aliceVision::image;
 
+namespace {
+
+const std::int32_t samplesMagic = 0x53485641; // "AVHS"
+const std::int32_t samplesVersion = 2;
+
+/**
+ * @brief Extract the samples of an image on a regular grid of the downscaled image
+ * The grid covers the full frame, or the square around the image circle for the fisheye images.
+ * Only the rows of the image covered by the grid are decoded and kept in memory.
+ */
+void extractImageSamples(std::vector<Rgb<double>>& colors,
+                         const std::string& imagePath,
+                         int samplesPerImage,
+                         int downscale,
+                         bool fisheye,
+                         EImageColorSpace colorSpace)
+{
+    ImageRowsReader reader(imagePath, colorSpace);
+
+    const std::size_t fullWidth = reader.width();
+    const std::size_t width = reader.width() / downscale;
+    const std::size_t height = reader.height() / downscale;
+
+    const std::size_t minSize = std::min(width, height) * 0.97;
+    const Vec2i center(width / 2, height / 2);
+    const std::size_t maxDist2 = pow(minSize * 0.5, 2);
+
+    // first and last sampled positions of the downscaled image
+    int xFirst, yFirst, xLast, yLast, step;
+    if (fisheye)
+    {
+        // square around the image circle
+        step = std::max(1, int(std::ceil(minSize / sqrt(samplesPerImage))));
+        xFirst = std::ceil(center(0) - minSize / 2);
+        yFirst = std::ceil(center(1) - minSize / 2);
+        xLast = int(std::floor(center(0) + minSize / 2)) - step;
+        yLast = int(std::floor(center(1) + minSize / 2)) - step;
+    }
+    else
+    {
+        // full frame, grid centered in the image with at most samplesPerImage samples
+        step = std::max(1, int(std::ceil(std::sqrt(double(width * height) / samplesPerImage))));
+        const int nbColumns = std::max(1, int(width) / step);
+        const int nbRows = std::max(1, int(height) / step);
+        xFirst = (int(width) - (nbColumns - 1) * step) / 2;
+        yFirst = (int(height) - (nbRows - 1) * step) / 2;
+        xLast = xFirst + (nbColumns - 1) * step;
+        yLast = yFirst + (nbRows - 1) * step;
+    }
+
+    // rows of the full resolution image averaged into one row of the downscaled image
+    std::vector<RGBfColor> rows(fullWidth * downscale);
+    const double blockWeight = 1.0 / (downscale * downscale);
+
+    // extract samples
+    for (int y = yFirst; y <= yLast; y += step)
+    {
+        reader.read(y * downscale, (y + 1) * downscale, rows.data());
+
+        for (int x = xFirst; x <= xLast; x += step)
+        {
+            if (fisheye)
+            {
+                std::size_t dist2 = pow(center(0) - x, 2) + pow(center(1) - y, 2);
+                if (dist2 > maxDist2)
+                    continue;
+            }
+
+            double r = 0.0, g = 0.0, b = 0.0;
+            for (int dy = 0; dy < downscale; ++dy)
+            {
+                const RGBfColor* block = &rows[dy * fullWidth + x * downscale];
+                for (int dx = 0; dx < downscale; ++dx)
+                {
+                    r += block[dx].r();
+                    g += block[dx].g();
+                    b += block[dx].b();
+                }
+            }
+            colors.push_back(Rgb<double>(r * blockWeight, g * blockWeight, b * blockWeight));
+        }
+    }
+}
+
+template <typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::istream& stream, T& value)
+{
+    return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeString(std::ostream& stream, const std::string& str)
+{
+    writeValue(stream, static_cast<std::int32_t>(str.size()));
+    stream.write(str.data(), str.size());
+}
+
+bool readString(std::istream& stream, std::string& str)
+{
+    std::int32_t size;
+    if(!readValue(stream, size) || size < 0)
+        return false;
+    str.resize(size);
+    return bool(stream.read(&str[0], size));
+}
+
+} // namespace
+
 void extractSamples(
     std::vector<std::vector<ImageSamples>>& out_samples,
     const std::vector<std::vector<std::string>>& imagePathsGroups,
     const std::vector< std::vector<float> >& cameraExposures,
     int nbPoints,
     int calibrationDownscale,
-    bool fisheye
+    bool fisheye,
+    EImageColorSpace colorSpace
     )
 {
     const int nbGroups = imagePathsGroups.size();
     out_samples.resize(nbGroups);
 
-    int averallNbImages = 0;
-    for (const auto& imgPaths : imagePathsGroups)
+    // flat list of the images to share the work between threads whatever the number of groups
+    std::vector<std::pair<int, int>> images;
+    for (int g = 0; g < nbGroups; ++g)
     {
-        averallNbImages += imgPaths.size();
+        out_samples[g].resize(imagePathsGroups[g].size());
+        for (int i = 0; i < imagePathsGroups[g].size(); ++i)
+            images.emplace_back(g, i);
     }
-    const int samplesPerImage = nbPoints / averallNbImages;
+    if (images.empty())
+        return;
+
+    const int samplesPerImage = std::max(1, nbPoints / int(images.size()));
+    const int downscale = std::max(1, calibrationDownscale);
 
     ALICEVISION_LOG_TRACE("samplesPerImage: " << samplesPerImage);
 
-    #pragma omp parallel for num_threads(3)
-    for (int g = 0; g<nbGroups; ++g)
+    // the images are decoded by rows and only a few rows are kept in memory
+    #pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < images.size(); ++k)
     {
-        std::vector<ImageSamples>& out_hdrSamples = out_samples[g];
-
-        const std::vector<std::string > &imagePaths = imagePathsGroups[g];
-        out_hdrSamples.resize(imagePaths.size());
+        const int g = images[k].first;
+        const int i = images[k].second;
 
-        const std::vector<float>& exposures = cameraExposures[g];
+        ImageSamples& imageSamples = out_samples[g][i];
+        imageSamples.exposure = cameraExposures[g][i];
+        imageSamples.colors.reserve(samplesPerImage);
 
-        for (unsigned int i = 0; i < imagePaths.size(); ++i)
-        {
-            out_hdrSamples[i].exposure = exposures[i];
-            out_hdrSamples[i].colors.reserve(samplesPerImage);
-            std::vector<Rgb<double>>& colors = out_hdrSamples[i].colors;
+        extractImageSamples(imageSamples.colors, imagePathsGroups[g][i], samplesPerImage, downscale, fisheye, colorSpace);
+    }
+}
 
-            Image<RGBfColor> img;
-            readImage(imagePaths[i], img, EImageColorSpace::LINEAR);
-            if (calibrationDownscale != 1.0f)
-            {
-                unsigned int w = img.Width();
-                unsigned int h = img.Height();
-                unsigned int nw = (unsigned int)(floor(float(w) / calibrationDownscale));
-                unsigned int nh = (unsigned int)(floor(float(h) / calibrationDownscale));
+bool writeSamples(
+    const std::string& filepath,
+    const std::vector<std::vector<ImageSamples>>& samples,
+    const std::vector<std::vector<std::string>>& imagePathsGroups,
+    int nbPoints,
+    int calibrationDownscale,
+    bool fisheye,
+    EImageColorSpace colorSpace)
+{
+    assert(samples.size() == imagePathsGroups.size());
 
-                image::Image<image::RGBfColor> rescaled(nw, nh);
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file)
+        return false;
 
-                oiio::ImageSpec imageSpecResized(nw, nh, 3, oiio::TypeDesc::FLOAT);
-                oiio::ImageSpec imageSpecOrigin(w, h, 3, oiio::TypeDesc::FLOAT);
-                oiio::ImageBuf bufferOrigin(imageSpecOrigin, img.data());
-                oiio::ImageBuf bufferResized(imageSpecResized, rescaled.data());
-                oiio::ImageBufAlgo::resample(bufferResized, bufferOrigin);
+    const std::int32_t header[] = {samplesMagic, samplesVersion, nbPoints, calibrationDownscale, fisheye,
+                                   static_cast<std::int32_t>(colorSpace), static_cast<std::int32_t>(samples.size())};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
 
-                const oiio::ImageBuf inBuf(oiio::ImageSpec(w, h, 3, oiio::TypeDesc::FLOAT), img.data());
-                oiio::ImageBuf outBuf(oiio::ImageSpec(nw, nh, 3, oiio::TypeDesc::FLOAT), rescaled.data());
+    for (int g = 0; g < samples.size(); ++g)
+    {
+        writeValue(file, static_cast<std::int32_t>(samples[g].size()));
+        for (int i = 0; i < samples[g].size(); ++i)
+        {
+            const ImageSamples& imageSamples = samples[g][i];
+            writeString(file, imagePathsGroups[g][i]);
+            writeValue(file, imageSamples.exposure);
+            writeValue(file, static_cast<std::int32_t>(imageSamples.camId));
+            writeValue(file, static_cast<std::int32_t>(imageSamples.colors.size()));
 
-                oiio::ImageBufAlgo::resize(outBuf, inBuf);
-                img.swap(rescaled);
+            // the colors are decoded as float
+            std::vector<float> colors;
+            colors.reserve(imageSamples.colors.size() * 3);
+            for (const Rgb<double>& c : imageSamples.colors)
+            {
+                colors.push_back(c.r());
+                colors.push_back(c.g());
+                colors.push_back(c.b());
             }
+            file.write(reinterpret_cast<const char*>(colors.data()), colors.size() * sizeof(float));
+        }
+    }
+    return bool(file);
+}
 
-            const std::size_t width = img.Width();
-            const std::size_t height = img.Height();
+bool readSamples(
+    const std::string& filepath,
+    std::vector<std::vector<ImageSamples>>& out_samples,
+    const std::vector<std::vector<std::string>>& imagePathsGroups,
+    int nbPoints,
+    int calibrationDownscale,
+    bool fisheye,
+    EImageColorSpace colorSpace)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file)
+        return false;
 
-            const std::size_t minSize = std::min(width, height) * 0.97;
-            const Vec2i center(width / 2, height / 2);
+    std::int32_t header[7];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        header[0] != samplesMagic || header[1] != samplesVersion)
+    {
+        ALICEVISION_LOG_WARNING("Invalid calibration samples file: " << filepath);
+        return false;
+    }
 
-            const int xMin = std::ceil(center(0) - minSize / 2);
-            const int yMin = std::ceil(center(1) - minSize / 2);
-            const int xMax = std::floor(center(0) + minSize / 2);
-            const int yMax = std::floor(center(1) + minSize / 2);
-            const std::size_t maxDist2 = pow(minSize * 0.5, 2);
+    if (header[2] != nbPoints || header[3] != calibrationDownscale || header[4] != fisheye ||
+        header[5] != static_cast<std::int32_t>(colorSpace) || header[6] != imagePathsGroups.size())
+    {
+        ALICEVISION_LOG_INFO("The calibration samples file '" << filepath << "' has been extracted with other parameters.");
+        return false;
+    }
 
-            const int step = std::ceil(minSize / sqrt(samplesPerImage));
+    std::vector<std::vector<ImageSamples>> samples(imagePathsGroups.size());
+    for (int g = 0; g < samples.size(); ++g)
+    {
+        std::int32_t nbImages;
+        if (!readValue(file, nbImages) || nbImages != imagePathsGroups[g].size())
+        {
+            ALICEVISION_LOG_INFO("The calibration samples file '" << filepath << "' has been extracted from other images.");
+            return false;
+        }
+        samples[g].resize(nbImages);
 
-            // extract samples
-            for (int y = yMin; y <= yMax - step; y += step)
+        for (int i = 0; i < nbImages; ++i)
+        {
+            ImageSamples& imageSamples = samples[g][i];
+            std::string imagePath;
+            std::int32_t camId, nbColors;
+            if (!readString(file, imagePath) ||
+                !readValue(file, imageSamples.exposure) ||
+                !readValue(file, camId) ||
+                !readValue(file, nbColors) || nbColors < 0)
             {
-                for (int x = xMin; x <= xMax - step; x += step)
-                {
-                    if (fisheye)
-                    {
-                        std::size_t dist2 = pow(center(0) - x, 2) + pow(center(1) - y, 2);
-                        if (dist2 > maxDist2)
-                            continue;
-                    }
-                    RGBfColor& c = img(y, x);
-                    colors.push_back(Rgb<double>(c(0), c(1), c(2)));
-                }
+                ALICEVISION_LOG_WARNING("Truncated calibration samples file: " << filepath);
+                return false;
+            }
+            if (imagePath != imagePathsGroups[g][i])
+            {
+                ALICEVISION_LOG_INFO("The calibration samples file '" << filepath << "' has been extracted from other images.");
+                return false;
             }
+            imageSamples.camId = camId;
+
+            std::vector<float> colors(nbColors * 3);
+            if (!file.read(reinterpret_cast<char*>(colors.data()), colors.size() * sizeof(float)))
+            {
+                ALICEVISION_LOG_WARNING("Truncated calibration samples file: " << filepath);
+                return false;
+            }
+            imageSamples.colors.reserve(nbColors);
+            for (std::size_t c = 0; c < colors.size(); c += 3)
+                imageSamples.colors.push_back(Rgb<double>(colors[c], colors[c + 1], colors[c + 2]));
         }
     }
-}
-
 
+    out_samples.swap(samples);
+    return true;
+}
 
 } // namespace hdr
 } // namespace aliceVision
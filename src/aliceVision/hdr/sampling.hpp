@@ -9,6 +9,9 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <string>
+#include <vector>
+
 namespace aliceVision {
 namespace hdr {
 
@@ -21,13 +24,53 @@ struct ImageSamples
 };
 
 
+/**
+ * @brief Extract the calibration samples of all the bracket groups: for each group, the colors of each bracket
+ * at the same positions of a regular grid of the image downscaled by calibrationDownscale.
+ * Each image is decoded once, by rows, and only the rows of the sampling grid are kept in memory.
+ * @param[out] out_samples The samples of each bracket of each group
+ * @param[in] imagePathsGroups The bracket image paths of each group
+ * @param[in] cameraExposures The exposure of each bracket of each group
+ * @param[in] nbPoints The total number of samples
+ * @param[in] calibrationDownscale The image downscale, each sample is the average color of a block of calibrationDownscale x calibrationDownscale pixels
+ * @param[in] fisheye Only keep the samples inside the image circle
+ * @param[in] colorSpace The color space of the samples
+ */
 void extractSamples(
     std::vector<std::vector<ImageSamples>>& out_samples,
     const std::vector<std::vector<std::string>>& imagePathsGroups,
     const std::vector< std::vector<float> >& cameraExposures,
     int nbPoints,
     int calibrationDownscale,
-    bool fisheye);
+    bool fisheye,
+    image::EImageColorSpace colorSpace = image::EImageColorSpace::LINEAR);
+
+/**
+ * @brief Save the calibration samples with the extraction parameters in a binary file
+ * @return true if the file has been written
+ */
+bool writeSamples(
+    const std::string& filepath,
+    const std::vector<std::vector<ImageSamples>>& samples,
+    const std::vector<std::vector<std::string>>& imagePathsGroups,
+    int nbPoints,
+    int calibrationDownscale,
+    bool fisheye,
+    image::EImageColorSpace colorSpace);
+
+/**
+ * @brief Load calibration samples saved by writeSamples,
+ * only if they have been extracted from the same images with the same parameters
+ * @return true if the samples have been loaded
+ */
+bool readSamples(
+    const std::string& filepath,
+    std::vector<std::vector<ImageSamples>>& out_samples,
+    const std::vector<std::vector<std::string>>& imagePathsGroups,
+    int nbPoints,
+    int calibrationDownscale,
+    bool fisheye,
+    image::EImageColorSpace colorSpace);
 
 
 } // namespace hdr
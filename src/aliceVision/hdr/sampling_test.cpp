@@ -0,0 +1,161 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/hdr/sampling.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#define BOOST_TEST_MODULE hdrSampling
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::hdr;
+
+namespace fs = boost::filesystem;
+
+//-----------------
+// Test summary:
+//-----------------
+// - Write calibration samples and read them back
+// - Assert that the samples are identical
+// - Assert that the samples are not loaded for other images or other extraction parameters
+//-----------------
+BOOST_AUTO_TEST_CASE(hdrSampling_writeRead)
+{
+  const std::vector<std::vector<std::string>> imagePathsGroups = {{"a_0.jpg", "a_1.jpg", "a_2.jpg"},
+                                                                  {"b_0.jpg", "b_1.jpg", "b_2.jpg"}};
+  const std::vector<float> exposures = {0.01f, 0.04f, 0.16f};
+
+  std::vector<std::vector<ImageSamples>> samples(imagePathsGroups.size());
+  for(std::size_t g = 0; g < samples.size(); ++g)
+  {
+    for(std::size_t i = 0; i < exposures.size(); ++i)
+    {
+      ImageSamples imageSamples;
+      imageSamples.exposure = exposures[i];
+      for(int k = 0; k < 100 + 10 * g; ++k)
+        imageSamples.colors.emplace_back(k * 0.01f, (k % 7) * 0.1f, std::min(1.f, exposures[i] * k));
+      samples[g].push_back(imageSamples);
+    }
+  }
+
+  const int nbPoints = 1000;
+  const int downscale = 4;
+  const std::string filepath = (fs::temp_directory_path() / fs::unique_path("hdrSamples_%%%%%%.bin")).string();
+  BOOST_REQUIRE(writeSamples(filepath, samples, imagePathsGroups, nbPoints, downscale, false, image::EImageColorSpace::SRGB));
+
+  std::vector<std::vector<ImageSamples>> loaded;
+  BOOST_REQUIRE(readSamples(filepath, loaded, imagePathsGroups, nbPoints, downscale, false, image::EImageColorSpace::SRGB));
+
+  BOOST_REQUIRE_EQUAL(loaded.size(), samples.size());
+  for(std::size_t g = 0; g < samples.size(); ++g)
+  {
+    BOOST_REQUIRE_EQUAL(loaded[g].size(), samples[g].size());
+    for(std::size_t i = 0; i < samples[g].size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(loaded[g][i].exposure, samples[g][i].exposure);
+      BOOST_REQUIRE_EQUAL(loaded[g][i].colors.size(), samples[g][i].colors.size());
+      for(std::size_t k = 0; k < samples[g][i].colors.size(); ++k)
+        BOOST_CHECK(loaded[g][i].colors[k] == samples[g][i].colors[k]);
+    }
+  }
+
+  // other extraction parameters
+  BOOST_CHECK(!readSamples(filepath, loaded, imagePathsGroups, nbPoints * 2, downscale, false, image::EImageColorSpace::SRGB));
+  BOOST_CHECK(!readSamples(filepath, loaded, imagePathsGroups, nbPoints, 1, false, image::EImageColorSpace::SRGB));
+  BOOST_CHECK(!readSamples(filepath, loaded, imagePathsGroups, nbPoints, downscale, true, image::EImageColorSpace::SRGB));
+  BOOST_CHECK(!readSamples(filepath, loaded, imagePathsGroups, nbPoints, downscale, false, image::EImageColorSpace::LINEAR));
+
+  // other images
+  std::vector<std::vector<std::string>> otherImagePathsGroups = imagePathsGroups;
+  otherImagePathsGroups[1][2] = "c_2.jpg";
+  BOOST_CHECK(!readSamples(filepath, loaded, otherImagePathsGroups, nbPoints, downscale, false, image::EImageColorSpace::SRGB));
+  otherImagePathsGroups.pop_back();
+  BOOST_CHECK(!readSamples(filepath, loaded, otherImagePathsGroups, nbPoints, downscale, false, image::EImageColorSpace::SRGB));
+
+  fs::remove(filepath);
+
+  // missing file
+  BOOST_CHECK(!readSamples(filepath, loaded, imagePathsGroups, nbPoints, downscale, false, image::EImageColorSpace::SRGB));
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Extract the samples of an image which colors encode the pixel positions
+// - Assert that the number of samples does not exceed the requested one
+// - Assert that the samples cover the full frame, or only the image circle for a fisheye image
+//-----------------
+BOOST_AUTO_TEST_CASE(hdrSampling_extract)
+{
+  const int width = 120;
+  const int height = 80;
+
+  // red: x position, green: y position
+  image::Image<image::RGBfColor> image(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = image::RGBfColor((x + 0.5f) / width, (y + 0.5f) / height, 0.f);
+
+  const std::string imagePath = (fs::temp_directory_path() / fs::unique_path("hdrSampling_%%%%%%.exr")).string();
+  image::writeImage(imagePath, image, image::EImageColorSpace::NO_CONVERSION);
+
+  const std::vector<std::vector<std::string>> imagePathsGroups = {{imagePath}};
+  const std::vector<std::vector<float>> exposures = {{1.f}};
+  const int nbPoints = 96;
+
+  for(const int downscale : {1, 2})
+  {
+    std::vector<std::vector<ImageSamples>> samples;
+    extractSamples(samples, imagePathsGroups, exposures, nbPoints, downscale, false, image::EImageColorSpace::NO_CONVERSION);
+    BOOST_REQUIRE_EQUAL(samples.size(), 1);
+    BOOST_REQUIRE_EQUAL(samples[0].size(), 1);
+
+    const std::vector<image::Rgb<double>>& colors = samples[0][0].colors;
+    BOOST_CHECK_LE(colors.size(), nbPoints);
+    BOOST_CHECK_GE(colors.size(), nbPoints / 2);
+
+    // full frame
+    double xMin = 1.0, xMax = 0.0, yMin = 1.0, yMax = 0.0;
+    for(const image::Rgb<double>& color : colors)
+    {
+      xMin = std::min(xMin, color.r());
+      xMax = std::max(xMax, color.r());
+      yMin = std::min(yMin, color.g());
+      yMax = std::max(yMax, color.g());
+    }
+    BOOST_CHECK_LT(xMin, 0.1);
+    BOOST_CHECK_GT(xMax, 0.9);
+    BOOST_CHECK_LT(yMin, 0.15);
+    BOOST_CHECK_GT(yMax, 0.85);
+  }
+
+  // fisheye: samples inside the image circle only
+  {
+    std::vector<std::vector<ImageSamples>> samples;
+    extractSamples(samples, imagePathsGroups, exposures, nbPoints, 1, true, image::EImageColorSpace::NO_CONVERSION);
+    BOOST_REQUIRE_EQUAL(samples.size(), 1);
+    BOOST_REQUIRE_EQUAL(samples[0].size(), 1);
+
+    const std::vector<image::Rgb<double>>& colors = samples[0][0].colors;
+    BOOST_CHECK_LE(colors.size(), nbPoints);
+    BOOST_CHECK_GE(colors.size(), nbPoints / 2);
+
+    const double radius = 0.5 * std::min(width, height);
+    for(const image::Rgb<double>& color : colors)
+    {
+      const double x = color.r() * width - 0.5;
+      const double y = color.g() * height - 0.5;
+      BOOST_CHECK_LE(std::hypot(x - width / 2, y - height / 2), radius);
+    }
+  }
+
+  fs::remove(imagePath);
+}
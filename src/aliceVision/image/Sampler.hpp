@@ -430,8 +430,9 @@ struct Sampler2d
     _sampler( dx , coefs_x ) ;
     _sampler( dy , coefs_y ) ;
 
-    // Default color constructor init all channels to zero
-    typename RealPixel<T>::real_type res;
+    // Default color constructor init all channels to zero (value initialization for scalar types)
+    // Scalar accumulators were left uninitialized before, so the sampled values differ from the previous releases
+    typename RealPixel<T>::real_type res = typename RealPixel<T>::real_type();
 
     // integer position of sample (x,y)
     const int grid_x = static_cast<int>( floor( x ) );
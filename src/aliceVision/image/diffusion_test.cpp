@@ -0,0 +1,86 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/image/Image.hpp"
+#include "aliceVision/image/diffusion.hpp"
+
+#include <random>
+
+#define BOOST_TEST_MODULE ImageDiffusion
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+void randomImage(Image<float>& image, int width, int height, float minValue, float maxValue, std::mt19937& generator)
+{
+  std::uniform_real_distribution<float> distribution(minValue, maxValue);
+  image.resize(width, height);
+  for(int i = 0; i < height; ++i)
+    for(int j = 0; j < width; ++j)
+      image(i, j) = distribution(generator);
+}
+
+BOOST_AUTO_TEST_CASE(Image_FEDStep)
+{
+  std::mt19937 generator(42);
+
+  // odd sizes exercise the scalar tail of the vectorized rows
+  const std::vector<std::pair<int, int>> sizes = {{2, 2}, {3, 7}, {5, 4}, {37, 19}, {256, 128}};
+
+  for(const auto& size : sizes)
+  {
+    Image<float> src, diff;
+    randomImage(src, size.first, size.second, 0.f, 1.f, generator);
+    randomImage(diff, size.first, size.second, 0.1f, 1.f, generator);
+
+    // reference: FED image, then addition
+    Image<float> fed;
+    ImageFED(src, diff, 0.2f, fed);
+    Image<float> expected = src;
+    expected.array() += fed.array();
+
+    Image<float> out;
+    ImageFEDStep(src, diff, 0.2f, out);
+
+    BOOST_CHECK(out == expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Image_FEDCycle)
+{
+  std::mt19937 generator(42);
+
+  Image<float> src, diff;
+  randomImage(src, 123, 45, 0.f, 1.f, generator);
+  randomImage(diff, 123, 45, 0.1f, 1.f, generator);
+
+  std::vector<float> tau;
+  FEDCycleTimings(4.f, 0.25f, tau);
+
+  // reference: naive FED cycle
+  Image<float> expected = src;
+  Image<float> fed;
+  for(const float t : tau)
+  {
+    ImageFED(expected, diff, t, fed);
+    expected.array() += fed.array();
+  }
+
+  Image<float> out = src;
+  ImageFEDCycle(out, diff, tau);
+  BOOST_CHECK(out == expected);
+
+  // reuse of the scratch buffer between cycles
+  Image<float> buffer;
+  Image<float> outBuffer = src;
+  ImageFEDCycle(outBuffer, diff, tau, buffer);
+  BOOST_CHECK(outBuffer == expected);
+
+  outBuffer = src;
+  ImageFEDCycle(outBuffer, diff, tau, buffer);
+  BOOST_CHECK(outBuffer == expected);
+}
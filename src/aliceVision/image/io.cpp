@@ -16,7 +16,10 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <memory>
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
@@ -188,16 +191,44 @@ void getBufferFromImage(Image<RGBColor>& image, oiio::ImageBuf& buffer)
   getBufferFromImage(image, oiio::TypeDesc::UINT8, 3, buffer);
 }
 
-template<typename T>
-void readImage(const std::string& path,
-               oiio::TypeDesc format,
-               int nchannels,
-               Image<T>& image,
-               EImageColorSpace imageColorSpace)
+namespace {
+
+std::atomic<std::size_t> nbImagesRead(0);
+std::atomic<std::size_t> nbDecodedBytes(0);
+
+/// count the bytes decoded from an image file, in the file pixel format
+void addDecodedBytes(const oiio::ImageSpec& spec, std::size_t nbPixels)
 {
-  // check requested channels number
-  assert(nchannels == 1 || nchannels >= 3);
+  nbDecodedBytes += nbPixels * spec.pixel_bytes(true);
+}
+
+/// clamp a value in [lo, hi]
+int clampValue(int value, int lo, int hi)
+{
+  return std::max(lo, std::min(value, hi));
+}
+
+} // namespace
+
+ImageReadStats getImageReadStats()
+{
+  ImageReadStats stats;
+  stats.nbReads = nbImagesRead;
+  stats.decodedBytes = nbDecodedBytes;
+  return stats;
+}
 
+void resetImageReadStats()
+{
+  nbImagesRead = 0;
+  nbDecodedBytes = 0;
+}
+
+/**
+ * @brief OIIO configuration used to read the input images
+ */
+oiio::ImageSpec getReadConfigSpec()
+{
   oiio::ImageSpec configSpec;
 
   // libRAW configuration
@@ -210,32 +241,28 @@ void readImage(const std::string& path,
 #else
   configSpec.attribute("raw:ColorSpace", "Linear");   // want linear colorspace with sRGB primaries
 #endif
+  return configSpec;
+}
 
-  oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
-
-  inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
-
-  if(!inBuf.initialized())
-    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
-
-#if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
-  // Workaround for bug in RAW colorspace management in previous versions of OIIO:
-  //     When asking sRGB we got sRGB primaries with linear gamma,
-  //     but oiio::ColorSpace was wrongly set to sRGB.
-  oiio::ImageSpec inSpec = inBuf.spec();
-  if(inSpec.get_string_attribute("oiio:ColorSpace", "") == "sRGB")
-  {
-    if(inBuf.file_format_name() == "raw")
-    {
-      // For the RAW plugin: override colorspace as linear (as the content is linear with sRGB primaries but declared as sRGB)
-      inSpec.attribute("oiio:ColorSpace", "Linear");
-      ALICEVISION_LOG_TRACE("OIIO workaround: RAW input image " << path << " is in Linear.");
-    }
-  }
-#else
-  const oiio::ImageSpec& inSpec = inBuf.spec();
-#endif
-
+/**
+ * @brief Convert the color space and the channels of a read image buffer and copy it in an image
+ * @param[in] path The image path (for the messages)
+ * @param[in,out] inBuf The read float buffer
+ * @param[in] inSpec The spec of the read buffer, with the file color space
+ * @param[in] outWidth The output image width, the buffer is resized after the color conversion if needed
+ * @param[in] outHeight The output image height
+ */
+template<typename T>
+void exportImage(const std::string& path,
+                 oiio::ImageBuf& inBuf,
+                 const oiio::ImageSpec& inSpec,
+                 oiio::TypeDesc format,
+                 int nchannels,
+                 Image<T>& image,
+                 EImageColorSpace imageColorSpace,
+                 int outWidth,
+                 int outHeight)
+{
   // check picture channels number
   if(inSpec.nchannels != 1 && inSpec.nchannels < 3)
     throw std::runtime_error("Can't load channels of image file '" + path + "'.");
@@ -280,10 +307,18 @@ void readImage(const std::string& path,
     inBuf.copy(grayscaleBuf);
   }
 
+  // remaining downscale, applied after the color conversion as a full resolution read followed by a resize
+  if(outWidth != inSpec.width || outHeight != inSpec.height)
+  {
+    oiio::ImageBuf resizedBuf(oiio::ImageSpec(outWidth, outHeight, inBuf.nchannels(), oiio::TypeDesc::FLOAT));
+    oiio::ImageBufAlgo::resize(resizedBuf, inBuf);
+    inBuf.copy(resizedBuf);
+  }
+
   // add missing channels
   if(nchannels > inSpec.nchannels)
   {
-    oiio::ImageSpec requestedSpec(inSpec.width, inSpec.height, nchannels, format);
+    oiio::ImageSpec requestedSpec(outWidth, outHeight, nchannels, format);
     oiio::ImageBuf requestedBuf(requestedSpec);
 
     // duplicate first channel for RGB
@@ -298,7 +333,7 @@ void readImage(const std::string& path,
   }
 
   // copy pixels from oiio to eigen
-  image.resize(inSpec.width, inSpec.height, false);
+  image.resize(outWidth, outHeight, false);
   {
     oiio::ROI exportROI = inBuf.roi();
     exportROI.chbegin = 0;
@@ -308,6 +343,219 @@ void readImage(const std::string& path,
   }
 }
 
+
+template<typename T>
+void readImage(const std::string& path,
+               oiio::TypeDesc format,
+               int nchannels,
+               Image<T>& image,
+               EImageColorSpace imageColorSpace)
+{
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+
+  const oiio::ImageSpec configSpec = getReadConfigSpec();
+
+  oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
+
+  inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+
+  if(!inBuf.initialized())
+    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+  ++nbImagesRead;
+
+#if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
+  // Workaround for bug in RAW colorspace management in previous versions of OIIO:
+  //     When asking sRGB we got sRGB primaries with linear gamma,
+  //     but oiio::ColorSpace was wrongly set to sRGB.
+  oiio::ImageSpec inSpec = inBuf.spec();
+  if(inSpec.get_string_attribute("oiio:ColorSpace", "") == "sRGB")
+  {
+    if(inBuf.file_format_name() == "raw")
+    {
+      // For the RAW plugin: override colorspace as linear (as the content is linear with sRGB primaries but declared as sRGB)
+      inSpec.attribute("oiio:ColorSpace", "Linear");
+      ALICEVISION_LOG_TRACE("OIIO workaround: RAW input image " << path << " is in Linear.");
+    }
+  }
+#else
+  const oiio::ImageSpec& inSpec = inBuf.spec();
+#endif
+
+  addDecodedBytes(inSpec, std::size_t(inSpec.width) * inSpec.height);
+
+  exportImage(path, inBuf, inSpec, format, nchannels, image, imageColorSpace, inSpec.width, inSpec.height);
+}
+
+/**
+ * @brief Seek the MIP level of an image with the largest downscale not greater than the requested one.
+ * The MIP levels (if any) are successive halvings of the image.
+ * @param[in] path The image path (for the messages)
+ * @param[in,out] in The opened image
+ * @param[in] subimage The subimage index
+ * @param[in] downscale The requested downscale factor
+ * @param[out] levelSpec The spec of the selected MIP level
+ * @return the selected MIP level
+ */
+int seekMipLevel(const std::string& path, oiio::ImageInput& in, int subimage, int downscale, oiio::ImageSpec& levelSpec)
+{
+  int miplevel = 0;
+  oiio::ImageSpec spec;
+  while((2 << miplevel) <= downscale && in.seek_subimage(subimage, miplevel + 1, spec))
+    ++miplevel;
+
+  if(!in.seek_subimage(subimage, miplevel, levelSpec))
+    throw std::runtime_error("Cannot read MIP level " + std::to_string(miplevel) + " of image file '" + path + "'.");
+
+  return miplevel;
+}
+
+/**
+ * @brief Read a region of an image, at the MIP level with the largest downscale not greater than the requested one.
+ * Only the scanlines (or the tiles) covering the region are decoded.
+ * @param[in] path The image path
+ * @param[in] options The region, downscale and subimage to read
+ * @param[out] inBuf The float buffer of the region at the MIP level resolution
+ * @param[out] inSpec The spec of the buffer, with the file color space
+ * @param[out] outWidth The width of the region at the requested resolution
+ * @param[out] outHeight The height of the region at the requested resolution
+ */
+void readImageRegion(const std::string& path,
+                     const ImageReadOptions& options,
+                     oiio::ImageBuf& inBuf,
+                     oiio::ImageSpec& inSpec,
+                     int& outWidth,
+                     int& outHeight)
+{
+  const oiio::ImageSpec configSpec = getReadConfigSpec();
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path, &configSpec));
+
+  if(!in)
+    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+  ++nbImagesRead;
+
+  oiio::ImageSpec fullSpec;
+  if(!in->seek_subimage(options.subimage, 0, fullSpec))
+    throw std::runtime_error("Cannot find subimage " + std::to_string(options.subimage) + " of image file '" + path + "'.");
+
+  // requested region in the full resolution image, clamped to at least one pixel inside the image
+  const int x0 = clampValue(options.roiX, 0, fullSpec.width - 1);
+  const int y0 = clampValue(options.roiY, 0, fullSpec.height - 1);
+  const int x1 = (options.roiWidth > 0) ? clampValue(options.roiX + options.roiWidth, x0 + 1, fullSpec.width) : fullSpec.width;
+  const int y1 = (options.roiHeight > 0) ? clampValue(options.roiY + options.roiHeight, y0 + 1, fullSpec.height) : fullSpec.height;
+
+  const int downscale = std::max(1, options.downscale);
+  outWidth = std::max(1, (x1 - x0) / downscale);
+  outHeight = std::max(1, (y1 - y0) / downscale);
+
+  oiio::ImageSpec levelSpec;
+  const int miplevel = seekMipLevel(path, *in, options.subimage, downscale, levelSpec);
+
+  // region at the MIP level resolution
+  const int levelScale = 1 << miplevel;
+  const int lx0 = std::min(x0 / levelScale, levelSpec.width - 1);
+  const int ly0 = std::min(y0 / levelScale, levelSpec.height - 1);
+  const int lx1 = clampValue((x1 + levelScale - 1) / levelScale, lx0 + 1, levelSpec.width);
+  const int ly1 = clampValue((y1 + levelScale - 1) / levelScale, ly0 + 1, levelSpec.height);
+  const int regionWidth = lx1 - lx0;
+  const int regionHeight = ly1 - ly0;
+  const int nchannels = levelSpec.nchannels;
+
+  inSpec = levelSpec;
+  inSpec.x = inSpec.y = inSpec.z = 0;
+  inSpec.full_x = inSpec.full_y = inSpec.full_z = 0;
+  inSpec.width = inSpec.full_width = regionWidth;
+  inSpec.height = inSpec.full_height = regionHeight;
+  inSpec.tile_width = inSpec.tile_height = inSpec.tile_depth = 0;
+  inSpec.set_format(oiio::TypeDesc::FLOAT);
+
+#if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
+  // Workaround for bug in RAW colorspace management in previous versions of OIIO (see readImage)
+  if(inSpec.get_string_attribute("oiio:ColorSpace", "") == "sRGB" && std::string(in->format_name()) == "raw")
+    inSpec.attribute("oiio:ColorSpace", "Linear");
+#endif
+
+  inBuf.reset(inSpec);
+  float* data = static_cast<float*>(inBuf.localpixels());
+  const std::size_t rowSize = std::size_t(regionWidth) * nchannels;
+
+  if(levelSpec.tile_width > 0)
+  {
+    // tiles covering the region
+    const int tileWidth = levelSpec.tile_width;
+    const int tileHeight = levelSpec.tile_height;
+    const int tx0 = (lx0 / tileWidth) * tileWidth;
+    const int ty0 = (ly0 / tileHeight) * tileHeight;
+    const int tx1 = std::min(levelSpec.width, ((lx1 + tileWidth - 1) / tileWidth) * tileWidth);
+    const int ty1 = std::min(levelSpec.height, ((ly1 + tileHeight - 1) / tileHeight) * tileHeight);
+
+    std::vector<float> tiles(std::size_t(tx1 - tx0) * (ty1 - ty0) * nchannels);
+    if(!in->read_tiles(levelSpec.x + tx0, levelSpec.x + tx1, levelSpec.y + ty0, levelSpec.y + ty1, levelSpec.z, levelSpec.z + 1,
+                       0, nchannels, oiio::TypeDesc::FLOAT, tiles.data()))
+      throw std::runtime_error("Can't read the tiles of image file '" + path + "'.");
+
+    for(int y = ly0; y < ly1; ++y)
+      std::copy_n(&tiles[(std::size_t(y - ty0) * (tx1 - tx0) + (lx0 - tx0)) * nchannels], rowSize, data + std::size_t(y - ly0) * rowSize);
+
+    addDecodedBytes(levelSpec, std::size_t(tx1 - tx0) * (ty1 - ty0));
+  }
+  else
+  {
+    // scanlines covering the region, the columns outside of the region are dropped
+    std::vector<float> rows;
+    float* rowsData = data;
+    if(regionWidth != levelSpec.width)
+    {
+      rows.resize(std::size_t(levelSpec.width) * regionHeight * nchannels);
+      rowsData = rows.data();
+    }
+
+    if(!in->read_scanlines(levelSpec.y + ly0, levelSpec.y + ly1, levelSpec.z, 0, nchannels, oiio::TypeDesc::FLOAT, rowsData))
+      throw std::runtime_error("Can't read the scanlines of image file '" + path + "'.");
+
+    if(!rows.empty())
+    {
+      for(int y = 0; y < regionHeight; ++y)
+        std::copy_n(&rows[(std::size_t(y) * levelSpec.width + lx0) * nchannels], rowSize, data + std::size_t(y) * rowSize);
+    }
+
+    // the sequential scanline decoders (JPEG, PNG) decode all the scanlines before the region
+    addDecodedBytes(levelSpec, std::size_t(levelSpec.width) * ly1);
+  }
+
+  in->close();
+
+  ALICEVISION_LOG_TRACE("Read region [" << x0 << ", " << x1 << "] x [" << y0 << ", " << y1 << "] of image " << path
+                        << " at MIP level " << miplevel << " (" << regionWidth << "x" << regionHeight << ").");
+}
+
+template<typename T>
+void readImage(const std::string& path,
+               oiio::TypeDesc format,
+               int nchannels,
+               Image<T>& image,
+               EImageColorSpace imageColorSpace,
+               const ImageReadOptions& options)
+{
+  if(options.isFullImage())
+  {
+    readImage(path, format, nchannels, image, imageColorSpace);
+    return;
+  }
+
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+
+  oiio::ImageBuf inBuf;
+  oiio::ImageSpec inSpec;
+  int outWidth, outHeight;
+  readImageRegion(path, options, inBuf, inSpec, outWidth, outHeight);
+
+  exportImage(path, inBuf, inSpec, format, nchannels, image, imageColorSpace, outWidth, outHeight);
+}
+
 template<typename T>
 void writeImage(const std::string& path,
                 oiio::TypeDesc typeDesc,
@@ -394,6 +642,170 @@ void readImage(const std::string& path, Image<RGBColor>& image, EImageColorSpace
   readImage(path, oiio::TypeDesc::UINT8, 3, image, imageColorSpace);
 }
 
+void readImage(const std::string& path, Image<float>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options)
+{
+  readImage(path, oiio::TypeDesc::FLOAT, 1, image, imageColorSpace, options);
+}
+
+void readImage(const std::string& path, Image<unsigned char>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options)
+{
+  readImage(path, oiio::TypeDesc::UINT8, 1, image, imageColorSpace, options);
+}
+
+void readImage(const std::string& path, Image<RGBAfColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options)
+{
+  readImage(path, oiio::TypeDesc::FLOAT, 4, image, imageColorSpace, options);
+}
+
+void readImage(const std::string& path, Image<RGBAColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options)
+{
+  readImage(path, oiio::TypeDesc::UINT8, 4, image, imageColorSpace, options);
+}
+
+void readImage(const std::string& path, Image<RGBfColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options)
+{
+  readImage(path, oiio::TypeDesc::FLOAT, 3, image, imageColorSpace, options);
+}
+
+void readImage(const std::string& path, Image<RGBColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options)
+{
+  readImage(path, oiio::TypeDesc::UINT8, 3, image, imageColorSpace, options);
+}
+
+void readImagePixels(const std::string& path, const std::vector<Vec2i>& pixels, std::vector<RGBColor>& colors,
+                     EImageColorSpace imageColorSpace, int downscale)
+{
+  if(imageColorSpace == EImageColorSpace::AUTO)
+    throw std::runtime_error("You must specify a requested color space for image file '" + path + "'.");
+
+  colors.resize(pixels.size());
+  if(pixels.empty())
+    return;
+
+  const oiio::ImageSpec configSpec = getReadConfigSpec();
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path, &configSpec));
+
+  if(!in)
+    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+  ++nbImagesRead;
+
+  const oiio::ImageSpec fullSpec = in->spec();
+  oiio::ImageSpec levelSpec;
+  const int miplevel = seekMipLevel(path, *in, 0, std::max(1, downscale), levelSpec);
+
+  // check picture channels number
+  const int nchannels = levelSpec.nchannels;
+  if(nchannels != 1 && nchannels < 3)
+    throw std::runtime_error("Can't load channels of image file '" + path + "'.");
+
+  // pixel positions in the MIP level, sorted by (tile) row to read the file in a single pass
+  const int levelScale = 1 << miplevel;
+  const int rowHeight = (levelSpec.tile_width > 0) ? levelSpec.tile_height : 1;
+  const int columnWidth = (levelSpec.tile_width > 0) ? levelSpec.tile_width : levelSpec.width;
+  std::vector<Vec2i> levelPixels(pixels.size());
+  std::vector<std::size_t> order(pixels.size());
+  for(std::size_t i = 0; i < pixels.size(); ++i)
+  {
+    levelPixels[i].x() = clampValue(clampValue(pixels[i].x(), 0, fullSpec.width - 1) / levelScale, 0, levelSpec.width - 1);
+    levelPixels[i].y() = clampValue(clampValue(pixels[i].y(), 0, fullSpec.height - 1) / levelScale, 0, levelSpec.height - 1);
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+  {
+    const int rowA = levelPixels[a].y() / rowHeight;
+    const int rowB = levelPixels[b].y() / rowHeight;
+    return rowA < rowB || (rowA == rowB && levelPixels[a].x() / columnWidth < levelPixels[b].x() / columnWidth);
+  });
+
+  // float RGB samples, converted as a single row image
+  oiio::ImageBuf samplesBuf(oiio::ImageSpec(int(pixels.size()), 1, 3, oiio::TypeDesc::FLOAT));
+  float* samples = static_cast<float*>(samplesBuf.localpixels());
+
+  const auto setSample = [&](std::size_t i, const float* pixel)
+  {
+    for(int c = 0; c < 3; ++c)
+      samples[3 * i + c] = pixel[(nchannels == 1) ? 0 : c];
+  };
+
+  if(levelSpec.tile_width > 0)
+  {
+    const int tileWidth = levelSpec.tile_width;
+    const int tileHeight = levelSpec.tile_height;
+    std::vector<float> tile(std::size_t(tileWidth) * tileHeight * nchannels);
+
+    for(std::size_t k = 0; k < order.size();)
+    {
+      const Vec2i& first = levelPixels[order[k]];
+      const int tx = (first.x() / tileWidth) * tileWidth;
+      const int ty = (first.y() / tileHeight) * tileHeight;
+
+      if(!in->read_tile(levelSpec.x + tx, levelSpec.y + ty, levelSpec.z, oiio::TypeDesc::FLOAT, tile.data()))
+        throw std::runtime_error("Can't read the tiles of image file '" + path + "'.");
+      addDecodedBytes(levelSpec, std::size_t(tileWidth) * tileHeight);
+
+      // all the pixels of this tile (read_tile uses the full tile size, even on the image border)
+      for(; k < order.size() && levelPixels[order[k]].x() / tileWidth == tx / tileWidth && levelPixels[order[k]].y() / tileHeight == ty / tileHeight; ++k)
+      {
+        const Vec2i& pixel = levelPixels[order[k]];
+        setSample(order[k], &tile[(std::size_t(pixel.y() - ty) * tileWidth + (pixel.x() - tx)) * nchannels]);
+      }
+    }
+  }
+  else
+  {
+    std::vector<float> row(std::size_t(levelSpec.width) * nchannels);
+    int lastRow = -1;
+
+    for(std::size_t k = 0; k < order.size();)
+    {
+      const int y = levelPixels[order[k]].y();
+
+      if(!in->read_scanline(levelSpec.y + y, levelSpec.z, oiio::TypeDesc::FLOAT, row.data()))
+        throw std::runtime_error("Can't read the scanlines of image file '" + path + "'.");
+      lastRow = y;
+
+      for(; k < order.size() && levelPixels[order[k]].y() == y; ++k)
+        setSample(order[k], &row[std::size_t(levelPixels[order[k]].x()) * nchannels]);
+    }
+
+    // the sequential scanline decoders (JPEG, PNG) decode all the scanlines up to the last one read
+    addDecodedBytes(levelSpec, std::size_t(levelSpec.width) * (lastRow + 1));
+  }
+
+  std::string colorSpace = levelSpec.get_string_attribute("oiio:ColorSpace", "sRGB"); // default image color space is sRGB
+#if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
+  // Workaround for bug in RAW colorspace management in previous versions of OIIO (see readImage)
+  if(colorSpace == "sRGB" && std::string(in->format_name()) == "raw")
+    colorSpace = "Linear";
+#endif
+
+  in->close();
+
+  // color conversion of the samples only
+  if(imageColorSpace == EImageColorSpace::SRGB && colorSpace != "sRGB")
+    oiio::ImageBufAlgo::colorconvert(samplesBuf, samplesBuf, colorSpace, "sRGB");
+  else if(imageColorSpace == EImageColorSpace::LINEAR && colorSpace != "Linear")
+    oiio::ImageBufAlgo::colorconvert(samplesBuf, samplesBuf, colorSpace, "Linear");
+
+  samplesBuf.get_pixels(samplesBuf.roi(), oiio::TypeDesc::UINT8, colors.data());
+}
+
+int getImageMipDownscale(const std::string& path, int downscale)
+{
+  const oiio::ImageSpec configSpec = getReadConfigSpec();
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path, &configSpec));
+
+  if(!in)
+    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+  oiio::ImageSpec levelSpec;
+  const int miplevel = seekMipLevel(path, *in, 0, std::max(1, downscale), levelSpec);
+  in->close();
+
+  return 1 << miplevel;
+}
+
 void writeImage(const std::string& path, const Image<unsigned char>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata)
 {
   writeImage(path, oiio::TypeDesc::UINT8, 1, image, imageColorSpace, metadata);
@@ -424,5 +836,170 @@ void writeImage(const std::string& path, const Image<RGBColor>& image, EImageCol
   writeImage(path, oiio::TypeDesc::UINT8, 3, image, imageColorSpace, metadata);
 }
 
+ImageRowsReader::ImageRowsReader(const std::string& path, EImageColorSpace imageColorSpace)
+  : _path(path)
+  , _imageColorSpace(imageColorSpace)
+{
+  if(imageColorSpace == EImageColorSpace::AUTO)
+    throw std::runtime_error("You must specify a requested color space for image file '" + path + "'.");
+
+  const oiio::ImageSpec configSpec = getReadConfigSpec();
+  _input = std::unique_ptr<oiio::ImageInput>(oiio::ImageInput::open(path, &configSpec));
+
+  if(!_input)
+    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+  ++nbImagesRead;
+
+  const oiio::ImageSpec& inSpec = _input->spec();
+  _width = inSpec.width;
+  _height = inSpec.height;
+  _nchannels = inSpec.nchannels;
+
+  // check picture channels number
+  if(_nchannels != 1 && _nchannels < 3)
+    throw std::runtime_error("Can't load channels of image file '" + path + "'.");
+
+  _fileColorSpace = inSpec.get_string_attribute("oiio:ColorSpace", "sRGB"); // default image color space is sRGB
+#if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
+  // Workaround for bug in RAW colorspace management in previous versions of OIIO (see readImage)
+  if(_fileColorSpace == "sRGB" && std::string(_input->format_name()) == "raw")
+    _fileColorSpace = "Linear";
+#endif
+  ALICEVISION_LOG_TRACE("Read image " << path << " by rows (encoded in " << _fileColorSpace << " colorspace).");
+}
+
+ImageRowsReader::~ImageRowsReader()
+{
+  if(_input)
+    _input->close();
+}
+
+void ImageRowsReader::read(int yBegin, int yEnd, RGBfColor* data)
+{
+  assert(0 <= yBegin && yBegin <= yEnd && yEnd <= _height);
+  const int nbRows = yEnd - yBegin;
+  if(nbRows == 0)
+    return;
+
+  // read the 3 first channels, or the single channel in the red channel
+  const int chend = std::min(_nchannels, 3);
+  if(!_input->read_scanlines(yBegin, yEnd, 0, 0, chend, oiio::TypeDesc::FLOAT, data, sizeof(RGBfColor)))
+    throw std::runtime_error("Can't read rows [" + std::to_string(yBegin) + ", " + std::to_string(yEnd) + ") of image file '" + _path + "'.");
+
+  addDecodedBytes(_input->spec(), std::size_t(_width) * nbRows);
+
+  oiio::ImageSpec bandSpec(_width, nbRows, 3, oiio::TypeDesc::FLOAT);
+  oiio::ImageBuf bandBuf(bandSpec, data);
+
+  // duplicate first channel for RGB
+  if(chend == 1)
+  {
+    const std::size_t nbPixels = std::size_t(_width) * nbRows;
+    for(std::size_t i = 0; i < nbPixels; ++i)
+      data[i] = RGBfColor(data[i].r());
+  }
+
+  // color conversion
+  if(_imageColorSpace == EImageColorSpace::SRGB && _fileColorSpace != "sRGB")
+    oiio::ImageBufAlgo::colorconvert(bandBuf, bandBuf, _fileColorSpace, "sRGB");
+  else if(_imageColorSpace == EImageColorSpace::LINEAR && _fileColorSpace != "Linear")
+    oiio::ImageBufAlgo::colorconvert(bandBuf, bandBuf, _fileColorSpace, "Linear");
+}
+
+ImageRowsWriter::ImageRowsWriter(const std::string& path, int width, int height, EImageColorSpace imageColorSpace,
+                                 const oiio::ParamValueList& metadata, int tileSize)
+  : _path(path)
+  , _imageColorSpace(imageColorSpace)
+  , _width(width)
+  , _height(height)
+{
+  const fs::path bPath = fs::path(path);
+  const std::string extension = bPath.extension().string();
+  _tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + extension;
+  const bool isEXR = (extension == ".exr");
+  const bool isJPG = (extension == ".jpg");
+  const bool isPNG = (extension == ".png");
+
+  if(_imageColorSpace == EImageColorSpace::AUTO)
+    _imageColorSpace = (isJPG || isPNG) ? EImageColorSpace::SRGB : EImageColorSpace::LINEAR;
+
+  _output = std::unique_ptr<oiio::ImageOutput>(oiio::ImageOutput::create(_tmpPath));
+  if(!_output)
+    throw std::runtime_error("Can't create output image file '" + path + "'.");
+
+  // same settings as writeImage, half instead of float for EXR
+  oiio::ImageSpec imageSpec(width, height, 3, isEXR ? oiio::TypeDesc::HALF : oiio::TypeDesc::FLOAT);
+  imageSpec.extra_attribs = metadata; // add custom metadata
+  imageSpec.attribute("jpeg:subsampling", "4:4:4");
+  imageSpec.attribute("CompressionQuality", 100);
+  imageSpec.attribute("compression", isEXR ? "piz" : "none");
+
+  if(tileSize > 0 && _output->supports("tiles"))
+  {
+    _tileSize = tileSize;
+    imageSpec.tile_width = tileSize;
+    imageSpec.tile_height = tileSize;
+    imageSpec.tile_depth = 1;
+  }
+
+  if(!_output->open(_tmpPath, imageSpec))
+    throw std::runtime_error("Can't open output image file '" + path + "'.");
+}
+
+ImageRowsWriter::~ImageRowsWriter()
+{
+  if(_output)
+  {
+    // not closed properly: remove the temporary file
+    _output->close();
+    _output.reset();
+    fs::remove(_tmpPath);
+  }
+}
+
+void ImageRowsWriter::write(int yBegin, int yEnd, const RGBfColor* data)
+{
+  assert(0 <= yBegin && yBegin <= yEnd && yEnd <= _height);
+  const int nbRows = yEnd - yBegin;
+  if(nbRows == 0)
+    return;
+
+  std::vector<RGBfColor> converted;
+  if(_imageColorSpace == EImageColorSpace::SRGB)
+  {
+    converted.assign(data, data + std::size_t(_width) * nbRows);
+    oiio::ImageSpec bandSpec(_width, nbRows, 3, oiio::TypeDesc::FLOAT);
+    oiio::ImageBuf bandBuf(bandSpec, converted.data());
+    oiio::ImageBufAlgo::colorconvert(bandBuf, bandBuf, "Linear", "sRGB");
+    data = converted.data();
+  }
+
+  bool success;
+  if(_tileSize > 0)
+  {
+    if(yBegin % _tileSize != 0 || (yEnd % _tileSize != 0 && yEnd != _height))
+      throw std::invalid_argument("Rows [" + std::to_string(yBegin) + ", " + std::to_string(yEnd) + ") are not aligned on tiles of image file '" + _path + "'.");
+    success = _output->write_tiles(0, _width, yBegin, yEnd, 0, 1, oiio::TypeDesc::FLOAT, data);
+  }
+  else
+  {
+    success = _output->write_scanlines(yBegin, yEnd, 0, oiio::TypeDesc::FLOAT, data);
+  }
+
+  if(!success)
+    throw std::runtime_error("Can't write rows [" + std::to_string(yBegin) + ", " + std::to_string(yEnd) + ") of image file '" + _path + "'.");
+}
+
+void ImageRowsWriter::close()
+{
+  if(!_output->close())
+    throw std::runtime_error("Can't write output image file '" + _path + "'.");
+  _output.reset();
+
+  // rename temporay filename
+  fs::rename(_tmpPath, _path);
+}
+
 }  // namespace image
 }  // namespace aliceVision
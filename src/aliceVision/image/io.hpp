@@ -14,7 +14,9 @@
 #include <OpenImageIO/imagebuf.h>
 
 #include <boost/algorithm/string.hpp>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace oiio = OIIO;
 
@@ -143,6 +145,84 @@ void readImage(const std::string& path, Image<RGBAColor>& image, EImageColorSpac
 void readImage(const std::string& path, Image<RGBfColor>& image, EImageColorSpace imageColorSpace);
 void readImage(const std::string& path, Image<RGBColor>& image, EImageColorSpace imageColorSpace);
 
+/**
+ * @brief Part of an image to read: region of interest, resolution and subimage
+ */
+struct ImageReadOptions
+{
+  /// region of interest in the full resolution image (a zero size extends the region to the image border)
+  int roiX = 0;
+  int roiY = 0;
+  int roiWidth = 0;
+  int roiHeight = 0;
+  /// downscale factor of the output image, the MIP levels of the file are used when available
+  int downscale = 1;
+  /// subimage index (multi-part files)
+  int subimage = 0;
+
+  bool isFullImage() const
+  {
+    return roiX == 0 && roiY == 0 && roiWidth <= 0 && roiHeight <= 0 && downscale <= 1 && subimage == 0;
+  }
+};
+
+/**
+ * @brief read a part of an image with a given path and buffer
+ * Only the scanlines (or the tiles) covering the region of interest are decoded.
+ * @param[in] path The given path to the image
+ * @param[out] image The output image buffer, of the size of the region divided by the downscale
+ * @param[in] image color space
+ * @param[in] options The region of interest, downscale and subimage to read
+ */
+void readImage(const std::string& path, Image<float>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options);
+void readImage(const std::string& path, Image<unsigned char>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options);
+void readImage(const std::string& path, Image<RGBAfColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options);
+void readImage(const std::string& path, Image<RGBAColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options);
+void readImage(const std::string& path, Image<RGBfColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options);
+void readImage(const std::string& path, Image<RGBColor>& image, EImageColorSpace imageColorSpace, const ImageReadOptions& options);
+
+/**
+ * @brief read the color of a set of pixels of an image
+ * The file is read in a single pass and only the scanlines (or the tiles) containing the pixels are decoded.
+ * @param[in] path The given path to the image
+ * @param[in] pixels The pixel positions (x, y) in the full resolution image, clamped to the image
+ * @param[out] colors The color of each pixel
+ * @param[in] imageColorSpace The output color space
+ * @param[in] downscale Sample the pixels in the MIP level of this downscale factor (or the closest larger level) if the file has MIP levels
+ */
+void readImagePixels(const std::string& path, const std::vector<Vec2i>& pixels, std::vector<RGBColor>& colors,
+                     EImageColorSpace imageColorSpace, int downscale = 1);
+
+/**
+ * @brief Get the downscale factor of the MIP level of an image read for a requested downscale
+ * The MIP levels (if any) are successive halvings of the image, only the file header is read.
+ * @param[in] path The given path to the image
+ * @param[in] downscale The requested downscale factor
+ * @return the largest MIP level downscale not greater than the requested one, 1 if the file has no MIP level
+ */
+int getImageMipDownscale(const std::string& path, int downscale);
+
+/**
+ * @brief Statistics of the image reads of the process
+ */
+struct ImageReadStats
+{
+  /// number of image files read
+  std::size_t nbReads = 0;
+  /// number of bytes decoded from the image files (in the file pixel format), including the scanlines decoded before a region
+  std::size_t decodedBytes = 0;
+};
+
+/**
+ * @brief get the statistics of the image reads since the start of the process or the last reset
+ */
+ImageReadStats getImageReadStats();
+
+/**
+ * @brief reset the statistics of the image reads
+ */
+void resetImageReadStats();
+
 /**
  * @brief write an image with a given path and buffer
  * @param[in] path The given path to the image
@@ -155,5 +235,83 @@ void writeImage(const std::string& path, const Image<RGBAColor>& image, EImageCo
 void writeImage(const std::string& path, const Image<RGBfColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 void writeImage(const std::string& path, const Image<RGBColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 
+/**
+ * @brief Read an RGB image band by band (ranges of rows), without loading the full image in memory.
+ * Rows should be read in increasing order: depending on the file format, going back requires to decode the image again.
+ */
+class ImageRowsReader
+{
+public:
+  /**
+   * @param[in] path The given path to the image
+   * @param[in] imageColorSpace The color space of the read rows
+   */
+  ImageRowsReader(const std::string& path, EImageColorSpace imageColorSpace);
+  ~ImageRowsReader();
+
+  int width() const { return _width; }
+  int height() const { return _height; }
+
+  /**
+   * @brief Read the rows [yBegin, yEnd) of the image
+   * @param[in] yBegin First row
+   * @param[in] yEnd Last row (excluded)
+   * @param[out] data Output buffer of (yEnd - yBegin) * width pixels
+   */
+  void read(int yBegin, int yEnd, RGBfColor* data);
+
+private:
+  std::unique_ptr<oiio::ImageInput> _input;
+  std::string _path;
+  std::string _fileColorSpace;
+  EImageColorSpace _imageColorSpace;
+  int _width = 0;
+  int _height = 0;
+  int _nchannels = 0;
+};
+
+/**
+ * @brief Write an RGB image band by band (ranges of rows), without storing the full image in memory.
+ * The image is written in a temporary file renamed by close().
+ */
+class ImageRowsWriter
+{
+public:
+  /**
+   * @param[in] path The given path to the image
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] imageColorSpace The output color space (the written rows are linear)
+   * @param[in] metadata The image metadata
+   * @param[in] tileSize The tile size if the file format supports tiles (0 for scanlines),
+   *            the rows must then be written by bands of a multiple of the tile size
+   */
+  ImageRowsWriter(const std::string& path, int width, int height, EImageColorSpace imageColorSpace,
+                  const oiio::ParamValueList& metadata = oiio::ParamValueList(), int tileSize = 0);
+  ~ImageRowsWriter();
+
+  /**
+   * @brief Write the rows [yBegin, yEnd) of the image, rows must be written in increasing order
+   * @param[in] yBegin First row
+   * @param[in] yEnd Last row (excluded)
+   * @param[in] data Buffer of (yEnd - yBegin) * width pixels
+   */
+  void write(int yBegin, int yEnd, const RGBfColor* data);
+
+  /**
+   * @brief Close the image file and move it to its final path
+   */
+  void close();
+
+private:
+  std::unique_ptr<oiio::ImageOutput> _output;
+  std::string _path;
+  std::string _tmpPath;
+  EImageColorSpace _imageColorSpace;
+  int _width = 0;
+  int _height = 0;
+  int _tileSize = 0;
+};
+
 }  // namespace image
 }  // namespace aliceVision
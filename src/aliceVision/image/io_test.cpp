@@ -12,8 +12,10 @@
 #include <boost/test/included/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 
+#include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -257,3 +259,164 @@ BOOST_AUTO_TEST_CASE(read_write_from_grayscale_to_rgb) {
     remove(filename.c_str());
   }
 }
+
+BOOST_AUTO_TEST_CASE(read_region) {
+  const int width = 64;
+  const int height = 48;
+  Image<RGBColor> image(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = RGBColor(x * 4, y * 5, (x + y) % 256);
+
+  // lossless extensions
+  for(const std::string extension : {"png", "ppm", "tiff", "exr"})
+  {
+    const std::string filename = "test_read_region." + extension;
+    BOOST_CHECK_NO_THROW(writeImage(filename, image, image::EImageColorSpace::NO_CONVERSION));
+
+    ImageReadOptions options;
+    options.roiX = 10;
+    options.roiY = 7;
+    options.roiWidth = 21;
+    options.roiHeight = 13;
+
+    Image<RGBColor> region;
+    BOOST_CHECK_NO_THROW(readImage(filename, region, image::EImageColorSpace::NO_CONVERSION, options));
+    BOOST_CHECK_EQUAL(region.Width(), options.roiWidth);
+    BOOST_CHECK_EQUAL(region.Height(), options.roiHeight);
+    for(int y = 0; y < region.Height(); ++y)
+      for(int x = 0; x < region.Width(); ++x)
+        BOOST_CHECK_EQUAL(region(y, x), image(y + options.roiY, x + options.roiX));
+
+    // region clamped to the image border
+    options.roiWidth = 2 * width;
+    options.roiHeight = 0;
+    BOOST_CHECK_NO_THROW(readImage(filename, region, image::EImageColorSpace::NO_CONVERSION, options));
+    BOOST_CHECK_EQUAL(region.Width(), width - options.roiX);
+    BOOST_CHECK_EQUAL(region.Height(), height - options.roiY);
+    BOOST_CHECK_EQUAL(region(region.Height() - 1, region.Width() - 1), image(height - 1, width - 1));
+
+    // reduced resolution
+    ImageReadOptions downscaleOptions;
+    downscaleOptions.downscale = 2;
+    Image<RGBColor> reduced;
+    BOOST_CHECK_NO_THROW(readImage(filename, reduced, image::EImageColorSpace::NO_CONVERSION, downscaleOptions));
+    BOOST_CHECK_EQUAL(reduced.Width(), width / 2);
+    BOOST_CHECK_EQUAL(reduced.Height(), height / 2);
+
+    remove(filename.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(read_mipLevelDownscale) {
+  const int width = 64;
+  const int height = 48;
+  Image<RGBColor> image(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = RGBColor(x * 4, y * 5, (x + y) % 256);
+
+  // without MIP level: the full resolution image is read unchanged
+  {
+    const std::string filename = "test_read_mipLevelDownscale.png";
+    BOOST_CHECK_NO_THROW(writeImage(filename, image, image::EImageColorSpace::NO_CONVERSION));
+    BOOST_CHECK_EQUAL(getImageMipDownscale(filename, 4), 1);
+
+    ImageReadOptions options;
+    options.downscale = getImageMipDownscale(filename, 4);
+    Image<RGBColor> read;
+    BOOST_CHECK_NO_THROW(readImage(filename, read, image::EImageColorSpace::NO_CONVERSION, options));
+    BOOST_CHECK(read == image);
+
+    remove(filename.c_str());
+  }
+
+  // with MIP levels: 64x48, 32x24, 16x12
+  {
+    const std::string filename = "test_read_mipLevelDownscale.exr";
+    std::unique_ptr<oiio::ImageOutput> out(oiio::ImageOutput::create(filename));
+    BOOST_REQUIRE(out && out->supports("mipmap"));
+
+    oiio::ImageSpec spec(width, height, 3, oiio::TypeDesc::UINT8);
+    spec.tile_width = spec.tile_height = 16;
+    BOOST_CHECK(out->open(filename, spec, oiio::ImageOutput::Create));
+    BOOST_CHECK(out->write_image(oiio::TypeDesc::UINT8, image.data()));
+
+    for(int level = 1; level < 3; ++level)
+    {
+      Image<RGBColor> levelImage(width >> level, height >> level);
+      for(int y = 0; y < levelImage.Height(); ++y)
+        for(int x = 0; x < levelImage.Width(); ++x)
+          levelImage(y, x) = image(y << level, x << level);
+
+      spec.width = spec.full_width = levelImage.Width();
+      spec.height = spec.full_height = levelImage.Height();
+      BOOST_CHECK(out->open(filename, spec, oiio::ImageOutput::AppendMIPLevel));
+      BOOST_CHECK(out->write_image(oiio::TypeDesc::UINT8, levelImage.data()));
+    }
+    out->close();
+
+    BOOST_CHECK_EQUAL(getImageMipDownscale(filename, 1), 1);
+    BOOST_CHECK_EQUAL(getImageMipDownscale(filename, 3), 2);
+    BOOST_CHECK_EQUAL(getImageMipDownscale(filename, 4), 4);
+    BOOST_CHECK_EQUAL(getImageMipDownscale(filename, 16), 4);
+
+    ImageReadOptions options;
+    options.downscale = getImageMipDownscale(filename, 4);
+    Image<RGBColor> read;
+    BOOST_CHECK_NO_THROW(readImage(filename, read, image::EImageColorSpace::NO_CONVERSION, options));
+    BOOST_CHECK_EQUAL(read.Width(), width / 4);
+    BOOST_CHECK_EQUAL(read.Height(), height / 4);
+    BOOST_CHECK_EQUAL(read(1, 1), image(4, 4));
+
+    remove(filename.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(read_region_decodedBytes) {
+  const int width = 2048;
+  const int height = 1536;
+  const int nbReads = 10;
+  Image<RGBColor> image(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = RGBColor(x % 256, y % 256, (x ^ y) % 256);
+
+  const std::string filename = "test_read_region_decodedBytes.tiff";
+  BOOST_CHECK_NO_THROW(writeImage(filename, image, image::EImageColorSpace::NO_CONVERSION));
+
+  ImageReadOptions options;
+  options.roiX = 900;
+  options.roiY = 700;
+  options.roiWidth = 256;
+  options.roiHeight = 128;
+
+  Image<RGBColor> full, region;
+
+  resetImageReadStats();
+  const auto startFull = std::chrono::steady_clock::now();
+  for(int i = 0; i < nbReads; ++i)
+    readImage(filename, full, image::EImageColorSpace::NO_CONVERSION);
+  const auto startRegion = std::chrono::steady_clock::now();
+  const ImageReadStats fullStats = getImageReadStats();
+
+  resetImageReadStats();
+  for(int i = 0; i < nbReads; ++i)
+    readImage(filename, region, image::EImageColorSpace::NO_CONVERSION, options);
+  const auto end = std::chrono::steady_clock::now();
+  const ImageReadStats regionStats = getImageReadStats();
+
+  remove(filename.c_str());
+
+  BOOST_CHECK_EQUAL(fullStats.nbReads, nbReads);
+  BOOST_CHECK_EQUAL(regionStats.nbReads, nbReads);
+  BOOST_CHECK_EQUAL(fullStats.decodedBytes, std::size_t(nbReads) * width * height * 3);
+  BOOST_CHECK_LT(regionStats.decodedBytes, fullStats.decodedBytes);
+  BOOST_CHECK(region == full.block(options.roiY, options.roiX, options.roiHeight, options.roiWidth));
+
+  const double fullMs = std::chrono::duration<double, std::milli>(startRegion - startFull).count() / nbReads;
+  const double regionMs = std::chrono::duration<double, std::milli>(end - startRegion).count() / nbReads;
+  BOOST_TEST_MESSAGE("Read of a " << options.roiWidth << "x" << options.roiHeight << " region of a " << width << "x" << height << " image: "
+                     << regionStats.decodedBytes / nbReads << " bytes decoded in " << regionMs << " ms, "
+                     << fullStats.decodedBytes / nbReads << " bytes decoded in " << fullMs << " ms for the full image");
+}
@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <deque>
+#include <mutex>
+#include <utility>
 #include <assert.h>
 
 namespace aliceVision {
@@ -86,9 +89,97 @@ public:
     {
       _buffer.pop_front();
     }
-    _buffer.emplace_back(args...);
+    _buffer.emplace_back(std::forward<Args>(args)...);
   }
 
+  /**
+   * @brief Returns the first (oldest) element of the buffer.
+   *
+   * @return the first element of the buffer.
+   */
+  T& front() { return _buffer.front(); }
+
+  /**
+   * @brief Remove the first (oldest) element of the buffer.
+   */
+  void pop_front() { _buffer.pop_front(); }
+
+  std::size_t size() const { return _buffer.size(); }
+
+  bool empty() const { return _buffer.empty(); }
+
+  bool full() const { return _buffer.size() == _maxSize; }
+
+};
+
+/**
+ * @brief This class implements a thread-safe bounded buffer to connect the stages
+ * of a pipeline (one or several producers and consumers). Unlike BoundedBuffer, 
+ * pushing a new element into a full buffer waits for an element to be popped 
+ * instead of dropping the oldest one, so no element is lost.
+ */
+template<class T>
+class ConcurrentBoundedBuffer
+{
+public:
+
+  /**
+   * @brief Build a concurrent bounded buffer of the given size.
+   * @param[in] maxSize The maximum number of elements waiting in the buffer (at least 1).
+   */
+  ConcurrentBoundedBuffer(std::size_t maxSize) : _buffer(maxSize) { assert(maxSize > 0); }
+
+  /**
+   * @brief Append an element at the end of the buffer, it waits while the buffer is full.
+   * @param[in] value The element to add.
+   * @return false if the buffer has been closed, the element is then not added.
+   */
+  bool push(T&& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]{ return _closed || !_buffer.full(); });
+    if(_closed)
+      return false;
+    _buffer.emplace_back(std::move(value));
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the first element of the buffer, it waits while the buffer is empty.
+   * @param[out] value The removed element.
+   * @return false if the buffer is empty and has been closed.
+   */
+  bool pop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]{ return _closed || !_buffer.empty(); });
+    if(_buffer.empty())
+      return false;
+    value = std::move(_buffer.front());
+    _buffer.pop_front();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Close the buffer: no element can be pushed anymore and the consumers
+   * stop once the remaining elements have been popped.
+   */
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _closed = true;
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+  }
+
+private:
+  BoundedBuffer<T> _buffer;
+  std::mutex _mutex;
+  std::condition_variable _notEmpty;
+  std::condition_variable _notFull;
+  bool _closed = false;
 };
 
 }
@@ -0,0 +1,71 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/localization/BoundedBuffer.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE BoundedBuffer
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+
+BOOST_AUTO_TEST_CASE(BoundedBuffer_fifo)
+{
+  localization::BoundedBuffer<int> buffer(3);
+  BOOST_CHECK(buffer.empty());
+
+  for(int i = 0; i < 5; ++i)
+    buffer.emplace_back(i);
+
+  // the oldest elements are dropped
+  BOOST_CHECK(buffer.full());
+  BOOST_CHECK_EQUAL(buffer.size(), 3);
+  BOOST_CHECK_EQUAL(buffer.front(), 2);
+  buffer.pop_front();
+  BOOST_CHECK_EQUAL(buffer.front(), 3);
+  BOOST_CHECK_EQUAL(buffer.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentBoundedBuffer_producerConsumer)
+{
+  const int nbElements = 1000;
+  localization::ConcurrentBoundedBuffer<std::unique_ptr<int>> buffer(2);
+
+  std::thread producer([&]()
+  {
+    for(int i = 0; i < nbElements; ++i)
+      buffer.push(std::unique_ptr<int>(new int(i)));
+    buffer.close();
+  });
+
+  std::vector<int> received;
+  std::unique_ptr<int> value;
+  while(buffer.pop(value))
+    received.push_back(*value);
+  producer.join();
+
+  // all the elements are received in order
+  BOOST_REQUIRE_EQUAL(received.size(), nbElements);
+  for(int i = 0; i < nbElements; ++i)
+    BOOST_CHECK_EQUAL(received[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentBoundedBuffer_close)
+{
+  localization::ConcurrentBoundedBuffer<int> buffer(1);
+  BOOST_CHECK(buffer.push(1));
+  buffer.close();
+
+  // no element is added once closed, the remaining ones can still be read
+  BOOST_CHECK(!buffer.push(2));
+  int value = 0;
+  BOOST_CHECK(buffer.pop(value));
+  BOOST_CHECK_EQUAL(value, 1);
+  BOOST_CHECK(!buffer.pop(value));
+}
@@ -192,12 +192,10 @@ bool CCTagLocalizer::loadReconstructionDescriptors(const sfmData::SfMData & sfm_
   return true;
 }
 
-bool CCTagLocalizer::localize(const image::Image<float> & imageGrey,
-                              const LocalizerParameters *parameters,
-                              bool useInputIntrinsics,
-                              camera::PinholeRadialK3 &queryIntrinsics,
-                              LocalizationResult & localizationResult, 
-                              const std::string& imagePath)
+void CCTagLocalizer::extractRegions(const image::Image<float> & imageGrey,
+                                    const LocalizerParameters *parameters,
+                                    feature::MapRegionsPerDesc & queryRegions,
+                                    const std::string& imagePath)
 {
   namespace bfs = boost::filesystem;
   
@@ -212,19 +210,19 @@ bool CCTagLocalizer::localize(const image::Image<float> & imageGrey,
   image::Image<unsigned char> imageGrayUChar; // cctag image describer don't support float image
   imageGrayUChar = (imageGrey.GetMat() * 255.f).cast<unsigned char>();
 
-  feature::MapRegionsPerDesc tmpQueryRegions;
-
-  _imageDescriber.setCudaPipe( _cudaPipe );
-  _imageDescriber.setConfigurationPreset(param->_featurePreset);
-  _imageDescriber.describe(imageGrayUChar, tmpQueryRegions[_cctagDescType]);
-  ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " << tmpQueryRegions.at(_cctagDescType)->RegionCount() << " features");
-  
-  std::pair<std::size_t, std::size_t> imageSize = std::make_pair(imageGrey.Width(),imageGrey.Height());
+  // local describer: the extraction can run while another frame is localized
+  feature::ImageDescriber_CCTAG imageDescriber;
+  imageDescriber.setCudaPipe( _cudaPipe );
+  imageDescriber.setConfigurationPreset(param->_featurePreset);
+  imageDescriber.describe(imageGrayUChar, queryRegions[_cctagDescType]);
+  ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " << queryRegions.at(_cctagDescType)->RegionCount() << " features");
   
   if(!param->_visualDebug.empty() && !imagePath.empty())
   {
+    const std::pair<std::size_t, std::size_t> imageSize = std::make_pair(imageGrey.Width(),imageGrey.Height());
+
     // it automatically throws an exception if the cast does not work
-    const feature::CCTAG_Regions & cctagQueryRegions = tmpQueryRegions.getRegions<feature::CCTAG_Regions>(_cctagDescType);
+    const feature::CCTAG_Regions & cctagQueryRegions = queryRegions.getRegions<feature::CCTAG_Regions>(_cctagDescType);
     
     // just debugging -- save the svg image with detected cctag
     feature::saveCCTag2SVG(imagePath, 
@@ -232,6 +230,20 @@ bool CCTagLocalizer::localize(const image::Image<float> & imageGrey,
                             cctagQueryRegions,
                             param->_visualDebug+"/"+bfs::path(imagePath).stem().string()+".svg");
   }
+}
+
+bool CCTagLocalizer::localize(const image::Image<float> & imageGrey,
+                              const LocalizerParameters *parameters,
+                              bool useInputIntrinsics,
+                              camera::PinholeRadialK3 &queryIntrinsics,
+                              LocalizationResult & localizationResult, 
+                              const std::string& imagePath)
+{
+  feature::MapRegionsPerDesc tmpQueryRegions;
+  extractRegions(imageGrey, parameters, tmpQueryRegions, imagePath);
+
+  const std::pair<std::size_t, std::size_t> imageSize = std::make_pair(imageGrey.Width(),imageGrey.Height());
+
   return localize(tmpQueryRegions,
                   imageSize,
                   parameters,
@@ -47,6 +47,11 @@ public:
    
   void setCudaPipe(int i) override;
 
+  void extractRegions(const image::Image<float> & imageGrey,
+                      const LocalizerParameters *param,
+                      feature::MapRegionsPerDesc & queryRegions,
+                      const std::string& imagePath = std::string()) override;
+
  /**
    * @brief Just a wrapper around the different localization algorithm, the algorith
    * used to localized is chosen using \p param._algorithm
@@ -69,6 +69,21 @@ public:
     
     const sfmData::SfMData& getSfMData() const {return _sfm_data; }
     
+  /**
+   * @brief Extract the query regions of one image, as done by localize() on images.
+   * It does not modify the localization database and can run while a previous
+   * frame is localized from its regions.
+   *
+   * @param[in] imageGrey The input greyscale image.
+   * @param[in] param The parameters for the localization.
+   * @param[out] queryRegions The extracted regions per describer type.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   */
+  virtual void extractRegions(const image::Image<float> & imageGrey,
+                              const LocalizerParameters *param,
+                              feature::MapRegionsPerDesc & queryRegions,
+                              const std::string& imagePath = std::string()) = 0;
+
     /**
    * @brief Localize one image
    * 
@@ -0,0 +1,461 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarkDescriptorIndex.hpp"
+#include <aliceVision/matching/Hamming.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+namespace aliceVision {
+namespace localization {
+
+namespace {
+
+const char indexFileMagic[4] = {'A', 'V', 'L', 'I'};
+const std::uint32_t indexFileVersion = 2;
+
+typedef Eigen::Matrix<unsigned char, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> DescriptorsMatrix;
+typedef Eigen::Map<const DescriptorsMatrix> DescriptorsMap;
+
+bool isIndexable(const feature::Regions& regions)
+{
+  // the cascade hashing projection is a square matrix of the descriptor length stored on 8 bits
+  return regions.IsScalar() &&
+         regions.DescriptorLength() <= std::numeric_limits<std::uint8_t>::max() &&
+         (regions.Type_id() == typeid(unsigned char).name() || regions.Type_id() == typeid(float).name());
+}
+
+/**
+ * @brief Add the i-th descriptor of the regions to an accumulator
+ */
+void accumulateDescriptor(const feature::Regions& regions, std::size_t i, float* accumulator)
+{
+  const std::size_t length = regions.DescriptorLength();
+  if(regions.Type_id() == typeid(unsigned char).name())
+  {
+    const unsigned char* desc = static_cast<const unsigned char*>(regions.DescriptorRawData()) + i * length;
+    for(std::size_t d = 0; d < length; ++d)
+      accumulator[d] += desc[d];
+  }
+  else
+  {
+    const float* desc = static_cast<const float*>(regions.DescriptorRawData()) + i * length;
+    for(std::size_t d = 0; d < length; ++d)
+      accumulator[d] += desc[d];
+  }
+}
+
+inline unsigned char quantize(float value, float offset, float scale)
+{
+  return static_cast<unsigned char>(std::max(0.f, std::min(255.f, std::round((value - offset) * scale))));
+}
+
+/**
+ * @brief Squared L2 distance between a full precision descriptor and a quantized one
+ */
+inline float squaredDistance(const float* desc, const unsigned char* quantized, std::size_t length, float offset, float scale)
+{
+  const float invScale = 1.f / scale;
+  float distance = 0.f;
+  for(std::size_t d = 0; d < length; ++d)
+  {
+    const float diff = desc[d] - (offset + quantized[d] * invScale);
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+template<typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+void readValue(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template<typename T>
+void writeVector(std::ostream& stream, const std::vector<T>& values)
+{
+  stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template<typename T>
+void readVector(std::istream& stream, std::vector<T>& values, std::size_t size)
+{
+  values.resize(size);
+  stream.read(reinterpret_cast<char*>(values.data()), size * sizeof(T));
+}
+
+} // namespace
+
+void LandmarkDescriptorIndex::build(const sfmData::SfMData& sfmData,
+                                    const feature::RegionsPerView& regionsPerView,
+                                    const ReconstructedRegionsMappingPerView& mappingPerView,
+                                    std::size_t maxLandmarks)
+{
+  _indexPerDesc.clear();
+
+  // landmarks of each describer type with indexable regions
+  std::map<feature::EImageDescriberType, std::vector<IndexT>> landmarksPerDesc;
+  std::map<feature::EImageDescriberType, std::size_t> descLengthPerDesc;
+
+  for(const auto& regionsPerViewIt : regionsPerView.getData())
+  {
+    for(const auto& regionsIt : regionsPerViewIt.second)
+    {
+      if(regionsIt.second && isIndexable(*regionsIt.second))
+        descLengthPerDesc.emplace(regionsIt.first, regionsIt.second->DescriptorLength());
+    }
+  }
+
+  for(const auto& landmarkIt : sfmData.getLandmarks())
+  {
+    if(descLengthPerDesc.count(landmarkIt.second.descType))
+      landmarksPerDesc[landmarkIt.second.descType].push_back(landmarkIt.first);
+  }
+
+  for(auto& landmarksIt : landmarksPerDesc)
+  {
+    const feature::EImageDescriberType descType = landmarksIt.first;
+    std::vector<IndexT>& landmarkIds = landmarksIt.second;
+    const std::size_t descLength = descLengthPerDesc.at(descType);
+
+    // visibility-based prioritization: most observed landmarks first
+    std::stable_sort(landmarkIds.begin(), landmarkIds.end(), [&](IndexT a, IndexT b)
+    {
+      return sfmData.getLandmarks().at(a).observations.size() > sfmData.getLandmarks().at(b).observations.size();
+    });
+
+    // mean descriptor of each landmark
+    Eigen::MatrixXf meanDescriptors = Eigen::MatrixXf::Zero(descLength, landmarkIds.size());
+    std::vector<IndexT> nbDescriptors(landmarkIds.size(), 0);
+
+    #pragma omp parallel for
+    for(int l = 0; l < static_cast<int>(landmarkIds.size()); ++l)
+    {
+      const sfmData::Landmark& landmark = sfmData.getLandmarks().at(landmarkIds[l]);
+      float* accumulator = meanDescriptors.col(l).data();
+
+      for(const auto& observationIt : landmark.observations)
+      {
+        const auto regionsPerDescIt = regionsPerView.getData().find(observationIt.first);
+        const auto mappingPerDescIt = mappingPerView.find(observationIt.first);
+        if(regionsPerDescIt == regionsPerView.getData().end() || mappingPerDescIt == mappingPerView.end())
+          continue;
+
+        const auto regionsIt = regionsPerDescIt->second.find(descType);
+        const auto mappingIt = mappingPerDescIt->second.find(descType);
+        if(regionsIt == regionsPerDescIt->second.end() || mappingIt == mappingPerDescIt->second.end())
+          continue;
+
+        const auto localIt = mappingIt->second._mapFullToLocal.find(observationIt.second.id_feat);
+        if(localIt == mappingIt->second._mapFullToLocal.end())
+          continue;
+
+        accumulateDescriptor(*regionsIt->second, localIt->second, accumulator);
+        ++nbDescriptors[l];
+      }
+
+      if(nbDescriptors[l] > 0)
+        meanDescriptors.col(l) /= static_cast<float>(nbDescriptors[l]);
+    }
+
+    DescIndex& index = _indexPerDesc[descType];
+    index.descLength = descLength;
+
+    std::vector<std::size_t> kept;
+    kept.reserve(landmarkIds.size());
+    for(std::size_t l = 0; l < landmarkIds.size() && (maxLandmarks == 0 || kept.size() < maxLandmarks); ++l)
+    {
+      if(nbDescriptors[l] > 0)
+        kept.push_back(l);
+    }
+
+    // scalar quantization on 8 bits, the same scale for all the dimensions keeps the L2 metric isotropic
+    if(!kept.empty())
+    {
+      float minValue = std::numeric_limits<float>::max();
+      float maxValue = std::numeric_limits<float>::lowest();
+      for(const std::size_t l : kept)
+      {
+        minValue = std::min(minValue, meanDescriptors.col(l).minCoeff());
+        maxValue = std::max(maxValue, meanDescriptors.col(l).maxCoeff());
+      }
+      index.offset = minValue;
+      if(maxValue > minValue)
+        index.scale = 255.f / (maxValue - minValue);
+    }
+
+    index.landmarkIds.reserve(kept.size());
+    index.visibility.reserve(kept.size());
+    index.descriptors.resize(kept.size() * descLength);
+    for(std::size_t k = 0; k < kept.size(); ++k)
+    {
+      const std::size_t l = kept[k];
+      index.landmarkIds.push_back(landmarkIds[l]);
+      index.visibility.push_back(static_cast<IndexT>(sfmData.getLandmarks().at(landmarkIds[l]).observations.size()));
+      for(std::size_t d = 0; d < descLength; ++d)
+        index.descriptors[k * descLength + d] = quantize(meanDescriptors(d, l), index.offset, index.scale);
+    }
+
+    initSearch(index);
+
+    ALICEVISION_LOG_INFO("Landmark descriptor index (" << feature::EImageDescriberType_enumToString(descType) << "): "
+      << index.landmarkIds.size() << " landmarks indexed over " << landmarkIds.size() << ".");
+  }
+}
+
+void LandmarkDescriptorIndex::initSearch(DescIndex& index)
+{
+  const DescriptorsMap descriptors(index.descriptors.data(), index.landmarkIds.size(), index.descLength);
+
+  index.hasher.Init(static_cast<std::uint8_t>(index.descLength));
+  index.zeroMeanDescriptor = matching::CascadeHasher::GetZeroMeanDescriptor(descriptors);
+  index.hashedDescriptions = index.hasher.CreateHashedDescriptions(descriptors, index.zeroMeanDescriptor);
+}
+
+void LandmarkDescriptorIndex::match(feature::EImageDescriberType descType,
+                                    const feature::Regions& queryRegions,
+                                    float distRatio,
+                                    std::vector<IndMatch3D2D>& out_associations) const
+{
+  const auto indexIt = _indexPerDesc.find(descType);
+  if(indexIt == _indexPerDesc.end() || queryRegions.RegionCount() == 0)
+    return;
+
+  const DescIndex& index = indexIt->second;
+  if(index.landmarkIds.empty())
+    return;
+
+  if(!isIndexable(queryRegions) || queryRegions.DescriptorLength() != index.descLength)
+    throw std::invalid_argument("The query regions are not compatible with the landmark descriptor index.");
+
+  // full precision query descriptors for the distances and quantized ones for the hashing,
+  // values out of the indexed range are clamped but only change the hash buckets
+  const std::size_t nbQueries = queryRegions.RegionCount();
+  std::vector<float> queryFloatDescriptors(nbQueries * index.descLength, 0.f);
+  std::vector<unsigned char> queryDescriptors(nbQueries * index.descLength);
+  for(std::size_t i = 0; i < nbQueries; ++i)
+  {
+    float* descriptor = queryFloatDescriptors.data() + i * index.descLength;
+    accumulateDescriptor(queryRegions, i, descriptor);
+    for(std::size_t d = 0; d < index.descLength; ++d)
+      queryDescriptors[i * index.descLength + d] = quantize(descriptor[d], index.offset, index.scale);
+  }
+
+  const DescriptorsMap queryMap(queryDescriptors.data(), nbQueries, index.descLength);
+  const DescriptorsMap indexMap(index.descriptors.data(), index.landmarkIds.size(), index.descLength);
+  const matching::HashedDescriptions hashedQueries = index.hasher.CreateHashedDescriptions(queryMap, index.zeroMeanDescriptor);
+
+  typedef float DistanceType;
+  typedef matching::Hamming<stl::dynamic_bitset::BlockType> HammingMetricT;
+
+  // number of candidates per query feature evaluated with the L2 distance
+  const std::size_t nbTopCandidates = 10;
+  // distances are squared
+  const float squaredRatio = distRatio * distRatio;
+
+  // nearest landmark (position in the index) of each query feature, or -1
+  std::vector<int> nearestLandmark(nbQueries, -1);
+  std::vector<DistanceType> nearestDistance(nbQueries, 0);
+
+  #pragma omp parallel
+  {
+    const HammingMetricT hammingMetric;
+
+    // last query each landmark has been collected for, avoids duplicated candidates
+    std::vector<int> collectedFor(index.landmarkIds.size(), -1);
+    std::vector<std::pair<HammingMetricT::ResultType, int>> candidates;
+    std::vector<std::pair<DistanceType, int>> topCandidates;
+
+    #pragma omp for schedule(dynamic, 64)
+    for(int i = 0; i < static_cast<int>(nbQueries); ++i)
+    {
+      const matching::HashedDescription& hashedQuery = hashedQueries.hashed_desc[i];
+
+      // landmarks sharing a bucket with the query feature
+      candidates.clear();
+      for(std::size_t g = 0; g < hashedQuery.bucket_ids.size(); ++g)
+      {
+        for(const int candidate : index.hashedDescriptions.buckets[g][hashedQuery.bucket_ids[g]])
+        {
+          if(collectedFor[candidate] == i)
+            continue;
+          collectedFor[candidate] = i;
+          candidates.emplace_back(hammingMetric(hashedQuery.hash_code.data(),
+                                                index.hashedDescriptions.hashed_desc[candidate].hash_code.data(),
+                                                hashedQuery.hash_code.num_blocks()), candidate);
+        }
+      }
+      if(candidates.size() < 2)
+        continue;
+
+      // closest hash codes, landmarks are sorted by visibility so the most visible ones win the ties
+      const std::size_t nbTop = std::min(nbTopCandidates, candidates.size());
+      std::partial_sort(candidates.begin(), candidates.begin() + nbTop, candidates.end());
+
+      topCandidates.clear();
+      for(std::size_t c = 0; c < nbTop; ++c)
+      {
+        const int candidate = candidates[c].second;
+        topCandidates.emplace_back(squaredDistance(queryFloatDescriptors.data() + i * index.descLength, indexMap.row(candidate).data(),
+                                                   index.descLength, index.offset, index.scale), candidate);
+      }
+      std::partial_sort(topCandidates.begin(), topCandidates.begin() + 2, topCandidates.end());
+
+      if(topCandidates[0].first < squaredRatio * topCandidates[1].first)
+      {
+        nearestLandmark[i] = topCandidates[0].second;
+        nearestDistance[i] = topCandidates[0].first;
+      }
+    }
+  }
+
+  // keep the closest query feature of each landmark
+  std::map<IndexT, std::pair<DistanceType, IndexT>> bestPerLandmark;
+  for(std::size_t i = 0; i < nbQueries; ++i)
+  {
+    if(nearestLandmark[i] < 0)
+      continue;
+
+    const IndexT landmarkId = index.landmarkIds[nearestLandmark[i]];
+    const auto bestIt = bestPerLandmark.find(landmarkId);
+    if(bestIt == bestPerLandmark.end() || nearestDistance[i] < bestIt->second.first)
+      bestPerLandmark[landmarkId] = std::make_pair(nearestDistance[i], static_cast<IndexT>(i));
+  }
+
+  out_associations.reserve(out_associations.size() + bestPerLandmark.size());
+  for(const auto& bestIt : bestPerLandmark)
+    out_associations.emplace_back(bestIt.first, descType, bestIt.second.second);
+}
+
+std::size_t LandmarkDescriptorIndex::nbLandmarks() const
+{
+  std::size_t nb = 0;
+  for(const auto& indexIt : _indexPerDesc)
+    nb += indexIt.second.landmarkIds.size();
+  return nb;
+}
+
+std::size_t LandmarkDescriptorIndex::descriptorsMemorySize() const
+{
+  std::size_t size = 0;
+  for(const auto& indexIt : _indexPerDesc)
+    size += indexIt.second.descriptors.size();
+  return size;
+}
+
+bool LandmarkDescriptorIndex::save(const std::string& filepath) const
+{
+  std::ofstream stream(filepath, std::ios::out | std::ios::binary);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Unable to open the landmark descriptor index file: " << filepath);
+    return false;
+  }
+
+  stream.write(indexFileMagic, sizeof(indexFileMagic));
+  writeValue(stream, indexFileVersion);
+  writeValue(stream, static_cast<std::uint32_t>(_indexPerDesc.size()));
+
+  for(const auto& indexIt : _indexPerDesc)
+  {
+    const DescIndex& index = indexIt.second;
+    const std::string descTypeName = feature::EImageDescriberType_enumToString(indexIt.first);
+
+    writeValue(stream, static_cast<std::uint32_t>(descTypeName.size()));
+    stream.write(descTypeName.data(), descTypeName.size());
+    writeValue(stream, static_cast<std::uint32_t>(index.descLength));
+    writeValue(stream, static_cast<std::uint64_t>(index.landmarkIds.size()));
+    writeValue(stream, index.offset);
+    writeValue(stream, index.scale);
+    writeVector(stream, index.landmarkIds);
+    writeVector(stream, index.visibility);
+    writeVector(stream, index.descriptors);
+  }
+
+  if(!stream.good())
+  {
+    ALICEVISION_LOG_ERROR("Unable to write the landmark descriptor index file: " << filepath);
+    return false;
+  }
+  return true;
+}
+
+bool LandmarkDescriptorIndex::load(const std::string& filepath)
+{
+  _indexPerDesc.clear();
+
+  std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Unable to open the landmark descriptor index file: " << filepath);
+    return false;
+  }
+
+  char magic[sizeof(indexFileMagic)];
+  std::uint32_t version = 0;
+  std::uint32_t nbDescTypes = 0;
+  stream.read(magic, sizeof(magic));
+  readValue(stream, version);
+  readValue(stream, nbDescTypes);
+
+  if(!stream.good() || !std::equal(magic, magic + sizeof(magic), indexFileMagic) || version != indexFileVersion)
+  {
+    ALICEVISION_LOG_ERROR("Invalid landmark descriptor index file: " << filepath);
+    return false;
+  }
+
+  for(std::uint32_t t = 0; t < nbDescTypes; ++t)
+  {
+    std::uint32_t nameSize = 0;
+    readValue(stream, nameSize);
+    std::string descTypeName(nameSize, '\0');
+    stream.read(&descTypeName[0], nameSize);
+
+    std::uint32_t descLength = 0;
+    std::uint64_t nbLandmarks = 0;
+    readValue(stream, descLength);
+    readValue(stream, nbLandmarks);
+
+    if(!stream.good() || descLength == 0 || descLength > std::numeric_limits<std::uint8_t>::max())
+    {
+      ALICEVISION_LOG_ERROR("Invalid landmark descriptor index file: " << filepath);
+      _indexPerDesc.clear();
+      return false;
+    }
+
+    DescIndex& index = _indexPerDesc[feature::EImageDescriberType_stringToEnum(descTypeName)];
+    index.descLength = descLength;
+    readValue(stream, index.offset);
+    readValue(stream, index.scale);
+    readVector(stream, index.landmarkIds, nbLandmarks);
+    readVector(stream, index.visibility, nbLandmarks);
+    readVector(stream, index.descriptors, nbLandmarks * descLength);
+
+    if(!stream.good())
+    {
+      ALICEVISION_LOG_ERROR("Truncated landmark descriptor index file: " << filepath);
+      _indexPerDesc.clear();
+      return false;
+    }
+
+    initSearch(index);
+  }
+  return true;
+}
+
+} // namespace localization
+} // namespace aliceVision
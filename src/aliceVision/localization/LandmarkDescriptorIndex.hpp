@@ -0,0 +1,116 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/Regions.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/matching/CascadeHasher.hpp>
+#include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/localization/reconstructed_regions.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Compact descriptor index over all the reconstructed landmarks.
+ *
+ * Each landmark is represented by a single descriptor, the mean of the descriptors
+ * of its observations, quantized on 8 bits with the same scale for all the dimensions
+ * so that the L2 distances are preserved up to the quantization step. The index is searched
+ * with cascade hashing so that each query feature is associated to a 3D point with a single
+ * search, instead of one matching per retrieved database image. The query descriptors are
+ * only quantized for the hashing: the candidates are ranked with the full precision query.
+ *
+ * Landmarks are sorted by decreasing visibility (number of observations): for the same
+ * hashing distance the most visible landmarks are evaluated first and, if the size of
+ * the index is bounded, only the most visible ones are kept.
+ *
+ * Only scalar descriptors (unsigned char or float) are indexed.
+ */
+class LandmarkDescriptorIndex
+{
+public:
+  /**
+   * @brief Build the index from the reconstructed regions of the database views
+   * @param[in] sfmData The reconstruction, it provides the observations of each landmark
+   * @param[in] regionsPerView The regions of the reconstructed features of each view
+   * @param[in] mappingPerView The mapping between the full and the reconstructed regions of each view
+   * @param[in] maxLandmarks The maximum number of landmarks per describer type (0 = all)
+   */
+  void build(const sfmData::SfMData& sfmData,
+             const feature::RegionsPerView& regionsPerView,
+             const ReconstructedRegionsMappingPerView& mappingPerView,
+             std::size_t maxLandmarks = 0);
+
+  /**
+   * @brief Find the 2D-3D correspondences of the query features
+   * @param[in] descType The describer type of the query regions
+   * @param[in] queryRegions The query regions
+   * @param[in] distRatio The nearest neighbor distance ratio
+   * @param[out] out_associations The 2D-3D correspondences, at most one per landmark
+   */
+  void match(feature::EImageDescriberType descType,
+             const feature::Regions& queryRegions,
+             float distRatio,
+             std::vector<IndMatch3D2D>& out_associations) const;
+
+  /**
+   * @brief Save the index in a binary file
+   * @return true if the file has been written
+   */
+  bool save(const std::string& filepath) const;
+
+  /**
+   * @brief Load the index from a binary file written by save()
+   * @return true if the index has been loaded
+   */
+  bool load(const std::string& filepath);
+
+  bool empty() const { return _indexPerDesc.empty(); }
+
+  bool hasDescType(feature::EImageDescriberType descType) const { return _indexPerDesc.count(descType) > 0; }
+
+  /// number of indexed landmarks over all the describer types
+  std::size_t nbLandmarks() const;
+
+  /// memory used by the quantized descriptors in bytes
+  std::size_t descriptorsMemorySize() const;
+
+private:
+  struct DescIndex
+  {
+    std::size_t descLength = 0;
+    /// indexed landmarks, sorted by decreasing visibility
+    std::vector<IndexT> landmarkIds;
+    std::vector<IndexT> visibility;
+    /// quantized descriptors, one row per landmark
+    std::vector<unsigned char> descriptors;
+    /// quantization of all the dimensions: value = offset + quantized / scale
+    float offset = 0.f;
+    float scale = 1.f;
+
+    // search structures, built from the quantized descriptors
+    matching::CascadeHasher hasher;
+    Eigen::VectorXf zeroMeanDescriptor;
+    matching::HashedDescriptions hashedDescriptions;
+  };
+
+  /// build the cascade hashing structures of a describer type
+  static void initSearch(DescIndex& index);
+
+  std::map<feature::EImageDescriberType, DescIndex> _indexPerDesc;
+};
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,218 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/localization/LandmarkDescriptorIndex.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE LandmarkDescriptorIndex
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+const feature::EImageDescriberType descType = feature::EImageDescriberType::SIFT;
+
+feature::SIFT_Regions::DescriptorT noisyDescriptor(const feature::SIFT_Regions::DescriptorT& desc, std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> noise(-4, 4);
+  feature::SIFT_Regions::DescriptorT noisy;
+  for(std::size_t d = 0; d < feature::SIFT_Regions::DescriptorT::static_size; ++d)
+    noisy[d] = static_cast<unsigned char>(std::max(0, std::min(255, desc[d] + noise(generator))));
+  return noisy;
+}
+
+/**
+ * @brief Synthetic scene: each landmark is observed in several views
+ * with noisy copies of a random reference descriptor.
+ */
+struct SyntheticScene
+{
+  SyntheticScene(std::size_t nbLandmarks, std::size_t nbViews)
+    : generator(42)
+  {
+    std::uniform_int_distribution<int> value(0, 200);
+
+    for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+    {
+      regionsPerView.getData()[viewId][descType].reset(new feature::SIFT_Regions());
+      mappingPerView[viewId][descType];
+    }
+
+    for(IndexT landmarkId = 0; landmarkId < nbLandmarks; ++landmarkId)
+    {
+      feature::SIFT_Regions::DescriptorT desc;
+      for(std::size_t d = 0; d < feature::SIFT_Regions::DescriptorT::static_size; ++d)
+        desc[d] = static_cast<unsigned char>(value(generator));
+      descriptors.push_back(desc);
+
+      sfmData::Landmark landmark(Vec3(landmarkId, 0.0, 1.0), descType);
+
+      // the first landmarks are the most visible ones
+      const std::size_t nbObservations = (landmarkId < nbLandmarks / 2) ? nbViews : 2;
+      for(IndexT viewId = 0; viewId < nbObservations; ++viewId)
+      {
+        feature::SIFT_Regions& regions = static_cast<feature::SIFT_Regions&>(*regionsPerView.getData()[viewId][descType]);
+        localization::ReconstructedRegionsMapping& mapping = mappingPerView[viewId][descType];
+
+        const IndexT featId = static_cast<IndexT>(regions.RegionCount());
+        regions.Features().emplace_back(landmarkId, viewId);
+        regions.Descriptors().push_back(noisyDescriptor(desc, generator));
+        mapping._associated3dPoint.push_back(landmarkId);
+        mapping._mapFullToLocal[featId] = featId;
+
+        landmark.observations[viewId] = sfmData::Observation(Vec2(landmarkId, viewId), featId);
+      }
+      sfmData.structure[landmarkId] = landmark;
+    }
+  }
+
+  /// query regions observing the given landmarks
+  feature::SIFT_Regions createQuery(const std::vector<IndexT>& landmarkIds)
+  {
+    feature::SIFT_Regions query;
+    for(const IndexT landmarkId : landmarkIds)
+    {
+      query.Features().emplace_back(landmarkId, 0.f);
+      query.Descriptors().push_back(noisyDescriptor(descriptors[landmarkId], generator));
+    }
+    return query;
+  }
+
+  std::mt19937 generator;
+  sfmData::SfMData sfmData;
+  feature::RegionsPerView regionsPerView;
+  localization::ReconstructedRegionsMappingPerView mappingPerView;
+  std::vector<feature::SIFT_Regions::DescriptorT> descriptors;
+};
+
+std::size_t nbCorrectAssociations(const std::vector<localization::IndMatch3D2D>& associations,
+                                  const std::vector<IndexT>& queryLandmarks)
+{
+  std::size_t nbCorrect = 0;
+  for(const auto& association : associations)
+  {
+    BOOST_CHECK(association.descType == descType);
+    if(queryLandmarks.at(association.featId) == association.landmarkId)
+      ++nbCorrect;
+  }
+  return nbCorrect;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LandmarkDescriptorIndex_match)
+{
+  SyntheticScene scene(2000, 4);
+
+  localization::LandmarkDescriptorIndex index;
+  index.build(scene.sfmData, scene.regionsPerView, scene.mappingPerView);
+  BOOST_CHECK_EQUAL(index.nbLandmarks(), 2000);
+  BOOST_CHECK_EQUAL(index.descriptorsMemorySize(), 2000 * 128);
+  BOOST_CHECK(index.hasDescType(descType));
+
+  std::vector<IndexT> queryLandmarks;
+  for(IndexT landmarkId = 0; landmarkId < 2000; landmarkId += 10)
+    queryLandmarks.push_back(landmarkId);
+  const feature::SIFT_Regions query = scene.createQuery(queryLandmarks);
+
+  std::vector<localization::IndMatch3D2D> associations;
+  index.match(descType, query, 0.8f, associations);
+
+  const std::size_t nbCorrect = nbCorrectAssociations(associations, queryLandmarks);
+  BOOST_TEST_MESSAGE(nbCorrect << " correct associations over " << associations.size() << " for " << queryLandmarks.size() << " query features");
+  BOOST_CHECK(nbCorrect >= 0.9 * queryLandmarks.size());
+  BOOST_CHECK(nbCorrect >= 0.95 * associations.size());
+}
+
+BOOST_AUTO_TEST_CASE(LandmarkDescriptorIndex_lowRangeDimensions)
+{
+  SyntheticScene scene(2000, 4);
+
+  // half of the dimensions only hold a small noise: they must not weigh more than the others in the distances
+  std::uniform_int_distribution<int> lowNoise(0, 2);
+  const auto addLowNoise = [&](feature::SIFT_Regions& regions)
+  {
+    for(auto& desc : regions.Descriptors())
+      for(std::size_t d = feature::SIFT_Regions::DescriptorT::static_size / 2; d < feature::SIFT_Regions::DescriptorT::static_size; ++d)
+        desc[d] = static_cast<unsigned char>(lowNoise(scene.generator));
+  };
+  for(auto& regionsPerViewIt : scene.regionsPerView.getData())
+    addLowNoise(static_cast<feature::SIFT_Regions&>(*regionsPerViewIt.second.at(descType)));
+
+  localization::LandmarkDescriptorIndex index;
+  index.build(scene.sfmData, scene.regionsPerView, scene.mappingPerView);
+
+  std::vector<IndexT> queryLandmarks;
+  for(IndexT landmarkId = 0; landmarkId < 2000; landmarkId += 10)
+    queryLandmarks.push_back(landmarkId);
+  feature::SIFT_Regions query = scene.createQuery(queryLandmarks);
+  addLowNoise(query);
+
+  std::vector<localization::IndMatch3D2D> associations;
+  index.match(descType, query, 0.8f, associations);
+
+  const std::size_t nbCorrect = nbCorrectAssociations(associations, queryLandmarks);
+  BOOST_CHECK(nbCorrect >= 0.9 * queryLandmarks.size());
+  BOOST_CHECK(nbCorrect >= 0.95 * associations.size());
+}
+
+BOOST_AUTO_TEST_CASE(LandmarkDescriptorIndex_visibility)
+{
+  SyntheticScene scene(1000, 4);
+
+  // only the most visible half of the landmarks is indexed
+  localization::LandmarkDescriptorIndex index;
+  index.build(scene.sfmData, scene.regionsPerView, scene.mappingPerView, 500);
+  BOOST_CHECK_EQUAL(index.nbLandmarks(), 500);
+
+  std::vector<IndexT> queryLandmarks;
+  for(IndexT landmarkId = 0; landmarkId < 1000; landmarkId += 5)
+    queryLandmarks.push_back(landmarkId);
+  const feature::SIFT_Regions query = scene.createQuery(queryLandmarks);
+
+  std::vector<localization::IndMatch3D2D> associations;
+  index.match(descType, query, 0.8f, associations);
+
+  for(const auto& association : associations)
+    BOOST_CHECK(association.landmarkId < 500);
+}
+
+BOOST_AUTO_TEST_CASE(LandmarkDescriptorIndex_io)
+{
+  SyntheticScene scene(1000, 3);
+
+  localization::LandmarkDescriptorIndex index;
+  index.build(scene.sfmData, scene.regionsPerView, scene.mappingPerView);
+
+  const std::string filepath = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("landmarkIndex_%%%%%%.bin")).string();
+  BOOST_REQUIRE(index.save(filepath));
+
+  localization::LandmarkDescriptorIndex loadedIndex;
+  BOOST_REQUIRE(loadedIndex.load(filepath));
+  boost::filesystem::remove(filepath);
+
+  BOOST_CHECK_EQUAL(loadedIndex.nbLandmarks(), index.nbLandmarks());
+  BOOST_CHECK_EQUAL(loadedIndex.descriptorsMemorySize(), index.descriptorsMemorySize());
+
+  std::vector<IndexT> queryLandmarks;
+  for(IndexT landmarkId = 0; landmarkId < 1000; landmarkId += 4)
+    queryLandmarks.push_back(landmarkId);
+  const feature::SIFT_Regions query = scene.createQuery(queryLandmarks);
+
+  std::vector<localization::IndMatch3D2D> associations;
+  loadedIndex.match(descType, query, 0.8f, associations);
+  BOOST_CHECK(nbCorrectAssociations(associations, queryLandmarks) >= 0.9 * queryLandmarks.size());
+
+  // invalid file
+  BOOST_CHECK(!loadedIndex.load(filepath));
+  BOOST_CHECK(loadedIndex.empty());
+}
@@ -48,12 +48,8 @@ const Mat LocalizationResult::retrieveUndistortedPt2D() const
   {
     return getPt2D();
   }
-  const std::size_t numPts = distorted.cols();
-  Mat pt2Dundistorted = Mat2X(2, numPts);
-  for(std::size_t iPoint = 0; iPoint < numPts; ++iPoint)
-  {
-    pt2Dundistorted.col(iPoint) = intrinsics.get_ud_pixel(distorted.col(iPoint));
-  }
+  Mat2X pt2Dundistorted;
+  intrinsics.getUndistortedPixelsBatch(distorted, pt2Dundistorted);
   return pt2Dundistorted;
 }
 
@@ -153,6 +149,140 @@ std::size_t LocalizationResult::selectBestInliers()
 }
 
 
+void LocalizationResult::saveTree(bpt::ptree& lrTree) const
+{
+  lrTree.put("isValid", _isValid);
+  sfmDataIO::savePose3("pose", _pose, lrTree);
+
+  // indMatch3D2D
+  {
+    bpt::ptree indMatch3D2DTree;
+
+    for(const IndMatch3D2D& indMatch3D2D : _indMatch3D2D)
+    {
+      bpt::ptree itTree;
+      itTree.put("landmarkId", indMatch3D2D.landmarkId);
+      itTree.put("featureId", indMatch3D2D.featId);
+      itTree.put("descType", feature::EImageDescriberType_enumToString(indMatch3D2D.descType));
+      indMatch3D2DTree.push_back(std::make_pair("", itTree));
+    }
+    lrTree.add_child("indMatch3D2D", indMatch3D2DTree);
+  }
+
+  //intrinsic
+  {
+    std::shared_ptr<camera::PinholeRadialK3> intrinsicPtr(new camera::PinholeRadialK3());
+    *intrinsicPtr = _intrinsics;
+    sfmDataIO::saveIntrinsic("intrinsic", UndefinedIndexT, std::dynamic_pointer_cast<camera::IntrinsicBase>(intrinsicPtr), lrTree);
+  }
+
+  // inliers
+  {
+    bpt::ptree inliersTree;
+    for(std::size_t index : _matchData.vec_inliers)
+    {
+      bpt::ptree inlierTree;
+      inlierTree.put("",index);
+      inliersTree.push_back(std::make_pair("", inlierTree));
+    }
+    lrTree.add_child("inliers", inliersTree);
+  }
+
+  // needed for loading
+  lrTree.put("nbPts", _matchData.pt3D.cols());
+
+  sfmDataIO::saveMatrix("pt3D", _matchData.pt3D, lrTree);
+  sfmDataIO::saveMatrix("pt2D", _matchData.pt2D, lrTree);
+  sfmDataIO::saveMatrix("projectionMatrix", _matchData.projection_matrix, lrTree);
+
+  lrTree.put("errorMax", _matchData.error_max);
+  lrTree.put("maxIteration", _matchData.max_iteration);
+
+  // matchedImages
+  {
+    bpt::ptree matchedImagesTree;
+
+    for(const voctree::DocMatch& docMatch : _matchedImages)
+    {
+      bpt::ptree itTree;
+      itTree.put("id", docMatch.id);
+      itTree.put("score", docMatch.score);
+      matchedImagesTree.push_back(std::make_pair("", itTree));
+    }
+    lrTree.add_child("matchedImages", matchedImagesTree);
+  }
+}
+
+void LocalizationResult::loadTree(bpt::ptree& lrTree)
+{
+  _indMatch3D2D.clear();
+  _matchData.vec_inliers.clear();
+  _matchedImages.clear();
+
+  _isValid = lrTree.get<bool>("isValid");
+  sfmDataIO::loadPose3("pose", _pose, lrTree);
+
+  // indMatch3D2D
+  if(lrTree.count("indMatch3D2D"))
+  {
+    for(bpt::ptree::value_type& itNode : lrTree.get_child("indMatch3D2D"))
+    {
+      bpt::ptree& itTree = itNode.second;
+
+      IndMatch3D2D indMatch;
+
+      indMatch.landmarkId = itTree.get<IndexT>("landmarkId");
+      indMatch.featId = itTree.get<IndexT>("featureId");
+      indMatch.descType = feature::EImageDescriberType_stringToEnum(itTree.get<std::string>("descType"));
+
+      _indMatch3D2D.emplace_back(indMatch);
+    }
+  }
+
+  // intrinsic
+  {
+    IndexT intrinsicId;
+    std::shared_ptr<camera::IntrinsicBase> intrinsicPtr;
+    sfmDataIO::loadIntrinsic(intrinsicId, intrinsicPtr, lrTree.get_child("intrinsic"));
+    _intrinsics = *(dynamic_cast<camera::PinholeRadialK3*>(intrinsicPtr.get()));
+  }
+
+  // inliers
+  if(lrTree.count("inliers"))
+  {
+    for(bpt::ptree::value_type& itNode : lrTree.get_child("inliers"))
+      _matchData.vec_inliers.emplace_back(itNode.second.get_value<std::size_t>());
+  }
+
+  const std::size_t nbPts = lrTree.get<std::size_t>("nbPts");
+
+  _matchData.pt3D = Mat(3, nbPts);
+  _matchData.pt2D = Mat(2, nbPts);
+
+  sfmDataIO::loadMatrix("pt3D", _matchData.pt3D, lrTree);
+  sfmDataIO::loadMatrix("pt2D", _matchData.pt2D, lrTree);
+  sfmDataIO::loadMatrix("projectionMatrix", _matchData.projection_matrix, lrTree);
+
+  _matchData.error_max = std::stod(lrTree.get<std::string>("errorMax"));
+  _matchData.max_iteration = lrTree.get<std::size_t>("maxIteration");
+
+  // matchedImages;
+  if(lrTree.count("matchedImages"))
+  {
+    for(bpt::ptree::value_type& itNode : lrTree.get_child("matchedImages"))
+    {
+      bpt::ptree& itTree = itNode.second;
+
+      voctree::DocMatch docMatch;
+
+      docMatch.id = itTree.get<voctree::DocId>("id");
+      docMatch.score = itTree.get<float>("score");
+
+      _matchedImages.emplace_back(docMatch);
+    }
+  }
+}
+
 void LocalizationResult::load(std::vector<LocalizationResult>& localizationResults, const std::string& filename)
 {
   using namespace aliceVision::sfm;
@@ -179,69 +309,7 @@ void LocalizationResult::load(std::vector<LocalizationResult>& localizationResul
       bpt::ptree lrTree = lrNode.second;
 
       LocalizationResult lr;
-
-      lr._isValid = lrTree.get<bool>("isValid");
-      sfmDataIO::loadPose3("pose", lr._pose, lrTree);
-
-      // indMatch3D2D
-      if(lrTree.count("indMatch3D2D"))
-      {
-        for(bpt::ptree::value_type& itNode : lrTree.get_child("indMatch3D2D"))
-        {
-          bpt::ptree& itTree = itNode.second;
-
-          IndMatch3D2D indMatch;
-
-          indMatch.landmarkId = itTree.get<IndexT>("landmarkId");
-          indMatch.featId = itTree.get<IndexT>("featureId");
-          indMatch.descType = feature::EImageDescriberType_stringToEnum(itTree.get<std::string>("descType"));
-
-          lr._indMatch3D2D.emplace_back(indMatch);
-        }
-      }
-
-      // intrinsic
-      {
-        IndexT intrinsicId;
-        std::shared_ptr<camera::IntrinsicBase> intrinsicPtr;
-        sfmDataIO::loadIntrinsic(intrinsicId, intrinsicPtr, lrTree.get_child("intrinsic"));
-        lr._intrinsics = *(dynamic_cast<camera::PinholeRadialK3*>(intrinsicPtr.get()));
-      }
-
-      // inliers
-      if(lrTree.count("inliers"))
-      {
-        for(bpt::ptree::value_type& itNode : lrTree.get_child("inliers"))
-          lr._matchData.vec_inliers.emplace_back(itNode.second.get_value<std::size_t>());
-      }
-
-      const std::size_t nbPts = lrTree.get<std::size_t>("nbPts");
-
-      lr._matchData.pt3D = Mat(3, nbPts);
-      lr._matchData.pt2D = Mat(2, nbPts);
-
-      sfmDataIO::loadMatrix("pt3D", lr._matchData.pt3D, lrTree);
-      sfmDataIO::loadMatrix("pt2D", lr._matchData.pt2D, lrTree);
-      sfmDataIO::loadMatrix("projectionMatrix", lr._matchData.projection_matrix, lrTree);
-
-      lr._matchData.error_max = std::stod(lrTree.get<std::string>("errorMax"));
-      lr._matchData.max_iteration = lrTree.get<std::size_t>("maxIteration");
-
-      // matchedImages;
-      if(lrTree.count("matchedImages"))
-      {
-        for(bpt::ptree::value_type& itNode : lrTree.get_child("matchedImages"))
-        {
-          bpt::ptree& itTree = itNode.second;
-
-          voctree::DocMatch docMatch;
-
-          docMatch.id = itTree.get<voctree::DocId>("id");
-          docMatch.score = itTree.get<float>("score");
-
-          lr._matchedImages.emplace_back(docMatch);
-        }
-      }
+      lr.loadTree(lrTree);
       localizationResults.emplace_back(lr);
     }
   }
@@ -265,67 +333,7 @@ void LocalizationResult::save(const std::vector<LocalizationResult>& localizatio
   for(const LocalizationResult& lr : localizationResults)
   {
     bpt::ptree lrTree;
-
-    lrTree.put("isValid", lr._isValid);
-    sfmDataIO::savePose3("pose", lr._pose, lrTree);
-
-    // indMatch3D2D
-    {
-      bpt::ptree indMatch3D2DTree;
-
-      for(const IndMatch3D2D& indMatch3D2D : lr._indMatch3D2D)
-      {
-        bpt::ptree itTree;
-        itTree.put("landmarkId", indMatch3D2D.landmarkId);
-        itTree.put("featureId", indMatch3D2D.featId);
-        itTree.put("descType", feature::EImageDescriberType_enumToString(indMatch3D2D.descType));
-        indMatch3D2DTree.push_back(std::make_pair("", itTree));
-      }
-      lrTree.add_child("indMatch3D2D", indMatch3D2DTree);
-    }
-
-    //intrinsic
-    {
-      std::shared_ptr<camera::PinholeRadialK3> intrinsicPtr(new camera::PinholeRadialK3());
-      *intrinsicPtr = lr._intrinsics;
-      sfmDataIO::saveIntrinsic("intrinsic", UndefinedIndexT, std::dynamic_pointer_cast<camera::IntrinsicBase>(intrinsicPtr), lrTree);
-    }
-
-    // inliers
-    {
-      bpt::ptree inliersTree;
-      for(std::size_t index : lr._matchData.vec_inliers)
-      {
-        bpt::ptree inlierTree;
-        inlierTree.put("",index);
-        inliersTree.push_back(std::make_pair("", inlierTree));
-      }
-      lrTree.add_child("inliers", inliersTree);
-    }
-
-    // needed for loading
-    lrTree.put("nbPts", lr._matchData.pt3D.cols());
-
-    sfmDataIO::saveMatrix("pt3D", lr._matchData.pt3D, lrTree);
-    sfmDataIO::saveMatrix("pt2D", lr._matchData.pt2D, lrTree);
-    sfmDataIO::saveMatrix("projectionMatrix", lr._matchData.projection_matrix, lrTree);
-
-    lrTree.put("errorMax", lr._matchData.error_max);
-    lrTree.put("maxIteration", lr._matchData.max_iteration);
-
-    // matchedImages
-    {
-      bpt::ptree matchedImagesTree;
-
-      for(const voctree::DocMatch& docMatch : lr._matchedImages)
-      {
-        bpt::ptree itTree;
-        itTree.put("id", docMatch.id);
-        itTree.put("score", docMatch.score);
-        matchedImagesTree.push_back(std::make_pair("", itTree));
-      }
-      lrTree.add_child("matchedImages", matchedImagesTree);
-    }
+    lr.saveTree(lrTree);
     localizationResultsTree.push_back(std::make_pair("", lrTree));
   }
   fileTree.add_child("localizationResults", localizationResultsTree);
@@ -9,6 +9,8 @@
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/voctree/Database.hpp>
 
+#include <boost/property_tree/ptree_fwd.hpp>
+
 #include <vector>
 #include <utility>
 #include <string>
@@ -172,6 +174,18 @@ public:
   
   double getMaxReprojectionError() const { return _matchData.error_max;}
 
+  /**
+   * @brief Export the localization result in a property tree (json layout of save())
+   * @param[out] lrTree The tree to fill
+   */
+  void saveTree(boost::property_tree::ptree& lrTree) const;
+
+  /**
+   * @brief Import the localization result from a property tree (json layout of load())
+   * @param[in] lrTree The tree to read
+   */
+  void loadTree(boost::property_tree::ptree& lrTree);
+
   static void save(const std::vector<LocalizationResult>& localizationResults, const std::string& filename);
   static void load(std::vector<LocalizationResult>& localizationResults, const std::string& filename);
   
@@ -0,0 +1,276 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LocalizationServer.hpp"
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/tokenizer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+namespace aliceVision {
+namespace localization {
+
+namespace bpt = boost::property_tree;
+
+void LocalizationLatencyStats::add(double latencyMs, bool localized)
+{
+  _latenciesMs.push_back(latencyMs);
+  if(localized)
+    ++_nbLocalized;
+}
+
+double LocalizationLatencyStats::sumMs() const
+{
+  return std::accumulate(_latenciesMs.begin(), _latenciesMs.end(), 0.0);
+}
+
+double LocalizationLatencyStats::meanMs() const
+{
+  return _latenciesMs.empty() ? 0.0 : sumMs() / _latenciesMs.size();
+}
+
+double LocalizationLatencyStats::minMs() const
+{
+  return _latenciesMs.empty() ? 0.0 : *std::min_element(_latenciesMs.begin(), _latenciesMs.end());
+}
+
+double LocalizationLatencyStats::maxMs() const
+{
+  return _latenciesMs.empty() ? 0.0 : *std::max_element(_latenciesMs.begin(), _latenciesMs.end());
+}
+
+double LocalizationLatencyStats::quantileMs(double q) const
+{
+  if(_latenciesMs.empty())
+    return 0.0;
+
+  std::vector<double> latencies = _latenciesMs;
+  const std::size_t n = static_cast<std::size_t>(std::round(std::max(0.0, std::min(1.0, q)) * (latencies.size() - 1)));
+  std::nth_element(latencies.begin(), latencies.begin() + n, latencies.end());
+  return latencies[n];
+}
+
+void LocalizationLatencyStats::log() const
+{
+  ALICEVISION_LOG_INFO("Localization latency (query to pose):" << std::endl
+    << "\t- # requests: " << nbRequests() << std::endl
+    << "\t- # localized: " << nbLocalized() << std::endl
+    << "\t- mean: " << meanMs() << " ms" << std::endl
+    << "\t- median: " << quantileMs(0.5) << " ms" << std::endl
+    << "\t- 95th percentile: " << quantileMs(0.95) << " ms" << std::endl
+    << "\t- min: " << minMs() << " ms" << std::endl
+    << "\t- max: " << maxMs() << " ms");
+}
+
+namespace {
+
+std::vector<std::string> tokenizeRequest(const std::string& request)
+{
+  // space separated, double-quoted tokens may contain spaces, no escape character
+  typedef boost::escaped_list_separator<char> Separator;
+  const boost::tokenizer<Separator> tokenizer(request, Separator("", " \t\r", "\""));
+
+  std::vector<std::string> tokens;
+  for(const std::string& token : tokenizer)
+  {
+    if(!token.empty())
+      tokens.push_back(token);
+  }
+  return tokens;
+}
+
+/**
+ * @brief Read the optional known intrinsics of a request
+ * @param[in] args The request arguments
+ * @param[in] first The index of the first intrinsic parameter (focal)
+ * @param[in] width The image width
+ * @param[in] height The image height
+ * @param[out] intrinsics The query intrinsics
+ * @return true if the intrinsics are given by the request
+ */
+bool readIntrinsics(const std::vector<std::string>& args,
+                    std::size_t first,
+                    std::size_t width,
+                    std::size_t height,
+                    camera::PinholeRadialK3& intrinsics)
+{
+  if(args.size() <= first)
+  {
+    intrinsics = camera::PinholeRadialK3(width, height);
+    return false;
+  }
+
+  if(args.size() != first + 6)
+    throw std::invalid_argument("Expected 6 intrinsic parameters: <focal> <ppx> <ppy> <k1> <k2> <k3>");
+
+  intrinsics = camera::PinholeRadialK3(width, height,
+                                       std::stod(args[first]),
+                                       std::stod(args[first + 1]),
+                                       std::stod(args[first + 2]),
+                                       std::stod(args[first + 3]),
+                                       std::stod(args[first + 4]),
+                                       std::stod(args[first + 5]));
+  return true;
+}
+
+} // namespace
+
+LocalizationServer::LocalizationServer(ILocalizer& localizer,
+                                       const LocalizerParameters& param,
+                                       const std::vector<feature::EImageDescriberType>& descTypes,
+                                       const std::vector<std::string>& featuresFolders)
+  : _localizer(localizer)
+  , _param(param)
+  , _featuresFolders(featuresFolders)
+{
+  for(const feature::EImageDescriberType descType : descTypes)
+    _imageDescribers.push_back(feature::createImageDescriber(descType));
+}
+
+std::size_t LocalizationServer::serve(std::istream& in, std::ostream& out)
+{
+  std::size_t nbRequests = 0;
+  std::string request;
+
+  while(std::getline(in, request))
+  {
+    if(tokenizeRequest(request).empty())
+      continue;
+
+    bpt::ptree response;
+    const bool keepServing = processRequest(request, response);
+    ++nbRequests;
+
+    // one response per line
+    bpt::write_json(out, response, false);
+    out.flush();
+
+    if(!keepServing)
+      break;
+  }
+  return nbRequests;
+}
+
+bool LocalizationServer::processRequest(const std::string& request, bpt::ptree& response)
+{
+  response.put("id", _requestId++);
+
+  const std::vector<std::string> args = tokenizeRequest(request);
+  const std::string command = args.empty() ? std::string() : args.front();
+
+  if(command == "quit")
+  {
+    response.put("status", "ok");
+    return false;
+  }
+
+  if(command == "stats")
+  {
+    response.put("status", "ok");
+    response.put("nbRequests", _latencyStats.nbRequests());
+    response.put("nbLocalized", _latencyStats.nbLocalized());
+    response.put("meanMs", _latencyStats.meanMs());
+    response.put("medianMs", _latencyStats.quantileMs(0.5));
+    response.put("p95Ms", _latencyStats.quantileMs(0.95));
+    response.put("minMs", _latencyStats.minMs());
+    response.put("maxMs", _latencyStats.maxMs());
+    return true;
+  }
+
+  if(command != "image" && command != "regions")
+  {
+    response.put("status", "error");
+    response.put("message", "Unknown request: '" + command + "'");
+    return true;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  camera::PinholeRadialK3 intrinsics;
+  LocalizationResult result;
+  bool localized = false;
+
+  try
+  {
+    if(command == "image")
+      localized = localizeImage(args, intrinsics, result);
+    else
+      localized = localizeRegions(args, intrinsics, result);
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Localization request " << request << " failed: " << e.what());
+    response.put("status", "error");
+    response.put("message", e.what());
+    return true;
+  }
+
+  const double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  _latencyStats.add(latencyMs, localized);
+
+  ALICEVISION_LOG_INFO("Request " << response.get<std::size_t>("id") << ": "
+    << (localized ? "localized" : "not localized") << " in " << latencyMs << " ms");
+
+  response.put("status", "ok");
+  response.put("localized", localized);
+  response.put("latencyMs", latencyMs);
+
+  bpt::ptree resultTree;
+  result.saveTree(resultTree);
+  response.add_child("localizationResult", resultTree);
+  return true;
+}
+
+bool LocalizationServer::localizeImage(const std::vector<std::string>& args,
+                                       camera::PinholeRadialK3& intrinsics,
+                                       LocalizationResult& result)
+{
+  if(args.size() < 2)
+    throw std::invalid_argument("Usage: image <imagePath> [<focal> <ppx> <ppy> <k1> <k2> <k3>]");
+
+  const std::string& imagePath = args[1];
+
+  image::Image<float> imageGrey;
+  image::readImage(imagePath, imageGrey, image::EImageColorSpace::NO_CONVERSION);
+
+  const bool useInputIntrinsics = readIntrinsics(args, 2, imageGrey.Width(), imageGrey.Height(), intrinsics);
+
+  return _localizer.localize(imageGrey, &_param, useInputIntrinsics, intrinsics, result, imagePath);
+}
+
+bool LocalizationServer::localizeRegions(const std::vector<std::string>& args,
+                                         camera::PinholeRadialK3& intrinsics,
+                                         LocalizationResult& result)
+{
+  if(args.size() < 4)
+    throw std::invalid_argument("Usage: regions <viewId> <width> <height> [<focal> <ppx> <ppy> <k1> <k2> <k3>]");
+
+  if(_featuresFolders.empty())
+    throw std::runtime_error("No features folder given for the precomputed regions");
+
+  const IndexT viewId = static_cast<IndexT>(std::stoul(args[1]));
+  const std::pair<std::size_t, std::size_t> imageSize(std::stoul(args[2]), std::stoul(args[3]));
+
+  feature::MapRegionsPerDesc queryRegions;
+  for(const auto& imageDescriber : _imageDescribers)
+    queryRegions[imageDescriber->getDescriberType()] = sfm::loadRegions(_featuresFolders, viewId, *imageDescriber);
+
+  const bool useInputIntrinsics = readIntrinsics(args, 4, imageSize.first, imageSize.second, intrinsics);
+
+  return _localizer.localize(queryRegions, imageSize, &_param, useInputIntrinsics, intrinsics, result, args[1]);
+}
+
+} // namespace localization
+} // namespace aliceVision
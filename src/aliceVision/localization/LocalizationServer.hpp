@@ -0,0 +1,118 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/localization/ILocalizer.hpp>
+#include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/feature/ImageDescriber.hpp>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Latency statistics of the localization requests,
+ * measured from the reception of the query to the estimated pose.
+ */
+class LocalizationLatencyStats
+{
+public:
+  void add(double latencyMs, bool localized);
+
+  std::size_t nbRequests() const { return _latenciesMs.size(); }
+  std::size_t nbLocalized() const { return _nbLocalized; }
+
+  double sumMs() const;
+  double meanMs() const;
+  double minMs() const;
+  double maxMs() const;
+
+  /**
+   * @brief Latency quantile
+   * @param[in] q quantile in [0, 1] (0.5 for the median)
+   */
+  double quantileMs(double q) const;
+
+  void log() const;
+
+private:
+  std::vector<double> _latenciesMs;
+  std::size_t _nbLocalized = 0;
+};
+
+/**
+ * @brief Long-running localization service.
+ * It keeps an initialized localizer (database, vocabulary tree, reconstructed descriptors)
+ * resident and answers localization requests read from a text stream.
+ *
+ * Protocol: one request per line, one json response per line.
+ * Paths containing spaces must be double-quoted.
+ *   image <imagePath> [<focal> <ppx> <ppy> <k1> <k2> <k3>]
+ *   regions <viewId> <width> <height> [<focal> <ppx> <ppy> <k1> <k2> <k3>]
+ *   stats
+ *   quit
+ * If the intrinsics are given they are used as known calibration, otherwise they are estimated.
+ * Precomputed regions are read from the features folders (<viewId>.<describerType>.feat/desc).
+ */
+class LocalizationServer
+{
+public:
+  /**
+   * @param[in] localizer An initialized localizer
+   * @param[in] param The localizer parameters
+   * @param[in] descTypes The describer types of the precomputed query regions
+   * @param[in] featuresFolders The folders containing the precomputed query regions
+   */
+  LocalizationServer(ILocalizer& localizer,
+                     const LocalizerParameters& param,
+                     const std::vector<feature::EImageDescriberType>& descTypes,
+                     const std::vector<std::string>& featuresFolders);
+
+  /**
+   * @brief Serve the requests until the end of the input stream or a quit request.
+   * Each response is flushed as soon as it is available.
+   * @param[in] in The request stream
+   * @param[out] out The response stream
+   * @return the number of requests served
+   */
+  std::size_t serve(std::istream& in, std::ostream& out);
+
+  /**
+   * @brief Process a single request
+   * @param[in] request The request line
+   * @param[out] response The json response
+   * @return false if the request asks to stop the service
+   */
+  bool processRequest(const std::string& request, boost::property_tree::ptree& response);
+
+  const LocalizationLatencyStats& getLatencyStats() const { return _latencyStats; }
+
+private:
+  bool localizeImage(const std::vector<std::string>& args,
+                     camera::PinholeRadialK3& intrinsics,
+                     LocalizationResult& result);
+
+  bool localizeRegions(const std::vector<std::string>& args,
+                       camera::PinholeRadialK3& intrinsics,
+                       LocalizationResult& result);
+
+  ILocalizer& _localizer;
+  const LocalizerParameters& _param;
+  std::vector<std::unique_ptr<feature::ImageDescriber>> _imageDescribers;
+  std::vector<std::string> _featuresFolders;
+  LocalizationLatencyStats _latencyStats;
+  std::size_t _requestId = 0;
+};
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,188 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/localization/LocalizationServer.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE LocalizationServer
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+namespace bpt = boost::property_tree;
+
+/**
+ * @brief Localizer returning a fixed pose, it only localizes
+ * the query regions of even width.
+ */
+class FakeLocalizer : public localization::ILocalizer
+{
+public:
+  FakeLocalizer() { _isInit = true; }
+
+  void extractRegions(const image::Image<float>& imageGrey,
+                      const localization::LocalizerParameters* param,
+                      feature::MapRegionsPerDesc& queryRegions,
+                      const std::string& imagePath) override
+  {
+  }
+
+  bool localize(const image::Image<float>& imageGrey,
+                const localization::LocalizerParameters* param,
+                bool useInputIntrinsics,
+                camera::PinholeRadialK3& queryIntrinsics,
+                localization::LocalizationResult& localizationResult,
+                const std::string& imagePath) override
+  {
+    return false;
+  }
+
+  bool localize(const feature::MapRegionsPerDesc& queryRegions,
+                const std::pair<std::size_t, std::size_t>& imageSize,
+                const localization::LocalizerParameters* param,
+                bool useInputIntrinsics,
+                camera::PinholeRadialK3& queryIntrinsics,
+                localization::LocalizationResult& localizationResult,
+                const std::string& imagePath) override
+  {
+    ++nbQueries;
+    lastUseInputIntrinsics = useInputIntrinsics;
+
+    const bool valid = (imageSize.first % 2 == 0);
+    const geometry::Pose3 pose(Mat3::Identity(), Vec3(1.0, 2.0, 3.0));
+    localizationResult = localization::LocalizationResult(sfm::ImageLocalizerMatchData(), {}, pose, queryIntrinsics, {}, valid);
+    return valid;
+  }
+
+  bool localizeRig(const std::vector<image::Image<float>>& vec_imageGrey,
+                   const localization::LocalizerParameters* param,
+                   std::vector<camera::PinholeRadialK3>& vec_queryIntrinsics,
+                   const std::vector<geometry::Pose3>& vec_subPoses,
+                   geometry::Pose3& rigPose,
+                   std::vector<localization::LocalizationResult>& vec_locResults) override
+  {
+    return false;
+  }
+
+  bool localizeRig(const std::vector<feature::MapRegionsPerDesc>& vec_queryRegions,
+                   const std::vector<std::pair<std::size_t, std::size_t>>& imageSize,
+                   const localization::LocalizerParameters* param,
+                   std::vector<camera::PinholeRadialK3>& vec_queryIntrinsics,
+                   const std::vector<geometry::Pose3>& vec_subPoses,
+                   geometry::Pose3& rigPose,
+                   std::vector<localization::LocalizationResult>& vec_locResults) override
+  {
+    return false;
+  }
+
+  std::size_t nbQueries = 0;
+  bool lastUseInputIntrinsics = false;
+};
+
+struct FakeParameters : public localization::LocalizerParameters
+{
+};
+
+std::vector<bpt::ptree> readResponses(std::istream& in)
+{
+  std::vector<bpt::ptree> responses;
+  std::string line;
+  while(std::getline(in, line))
+  {
+    std::istringstream lineStream(line);
+    bpt::ptree response;
+    bpt::read_json(lineStream, response);
+    responses.push_back(response);
+  }
+  return responses;
+}
+
+BOOST_AUTO_TEST_CASE(LocalizationServer_protocol)
+{
+  FakeLocalizer localizer;
+  FakeParameters param;
+  localization::LocalizationServer server(localizer, param, {}, {"."});
+
+  std::istringstream requests(
+    "regions 0 640 480\n"
+    "\n"
+    "regions 1 641 480 1000 320 240 0 0 0\n"
+    "regions 2 640\n"
+    "foo\n"
+    "stats\n"
+    "quit\n"
+    "regions 3 640 480\n");
+  std::stringstream responses;
+
+  const std::size_t nbServed = server.serve(requests, responses);
+  BOOST_CHECK_EQUAL(nbServed, 6);
+
+  const std::vector<bpt::ptree> r = readResponses(responses);
+  BOOST_REQUIRE_EQUAL(r.size(), 6);
+
+  // localized query, the result can be read back
+  BOOST_CHECK_EQUAL(r[0].get<std::string>("status"), "ok");
+  BOOST_CHECK(r[0].get<bool>("localized"));
+  BOOST_CHECK(r[0].get<double>("latencyMs") >= 0.0);
+  {
+    bpt::ptree resultTree = r[0].get_child("localizationResult");
+    localization::LocalizationResult result;
+    result.loadTree(resultTree);
+    BOOST_CHECK(result.isValid());
+    BOOST_CHECK_SMALL((result.getPose().center() - Vec3(1.0, 2.0, 3.0)).norm(), 1e-9);
+  }
+
+  // query with known intrinsics, not localized
+  BOOST_CHECK_EQUAL(r[1].get<std::string>("status"), "ok");
+  BOOST_CHECK(!r[1].get<bool>("localized"));
+  BOOST_CHECK(localizer.lastUseInputIntrinsics);
+
+  // malformed and unknown requests
+  BOOST_CHECK_EQUAL(r[2].get<std::string>("status"), "error");
+  BOOST_CHECK_EQUAL(r[3].get<std::string>("status"), "error");
+
+  // latency statistics only count the served localization queries
+  BOOST_CHECK_EQUAL(r[4].get<std::size_t>("nbRequests"), 2);
+  BOOST_CHECK_EQUAL(r[4].get<std::size_t>("nbLocalized"), 1);
+
+  // nothing is served after quit
+  BOOST_CHECK_EQUAL(r[5].get<std::string>("status"), "ok");
+  BOOST_CHECK_EQUAL(localizer.nbQueries, 2);
+  BOOST_CHECK_EQUAL(r[5].get<std::size_t>("id"), 5);
+}
+
+BOOST_AUTO_TEST_CASE(LocalizationServer_latency)
+{
+  FakeLocalizer localizer;
+  FakeParameters param;
+  localization::LocalizationServer server(localizer, param, {}, {"."});
+
+  const std::size_t nbQueries = 1000;
+  std::stringstream requests;
+  for(std::size_t i = 0; i < nbQueries; ++i)
+    requests << "regions " << i << " 640 480\n";
+
+  std::stringstream responses;
+  BOOST_CHECK_EQUAL(server.serve(requests, responses), nbQueries);
+
+  const localization::LocalizationLatencyStats& stats = server.getLatencyStats();
+  BOOST_CHECK_EQUAL(stats.nbRequests(), nbQueries);
+  BOOST_CHECK_EQUAL(stats.nbLocalized(), nbQueries);
+  BOOST_CHECK(stats.minMs() <= stats.quantileMs(0.5));
+  BOOST_CHECK(stats.quantileMs(0.5) <= stats.quantileMs(0.95));
+  BOOST_CHECK(stats.quantileMs(0.95) <= stats.maxMs());
+
+  // query to pose latency of the service itself, the fake localizer does no work
+  BOOST_TEST_MESSAGE("Query to pose latency: mean " << stats.meanMs() << " ms, "
+                     "median " << stats.quantileMs(0.5) << " ms, "
+                     "95th percentile " << stats.quantileMs(0.95) << " ms");
+}
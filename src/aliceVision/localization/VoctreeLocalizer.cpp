@@ -28,6 +28,7 @@
 #include <boost/filesystem.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 
 namespace aliceVision {
@@ -56,6 +57,8 @@ std::ostream& operator<<(std::ostream& os, VoctreeLocalizer::Algorithm a)
     break;
   case VoctreeLocalizer::Algorithm::Cluster: os << "Cluster";
     break;
+  case VoctreeLocalizer::Algorithm::LandmarkIndex: os << "LandmarkIndex";
+    break;
   default: 
     os << "Unknown algorithm!";
     throw std::invalid_argument("Unrecognized algorithm!");
@@ -112,6 +115,8 @@ VoctreeLocalizer::Algorithm VoctreeLocalizer::initFromString(const std::string &
     throw std::invalid_argument("BestResult not yet implemented");
   else if(value=="Cluster")
     throw std::invalid_argument("Cluster not yet implemented");
+  else if(value=="LandmarkIndex")
+    return VoctreeLocalizer::Algorithm::LandmarkIndex;
   else
     throw std::invalid_argument("Unrecognized algorithm \"" + value + "\"!");
 }
@@ -179,20 +184,25 @@ bool VoctreeLocalizer::localize(const feature::MapRegionsPerDesc & queryRegions,
                               localizationResult,
                               imagePath);
     case Algorithm::Cluster: throw std::invalid_argument("Cluster not yet implemented");
+    case Algorithm::LandmarkIndex:
+    return localizeLandmarkIndex(queryRegions,
+                                 imageSize,
+                                 *voctreeParam,
+                                 useInputIntrinsics,
+                                 queryIntrinsics,
+                                 localizationResult,
+                                 imagePath);
     default: throw std::invalid_argument("Unknown algorithm type");
   }
 }
 
-bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
-                                const LocalizerParameters *param,
-                                bool useInputIntrinsics,
-                                camera::PinholeRadialK3 &queryIntrinsics,
-                                LocalizationResult &localizationResult,
-                                const std::string& imagePath /* = std::string() */)
+void VoctreeLocalizer::extractRegions(const image::Image<float>& imageGrey,
+                                      const LocalizerParameters *param,
+                                      feature::MapRegionsPerDesc& queryRegionsPerDesc,
+                                      const std::string& imagePath /* = std::string() */)
 {
   // A. extract descriptors and features from image
   ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
-  feature::MapRegionsPerDesc queryRegionsPerDesc;
 
   image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
 
@@ -222,11 +232,10 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
     ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
   }
 
-  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
-
   // if debugging is enable save the svg image with the extracted features
   if(!param->_visualDebug.empty() && !imagePath.empty())
   {
+    const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
     feature::MapFeaturesPerDesc extractedFeatures;
 
     for(const auto& imageDescriber : _imageDescribers)
@@ -241,6 +250,19 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
                      extractedFeatures,
                      param->_visualDebug + "/" + bfs::path(imagePath).stem().string() + ".svg");
   }
+}
+
+bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
+                                const LocalizerParameters *param,
+                                bool useInputIntrinsics,
+                                camera::PinholeRadialK3 &queryIntrinsics,
+                                LocalizationResult &localizationResult,
+                                const std::string& imagePath /* = std::string() */)
+{
+  feature::MapRegionsPerDesc queryRegionsPerDesc;
+  extractRegions(imageGrey, param, queryRegionsPerDesc, imagePath);
+
+  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
 
   return localize(queryRegionsPerDesc,
                   queryImageSize,
@@ -645,6 +667,38 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
   assert(resectionData.pt2D.cols() == numCollectedPts);
   assert(resectionData.pt3D.cols() == numCollectedPts);
 
+  if(!estimatePose(queryImageSize,
+                   param,
+                   useInputIntrinsics,
+                   queryIntrinsics,
+                   resectionData,
+                   associationIDs,
+                   matchedImages,
+                   localizationResult,
+                   imagePath))
+  {
+    return localizationResult.isValid();
+  }
+
+  if(param._nbFrameBufferMatching > 0)
+  {
+    // add everything to the buffer
+    _frameBuffer.emplace_back(localizationResult, queryRegions);
+  }
+
+  return localizationResult.isValid();
+}
+
+bool VoctreeLocalizer::estimatePose(const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                    const Parameters &param,
+                                    bool useInputIntrinsics,
+                                    camera::PinholeRadialK3 &queryIntrinsics,
+                                    sfm::ImageLocalizerMatchData &resectionData,
+                                    const std::vector<IndMatch3D2D> &associationIDs,
+                                    const std::vector<voctree::DocMatch> &matchedImages,
+                                    LocalizationResult &localizationResult,
+                                    const std::string& imagePath) const
+{
   geometry::Pose3 pose;
   
   // estimate the pose
@@ -670,7 +724,7 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                                  param._visualDebug + "/" + bfs::path(imagePath).stem().string() + ".associations.svg");
     }
     localizationResult = LocalizationResult(resectionData, associationIDs, pose, queryIntrinsics, matchedImages, bResection);
-    return localizationResult.isValid();
+    return false;
   }
   ALICEVISION_LOG_DEBUG("[poseEstimation]\tResection SUCCEDED");
 
@@ -730,12 +784,79 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                 << " max = " << std::sqrt(sqrErrors.maxCoeff()));
   }
 
-  if(param._nbFrameBufferMatching > 0)
+  return true;
+}
+
+bool VoctreeLocalizer::initLandmarkIndex(const std::string& indexFilepath, std::size_t maxLandmarks)
+{
+  if(!indexFilepath.empty() && boost::filesystem::exists(indexFilepath))
   {
-    // add everything to the buffer
-    _frameBuffer.emplace_back(localizationResult, queryRegions);
+    ALICEVISION_LOG_INFO("Loading the landmark descriptor index: " << indexFilepath);
+    if(_landmarkIndex.load(indexFilepath))
+      return !_landmarkIndex.empty();
+    ALICEVISION_LOG_WARNING("The landmark descriptor index will be rebuilt.");
+  }
+
+  system::Timer timer;
+  _landmarkIndex.build(_sfm_data, _regionsPerView, _reconstructedRegionsMappingPerView, maxLandmarks);
+  ALICEVISION_LOG_INFO("Landmark descriptor index built in " << timer.elapsedMs() << " ms: "
+    << _landmarkIndex.nbLandmarks() << " landmarks, "
+    << _landmarkIndex.descriptorsMemorySize() / (1024.0 * 1024.0) << " MB of descriptors.");
+
+  if(!indexFilepath.empty())
+    _landmarkIndex.save(indexFilepath);
+
+  return !_landmarkIndex.empty();
+}
+
+bool VoctreeLocalizer::localizeLandmarkIndex(const feature::MapRegionsPerDesc &queryRegions,
+                                             const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                             const Parameters &param,
+                                             bool useInputIntrinsics,
+                                             camera::PinholeRadialK3 &queryIntrinsics,
+                                             LocalizationResult &localizationResult,
+                                             const std::string& imagePath)
+{
+  if(_landmarkIndex.empty() && !initLandmarkIndex())
+  {
+    ALICEVISION_LOG_WARNING("[matching]\tNo landmark can be indexed for the localization.");
+    localizationResult = LocalizationResult();
+    return false;
   }
 
+  // a single 2D-3D search for each query feature
+  std::vector<IndMatch3D2D> associationIDs;
+  for(const auto& queryRegionsIt : queryRegions)
+  {
+    if(!_landmarkIndex.hasDescType(queryRegionsIt.first))
+      continue;
+    _landmarkIndex.match(queryRegionsIt.first, *queryRegionsIt.second, param._fDistRatio, associationIDs);
+  }
+  ALICEVISION_LOG_DEBUG("[matching]\tFound " << associationIDs.size() << " 2D-3D associations in the landmark index");
+
+  sfm::ImageLocalizerMatchData resectionData;
+  resectionData.pt2D = Mat2X(2, associationIDs.size());
+  resectionData.pt3D = Mat3X(3, associationIDs.size());
+  resectionData.vec_descType.resize(associationIDs.size());
+
+  for(std::size_t i = 0; i < associationIDs.size(); ++i)
+  {
+    const IndMatch3D2D& association = associationIDs[i];
+    resectionData.pt2D.col(i) = queryRegions.at(association.descType)->GetRegionPosition(association.featId);
+    resectionData.pt3D.col(i) = _sfm_data.getLandmarks().at(association.landmarkId).X;
+    resectionData.vec_descType[i] = association.descType;
+  }
+
+  estimatePose(queryImageSize,
+               param,
+               useInputIntrinsics,
+               queryIntrinsics,
+               resectionData,
+               associationIDs,
+               std::vector<voctree::DocMatch>(),
+               localizationResult,
+               imagePath);
+
   return localizationResult.isValid();
 }
 
@@ -783,115 +904,151 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
   matching::RegionsDatabaseMatcherPerDesc matchers(_matcherType, queryRegions);
 
-  std::map< std::pair<IndexT, IndexT>, std::size_t > repeated;
-  
   // B. for each found similar image, try to find the correspondences between the 
   // query image adn the similar image
-  // stop when param._maxResults successful matches have been found
-  std::size_t goodMatches = 0;
-  for(const voctree::DocMatch& matchedImage : out_matchedImages)
+  // stop when param._maxResults successful matches have been found.
+  // The candidates are matched in parallel and handed out in order of score:
+  // when a candidate starts, all the better ones have already started, so once
+  // param._maxResults of them succeeded no new candidate is needed.
+  const std::size_t nbCandidates = out_matchedImages.size();
+  std::vector<matching::MatchesPerDescType> candidateMatches(nbCandidates);
+  std::vector<char> candidateWorked(nbCandidates, 0);
+  std::atomic<std::size_t> nextCandidate(0);
+  std::atomic<std::size_t> nbWorkedCandidates(0);
+  // first candidate with an unsupported camera, the search stops there as the sequential one
+  std::atomic<std::size_t> unsupportedCandidate(nbCandidates);
+
+  #pragma omp parallel
   {
-    // minimum number of points that allows a reliable 3D reconstruction
-    const size_t minNum3DPoints = 5;
-
-    const auto matchedViewId = matchedImage.id;
-    // the handler to the current view
-    const std::shared_ptr<sfmData::View> matchedView = _sfm_data.views.at(matchedViewId);
-    // its associated reconstructed regions
-    const feature::MapRegionsPerDesc& matchedRegions = _regionsPerView.getRegionsPerDesc(matchedViewId);
-    
-    // safeguard: we should match the query image with an image that has at least
-    // some 3D points visible --> if this is not true it is likely that it is an
-    // image of the dataset that was not reconstructed
-    if(matchedRegions.getNbAllRegions() < minNum3DPoints)
-    {
-      ALICEVISION_LOG_DEBUG("[matching]\tSkipping matching with " << matchedView->getImagePath() << " as it has too few visible 3D points");
-      continue;
-    }
-    ALICEVISION_LOG_TRACE("[matching]\tTrying to match the query image with " << matchedView->getImagePath());
-    ALICEVISION_LOG_TRACE("[matching]\tIt has " << matchedRegions.getNbAllRegions() << " available features to match");
-    
-    // its associated intrinsics
-    // this is just ugly!
-    const camera::IntrinsicBase *matchedIntrinsicsBase = _sfm_data.intrinsics.at(matchedView->getIntrinsicId()).get();
-    if ( !isPinhole(matchedIntrinsicsBase->getType()) )
+    for(;;)
     {
-      //@fixme maybe better to throw something here
-      ALICEVISION_CERR("Only Pinhole cameras are supported!");
-      return;
-    }
-    const camera::Pinhole *matchedIntrinsics = (const camera::Pinhole*)(matchedIntrinsicsBase);
+      if((unsupportedCandidate < nbCandidates) || ((param._maxResults != 0) && (nbWorkedCandidates >= param._maxResults)))
+        break;
 
-    matching::MatchesPerDescType featureMatches;
-    const bool matchWorked = robustMatching(matchers,
-                                      // pass the input intrinsic if they are valid, null otherwise
-                                      (useInputIntrinsics) ? &queryIntrinsics : nullptr,
-                                      matchedRegions,
-                                      matchedIntrinsics,
-                                      param._fDistRatio,
-                                      param._matchingError,
-                                      param._useRobustMatching,
-                                      param._useGuidedMatching,
-                                      imageSize,
-                                      std::make_pair(matchedView->getWidth(), matchedView->getHeight()),
-                                      featureMatches,
-                                      param._matchingEstimator);
-    if (!matchWorked)
-    {
-//      ALICEVISION_LOG_DEBUG("[matching]\tMatching with " << matchedView->getImagePath() << " failed! Skipping image");
-      continue;
-    }
+      const std::size_t candidate = nextCandidate++;
+      if(candidate >= nbCandidates)
+        break;
 
-    ALICEVISION_LOG_DEBUG("[matching]\tFound " << featureMatches.getNbAllMatches() << " geometrically validated matches");
-    assert(featureMatches.getNbAllMatches() > 0);
+      // minimum number of points that allows a reliable 3D reconstruction
+      const size_t minNum3DPoints = 5;
 
-    // if debug is enable save the matches between the query image and the current matching image
-    // It saves the feature matches in a folder with the same name as the query
-    // image, if it does not exist it will create it. The final svg file will have
-    // a name like this: queryImage_matchedImage.svg placed in the following directory:
-    // param._visualDebug/queryImage/
-    if(!param._visualDebug.empty() && !imagePath.empty())
-    {
-      namespace bfs = boost::filesystem;
-      const sfmData::View *mview = _sfm_data.getViews().at(matchedViewId).get();
-      // the current query image without extension
-      const auto queryImage = bfs::path(imagePath).stem();
-      // the matching image without extension
-      const auto matchedImage = bfs::path(mview->getImagePath()).stem();
-      // the full path of the matching image
-      const auto matchedPath = mview->getImagePath();
-
-      // the directory where to save the feature matches
-      const auto baseDir = bfs::path(param._visualDebug) / queryImage;
-      if((!bfs::exists(baseDir)))
+      const auto matchedViewId = out_matchedImages[candidate].id;
+      // the handler to the current view
+      const std::shared_ptr<sfmData::View> matchedView = _sfm_data.views.at(matchedViewId);
+      // its associated reconstructed regions
+      const feature::MapRegionsPerDesc& matchedRegions = _regionsPerView.getRegionsPerDesc(matchedViewId);
+
+      // safeguard: we should match the query image with an image that has at least
+      // some 3D points visible --> if this is not true it is likely that it is an
+      // image of the dataset that was not reconstructed
+      if(matchedRegions.getNbAllRegions() < minNum3DPoints)
       {
-        ALICEVISION_LOG_DEBUG("created " << baseDir.string());
-        bfs::create_directories(baseDir);
+        ALICEVISION_LOG_DEBUG("[matching]\tSkipping matching with " << matchedView->getImagePath() << " as it has too few visible 3D points");
+        continue;
       }
-      
-      // damn you, boost, what does it take to make the operator "+"?
-      // the final filename for the output svg file as a composition of the query
-      // image and the matched image
-      auto outputName = baseDir / queryImage;
-      outputName += "_";
-      outputName += matchedImage;
-      outputName += ".svg";
+      ALICEVISION_LOG_TRACE("[matching]\tTrying to match the query image with " << matchedView->getImagePath());
+      ALICEVISION_LOG_TRACE("[matching]\tIt has " << matchedRegions.getNbAllRegions() << " available features to match");
 
-      feature::saveMatches2SVG(imagePath,
-                                imageSize,
-                                queryRegions,
-                                matchedPath,
-                                std::make_pair(mview->getWidth(), mview->getHeight()),
-                                _regionsPerView.getRegionsPerDesc(matchedViewId),
-                                featureMatches,
-                                outputName.string()); 
+      // its associated intrinsics
+      // this is just ugly!
+      const camera::IntrinsicBase *matchedIntrinsicsBase = _sfm_data.intrinsics.at(matchedView->getIntrinsicId()).get();
+      if ( !isPinhole(matchedIntrinsicsBase->getType()) )
+      {
+        //@fixme maybe better to throw something here
+        ALICEVISION_CERR("Only Pinhole cameras are supported!");
+        // keep the smallest one, the better candidates still running finish their matching
+        std::size_t current = unsupportedCandidate;
+        while(candidate < current && !unsupportedCandidate.compare_exchange_weak(current, candidate));
+        break;
+      }
+      const camera::Pinhole *matchedIntrinsics = (const camera::Pinhole*)(matchedIntrinsicsBase);
+
+      matching::MatchesPerDescType& featureMatches = candidateMatches[candidate];
+      const bool matchWorked = robustMatching(matchers,
+                                        // pass the input intrinsic if they are valid, null otherwise
+                                        (useInputIntrinsics) ? &queryIntrinsics : nullptr,
+                                        matchedRegions,
+                                        matchedIntrinsics,
+                                        param._fDistRatio,
+                                        param._matchingError,
+                                        param._useRobustMatching,
+                                        param._useGuidedMatching,
+                                        imageSize,
+                                        std::make_pair(matchedView->getWidth(), matchedView->getHeight()),
+                                        featureMatches,
+                                        param._matchingEstimator);
+      if (!matchWorked)
+      {
+//        ALICEVISION_LOG_DEBUG("[matching]\tMatching with " << matchedView->getImagePath() << " failed! Skipping image");
+        continue;
+      }
+
+      ALICEVISION_LOG_DEBUG("[matching]\tFound " << featureMatches.getNbAllMatches() << " geometrically validated matches");
+      assert(featureMatches.getNbAllMatches() > 0);
+
+      candidateWorked[candidate] = 1;
+      ++nbWorkedCandidates;
+
+      // if debug is enable save the matches between the query image and the current matching image
+      // It saves the feature matches in a folder with the same name as the query
+      // image, if it does not exist it will create it. The final svg file will have
+      // a name like this: queryImage_matchedImage.svg placed in the following directory:
+      // param._visualDebug/queryImage/
+      if(!param._visualDebug.empty() && !imagePath.empty())
+      {
+        namespace bfs = boost::filesystem;
+        const sfmData::View *mview = _sfm_data.getViews().at(matchedViewId).get();
+        // the current query image without extension
+        const auto queryImage = bfs::path(imagePath).stem();
+        // the matching image without extension
+        const auto matchedImage = bfs::path(mview->getImagePath()).stem();
+        // the full path of the matching image
+        const auto matchedPath = mview->getImagePath();
+
+        // the directory where to save the feature matches
+        const auto baseDir = bfs::path(param._visualDebug) / queryImage;
+        #pragma omp critical(visualDebugDirectory)
+        if((!bfs::exists(baseDir)))
+        {
+          ALICEVISION_LOG_DEBUG("created " << baseDir.string());
+          bfs::create_directories(baseDir);
+        }
+
+        // damn you, boost, what does it take to make the operator "+"?
+        // the final filename for the output svg file as a composition of the query
+        // image and the matched image
+        auto outputName = baseDir / queryImage;
+        outputName += "_";
+        outputName += matchedImage;
+        outputName += ".svg";
+
+        feature::saveMatches2SVG(imagePath,
+                                  imageSize,
+                                  queryRegions,
+                                  matchedPath,
+                                  std::make_pair(mview->getWidth(), mview->getHeight()),
+                                  _regionsPerView.getRegionsPerDesc(matchedViewId),
+                                  featureMatches,
+                                  outputName.string());
+      }
     }
+  }
 
-    const auto& matchedRegionsMapping = _reconstructedRegionsMappingPerView.at(matchedViewId);
+  // C. recover the 2D-3D associations from the matches, in order of score
+  std::size_t goodMatches = 0;
+  for(std::size_t candidate = 0; candidate < nbCandidates; ++candidate)
+  {
+    // unsupported camera: return the associations of the previous candidates
+    if(candidate == unsupportedCandidate)
+      return;
+
+    if(!candidateWorked[candidate])
+      continue;
+
+    const auto& matchedRegionsMapping = _reconstructedRegionsMappingPerView.at(out_matchedImages[candidate].id);
 
-    // C. recover the 2D-3D associations from the matches 
     // Each matched feature in the current similar image is associated to a 3D point
-    for(const auto& featureMatchesIt : featureMatches)
+    for(const auto& featureMatchesIt : candidateMatches[candidate])
     {
       feature::EImageDescriberType descType = featureMatchesIt.first;
       const auto& matchedRegionsMappingType = matchedRegionsMapping.at(descType);
@@ -902,14 +1059,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
         const IndexT pt2D_id = featureMatch._i;
 
         const OccurenceKey key(pt3D_id, descType, pt2D_id);
-        if(out_occurences.count(key))
-        {
-          out_occurences[key]++;
-        }
-        else
-        {
-          out_occurences[key] = 1;
-        }
+        ++out_occurences[key];
       }
     }
     ++goodMatches;
@@ -975,7 +1125,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   
 }
 
-void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc & matchers,
+void VoctreeLocalizer::getAssociationsFromBuffer(const matching::RegionsDatabaseMatcherPerDesc & matchers,
                                                  const std::pair<std::size_t, std::size_t> & queryImageSize,
                                                  const Parameters &param,
                                                  bool useInputIntrinsics,
@@ -1047,7 +1197,7 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
   }
 }
 
-bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
+bool VoctreeLocalizer::robustMatching(const matching::RegionsDatabaseMatcherPerDesc & matchers,
                                       const camera::IntrinsicBase * queryIntrinsicsBase,   // the intrinsics of the image we are using as reference
                                       const feature::MapRegionsPerDesc & matchedRegions,
                                       const camera::IntrinsicBase * matchedIntrinsicsBase,
@@ -19,6 +19,7 @@
 #include <aliceVision/localization/LocalizationResult.hpp>
 #include <aliceVision/localization/ILocalizer.hpp>
 #include <aliceVision/localization/BoundedBuffer.hpp>
+#include <aliceVision/localization/LandmarkDescriptorIndex.hpp>
 
 #include <flann/algorithms/dist.h>
 
@@ -37,7 +38,7 @@ struct FrameData
 class VoctreeLocalizer : public ILocalizer
 {
 public:
-  enum Algorithm : int {FirstBest=0, BestResult=1, AllResults=2, Cluster=3};
+  enum Algorithm : int {FirstBest=0, BestResult=1, AllResults=2, Cluster=3, LandmarkIndex=4};
   static Algorithm initFromString(const std::string &value);
   
 public:
@@ -107,6 +108,11 @@ public:
       _cudaPipe = i;
   }
   
+  void extractRegions(const image::Image<float> & imageGrey,
+                      const LocalizerParameters *param,
+                      feature::MapRegionsPerDesc & queryRegions,
+                      const std::string& imagePath = std::string()) override;
+
   /**
    * @brief Just a wrapper around the different localization algorithm, the algorithm
    * used to localized is chosen using \p param._algorithm. This version extract the
@@ -237,8 +243,46 @@ public:
                           const std::string& imagePath = std::string());
   
   
+  /**
+   * @brief Try to localize an image with a direct 2D-3D search: each query feature is
+   * matched against the landmark descriptor index, without image retrieval. The index is
+   * built with the default settings if initLandmarkIndex() has not been called.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera, they are used if the
+   * flag useInputIntrinsics is set to true, otherwise they are estimated from the correspondences.
+   * @param[out] localizationResult The localization result containing the pose and the associations.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the localization is successful
+   */
+  bool localizeLandmarkIndex(const feature::MapRegionsPerDesc & queryRegions,
+                             const std::pair<std::size_t, std::size_t> & imageSize,
+                             const Parameters &param,
+                             bool useInputIntrinsics,
+                             camera::PinholeRadialK3 &queryIntrinsics,
+                             LocalizationResult &localizationResult,
+                             const std::string& imagePath = std::string());
+
+  /**
+   * @brief Initialize the landmark descriptor index used by the LandmarkIndex algorithm.
+   * The index is loaded from \p indexFilepath if the file exists, otherwise it is built
+   * from the reconstructed regions and saved to \p indexFilepath (if not empty).
+   *
+   * @param[in] indexFilepath Optional path to the index file.
+   * @param[in] maxLandmarks The maximum number of indexed landmarks per describer type, the
+   * most visible ones are kept (0 = all).
+   * @return true if the index is available
+   */
+  bool initLandmarkIndex(const std::string& indexFilepath = std::string(), std::size_t maxLandmarks = 0);
+
   /**
    * @brief Retrieve matches to all images of the database.
+   * The candidate images are matched in parallel, new candidates are no longer
+   * started once \p param._maxResults candidates with a better score have been
+   * successfully matched. The associations are the ones of the sequential search.
    *
    * @param[in] queryRegions
    * @param[in] imageSize
@@ -298,7 +342,7 @@ private:
    * @param[in] estimator
    * @return
    */
-  bool robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
+  bool robustMatching(const matching::RegionsDatabaseMatcherPerDesc & matchers,
                       const camera::IntrinsicBase * queryIntrinsics,// the intrinsics of the image we are using as reference
                       const feature::MapRegionsPerDesc & regionsToMatch,
                       const camera::IntrinsicBase * matchedIntrinsics,
@@ -311,7 +355,31 @@ private:
                       matching::MatchesPerDescType & out_featureMatches,
                       robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC) const;
   
-  void getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc& matchers,
+  /**
+   * @brief Estimate and refine the camera pose from the collected 2D-3D correspondences
+   *
+   * @param[in] queryImageSize The size of the query image
+   * @param[in] param The parameters for the localization
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera
+   * @param[in,out] resectionData The 2D-3D correspondences, completed with the resection inliers
+   * @param[in] associationIDs The ids of the 2D-3D correspondences
+   * @param[in] matchedImages The database images used to collect the correspondences
+   * @param[out] localizationResult The localization result
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the resection succeeded
+   */
+  bool estimatePose(const std::pair<std::size_t, std::size_t> & queryImageSize,
+                    const Parameters &param,
+                    bool useInputIntrinsics,
+                    camera::PinholeRadialK3 &queryIntrinsics,
+                    sfm::ImageLocalizerMatchData &resectionData,
+                    const std::vector<IndMatch3D2D> &associationIDs,
+                    const std::vector<voctree::DocMatch> &matchedImages,
+                    LocalizationResult &localizationResult,
+                    const std::string& imagePath) const;
+
+  void getAssociationsFromBuffer(const matching::RegionsDatabaseMatcherPerDesc& matchers,
                                  const std::pair<std::size_t, std::size_t> & imageSize,
                                  const Parameters &param,
                                  bool useInputIntrinsics,
@@ -354,6 +422,9 @@ public:
   /// Last frames buffer
   BoundedBuffer<FrameData> _frameBuffer;
 
+  /// compact descriptor index over all the reconstructed landmarks
+  LandmarkDescriptorIndex _landmarkIndex;
+
   matching::EMatcherType _matcherType = matching::ANN_L2;
 };
 
@@ -248,13 +248,17 @@ public:
     }
   }
 
+  /**
+   * @brief Match the given regions to the database regions of each describer type.
+   * The database is not modified, it can be matched concurrently.
+   */
   bool Match(
     float distRatio,
     const feature::MapRegionsPerDesc & matchedRegions,
-    matching::MatchesPerDescType & out_putativeFeatureMatches)
+    matching::MatchesPerDescType & out_putativeFeatureMatches) const
   {
     bool res = false;
-    for(auto& matcherIt: _mapMatchers)
+    for(const auto& matcherIt: _mapMatchers)
     {
       const feature::EImageDescriberType descType = matcherIt.first;
       res |= matcherIt.second.Match(
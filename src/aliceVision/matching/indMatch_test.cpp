@@ -107,6 +107,69 @@ BOOST_AUTO_TEST_CASE(IndMatch_IO)
   boost::filesystem::remove_all(testFolder);
 }
 
+BOOST_AUTO_TEST_CASE(IndMatch_IncrementalWriter)
+{
+  const std::string testFolder = "matchingWriterTest";
+  const std::set<IndexT> viewsKeys = {0, 1, 2};
+
+  for(const bool matchFilePerImage : {false, true})
+  {
+    boost::filesystem::create_directory(testFolder);
+    {
+      MatchesWriter writer(testFolder, "txt", matchFilePerImage);
+
+      MatchesPerDescType matches12;
+      matches12[EImageDescriberType::UNKNOWN] = {{0,0},{1,1}, {2,2}};
+      writer.write(std::make_pair(1,2), matches12);
+
+      MatchesPerDescType matches01;
+      matches01[EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+      writer.write(std::make_pair(0,1), matches01);
+
+      MatchesPerDescType matches02;
+      matches02[EImageDescriberType::UNKNOWN] = {{3,3}};
+      writer.write(std::make_pair(0,2), matches02);
+
+      // nothing is visible before the writer is closed
+      PairwiseMatches matches;
+      BOOST_CHECK(!Load(matches, viewsKeys, {testFolder}, {}) || matches.empty());
+
+      writer.close();
+    }
+
+    PairwiseMatches matches;
+    BOOST_CHECK(Load(matches, viewsKeys, {testFolder}, {EImageDescriberType::UNKNOWN}));
+    BOOST_CHECK_EQUAL(3, matches.size());
+    BOOST_CHECK_EQUAL(2, matches.at(std::make_pair(0,1)).at(EImageDescriberType::UNKNOWN).size());
+    BOOST_CHECK_EQUAL(3, matches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN).size());
+    BOOST_CHECK_EQUAL(1, matches.at(std::make_pair(0,2)).at(EImageDescriberType::UNKNOWN).size());
+
+    boost::filesystem::remove_all(testFolder);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(IndMatch_IncrementalWriter_NotClosed)
+{
+  const std::string testFolder = "matchingWriterNotClosedTest";
+
+  for(const bool matchFilePerImage : {false, true})
+  {
+    boost::filesystem::create_directory(testFolder);
+    {
+      MatchesWriter writer(testFolder, "txt", matchFilePerImage);
+
+      MatchesPerDescType matches01;
+      matches01[EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+      writer.write(std::make_pair(0,1), matches01);
+    }
+
+    // a writer destroyed without close() leaves no file
+    BOOST_CHECK(boost::filesystem::is_empty(testFolder));
+
+    boost::filesystem::remove_all(testFolder);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval_NoRemoval)
 {
   std::vector<IndMatch> vec_indMatch;
@@ -281,6 +281,20 @@ bool Load(
 }
 
 
+/**
+ * @brief Write the matches of an image pair in the text format read by LoadMatchFile.
+ */
+static void writeMatchesTxt(std::ostream& stream, const Pair& pair, const MatchesPerDescType& matchesPerDesc)
+{
+  stream << pair.first << " " << pair.second << '\n'
+         << matchesPerDesc.size() << '\n';
+  for(const auto& m: matchesPerDesc)
+  {
+    stream << feature::EImageDescriberType_enumToString(m.first) << " " << m.second.size() << '\n';
+    copy(m.second.begin(), m.second.end(), std::ostream_iterator<IndMatch>(stream, "\n"));
+  }
+}
+
 class MatchExporter
 {
 private:
@@ -299,16 +313,7 @@ private:
         match != matchEnd;
         ++match)
       {
-        const std::size_t I = match->first.first;
-        const std::size_t J = match->first.second;
-        const MatchesPerDescType & matchesPerDesc = match->second;
-        stream << I << " " << J << '\n'
-               << matchesPerDesc.size() << '\n';
-        for(const auto& m: matchesPerDesc)
-        {
-          stream << feature::EImageDescriberType_enumToString(m.first) << " " << m.second.size() << '\n';
-          copy(m.second.begin(), m.second.end(), std::ostream_iterator<IndMatch>(stream, "\n"));
-        }
+        writeMatchesTxt(stream, match->first, match->second);
       }
     }
 
@@ -395,5 +400,92 @@ bool Save(
   return true;
 }
 
+MatchesWriter::MatchesWriter(const std::string& folder,
+                             const std::string& extension,
+                             bool matchFilePerImage,
+                             const std::string& prefix)
+  : _folder(folder)
+  , _filename(prefix + "matches." + extension)
+  , _matchFilePerImage(matchFilePerImage)
+{
+  if(fs::extension(_filename) != ".txt")
+    throw std::runtime_error(std::string("Unknown matching file format: ") + fs::extension(_filename));
+
+  if(!_matchFilePerImage)
+    _globalStream.reset(new std::ofstream(getTemporaryPath(getFilePath(UndefinedIndexT)), std::ios::out));
+}
+
+MatchesWriter::~MatchesWriter()
+{
+  if(_closed)
+    return;
+
+  // the writer has not been closed (failure or early exit): discard the partial matches
+  if(_globalStream)
+    _globalStream->close();
+
+  for(const auto& tmpPath : _temporaryPaths)
+  {
+    boost::system::error_code ec;
+    fs::remove(tmpPath.second, ec);
+    if(ec)
+      ALICEVISION_LOG_WARNING("Failed to remove the temporary match file '" << tmpPath.second << "': " << ec.message());
+  }
+}
+
+void MatchesWriter::write(const Pair& pair, const MatchesPerDescType& matches)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if(_closed)
+    throw std::runtime_error("Can't write matches in a closed MatchesWriter.");
+
+  if(_globalStream)
+  {
+    writeMatchesTxt(*_globalStream, pair, matches);
+    return;
+  }
+
+  // one file per image: files are reopened for each pair to avoid keeping a file handle per image
+  const std::string& tmpPath = getTemporaryPath(getFilePath(pair.first));
+  std::ofstream stream(tmpPath.c_str(), std::ios::out | std::ios::app);
+  writeMatchesTxt(stream, pair, matches);
+}
+
+void MatchesWriter::close()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if(_closed)
+    return;
+  _closed = true;
+
+  if(_globalStream)
+    _globalStream->close();
+
+  // rename temporary files
+  for(const auto& tmpPath : _temporaryPaths)
+    fs::rename(tmpPath.second, tmpPath.first);
+}
+
+std::string MatchesWriter::getFilePath(IndexT viewId) const
+{
+  if(viewId == UndefinedIndexT)
+    return (fs::path(_folder) / _filename).string();
+  return (fs::path(_folder) / (std::to_string(viewId) + "." + _filename)).string();
+}
+
+const std::string& MatchesWriter::getTemporaryPath(const std::string& filepath)
+{
+  auto it = _temporaryPaths.find(filepath);
+  if(it == _temporaryPaths.end())
+  {
+    const fs::path bPath = fs::path(filepath);
+    const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
+    it = _temporaryPaths.emplace(filepath, tmpPath).first;
+  }
+  return it->second;
+}
+
 }  // namespace matching
 }  // namespace aliceVision
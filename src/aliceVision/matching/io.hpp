@@ -9,6 +9,10 @@
 
 #include <aliceVision/matching/IndMatch.hpp>
 
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 namespace aliceVision {
@@ -84,5 +88,57 @@ bool Save(
   bool matchFilePerImage,
   const std::string& prefix="");
 
+/**
+ * @brief Write match files incrementally, pair by pair, with the same layout as Save.
+ * @details write() can be called from several threads. The matches are written into
+ *          temporary files which are only renamed by an explicit call to close(), so an
+ *          interrupted process never publishes partial match files.
+ */
+class MatchesWriter
+{
+public:
+  /**
+   * @param[in] folder: folder containing the match files
+   * @param[in] extension: file format (only txt is supported)
+   * @param[in] matchFilePerImage: do we store a global match file
+   *            or one match file per image
+   * @param[in] prefix: optional prefix for the output file(s)
+   */
+  MatchesWriter(const std::string& folder,
+                const std::string& extension,
+                bool matchFilePerImage,
+                const std::string& prefix = "");
+
+  /// discard the temporary files if the writer has not been closed
+  ~MatchesWriter();
+
+  /**
+   * @brief Append the matches of an image pair.
+   * @param[in] pair: the image pair
+   * @param[in] matches: the matches of the image pair
+   */
+  void write(const Pair& pair, const MatchesPerDescType& matches);
+
+  /**
+   * @brief Flush the written matches into the final match files.
+   * @note Must be called once all the matches are written, otherwise nothing is published.
+   */
+  void close();
+
+private:
+  std::string getFilePath(IndexT viewId) const;
+  const std::string& getTemporaryPath(const std::string& filepath);
+
+  const std::string _folder;
+  const std::string _filename;
+  const bool _matchFilePerImage;
+
+  /// temporary path per final path
+  std::map<std::string, std::string> _temporaryPaths;
+  std::unique_ptr<std::ofstream> _globalStream;
+  std::mutex _mutex;
+  bool _closed = false;
+};
+
 }  // namespace matching
 }  // namespace aliceVision
@@ -12,6 +12,7 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 
 #include <boost/progress.hpp>
 
@@ -23,6 +24,48 @@ namespace matchingImageCollection {
 
 using namespace aliceVision::matching;
 
+/**
+ * @brief Perform robust model estimation (with optional guided_matching)
+ * for one pair and its regions correspondences.
+ * Allow to keep only geometrically coherent matches.
+ * @param[out] out_inliers
+ * @param[in] sfmData
+ * @param[in] regionsPerView
+ * @param[in] functor
+ * @param[in] imagePair
+ * @param[in] putativeMatchesPerType
+ * @param[in] guidedMatching
+ * @param[in] distanceRatio
+ * @return true if the pair leads to a valid robust model estimation
+ */
+template<typename GeometryFunctor>
+bool robustModelEstimation(
+  MatchesPerDescType& out_inliers,
+  const sfmData::SfMData* sfmData,
+  const feature::RegionsPerView& regionsPerView,
+  const GeometryFunctor& functor,
+  const Pair& imagePair,
+  const MatchesPerDescType& putativeMatchesPerType,
+  const bool guidedMatching = false,
+  const double distanceRatio = 0.6)
+{
+  out_inliers.clear();
+
+  GeometryFunctor geometricFilter = functor; // use a copy since we may be in a multi-thread context
+  const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, out_inliers);
+  if(!state.hasStrongSupport)
+    return false;
+
+  if(guidedMatching)
+  {
+    MatchesPerDescType guidedGeometricInliers;
+    geometricFilter.Geometry_guided_matching(sfmData, regionsPerView, imagePair, distanceRatio, guidedGeometricInliers);
+    //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
+    std::swap(out_inliers, guidedGeometricInliers);
+  }
+  return true;
+}
+
 /**
  * @brief Perform robust model estimation (with optional guided_matching)
  * or all the pairs and regions correspondences contained in the putativeMatches set.
@@ -58,28 +101,16 @@ void robustModelEstimation(
 
     const Pair currentPair = iter->first;
     const MatchesPerDescType& putativeMatchesPerType = iter->second;
-    const Pair& imagePair = iter->first;
+
+    ALICEVISION_PERF_ZONE("matching.geometricFilter");
 
     // apply the geometric filter (robust model estimation)
+    MatchesPerDescType inliers;
+    if(robustModelEstimation(inliers, sfmData, regionsPerView, functor, currentPair, putativeMatchesPerType, guidedMatching, distanceRatio))
     {
-      MatchesPerDescType inliers;
-      GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
-      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, inliers);
-      if(state.hasStrongSupport)
-      {
-        if(guidedMatching)
-        {
-          MatchesPerDescType guidedGeometricInliers;
-          geometricFilter.Geometry_guided_matching(sfmData, regionsPerView, imagePair, distanceRatio, guidedGeometricInliers);
-          //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
-          std::swap(inliers, guidedGeometricInliers);
-        }
-
 #pragma omp critical
-        {
-          out_geometricMatches.emplace(currentPair, std::move(inliers));
-        }
-
+      {
+        out_geometricMatches.emplace(currentPair, std::move(inliers));
       }
     }
 
@@ -160,7 +160,7 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
       Mat3 F;
       FundamentalFromEssential(m_E, ptrPinhole_I->K(), ptrPinhole_J->K(), &F);
 
-      robustEstimation::GuidedMatching<Mat3,
+      robustEstimation::GuidedMatching_Fundamental_Grid<
             aliceVision::fundamental::kernel::EpipolarDistanceError>(
             //aliceVision::fundamental::kernel::SymmetricEpipolarDistanceError>(
         F,
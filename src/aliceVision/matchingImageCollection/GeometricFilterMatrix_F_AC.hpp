@@ -253,7 +253,7 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
           sfmData->getIntrinsics().at(view_J->getIntrinsicId()).get() : nullptr;
 
       // Check the features correspondences that agree in the geometric and photometric domain
-      robustEstimation::GuidedMatching<Mat3,
+      robustEstimation::GuidedMatching_Fundamental_Grid<
                                      fundamental::kernel::EpipolarDistanceError>(
         m_F,
         cam_I, // camera::IntrinsicBase
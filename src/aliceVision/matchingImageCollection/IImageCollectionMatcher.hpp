@@ -38,6 +38,35 @@ class IImageCollectionMatcher
     feature::EImageDescriberType descType,
     matching::PairwiseMatches & map_putatives_matches // the output pairwise photometric corresponding points
     ) const = 0;
+
+  /**
+   * @brief Build the data shared by all the pairs of a collection (e.g. hashed descriptors),
+   *        so that the next Match calls on subsets of these pairs give the same results as a single call.
+   * @details Does nothing by default: the other matchers only need the pairs given to Match.
+   */
+  virtual void prepare(
+    const feature::RegionsPerView& regionsPerView,
+    const PairSet & pairs,
+    feature::EImageDescriberType descType)
+  {}
+
+  /// Release the data built by prepare
+  virtual void release()
+  {}
+
+  /// Enable or disable the progress display (disabled when matching small sets of pairs concurrently)
+  void setDisplayProgress(bool displayProgress)
+  {
+    _displayProgress = displayProgress;
+  }
+
+  bool getDisplayProgress() const
+  {
+    return _displayProgress;
+  }
+
+protected:
+  bool _displayProgress = true;
 };
 
 } // namespace aliceVision
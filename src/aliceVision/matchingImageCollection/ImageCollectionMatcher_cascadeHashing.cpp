@@ -29,34 +29,26 @@ ImageCollectionMatcher_cascadeHashing
 
 namespace impl
 {
+/**
+ * @brief Hash the descriptors of a set of views
+ * @param[in] regionsPerView The regions of the views
+ * @param[in] used_index The views to hash
+ * @param[in] descType The describer type
+ * @param[out] collection The hasher and the hashed descriptors of each view
+ */
 template <typename ScalarT>
-void Match
+void HashCollection
 (
   const feature::RegionsPerView& regionsPerView,
-  const PairSet & pairs,
+  const std::set<IndexT>& used_index,
   EImageDescriberType descType,
-  float fDistRatio,
-  PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
+  ImageCollectionMatcher_cascadeHashing::HashedCollection& collection
 )
 {
-  boost::progress_display my_progress_bar( pairs.size() );
-
-  // Collect used view indexes
-  std::set<IndexT> used_index;
-  // Sort pairs according the first index to minimize later memory swapping
-  typedef std::map<IndexT, std::vector<IndexT> > Map_vectorT;
-  Map_vectorT map_Pairs;
-  for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
-  {
-    map_Pairs[iter->first].push_back(iter->second);
-    used_index.insert(iter->first);
-    used_index.insert(iter->second);
-  }
-
   typedef Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
 
   // Init the cascade hasher
-  CascadeHasher cascade_hasher;
+  CascadeHasher& cascade_hasher = collection.hasher;
   if (!used_index.empty())
   {
     const IndexT I = *used_index.begin();
@@ -65,7 +57,7 @@ void Match
     cascade_hasher.Init(dimension);
   }
 
-  std::map<IndexT, HashedDescriptions> hashed_base_;
+  std::map<IndexT, HashedDescriptions>& hashed_base_ = collection.hashedDescriptions;
 
   // Compute the zero mean descriptor that will be used for hashing (one for all the image regions)
   Eigen::VectorXf zero_mean_descriptor;
@@ -114,6 +106,45 @@ void Match
       hashed_base_[I] = std::move(hashed_description);
     }
   }
+}
+
+template <typename ScalarT>
+void Match
+(
+  const feature::RegionsPerView& regionsPerView,
+  const PairSet & pairs,
+  EImageDescriberType descType,
+  float fDistRatio,
+  const ImageCollectionMatcher_cascadeHashing::HashedCollection* preparedCollection,
+  PairwiseMatches & map_PutativesMatches, // the pairwise photometric corresponding points
+  std::ostream& progressStream
+)
+{
+  boost::progress_display my_progress_bar( pairs.size(), progressStream );
+
+  // Collect used view indexes
+  std::set<IndexT> used_index;
+  // Sort pairs according the first index to minimize later memory swapping
+  typedef std::map<IndexT, std::vector<IndexT> > Map_vectorT;
+  Map_vectorT map_Pairs;
+  for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
+  {
+    map_Pairs[iter->first].push_back(iter->second);
+    used_index.insert(iter->first);
+    used_index.insert(iter->second);
+  }
+
+  typedef Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+
+  // Use the hashed descriptors of the whole collection if they are prepared,
+  // otherwise hash the views of these pairs
+  ImageCollectionMatcher_cascadeHashing::HashedCollection localCollection;
+  if (preparedCollection == nullptr)
+    HashCollection<ScalarT>(regionsPerView, used_index, descType, localCollection);
+  const ImageCollectionMatcher_cascadeHashing::HashedCollection& collection =
+    (preparedCollection != nullptr) ? *preparedCollection : localCollection;
+  const CascadeHasher& cascade_hasher = collection.hasher;
+  const std::map<IndexT, HashedDescriptions>& hashed_base_ = collection.hashedDescriptions;
 
   // Perform matching between all the pairs
   for (Map_vectorT::const_iterator iter = map_Pairs.begin();
@@ -160,8 +191,8 @@ void Match
 
       // Match the query descriptors to the database
       cascade_hasher.Match_HashedDescriptions<BaseMat, ResultType>(
-        hashed_base_[J], mat_J,
-        hashed_base_[I], mat_I,
+        hashed_base_.at(J), mat_J,
+        hashed_base_.at(I), mat_I,
         &pvec_indices, &pvec_distances);
 
       std::vector<int> vec_nn_ratio_idx;
@@ -207,6 +238,41 @@ void Match
 }
 } // namespace impl
 
+void ImageCollectionMatcher_cascadeHashing::prepare
+(
+  const feature::RegionsPerView& regionsPerView,
+  const PairSet & pairs,
+  feature::EImageDescriberType descType
+)
+{
+  _hashedCollections.erase(descType);
+
+  if (regionsPerView.isEmpty())
+    return;
+
+  const feature::Regions& regions = regionsPerView.getFirstViewRegions(descType);
+
+  if (regions.IsBinary())
+    return;
+
+  std::set<IndexT> used_index;
+  for (const Pair& pair : pairs)
+  {
+    used_index.insert(pair.first);
+    used_index.insert(pair.second);
+  }
+
+  if(regions.Type_id() == typeid(unsigned char).name())
+    impl::HashCollection<unsigned char>(regionsPerView, used_index, descType, _hashedCollections[descType]);
+  else if(regions.Type_id() == typeid(float).name())
+    impl::HashCollection<float>(regionsPerView, used_index, descType, _hashedCollections[descType]);
+}
+
+void ImageCollectionMatcher_cascadeHashing::release()
+{
+  _hashedCollections.clear();
+}
+
 void ImageCollectionMatcher_cascadeHashing::Match
 (
   const feature::RegionsPerView& regionsPerView,
@@ -227,6 +293,12 @@ void ImageCollectionMatcher_cascadeHashing::Match
   if (regions.IsBinary())
     return;
 
+  std::ostream nullStream(nullptr);
+  std::ostream& progressStream = _displayProgress ? std::cout : nullStream;
+
+  const auto preparedIt = _hashedCollections.find(descType);
+  const HashedCollection* preparedCollection = (preparedIt != _hashedCollections.end()) ? &preparedIt->second : nullptr;
+
   if(regions.Type_id() == typeid(unsigned char).name())
   {
     impl::Match<unsigned char>(
@@ -234,7 +306,9 @@ void ImageCollectionMatcher_cascadeHashing::Match
       pairs,
       descType,
       f_dist_ratio_,
-      map_PutativesMatches);
+      preparedCollection,
+      map_PutativesMatches,
+      progressStream);
   }
   else
   if(regions.Type_id() == typeid(float).name())
@@ -244,7 +318,9 @@ void ImageCollectionMatcher_cascadeHashing::Match
       pairs,
       descType,
       f_dist_ratio_,
-      map_PutativesMatches);
+      preparedCollection,
+      map_PutativesMatches,
+      progressStream);
   }
   else
   {
@@ -8,6 +8,9 @@
 #pragma once
 
 #include "aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp"
+#include "aliceVision/matching/CascadeHasher.hpp"
+
+#include <map>
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -37,9 +40,27 @@ class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
     matching::PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
   ) const;
 
+  /// Hash the descriptors of all the views of the pairs once, for the next Match calls on subsets of the pairs
+  void prepare(
+    const feature::RegionsPerView& regionsPerView,
+    const PairSet & pairs,
+    feature::EImageDescriberType descType) override;
+
+  /// Release the hashed descriptors
+  void release() override;
+
+  /// Cascade hasher and hashed descriptors of each view
+  struct HashedCollection
+  {
+    matching::CascadeHasher hasher;
+    std::map<IndexT, matching::HashedDescriptions> hashedDescriptions;
+  };
+
   private:
   // Distance ratio used to discard spurious correspondence
   float f_dist_ratio_;
+  /// hashed descriptors of the collection, per describer type
+  std::map<feature::EImageDescriberType, HashedCollection> _hashedCollections;
 };
 
 } // namespace aliceVision
@@ -41,7 +41,8 @@ void ImageCollectionMatcher_generic::Match(
   const bool b_multithreaded_pair_search = (_matcherType == CASCADE_HASHING_L2);
   // -> set to true for CASCADE_HASHING_L2, since OpenMP instructions are not used in this matcher
 
-  boost::progress_display my_progress_bar( pairs.size() );
+  std::ostream nullStream(nullptr);
+  boost::progress_display my_progress_bar( pairs.size(), _displayProgress ? std::cout : nullStream );
 
   // Sort pairs according the first index to minimize the MatcherT build operations
   typedef std::map<size_t, std::vector<size_t> > Map_vectorT;
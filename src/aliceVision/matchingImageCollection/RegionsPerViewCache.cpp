@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsPerViewCache.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/// number of threads loading the regions files, as in sfm::loadRegionsPerView:
+/// the loading is mostly bound by the disk reads, a few threads are enough to overlap them with the parsing
+const int nbLoadingThreads = 3;
+
+RegionsPerViewCache::RegionsPerViewCache(const RegionsLoader& loader,
+                                         const std::vector<feature::EImageDescriberType>& descTypes,
+                                         const std::map<IndexT, std::size_t>& memoryPerView,
+                                         std::size_t maxMemory)
+  : _loader(loader)
+  , _descTypes(descTypes)
+  , _memoryPerView(memoryPerView)
+  , _maxMemory(maxMemory)
+{}
+
+void RegionsPerViewCache::request(const std::set<IndexT>& viewIds)
+{
+  // requested views already in the cache become the most recently used ones
+  std::list<IndexT> requestedCachedViews;
+  for(auto it = _cachedViews.begin(); it != _cachedViews.end();)
+  {
+    auto nextIt = std::next(it);
+    if(viewIds.count(*it))
+      requestedCachedViews.splice(requestedCachedViews.end(), _cachedViews, it);
+    it = nextIt;
+  }
+
+  std::vector<IndexT> missingViews;
+  std::size_t missingMemory = 0;
+  for(const IndexT viewId : viewIds)
+  {
+    if(_regionsPerView.viewExist(viewId))
+      continue;
+    missingViews.push_back(viewId);
+    missingMemory += getViewMemorySize(viewId);
+  }
+
+  // evict the least recently used views which are not requested
+  while(!_cachedViews.empty() && _memorySize + missingMemory > _maxMemory)
+  {
+    const IndexT viewId = _cachedViews.front();
+    _cachedViews.pop_front();
+    _regionsPerView.getData().erase(viewId);
+    _memorySize -= getViewMemorySize(viewId);
+    ++_nbEvictions;
+  }
+
+  _cachedViews.splice(_cachedViews.end(), requestedCachedViews);
+
+  if(_memorySize + missingMemory > _maxMemory)
+    ALICEVISION_LOG_WARNING("The regions of the " << viewIds.size() << " requested views exceed the memory budget ("
+                            << (_memorySize + missingMemory) << " / " << _maxMemory << " bytes).");
+
+  std::string errorMessage;
+
+  #pragma omp parallel for num_threads(nbLoadingThreads)
+  for(int i = 0; i < static_cast<int>(missingViews.size()); ++i)
+  {
+    const IndexT viewId = missingViews.at(i);
+
+    for(const feature::EImageDescriberType descType : _descTypes)
+    {
+      std::unique_ptr<feature::Regions> regionsPtr;
+      try
+      {
+        regionsPtr = _loader(viewId, descType);
+      }
+      catch(const std::exception& e)
+      {
+        #pragma omp critical
+        errorMessage = e.what();
+      }
+
+      #pragma omp critical
+      {
+        if(regionsPtr)
+          _regionsPerView.addRegions(viewId, descType, regionsPtr.release());
+        else if(errorMessage.empty())
+          errorMessage = "Can't load the regions of the view " + std::to_string(viewId);
+      }
+    }
+  }
+
+  if(!errorMessage.empty())
+    throw std::runtime_error(errorMessage);
+
+  _cachedViews.insert(_cachedViews.end(), missingViews.begin(), missingViews.end());
+  _memorySize += missingMemory;
+  _peakMemorySize = std::max(_peakMemorySize, _memorySize);
+  _nbLoads += missingViews.size();
+}
+
+std::size_t RegionsPerViewCache::getViewMemorySize(IndexT viewId) const
+{
+  const auto memoryIt = _memoryPerView.find(viewId);
+  return (memoryIt != _memoryPerView.end()) ? memoryIt->second : 0;
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
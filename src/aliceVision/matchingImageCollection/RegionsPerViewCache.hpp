@@ -0,0 +1,90 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Working set of view regions under a memory budget.
+ * @details Used to match datasets whose regions don't fit in memory: the regions of the requested views
+ *          are loaded on demand and the least recently used views are evicted when the budget is exceeded.
+ */
+class RegionsPerViewCache
+{
+public:
+  /// load the regions of a view for a describer type
+  using RegionsLoader = std::function<std::unique_ptr<feature::Regions>(IndexT viewId, feature::EImageDescriberType descType)>;
+
+  /**
+   * @brief RegionsPerViewCache constructor
+   * @param[in] loader The regions loader
+   * @param[in] descTypes The describer types to load for each view
+   * @param[in] memoryPerView The estimated memory size of the regions of each view
+   * @param[in] maxMemory The memory budget
+   */
+  RegionsPerViewCache(const RegionsLoader& loader,
+                      const std::vector<feature::EImageDescriberType>& descTypes,
+                      const std::map<IndexT, std::size_t>& memoryPerView,
+                      std::size_t maxMemory);
+
+  /**
+   * @brief Load the regions of the requested views which are not in the cache.
+   * @details The other views are evicted, least recently used first, while the budget is exceeded.
+   * @param[in] viewIds The requested views
+   */
+  void request(const std::set<IndexT>& viewIds);
+
+  /**
+   * @brief Get the regions of the views in the cache
+   * @return RegionsPerView
+   */
+  const feature::RegionsPerView& getRegionsPerView() const
+  {
+    return _regionsPerView;
+  }
+
+  /// estimated memory size of the views in the cache
+  std::size_t getMemorySize() const { return _memorySize; }
+  /// maximum estimated memory size of the views in the cache
+  std::size_t getPeakMemorySize() const { return _peakMemorySize; }
+  /// number of views loaded since the creation of the cache
+  std::size_t getNbLoads() const { return _nbLoads; }
+  /// number of views evicted since the creation of the cache
+  std::size_t getNbEvictions() const { return _nbEvictions; }
+
+private:
+  std::size_t getViewMemorySize(IndexT viewId) const;
+
+  RegionsLoader _loader;
+  std::vector<feature::EImageDescriberType> _descTypes;
+  std::map<IndexT, std::size_t> _memoryPerView;
+  std::size_t _maxMemory;
+
+  feature::RegionsPerView _regionsPerView;
+  /// views in the cache, least recently used first
+  std::list<IndexT> _cachedViews;
+
+  std::size_t _memorySize = 0;
+  std::size_t _peakMemorySize = 0;
+  std::size_t _nbLoads = 0;
+  std::size_t _nbEvictions = 0;
+};
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
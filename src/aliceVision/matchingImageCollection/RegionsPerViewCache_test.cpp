@@ -0,0 +1,179 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matchingImageCollection/RegionsPerViewCache.hpp"
+#include "aliceVision/matchingImageCollection/ImageCollectionMatcher_generic.hpp"
+#include "aliceVision/matchingImageCollection/pairBuilder.hpp"
+#include "aliceVision/matchingImageCollection/pairwiseMatching.hpp"
+#include "aliceVision/feature/regionsFactory.hpp"
+
+#define BOOST_TEST_MODULE matchingImageCollectionRegionsPerViewCache
+#include <boost/test/included/unit_test.hpp>
+
+#include <mutex>
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+/// regions of a view: descriptors drawn from a common pool with some noise, the same for each call
+std::unique_ptr<feature::Regions> createSyntheticRegions(IndexT viewId)
+{
+  const int poolSize = 300;
+
+  std::mt19937 poolGenerator(0);
+  std::uniform_int_distribution<int> byteDistribution(0, 255);
+  std::vector<feature::SIFT_Regions::DescriptorT> pool(poolSize);
+  for(feature::SIFT_Regions::DescriptorT& descriptor : pool)
+    for(int i = 0; i < 128; ++i)
+      descriptor[i] = static_cast<unsigned char>(byteDistribution(poolGenerator));
+
+  std::mt19937 generator(viewId + 1);
+  std::uniform_int_distribution<int> noiseDistribution(-4, 4);
+  std::uniform_real_distribution<float> positionDistribution(0.f, 1000.f);
+
+  std::unique_ptr<feature::SIFT_Regions> regions(new feature::SIFT_Regions());
+  for(int k = 0; k < poolSize; ++k)
+  {
+    // each view sees a part of the pool
+    if((k + 7 * viewId) % 3 == 0)
+      continue;
+
+    feature::SIFT_Regions::DescriptorT descriptor = pool.at(k);
+    for(int i = 0; i < 128; ++i)
+      descriptor[i] = static_cast<unsigned char>(std::min(255, std::max(0, descriptor[i] + noiseDistribution(generator))));
+
+    regions->Features().emplace_back(positionDistribution(generator), positionDistribution(generator), 1.f, 0.f);
+    regions->Descriptors().push_back(descriptor);
+  }
+  return std::unique_ptr<feature::Regions>(regions.release());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_regionsPerViewCache)
+{
+  const feature::EImageDescriberType descType = feature::EImageDescriberType::SIFT;
+
+  std::map<IndexT, std::size_t> memoryPerView;
+  for(IndexT i = 0; i < 5; ++i)
+    memoryPerView[i] = 10;
+
+  std::size_t nbLoaderCalls = 0;
+  const RegionsPerViewCache::RegionsLoader loader = [&](IndexT viewId, feature::EImageDescriberType)
+  {
+    #pragma omp critical
+    ++nbLoaderCalls;
+    return std::unique_ptr<feature::Regions>(new feature::SIFT_Regions());
+  };
+
+  RegionsPerViewCache cache(loader, {descType}, memoryPerView, 30);
+
+  cache.request({0, 1, 2});
+  BOOST_CHECK_EQUAL(cache.getNbLoads(), 3);
+  BOOST_CHECK_EQUAL(cache.getMemorySize(), 30);
+
+  // view 0 becomes the most recently used view
+  cache.request({0});
+  BOOST_CHECK_EQUAL(cache.getNbLoads(), 3);
+
+  // view 1 is the least recently used view
+  cache.request({2, 3});
+  BOOST_CHECK_EQUAL(cache.getNbLoads(), 4);
+  BOOST_CHECK_EQUAL(cache.getNbEvictions(), 1);
+  BOOST_CHECK(!cache.getRegionsPerView().viewExist(1));
+  BOOST_CHECK(cache.getRegionsPerView().viewExist(0));
+  BOOST_CHECK(cache.getRegionsPerView().viewExist(2));
+  BOOST_CHECK(cache.getRegionsPerView().viewExist(3));
+
+  // requested views are never evicted, even above the budget
+  cache.request({0, 1, 2, 3});
+  BOOST_CHECK_EQUAL(cache.getMemorySize(), 40);
+  BOOST_CHECK_EQUAL(cache.getPeakMemorySize(), 40);
+  BOOST_CHECK_EQUAL(nbLoaderCalls, cache.getNbLoads());
+}
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_regionsPerViewCache_matching)
+{
+  const feature::EImageDescriberType descType = feature::EImageDescriberType::SIFT;
+  const std::vector<feature::EImageDescriberType> descTypes = {descType};
+  const IndexT nbViews = 8;
+
+  PairSet pairs;
+  std::map<IndexT, std::size_t> memoryPerView;
+  for(IndexT i = 0; i < nbViews; ++i)
+  {
+    memoryPerView[i] = 10;
+    for(IndexT j = i + 1; j < nbViews; ++j)
+      pairs.insert(Pair(i, j));
+  }
+
+  ImageCollectionMatcher_generic matcher(0.8f, matching::BRUTE_FORCE_L2);
+
+  std::mutex mutex;
+  const auto createProcessor = [&](matching::PairwiseMatches& matches) -> PairMatchesProcessor
+  {
+    return [&](const Pair& pair, matching::MatchesPerDescType& putativeMatches)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      matches[pair] = putativeMatches;
+      return true;
+    };
+  };
+
+  // all the regions in memory
+  feature::RegionsPerView regionsPerView;
+  for(IndexT i = 0; i < nbViews; ++i)
+    regionsPerView.addRegions(i, descType, createSyntheticRegions(i).release());
+
+  matching::PairwiseMatches fullMatches;
+  PairwiseMatchingStats fullStats;
+  matchAndProcessPairs(matcher, regionsPerView, pairs, descTypes, createProcessor(fullMatches), fullStats);
+
+  // blocks of pairs with a budget of 3 views
+  const std::size_t maxMemory = 30;
+  const RegionsPerViewCache::RegionsLoader loader = [](IndexT viewId, feature::EImageDescriberType)
+  {
+    return createSyntheticRegions(viewId);
+  };
+  RegionsPerViewCache cache(loader, descTypes, memoryPerView, maxMemory);
+
+  matching::PairwiseMatches cachedMatches;
+  PairwiseMatchingStats cachedStats;
+  const std::vector<PairSet> blocks = blockPairs(pairs, memoryPerView, maxMemory);
+  BOOST_CHECK_GT(blocks.size(), 1);
+
+  for(const PairSet& block : blocks)
+  {
+    std::set<IndexT> blockViewIds;
+    for(const Pair& pair : block)
+    {
+      blockViewIds.insert(pair.first);
+      blockViewIds.insert(pair.second);
+    }
+    cache.request(blockViewIds);
+    matchAndProcessPairs(matcher, cache.getRegionsPerView(), block, descTypes, createProcessor(cachedMatches), cachedStats);
+  }
+
+  BOOST_CHECK_LE(cache.getPeakMemorySize(), maxMemory);
+  BOOST_CHECK_GT(cache.getNbEvictions(), 0);
+
+  // same matches
+  BOOST_CHECK_EQUAL(cachedStats.nbPairs, fullStats.nbPairs);
+  BOOST_CHECK_EQUAL(cachedStats.nbPutativePairs, fullStats.nbPutativePairs);
+  BOOST_REQUIRE_EQUAL(cachedMatches.size(), fullMatches.size());
+  BOOST_CHECK_GT(fullMatches.size(), 0);
+
+  for(const auto& matchesPair : fullMatches)
+  {
+    const matching::IndMatches& matches = matchesPair.second.at(descType);
+    const matching::IndMatches& otherMatches = cachedMatches.at(matchesPair.first).at(descType);
+    BOOST_CHECK_GT(matches.size(), 0);
+    BOOST_CHECK(matches == otherMatches);
+  }
+}
@@ -51,24 +51,24 @@ void fillMatricesWithUndistortFeaturesMatches(const matching::IndMatches &putati
   const bool I_hasValidIntrinsics = cam_I && cam_I->isValid() && cam_I->hasDistortion();
   const bool J_hasValidIntrinsics = cam_J && cam_J->isValid() && cam_J->hasDistortion();
 
-  for (size_t i = 0; i < putativeMatches.size(); ++i)
-  {
-    const Vec2 pt_I = getFeaturePosition(feature_I, putativeMatches[i]._i);
-    if (I_hasValidIntrinsics)
-      x_I.col(i) = cam_I->get_ud_pixel(pt_I);
-    else
-      x_I.col(i) = pt_I;
-  }
+  const std::size_t nbMatches = putativeMatches.size();
+  Mat2X pts_I(2, nbMatches);
+  Mat2X pts_J(2, nbMatches);
 
-  for (size_t i = 0; i < putativeMatches.size(); ++i)
+  for (size_t i = 0; i < nbMatches; ++i)
   {
-    const Vec2 pt_J = getFeaturePosition(feature_J, putativeMatches[i]._j);
-    if (J_hasValidIntrinsics)
-      x_J.col(i) = cam_J->get_ud_pixel(pt_J);
-    else
-      x_J.col(i) = pt_J;
+    pts_I.col(i) = getFeaturePosition(feature_I, putativeMatches[i]._i);
+    pts_J.col(i) = getFeaturePosition(feature_J, putativeMatches[i]._j);
   }
 
+  if (I_hasValidIntrinsics)
+    cam_I->getUndistortedPixelsBatch(pts_I, pts_I);
+  if (J_hasValidIntrinsics)
+    cam_J->getUndistortedPixelsBatch(pts_J, pts_J);
+
+  x_I.leftCols(nbMatches) = pts_I.template cast<Scalar>();
+  x_J.leftCols(nbMatches) = pts_J.template cast<Scalar>();
+
 }
 
 /**
@@ -123,4 +123,65 @@ bool savePairs(const std::string &sFileName, const PairSet & pairs)
   return bOk;
 }
 
+std::vector<PairSet> blockPairs(const PairSet& pairs,
+                                const std::map<IndexT, std::size_t>& memoryPerView,
+                                std::size_t maxMemory)
+{
+  // views of the pairs, sorted by id
+  std::set<IndexT> viewIds;
+  for(const Pair& pair : pairs)
+  {
+    viewIds.insert(pair.first);
+    viewIds.insert(pair.second);
+  }
+
+  // cut the sorted views into tiles of at most half the budget
+  const std::size_t maxTileMemory = maxMemory / 2;
+  std::map<IndexT, IndexT> tilePerView;
+  IndexT nbTiles = 0;
+  std::size_t tileMemory = 0;
+  std::size_t tileSize = 0;
+
+  for(const IndexT viewId : viewIds)
+  {
+    const auto memoryIt = memoryPerView.find(viewId);
+    const std::size_t viewMemory = (memoryIt != memoryPerView.end()) ? memoryIt->second : 0;
+
+    if(nbTiles == 0 || (tileSize > 0 && tileMemory + viewMemory > maxTileMemory))
+    {
+      ++nbTiles;
+      tileMemory = 0;
+      tileSize = 0;
+    }
+
+    tileMemory += viewMemory;
+    ++tileSize;
+    tilePerView[viewId] = nbTiles - 1;
+  }
+
+  // pairs of each couple of tiles
+  std::map<Pair, PairSet> pairsPerTiles;
+  for(const Pair& pair : pairs)
+  {
+    const IndexT tileA = tilePerView.at(pair.first);
+    const IndexT tileB = tilePerView.at(pair.second);
+    pairsPerTiles[std::make_pair(std::min(tileA, tileB), std::max(tileA, tileB))].insert(pair);
+  }
+
+  // traverse the upper triangle of the tiles adjacency matrix, row by row in alternate directions
+  std::vector<PairSet> blocks;
+  for(IndexT row = 0; row < nbTiles; ++row)
+  {
+    for(IndexT i = 0; i < nbTiles - row; ++i)
+    {
+      const IndexT col = (row % 2 == 0) ? row + i : nbTiles - 1 - i;
+      auto pairsIt = pairsPerTiles.find(std::make_pair(row, col));
+
+      if(pairsIt != pairsPerTiles.end())
+        blocks.push_back(std::move(pairsIt->second));
+    }
+  }
+  return blocks;
+}
+
 }; // namespace aliceVision
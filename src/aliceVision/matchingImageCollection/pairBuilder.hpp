@@ -11,6 +11,8 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 
 #include <algorithm>
+#include <map>
+#include <vector>
 
 namespace aliceVision {
 
@@ -30,4 +32,18 @@ bool loadPairs(
 /// I K
 bool savePairs(const std::string &sFileName, const PairSet & pairs);
 
+/**
+ * @brief Split the pairs into blocks whose views fit in a memory budget.
+ * @details The sorted views are cut into tiles of at most half the budget, and the pairs are grouped
+ *          by couple of tiles. The blocks follow the rows of the tiles adjacency matrix in alternate directions,
+ *          so two consecutive blocks share a tile and only the other tile has to be loaded.
+ * @param[in] pairs The pairs to split
+ * @param[in] memoryPerView The estimated memory size of each view
+ * @param[in] maxMemory The maximum memory size of the views of a block
+ * @return the blocks of pairs, in processing order
+ */
+std::vector<PairSet> blockPairs(const PairSet& pairs,
+                                const std::map<IndexT, std::size_t>& memoryPerView,
+                                std::size_t maxMemory);
+
 }; // namespace aliceVision
@@ -79,3 +79,43 @@ BOOST_AUTO_TEST_CASE(matchingImageCollection_IO)
   BOOST_CHECK( loadPairs("pairsT_IO.txt", loaded_Pairs));
   BOOST_CHECK( std::equal(loaded_Pairs.begin(), loaded_Pairs.end(), pairSetGTsorted.begin()) );
 }
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_blockPairs)
+{
+  sfmData::Views views;
+  std::map<IndexT, std::size_t> memoryPerView;
+  for(IndexT i = 0; i < 20; ++i)
+  {
+    views[i] = std::make_shared<sfmData::View>("filepath", i);
+    memoryPerView[i] = 10 + (i % 3);
+  }
+
+  const PairSet pairs = exhaustivePairs(views);
+  const std::size_t maxMemory = 100;
+  const std::vector<PairSet> blocks = blockPairs(pairs, memoryPerView, maxMemory);
+
+  BOOST_CHECK_GT(blocks.size(), 1);
+
+  PairSet blockedPairs;
+  for(const PairSet& block : blocks)
+  {
+    std::set<IndexT> blockViews;
+    for(const Pair& pair : block)
+    {
+      // each pair is in a single block
+      BOOST_CHECK(blockedPairs.insert(pair).second);
+      blockViews.insert(pair.first);
+      blockViews.insert(pair.second);
+    }
+
+    // the views of a block fit in the memory budget
+    std::size_t blockMemory = 0;
+    for(const IndexT viewId : blockViews)
+      blockMemory += memoryPerView.at(viewId);
+    BOOST_CHECK_LE(blockMemory, maxMemory);
+  }
+  BOOST_CHECK(blockedPairs == pairs);
+
+  // a single block if all the views fit in the memory budget
+  BOOST_CHECK_EQUAL(blockPairs(pairs, memoryPerView, 1000).size(), 1);
+}
@@ -0,0 +1,130 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "pairwiseMatching.hpp"
+
+#include <aliceVision/system/PerfTrace.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/progress.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+std::ostream& operator<<(std::ostream& os, const PairwiseMatchingStats& stats)
+{
+  const auto perPair = [&](double time) { return (stats.nbPairs > 0) ? (1000.0 * time / stats.nbPairs) : 0.0; };
+
+  os << "\t- image pairs: " << stats.nbPairs << std::endl
+     << "\t- image pairs with putative matches: " << stats.nbPutativePairs << std::endl
+     << "\t- valid image pairs: " << stats.nbValidPairs << std::endl
+     << "\t- throughput: " << ((stats.elapsedTime > 0.0) ? (stats.nbPairs / stats.elapsedTime) : 0.0) << " pairs/s" << std::endl
+     << "\t- putative matching: " << perPair(stats.matchingTime) << " ms/pair" << std::endl
+     << "\t- processing: " << perPair(stats.processingTime) << " ms/pair" << std::endl;
+  return os;
+}
+
+void matchAndProcessPairs(IImageCollectionMatcher& matcher,
+                          const feature::RegionsPerView& regionsPerView,
+                          const PairSet& pairs,
+                          const std::vector<feature::EImageDescriberType>& descTypes,
+                          const PairMatchesProcessor& processor,
+                          PairwiseMatchingStats& stats)
+{
+  system::Timer timer;
+
+  // group the pairs by their first view
+  std::map<IndexT, PairSet> pairsPerView;
+  for(const Pair& pair : pairs)
+    pairsPerView[pair.first].insert(pair);
+
+  // largest groups first to balance the threads load
+  std::vector<const PairSet*> groups;
+  groups.reserve(pairsPerView.size());
+  for(const auto& viewPairs : pairsPerView)
+    groups.push_back(&viewPairs.second);
+  std::stable_sort(groups.begin(), groups.end(), [](const PairSet* a, const PairSet* b) { return a->size() > b->size(); });
+
+  // collection-wide matcher data (e.g. hashed descriptors), shared by all the groups
+  {
+    ALICEVISION_PERF_ZONE("matching.prepare");
+    for(const feature::EImageDescriberType descType : descTypes)
+      matcher.prepare(regionsPerView, pairs, descType);
+  }
+
+  const bool displayProgress = matcher.getDisplayProgress();
+  matcher.setDisplayProgress(false);
+
+  boost::progress_display progressBar(pairs.size(), std::cout, "Putative matching and processing of the image pairs\n");
+  std::string errorMessage;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(groups.size()); ++i)
+  {
+    const PairSet& groupPairs = *groups.at(i);
+    PairwiseMatchingStats groupStats;
+    groupStats.nbPairs = groupPairs.size();
+
+    try
+    {
+      system::Timer groupTimer;
+
+      matching::PairwiseMatches putativeMatches;
+      {
+        ALICEVISION_PERF_ZONE("matching.putative");
+        for(const feature::EImageDescriberType descType : descTypes)
+          matcher.Match(regionsPerView, groupPairs, descType, putativeMatches);
+      }
+
+      groupStats.matchingTime = groupTimer.elapsed();
+      groupStats.nbPutativePairs = putativeMatches.size();
+      groupTimer.reset();
+
+      // process and drop the putative matches pair by pair
+      for(auto it = putativeMatches.begin(); it != putativeMatches.end(); it = putativeMatches.erase(it))
+      {
+        ALICEVISION_PERF_ZONE("matching.processPair");
+        if(processor(it->first, it->second))
+          ++groupStats.nbValidPairs;
+      }
+      ALICEVISION_PERF_COUNTER("matching.nbPairs", groupStats.nbPairs);
+      ALICEVISION_PERF_COUNTER("matching.nbValidPairs", groupStats.nbValidPairs);
+
+      groupStats.processingTime = groupTimer.elapsed();
+    }
+    catch(const std::exception& e)
+    {
+      #pragma omp critical
+      errorMessage = e.what();
+    }
+
+    #pragma omp critical
+    {
+      stats.nbPairs += groupStats.nbPairs;
+      stats.nbPutativePairs += groupStats.nbPutativePairs;
+      stats.nbValidPairs += groupStats.nbValidPairs;
+      stats.matchingTime += groupStats.matchingTime;
+      stats.processingTime += groupStats.processingTime;
+      progressBar += groupStats.nbPairs;
+    }
+  }
+
+  matcher.setDisplayProgress(displayProgress);
+  matcher.release();
+  stats.elapsedTime += timer.elapsed();
+
+  if(!errorMessage.empty())
+    throw std::runtime_error(errorMessage);
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -0,0 +1,74 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Process the putative matches of an image pair (e.g. geometric filtering and export).
+ * @details Called concurrently from several threads.
+ * @return true if the image pair is kept
+ */
+using PairMatchesProcessor = std::function<bool(const Pair& pair, matching::MatchesPerDescType& putativeMatches)>;
+
+/**
+ * @brief Statistics of the pairwise matching stage.
+ */
+struct PairwiseMatchingStats
+{
+  /// number of matched image pairs
+  std::size_t nbPairs = 0;
+  /// number of image pairs with putative matches
+  std::size_t nbPutativePairs = 0;
+  /// number of image pairs kept by the processor
+  std::size_t nbValidPairs = 0;
+  /// putative matching time (s) cumulated over the threads
+  double matchingTime = 0.0;
+  /// processing time (s) cumulated over the threads
+  double processingTime = 0.0;
+  /// wall time (s)
+  double elapsedTime = 0.0;
+};
+
+std::ostream& operator<<(std::ostream& os, const PairwiseMatchingStats& stats);
+
+/**
+ * @brief Compute the putative matches of image pairs and stream them to a processor.
+ * @details The image pairs are grouped by their first view, so the matchers build the
+ *          index of a view only once, and the groups are distributed over the threads.
+ *          The collection-wide data of the matcher (e.g. cascade hashing) is prepared once
+ *          for all the pairs before the matching.
+ *          The putative matches of a pair are processed as soon as its group is matched,
+ *          then dropped: the putative matches of the whole set of pairs are never stored.
+ *          The progress display of the matcher is disabled during the matching.
+ * @param[in] matcher The image collection matcher
+ * @param[in] regionsPerView The regions of the views of the pairs
+ * @param[in] pairs The image pairs to match
+ * @param[in] descTypes The describer types to match
+ * @param[in] processor The processor of the putative matches of each pair
+ * @param[in,out] stats The statistics, accumulated over the calls
+ */
+void matchAndProcessPairs(IImageCollectionMatcher& matcher,
+                          const feature::RegionsPerView& regionsPerView,
+                          const PairSet& pairs,
+                          const std::vector<feature::EImageDescriberType>& descTypes,
+                          const PairMatchesProcessor& processor,
+                          PairwiseMatchingStats& stats);
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
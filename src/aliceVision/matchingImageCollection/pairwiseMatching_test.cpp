@@ -0,0 +1,116 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matchingImageCollection/pairwiseMatching.hpp"
+
+#define BOOST_TEST_MODULE matchingImageCollectionPairwiseMatching
+#include <boost/test/included/unit_test.hpp>
+
+#include <map>
+#include <mutex>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+/// matcher returning (I+J) matches for each pair, none if I+J is a multiple of 5
+class SyntheticMatcher : public IImageCollectionMatcher
+{
+public:
+  void Match(const feature::RegionsPerView& regionsPerView,
+             const PairSet& pairs,
+             feature::EImageDescriberType descType,
+             matching::PairwiseMatches& putativeMatches) const override
+  {
+    for(const Pair& pair : pairs)
+    {
+      const std::size_t nbMatches = ((pair.first + pair.second) % 5 == 0) ? 0 : (pair.first + pair.second);
+      if(nbMatches > 0)
+        putativeMatches[pair][descType] = matching::IndMatches(nbMatches);
+    }
+  }
+
+  void prepare(const feature::RegionsPerView& regionsPerView,
+               const PairSet& pairs,
+               feature::EImageDescriberType descType) override
+  {
+    preparedPairs[descType] = pairs;
+  }
+
+  void release() override
+  {
+    ++nbReleases;
+  }
+
+  std::map<feature::EImageDescriberType, PairSet> preparedPairs;
+  int nbReleases = 0;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_matchAndProcessPairs)
+{
+  PairSet pairs;
+  for(IndexT i = 0; i < 12; ++i)
+    for(IndexT j = i + 1; j < 12; ++j)
+      pairs.insert(Pair(i, j));
+
+  const std::vector<feature::EImageDescriberType> descTypes = {feature::EImageDescriberType::SIFT,
+                                                               feature::EImageDescriberType::AKAZE};
+
+  std::mutex mutex;
+  matching::PairwiseMatches processedMatches;
+
+  const PairMatchesProcessor processor = [&](const Pair& pair, matching::MatchesPerDescType& putativeMatches)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    BOOST_CHECK_EQUAL(processedMatches.count(pair), 0);
+    processedMatches[pair] = putativeMatches;
+    return (pair.second % 2 == 0);
+  };
+
+  SyntheticMatcher matcher;
+  PairwiseMatchingStats stats;
+  matchAndProcessPairs(matcher, feature::RegionsPerView(), pairs, descTypes, processor, stats);
+
+  std::size_t nbPutativePairs = 0;
+  std::size_t nbValidPairs = 0;
+  for(const Pair& pair : pairs)
+  {
+    if((pair.first + pair.second) % 5 == 0)
+    {
+      BOOST_CHECK_EQUAL(processedMatches.count(pair), 0);
+      continue;
+    }
+    ++nbPutativePairs;
+    if(pair.second % 2 == 0)
+      ++nbValidPairs;
+
+    // the putative matches of all the describer types are processed at once
+    const matching::MatchesPerDescType& matches = processedMatches.at(pair);
+    BOOST_CHECK_EQUAL(matches.size(), descTypes.size());
+    BOOST_CHECK_EQUAL(matches.getNbAllMatches(), 2 * (pair.first + pair.second));
+  }
+
+  BOOST_CHECK_EQUAL(stats.nbPairs, pairs.size());
+  BOOST_CHECK_EQUAL(stats.nbPutativePairs, nbPutativePairs);
+  BOOST_CHECK_EQUAL(stats.nbValidPairs, nbValidPairs);
+  BOOST_CHECK(matcher.getDisplayProgress());
+
+  // the matcher is prepared once with all the pairs of each describer type
+  BOOST_CHECK_EQUAL(matcher.preparedPairs.size(), descTypes.size());
+  for(const feature::EImageDescriberType descType : descTypes)
+    BOOST_CHECK(matcher.preparedPairs.at(descType) == pairs);
+  BOOST_CHECK_EQUAL(matcher.nbReleases, 1);
+
+  // errors of the processor are reported to the caller
+  const PairMatchesProcessor failingProcessor = [](const Pair&, matching::MatchesPerDescType&) -> bool
+  {
+    throw std::runtime_error("processing error");
+  };
+  BOOST_CHECK_THROW(matchAndProcessPairs(matcher, feature::RegionsPerView(), pairs, descTypes, failingProcessor, stats), std::runtime_error);
+}
@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Mesh.hpp"
+#include "MeshRasterizer.hpp"
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/OrientedPoint.hpp>
@@ -12,6 +13,7 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <map>
 
@@ -758,9 +760,65 @@ void Mesh::getTrisMap(StaticVector<StaticVector<int>>& out, StaticVector<int>& v
 
 void Mesh::getDepthMap(StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h)
 {
-    StaticVector<StaticVector<int>> tmp;
-    getTrisMap(tmp, mp, rc, scale, w, h);
-    getDepthMap(depthMap, tmp, mp, rc, scale, w, h);
+    // same depth as getDepthMap from a triangles map: for each pixel, the minimum over the triangles intersecting
+    // the pixel of their maximum depth on the pixel, accumulated per triangle instead of storing the triangles per pixel
+    const float noDepth = 10000000.0f;
+    std::vector<float> minDepths(w * h, noDepth);
+    std::vector<bool> covered(w * h, false);
+
+    for(int idTri = 0; idTri < tris.size(); ++idTri)
+    {
+        triangle_proj tp = getTriangleProjection(idTri, mp, rc, w, h);
+        if(!isTriangleProjectionInImage(mp, tp, rc, 0))
+            continue;
+
+        OrientedPoint tri;
+        tri.p = pts[tris[idTri].v[0]];
+        tri.n = cross((pts[tris[idTri].v[1]] - pts[tris[idTri].v[0]]).normalize(),
+                      (pts[tris[idTri].v[2]] - pts[tris[idTri].v[0]]).normalize());
+        const bool isDegenerate = std::isnan(angleBetwV1andV2((mp.CArr[rc] - tri.p).normalize(), tri.n));
+
+        Pixel pix;
+        for(pix.x = tp.lu.x; pix.x <= tp.rd.x; pix.x++)
+        {
+            for(pix.y = tp.lu.y; pix.y <= tp.rd.y; pix.y++)
+            {
+                Mesh::rectangle re = Mesh::rectangle(pix, 1);
+                if(!doesTriangleIntersectsRectangle(tp, re))
+                    continue;
+
+                StaticVector<Point2d> tpis;
+                getTrianglePixelIntersectionsAndInternalPoints(tp, re, tpis);
+
+                double maxd = -1.0;
+                for(int k = 0; k < tpis.size(); k++)
+                {
+                    if(isDegenerate)
+                    {
+                        maxd = std::max(maxd, (mp.CArr[rc] - pts[tris[idTri].v[1]]).size());
+                    }
+                    else
+                    {
+                        const Point3d lpi = linePlaneIntersect(
+                            mp.CArr[rc], (mp.iCamArr[rc] * (tpis[k] * (float)scale)).normalize(), tri.p, tri.n);
+                        maxd = std::max(maxd, (mp.CArr[rc] - lpi).size());
+                    }
+                }
+
+                const int i = pix.x * h + pix.y;
+                minDepths[i] = std::min(minDepths[i], float(maxd));
+                covered[i] = true;
+            }
+        }
+    }
+
+    depthMap.clear();
+    depthMap.resize_with(w * h, -1.0f);
+    for(int i = 0; i < w * h; ++i)
+    {
+        if(covered[i])
+            depthMap[i] = minDepths[i];
+    }
 }
 
 void Mesh::getDepthMap(StaticVector<float>& depthMap, StaticVector<StaticVector<int>>& tmp, const mvsUtils::MultiViewParams& mp,
@@ -886,6 +944,32 @@ void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const std::
     getVisibleTrianglesIndexes(out_visTri, trisMap, depthMap, mp, rc, w, h);
 }
 
+void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const mvsUtils::MultiViewParams& mp, int rc, int w, int h)
+{
+    const MeshRasterizer rasterizer(*this);
+    ZBuffer zbuffer;
+    rasterizer.rasterize(MeshRasterizer::getCameraMatrix(mp, rc, w, h), w, h, zbuffer);
+    getVisibleTrianglesIndexes(out_visTri, zbuffer);
+}
+
+void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const ZBuffer& zbuffer) const
+{
+    std::vector<bool> visible(tris.size(), false);
+    for(int triId : zbuffer.trisIds)
+    {
+        if(triId >= 0)
+            visible[triId] = true;
+    }
+
+    out_visTri.clear();
+    out_visTri.reserve(std::count(visible.begin(), visible.end(), true));
+    for(int i = 0; i < tris.size(); ++i)
+    {
+        if(visible[i])
+            out_visTri.push_back(i);
+    }
+}
+
 void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc,
                                                        int w, int h)
 {
@@ -1803,60 +1887,58 @@ void Mesh::letJustTringlesIdsInMesh(StaticVector<int>& trisIdsToStay)
     tris.swap(trisTmp);
 }
 
-void Mesh::computeTrisCams(StaticVector<StaticVector<int>>& trisCams, const mvsUtils::MultiViewParams& mp, const std::string tmpDir)
+void Mesh::computeTrisCams(StaticVector<StaticVector<int>>& trisCams, const mvsUtils::MultiViewParams& mp, int scale)
 {
     if(mp.verbose)
         ALICEVISION_LOG_DEBUG("Computing tris cams.");
 
-    StaticVector<int> ntrisCams;
-    ntrisCams.reserve(tris.size());
-    ntrisCams.resize_with(tris.size(), 0);
+    // all the cameras are rasterized against the same triangle stream, one camera per thread
+    const MeshRasterizer rasterizer(*this);
 
-    long t1 = mvsUtils::initEstimate();
+    std::map<std::pair<int, int>, std::vector<int>> camsPerSize; // <width, height>: cameras
     for(int rc = 0; rc < mp.ncams; ++rc)
+        camsPerSize[std::make_pair(mp.getWidth(rc) / scale, mp.getHeight(rc) / scale)].push_back(rc);
+
+    std::vector<StaticVector<int>> visTrisPerCam(mp.ncams);
+
+    for(const auto& camsPerSizePair : camsPerSize)
     {
-        std::string visTrisFileName = tmpDir + "visTris" + std::to_string(mp.getViewId(rc)) + ".bin";
-        StaticVector<int> visTris;
-        loadArrayFromFile<int>(visTris, visTrisFileName);
-        if(visTris.size() != 0)
+        const int w = camsPerSizePair.first.first;
+        const int h = camsPerSizePair.first.second;
+        const std::vector<int>& sizeCams = camsPerSizePair.second;
+
+        std::vector<Matrix3x4> cameras;
+        for(int rc : sizeCams)
+            cameras.push_back(MeshRasterizer::getCameraMatrix(mp, rc, w, h));
+
+        // each camera writes its own list of visible triangles
+        rasterizer.rasterizeCameras(cameras, w, h, [&](int i, const ZBuffer& zbuffer)
         {
-            for(int i = 0; i < visTris.size(); ++i)
-            {
-                int idTri = visTris[i];
-                ntrisCams[idTri]++;
-            }
-        }
-        mvsUtils::printfEstimate(rc, mp.ncams, t1);
+            getVisibleTrianglesIndexes(visTrisPerCam[sizeCams[i]], zbuffer);
+        });
     }
-    mvsUtils::finishEstimate();
 
-    trisCams.reserve(tris.size());
+    StaticVector<int> ntrisCams;
+    ntrisCams.resize_with(tris.size(), 0);
+    for(const StaticVector<int>& visTris : visTrisPerCam)
+    {
+        for(int i = 0; i < visTris.size(); ++i)
+            ntrisCams[visTris[i]]++;
+    }
 
+    trisCams.resize(tris.size());
     for(int i = 0; i < tris.size(); ++i)
     {
         if(ntrisCams[i] > 0)
-        {
             trisCams[i].reserve(ntrisCams[i]);
-        }
     }
 
-    t1 = mvsUtils::initEstimate();
     for(int rc = 0; rc < mp.ncams; ++rc)
     {
-        std::string visTrisFileName = tmpDir + "visTris" + std::to_string(mp.getViewId(rc)) + ".bin";
-        StaticVector<int> visTris;
-        loadArrayFromFile<int>(visTris, visTrisFileName);
-        if(visTris.size() != 0)
-        {
-            for(int i = 0; i < visTris.size(); ++i)
-            {
-                int idTri = visTris[i];
-                trisCams[idTri].push_back(rc);
-            }
-        }
-        mvsUtils::printfEstimate(rc, mp.ncams, t1);
+        const StaticVector<int>& visTris = visTrisPerCam[rc];
+        for(int i = 0; i < visTris.size(); ++i)
+            trisCams[visTris[i]].push_back(rc);
     }
-    mvsUtils::finishEstimate();
 }
 
 void Mesh::computeTrisCamsFromPtsCams(StaticVector<StaticVector<int>>& trisCams) const
@@ -19,6 +19,8 @@
 namespace aliceVision {
 namespace mesh {
 
+struct ZBuffer;
+
 using PointVisibility = StaticVector<int>;
 using PointsVisibility = StaticVector<PointVisibility>;
 
@@ -148,6 +150,10 @@ public:
     const std::vector<int>& trisMtlIds() const { return _trisMtlIds; }
     std::vector<int>& trisMtlIds() { return _trisMtlIds; }
 
+    /**
+     * @brief Get the depth map of the mesh, at the resolution w x h of the camera image downscaled by @p scale.
+     *        Each pixel has the minimum over the triangles intersecting the pixel of their maximum depth on the pixel (-1: no triangle).
+     */
     void getDepthMap(StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h);
     void getDepthMap(StaticVector<float>& depthMap, StaticVector<StaticVector<int>>& tmp, const mvsUtils::MultiViewParams& mp, int rc,
                      int scale, int w, int h);
@@ -164,6 +170,13 @@ public:
                                                   int h);
     void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVector<float>& depthMap, const mvsUtils::MultiViewParams& mp, int rc, int w,
                                                   int h);
+    /**
+     * @brief Get the triangles visible in at least one pixel of a camera, from a z-buffer of the mesh.
+     *        A triangle is visible if it is the closest one at the center of a pixel, so unlike the overloads
+     *        based on a triangles map, the triangles smaller than a pixel can be missed.
+     */
+    void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const mvsUtils::MultiViewParams& mp, int rc, int w, int h);
+    void getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, const ZBuffer& zbuffer) const;
 
     void generateMeshFromTrianglesSubset(const StaticVector<int>& visTris, Mesh& outMesh, StaticVector<int>& out_ptIdToNewPtId) const;
 
@@ -209,7 +222,11 @@ public:
     int subdivideMesh(const Mesh& refMesh, float ratioSubdiv, bool remapVisibilities);
     int subdivideMeshOnce(const Mesh& refMesh, const GEO::AdaptiveKdTree& refMesh_kdTree, float ratioSubdiv);
 
-    void computeTrisCams(StaticVector<StaticVector<int>>& trisCams, const mvsUtils::MultiViewParams& mp, const std::string tmpDir);
+    /**
+     * @brief Compute the cameras seeing each triangle, with a z-buffer per camera at its resolution divided by @p scale.
+     *        The visibility is the one of getVisibleTrianglesIndexes from a z-buffer.
+     */
+    void computeTrisCams(StaticVector<StaticVector<int>>& trisCams, const mvsUtils::MultiViewParams& mp, int scale = 1);
     void computeTrisCamsFromPtsCams(StaticVector<StaticVector<int>>& trisCams) const;
 
     void initFromDepthMap(const mvsUtils::MultiViewParams& mp, float* depthMap, int rc, int scale, int step, float alpha);
@@ -0,0 +1,332 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshRasterizer.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/// spread the 10 lower bits of a value every 3 bits
+std::uint32_t expandBits(std::uint32_t v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+/// 30-bit Morton code of a point in the unit cube
+std::uint32_t mortonCode(double x, double y, double z)
+{
+    const auto quantize = [](double v) {
+        return static_cast<std::uint32_t>(std::min(std::max(v * 1024.0, 0.0), 1023.0));
+    };
+    return (expandBits(quantize(x)) << 2) | (expandBits(quantize(y)) << 1) | expandBits(quantize(z));
+}
+
+/// first pixel whose center is at or after a coordinate, clamped to [0, size]
+int firstPixel(double v, int size)
+{
+    return static_cast<int>(std::min(std::max(std::ceil(v - 0.5), 0.0), double(size)));
+}
+
+} // namespace
+
+MeshRasterizer::MeshRasterizer(const Mesh& mesh, int clusterSize)
+{
+    const int nbTris = mesh.tris.size();
+
+    // triangle centers in the bounding box of the mesh
+    std::vector<Point3d> centers(nbTris);
+    Point3d bbMin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bbMax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+
+    for(int i = 0; i < nbTris; ++i)
+    {
+        const Mesh::triangle& t = mesh.tris[i];
+        centers[i] = (mesh.pts[t.v[0]] + mesh.pts[t.v[1]] + mesh.pts[t.v[2]]) / 3.0;
+        bbMin = Point3d(std::min(bbMin.x, centers[i].x), std::min(bbMin.y, centers[i].y), std::min(bbMin.z, centers[i].z));
+        bbMax = Point3d(std::max(bbMax.x, centers[i].x), std::max(bbMax.y, centers[i].y), std::max(bbMax.z, centers[i].z));
+    }
+
+    const Point3d extent = bbMax - bbMin;
+    const double scale = 1.0 / std::max(std::max(extent.x, extent.y), std::max(extent.z, std::numeric_limits<double>::epsilon()));
+
+    // stream order along the Morton curve of the triangle centers
+    std::vector<std::uint32_t> codes(nbTris);
+    for(int i = 0; i < nbTris; ++i)
+    {
+        const Point3d p = (centers[i] - bbMin) * scale;
+        codes[i] = mortonCode(p.x, p.y, p.z);
+    }
+
+    _trisIds.resize(nbTris);
+    std::iota(_trisIds.begin(), _trisIds.end(), 0);
+    std::stable_sort(_trisIds.begin(), _trisIds.end(), [&codes](int a, int b) { return codes[a] < codes[b]; });
+
+    _trisPts.resize(3 * std::size_t(nbTris));
+    for(int i = 0; i < nbTris; ++i)
+    {
+        const Mesh::triangle& t = mesh.tris[_trisIds[i]];
+        for(int k = 0; k < 3; ++k)
+            _trisPts[3 * i + k] = mesh.pts[t.v[k]];
+    }
+
+    // clusters of consecutive triangles of the stream
+    clusterSize = std::max(1, clusterSize);
+    for(int begin = 0; begin < nbTris; begin += clusterSize)
+    {
+        Cluster cluster;
+        cluster.begin = begin;
+        cluster.end = std::min(nbTris, begin + clusterSize);
+        cluster.min = _trisPts[3 * begin];
+        cluster.max = _trisPts[3 * begin];
+        for(std::size_t k = 3 * begin; k < 3 * std::size_t(cluster.end); ++k)
+        {
+            const Point3d& p = _trisPts[k];
+            cluster.min = Point3d(std::min(cluster.min.x, p.x), std::min(cluster.min.y, p.y), std::min(cluster.min.z, p.z));
+            cluster.max = Point3d(std::max(cluster.max.x, p.x), std::max(cluster.max.y, p.y), std::max(cluster.max.z, p.z));
+        }
+        _clusters.push_back(cluster);
+    }
+}
+
+bool MeshRasterizer::isClusterVisible(const Cluster& cluster, const Matrix3x4& P, int width, int height) const
+{
+    double xMin = std::numeric_limits<double>::max();
+    double yMin = std::numeric_limits<double>::max();
+    double xMax = std::numeric_limits<double>::lowest();
+    double yMax = std::numeric_limits<double>::lowest();
+    int nbBehind = 0;
+
+    for(int c = 0; c < 8; ++c)
+    {
+        const Point3d corner((c & 1) ? cluster.max.x : cluster.min.x,
+                             (c & 2) ? cluster.max.y : cluster.min.y,
+                             (c & 4) ? cluster.max.z : cluster.min.z);
+        const Point3d h = P * corner;
+        if(h.z <= 0.0)
+        {
+            ++nbBehind;
+            continue;
+        }
+        xMin = std::min(xMin, h.x / h.z);
+        yMin = std::min(yMin, h.y / h.z);
+        xMax = std::max(xMax, h.x / h.z);
+        yMax = std::max(yMax, h.y / h.z);
+    }
+
+    // the bounding box crosses the camera plane: no bound on its projection
+    if(nbBehind > 0)
+        return nbBehind < 8;
+
+    return xMax >= 0.0 && yMax >= 0.0 && xMin <= width && yMin <= height;
+}
+
+void MeshRasterizer::projectTriangles(const Matrix3x4& P, int width, int height, Frame& frame) const
+{
+    frame.triangles.clear();
+
+    for(const Cluster& cluster : _clusters)
+    {
+        if(!isClusterVisible(cluster, P, width, height))
+            continue;
+
+        for(int i = cluster.begin; i < cluster.end; ++i)
+        {
+            ProjectedTriangle t;
+            bool inFront = true;
+            for(int k = 0; k < 3 && inFront; ++k)
+            {
+                const Point3d h = P * _trisPts[3 * i + k];
+                inFront = (h.z > 0.0);
+                t.x[k] = h.x / h.z;
+                t.y[k] = h.y / h.z;
+                t.invW[k] = 1.0 / h.z;
+            }
+            if(!inFront)
+                continue;
+
+            // counter-clockwise orientation (positive area with the edge functions of rasterizeTile)
+            const double area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.y[1] - t.y[0]) * (t.x[2] - t.x[0]);
+            if(!(std::abs(area) > 0.0) || !std::isfinite(area))
+                continue;
+            if(area < 0.0)
+            {
+                std::swap(t.x[1], t.x[2]);
+                std::swap(t.y[1], t.y[2]);
+                std::swap(t.invW[1], t.invW[2]);
+            }
+
+            t.xBegin = firstPixel(std::min(t.x[0], std::min(t.x[1], t.x[2])), width);
+            t.xEnd = firstPixel(std::max(t.x[0], std::max(t.x[1], t.x[2])) + 1.0, width);
+            t.yBegin = firstPixel(std::min(t.y[0], std::min(t.y[1], t.y[2])), height);
+            t.yEnd = firstPixel(std::max(t.y[0], std::max(t.y[1], t.y[2])) + 1.0, height);
+            if(t.xBegin >= t.xEnd || t.yBegin >= t.yEnd)
+                continue;
+
+            t.triId = _trisIds[i];
+            frame.triangles.push_back(t);
+        }
+    }
+}
+
+void MeshRasterizer::binTriangles(int nbTilesX, int nbTilesY, Frame& frame) const
+{
+    const int nbTiles = nbTilesX * nbTilesY;
+    frame.tileOffsets.assign(nbTiles + 1, 0);
+
+    // count the triangles per tile
+    for(const ProjectedTriangle& t : frame.triangles)
+    {
+        for(int ty = t.yBegin / tileSize; ty <= (t.yEnd - 1) / tileSize; ++ty)
+            for(int tx = t.xBegin / tileSize; tx <= (t.xEnd - 1) / tileSize; ++tx)
+                ++frame.tileOffsets[ty * nbTilesX + tx + 1];
+    }
+
+    for(int i = 0; i < nbTiles; ++i)
+        frame.tileOffsets[i + 1] += frame.tileOffsets[i];
+
+    // fill the bins in the stream order
+    frame.tileTriangles.resize(frame.tileOffsets[nbTiles]);
+    std::vector<int> cursors(frame.tileOffsets.begin(), frame.tileOffsets.end() - 1);
+
+    for(int k = 0; k < frame.triangles.size(); ++k)
+    {
+        const ProjectedTriangle& t = frame.triangles[k];
+        for(int ty = t.yBegin / tileSize; ty <= (t.yEnd - 1) / tileSize; ++ty)
+            for(int tx = t.xBegin / tileSize; tx <= (t.xEnd - 1) / tileSize; ++tx)
+                frame.tileTriangles[cursors[ty * nbTilesX + tx]++] = k;
+    }
+}
+
+void MeshRasterizer::rasterizeTile(const Frame& frame, int tileX, int tileY, ZBuffer& out) const
+{
+    const int nbTilesX = (out.width + tileSize - 1) / tileSize;
+    const int tile = tileY * nbTilesX + tileX;
+    const int tileXBegin = tileX * tileSize;
+    const int tileYBegin = tileY * tileSize;
+    const int tileXEnd = std::min(out.width, tileXBegin + tileSize);
+    const int tileYEnd = std::min(out.height, tileYBegin + tileSize);
+
+    for(int k = frame.tileOffsets[tile]; k < frame.tileOffsets[tile + 1]; ++k)
+    {
+        const ProjectedTriangle& t = frame.triangles[frame.tileTriangles[k]];
+
+        const int xBegin = std::max(t.xBegin, tileXBegin);
+        const int xEnd = std::min(t.xEnd, tileXEnd);
+        const int yBegin = std::max(t.yBegin, tileYBegin);
+        const int yEnd = std::min(t.yEnd, tileYEnd);
+
+        // edge functions E(p) = a * p.x + b * p.y + c, positive inside the triangle.
+        // Edge i is opposite to vertex (i + 2) % 3. A sample exactly on an edge is inside for one of
+        // the two triangles sharing the edge only (top-left rule).
+        double a[3], b[3], c[3];
+        bool inclusive[3];
+        for(int i = 0; i < 3; ++i)
+        {
+            const int j = (i + 1) % 3;
+            const double dx = t.x[j] - t.x[i];
+            const double dy = t.y[j] - t.y[i];
+            a[i] = -dy;
+            b[i] = dx;
+            c[i] = dy * t.x[i] - dx * t.y[i];
+            inclusive[i] = (dy > 0.0) || (dy == 0.0 && dx < 0.0);
+        }
+        const double invArea = 1.0 / (a[0] * t.x[2] + b[0] * t.y[2] + c[0]);
+
+        for(int y = yBegin; y < yEnd; ++y)
+        {
+            const double py = y + 0.5;
+            float* depthRow = &out.depth[std::size_t(y) * out.width];
+            int* trisIdsRow = &out.trisIds[std::size_t(y) * out.width];
+
+            for(int x = xBegin; x < xEnd; ++x)
+            {
+                const double px = x + 0.5;
+                const double e0 = a[0] * px + b[0] * py + c[0];
+                const double e1 = a[1] * px + b[1] * py + c[1];
+                const double e2 = a[2] * px + b[2] * py + c[2];
+
+                if((e0 < 0.0 || (e0 == 0.0 && !inclusive[0])) ||
+                   (e1 < 0.0 || (e1 == 0.0 && !inclusive[1])) ||
+                   (e2 < 0.0 || (e2 == 0.0 && !inclusive[2])))
+                    continue;
+
+                // perspective correct depth: 1/w is linear in the image
+                const double invW = (e1 * t.invW[0] + e2 * t.invW[1] + e0 * t.invW[2]) * invArea;
+                const float depth = static_cast<float>(1.0 / invW);
+
+                if(trisIdsRow[x] < 0 || depth < depthRow[x])
+                {
+                    depthRow[x] = depth;
+                    trisIdsRow[x] = t.triId;
+                }
+            }
+        }
+    }
+}
+
+void MeshRasterizer::rasterize(const Matrix3x4& P, int width, int height, ZBuffer& out, Frame& frame, bool parallel) const
+{
+    out.reset(width, height);
+
+    const int nbTilesX = (width + tileSize - 1) / tileSize;
+    const int nbTilesY = (height + tileSize - 1) / tileSize;
+
+    projectTriangles(P, width, height, frame);
+    binTriangles(nbTilesX, nbTilesY, frame);
+
+    #pragma omp parallel for schedule(dynamic) if(parallel)
+    for(int tile = 0; tile < nbTilesX * nbTilesY; ++tile)
+        rasterizeTile(frame, tile % nbTilesX, tile / nbTilesX, out);
+}
+
+void MeshRasterizer::rasterize(const Matrix3x4& P, int width, int height, ZBuffer& out, bool parallel) const
+{
+    Frame frame;
+    rasterize(P, width, height, out, frame, parallel);
+}
+
+void MeshRasterizer::rasterizeCameras(const std::vector<Matrix3x4>& cameras, int width, int height,
+                                      const std::function<void(int, const ZBuffer&)>& process) const
+{
+    // buffers reused by each thread between its cameras
+    std::vector<Frame> frames(omp_get_max_threads());
+    std::vector<ZBuffer> zbuffers(omp_get_max_threads());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < cameras.size(); ++i)
+    {
+        const int thread = omp_get_thread_num();
+        rasterize(cameras[i], width, height, zbuffers[thread], frames[thread], false);
+        process(i, zbuffers[thread]);
+    }
+}
+
+Matrix3x4 MeshRasterizer::getCameraMatrix(const mvsUtils::MultiViewParams& mp, int rc, int width, int height)
+{
+    Matrix3x4 P = mp.camArr[rc];
+    const double sx = double(width) / mp.getWidth(rc);
+    const double sy = double(height) / mp.getHeight(rc);
+    P.m11 *= sx; P.m12 *= sx; P.m13 *= sx; P.m14 *= sx;
+    P.m21 *= sy; P.m22 *= sy; P.m23 *= sy; P.m24 *= sy;
+    return P;
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,153 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace aliceVision {
+
+namespace mvsUtils {
+class MultiViewParams;
+} // namespace mvsUtils
+
+namespace mesh {
+
+/**
+ * @brief Visible triangle and depth of each pixel of a camera (row-major buffers).
+ */
+struct ZBuffer
+{
+    int width = 0;
+    int height = 0;
+    /// projective depth of the visible surface (depth along the optical axis for a metric camera), -1 if empty
+    std::vector<float> depth;
+    /// index of the visible triangle in the mesh, -1 if empty
+    std::vector<int> trisIds;
+
+    void reset(int w, int h)
+    {
+        width = w;
+        height = h;
+        depth.assign(std::size_t(w) * h, -1.0f);
+        trisIds.assign(std::size_t(w) * h, -1);
+    }
+
+    int getTriId(int x, int y) const { return trisIds[std::size_t(y) * width + x]; }
+    float getDepth(int x, int y) const { return depth[std::size_t(y) * width + x]; }
+};
+
+/**
+ * @brief Tiled software z-buffer rasterizer of a mesh.
+ *
+ * The triangles are stored once in a stream ordered along a Morton curve of their centers and
+ * grouped in clusters with a bounding box (a flat BVH): the clusters outside of a camera frustum
+ * are culled without looking at their triangles. The visible triangles are binned in image tiles
+ * (flat index arrays) and the tiles are rasterized independently.
+ *
+ * A pixel (x, y) covers [x, x+1) x [y, y+1) and is sampled at its center, with a top-left fill rule
+ * so that the pixels on a shared edge belong to a single triangle.
+ * The triangles with a vertex behind the camera are not rasterized.
+ *
+ * @note This is library API: it backs the Mesh visibility helpers (getVisibleTrianglesIndexes,
+ *       computeTrisCams, getDepthMap), which no pipeline executable calls yet. Its throughput is
+ *       measured by the "rasterization" kernels of aliceVision_mvsBenchmark.
+ */
+class MeshRasterizer
+{
+public:
+    /// size in pixels of the image tiles
+    static const int tileSize = 32;
+
+    /**
+     * @brief Build the triangle stream of a mesh
+     * @param[in] mesh The mesh, which must not be modified during the lifetime of the rasterizer
+     * @param[in] clusterSize The number of triangles per cluster
+     */
+    explicit MeshRasterizer(const Mesh& mesh, int clusterSize = 64);
+
+    /**
+     * @brief Rasterize the mesh in a camera
+     * @param[in] P The projection matrix to the output image
+     * @param[in] width The output image width
+     * @param[in] height The output image height
+     * @param[out] out The visible triangle and depth of each pixel
+     * @param[in] parallel Rasterize the tiles in parallel
+     */
+    void rasterize(const Matrix3x4& P, int width, int height, ZBuffer& out, bool parallel = true) const;
+
+    /**
+     * @brief Rasterize the mesh in several cameras, one camera per thread
+     * @param[in] cameras The projection matrices to the output images
+     * @param[in] width The output images width
+     * @param[in] height The output images height
+     * @param[in] process Function called with the camera index and its z-buffer, concurrently from several threads
+     */
+    void rasterizeCameras(const std::vector<Matrix3x4>& cameras, int width, int height,
+                          const std::function<void(int, const ZBuffer&)>& process) const;
+
+    /**
+     * @brief Get the projection matrix of a camera to an image of a given size
+     * @param[in] mp The multi-view parameters
+     * @param[in] rc The camera index
+     * @param[in] width The output image width
+     * @param[in] height The output image height
+     * @return the projection matrix of the camera scaled to the output image
+     */
+    static Matrix3x4 getCameraMatrix(const mvsUtils::MultiViewParams& mp, int rc, int width, int height);
+
+    int getNbTriangles() const { return static_cast<int>(_trisIds.size()); }
+    int getNbClusters() const { return static_cast<int>(_clusters.size()); }
+
+private:
+    struct Cluster
+    {
+        Point3d min;
+        Point3d max;
+        int begin;
+        int end;
+    };
+
+    /// triangle projected in the image, with its pixel bounding box
+    struct ProjectedTriangle
+    {
+        double x[3];
+        double y[3];
+        double invW[3];
+        int triId;
+        int xBegin, xEnd, yBegin, yEnd;
+    };
+
+    /**
+     * @brief Per-thread buffers reused between the cameras
+     */
+    struct Frame
+    {
+        std::vector<ProjectedTriangle> triangles;
+        std::vector<int> tileOffsets;
+        std::vector<int> tileTriangles;
+    };
+
+    bool isClusterVisible(const Cluster& cluster, const Matrix3x4& P, int width, int height) const;
+    void projectTriangles(const Matrix3x4& P, int width, int height, Frame& frame) const;
+    void binTriangles(int nbTilesX, int nbTilesY, Frame& frame) const;
+    void rasterizeTile(const Frame& frame, int tileX, int tileY, ZBuffer& out) const;
+    void rasterize(const Matrix3x4& P, int width, int height, ZBuffer& out, Frame& frame, bool parallel) const;
+
+    /// vertices of the triangles in the stream order (3 per triangle)
+    std::vector<Point3d> _trisPts;
+    /// index in the mesh of the triangles in the stream order
+    std::vector<int> _trisIds;
+    std::vector<Cluster> _clusters;
+};
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,198 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshRasterizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshRasterizer
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+/// camera at the origin looking along +z, focal f and principal point (cx, cy)
+Matrix3x4 createCamera(double f, double cx, double cy)
+{
+    Matrix3x4 P;
+    P.m11 = f;  P.m13 = cx;
+    P.m22 = f;  P.m23 = cy;
+    P.m33 = 1.0;
+    return P;
+}
+
+/// camera at a position, looking at the origin
+Matrix3x4 createLookAtCamera(const Point3d& C, double f, double cx, double cy)
+{
+    const Point3d z = (Point3d() - C).normalize();
+    const Point3d x = cross(Point3d(0.0, 1.0, 0.0), z).normalize();
+    const Point3d y = cross(z, x);
+    Matrix3x4 P;
+    const Point3d rows[3] = {x * f + z * cx, y * f + z * cy, z};
+    double* m = P.m;
+    for(int r = 0; r < 3; ++r)
+    {
+        m[4 * r + 0] = rows[r].x;
+        m[4 * r + 1] = rows[r].y;
+        m[4 * r + 2] = rows[r].z;
+        m[4 * r + 3] = -dot(rows[r], C);
+    }
+    return P;
+}
+
+/// fronto-parallel quad [x0, x1] x [y0, y1] at depth z, as 2 triangles
+void addQuad(Mesh& mesh, double x0, double x1, double y0, double y1, double z)
+{
+    const int first = mesh.pts.size();
+    mesh.pts.push_back(Point3d(x0, y0, z));
+    mesh.pts.push_back(Point3d(x1, y0, z));
+    mesh.pts.push_back(Point3d(x1, y1, z));
+    mesh.pts.push_back(Point3d(x0, y1, z));
+    mesh.tris.push_back(Mesh::triangle(first, first + 1, first + 2));
+    mesh.tris.push_back(Mesh::triangle(first, first + 2, first + 3));
+}
+
+/// UV sphere of radius 1 centered at the origin
+void createSphere(Mesh& mesh, int nbRings, int nbSegments)
+{
+    for(int r = 0; r <= nbRings; ++r)
+    {
+        const double theta = M_PI * r / nbRings;
+        for(int s = 0; s < nbSegments; ++s)
+        {
+            const double phi = 2.0 * M_PI * s / nbSegments;
+            mesh.pts.push_back(Point3d(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+        }
+    }
+    for(int r = 0; r < nbRings; ++r)
+    {
+        for(int s = 0; s < nbSegments; ++s)
+        {
+            const int a = r * nbSegments + s;
+            const int b = r * nbSegments + (s + 1) % nbSegments;
+            mesh.tris.push_back(Mesh::triangle(a, a + nbSegments, b));
+            mesh.tris.push_back(Mesh::triangle(b, a + nbSegments, b + nbSegments));
+        }
+    }
+}
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - Rasterize a quad split in 2 triangles whose diagonal goes through pixel centers
+// - Assert that each pixel of the quad is covered by exactly one triangle, and the others by none
+// - Assert that the nearest of 2 overlapping quads is visible, with its depth
+//-----------------
+BOOST_AUTO_TEST_CASE(meshRasterizer_coverage)
+{
+    const int width = 80;
+    const int height = 60;
+    const Matrix3x4 P = createCamera(10.0, 0.0, 0.0);
+
+    // quad covering the pixels [8, 48) x [8, 48) at depth 1: its diagonal goes through the pixel centers
+    Mesh mesh;
+    addQuad(mesh, 0.8, 4.8, 0.8, 4.8, 1.0);
+
+    const MeshRasterizer rasterizer(mesh);
+    ZBuffer zbuffer;
+    rasterizer.rasterize(P, width, height, zbuffer);
+
+    int nbCovered = 0;
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const bool inside = (x >= 8 && x < 48 && y >= 8 && y < 48);
+            BOOST_CHECK_EQUAL(zbuffer.getTriId(x, y) >= 0, inside);
+            if(inside)
+            {
+                ++nbCovered;
+                BOOST_CHECK_CLOSE(zbuffer.getDepth(x, y), 1.0f, 1e-4);
+                // pixels strictly above the diagonal belong to the first triangle
+                if(x > y)
+                    BOOST_CHECK_EQUAL(zbuffer.getTriId(x, y), 0);
+                else if(x < y)
+                    BOOST_CHECK_EQUAL(zbuffer.getTriId(x, y), 1);
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(nbCovered, 40 * 40);
+
+    // occluding quad in front of the first one
+    addQuad(mesh, 2.0, 6.0, 2.0, 6.0, 0.5);
+    const MeshRasterizer occludedRasterizer(mesh);
+    occludedRasterizer.rasterize(P, width, height, zbuffer);
+
+    // pixel centers inside the projection [40, 120) of the second quad
+    BOOST_CHECK_GE(zbuffer.getTriId(45, 45), 2);
+    BOOST_CHECK_CLOSE(zbuffer.getDepth(45, 45), 0.5f, 1e-4);
+    BOOST_CHECK_LT(zbuffer.getTriId(20, 20), 2);
+    BOOST_CHECK_CLOSE(zbuffer.getDepth(20, 20), 1.0f, 1e-4);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Rasterize a sphere seen from several cameras
+// - Assert that the tiled parallel, serial and batched results are identical
+// - Assert that the depths are in the range of the visible part of the sphere and the covered area is its projected disk
+//-----------------
+BOOST_AUTO_TEST_CASE(meshRasterizer_sphere)
+{
+    const int width = 320;
+    const int height = 240;
+
+    Mesh mesh;
+    createSphere(mesh, 64, 128);
+    const MeshRasterizer rasterizer(mesh, 32);
+
+    std::vector<Matrix3x4> cameras;
+    for(int i = 0; i < 6; ++i)
+    {
+        const double angle = 2.0 * M_PI * i / 6;
+        const Point3d C = Point3d(std::cos(angle), 0.25 * i - 0.5, std::sin(angle)).normalize() * 4.0;
+        cameras.push_back(createLookAtCamera(C, 300.0, width / 2.0, height / 2.0));
+    }
+
+    std::vector<ZBuffer> batched(cameras.size());
+    rasterizer.rasterizeCameras(cameras, width, height, [&](int i, const ZBuffer& zbuffer) { batched[i] = zbuffer; });
+
+    for(std::size_t i = 0; i < cameras.size(); ++i)
+    {
+        ZBuffer parallel, serial;
+        rasterizer.rasterize(cameras[i], width, height, parallel, true);
+        rasterizer.rasterize(cameras[i], width, height, serial, false);
+
+        BOOST_CHECK(parallel.trisIds == serial.trisIds);
+        BOOST_CHECK(parallel.depth == serial.depth);
+        BOOST_CHECK(parallel.trisIds == batched[i].trisIds);
+
+        // the visible part of the sphere is between the depths 3 (nearest point) and 15/4 (silhouette)
+        int nbCovered = 0;
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                if(parallel.getTriId(x, y) < 0)
+                    continue;
+                ++nbCovered;
+                BOOST_CHECK_GE(parallel.getDepth(x, y), 3.0f - 1e-3f);
+                BOOST_CHECK_LE(parallel.getDepth(x, y), 3.75f + 1e-3f);
+            }
+        }
+
+        // projected disk of radius f * 1 / sqrt(4^2 - 1)
+        const double radius = 300.0 / std::sqrt(15.0);
+        BOOST_CHECK_CLOSE(double(nbCovered), M_PI * radius * radius, 2.0);
+    }
+}
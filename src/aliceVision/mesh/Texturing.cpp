@@ -10,6 +10,7 @@
 
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/mvsData/Color.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
@@ -267,24 +268,37 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     const std::size_t imageMaxMemSize =  mp.getMaxImageWidth() * mp.getMaxImageHeight() * sizeof(Color) / std::pow(2,20); //MB
     const std::size_t imagePyramidMaxMemSize = texParams.nbBand * imageMaxMemSize;
     const std::size_t atlasContribMemSize = texParams.textureSide * texParams.textureSide * (sizeof(Color)+sizeof(float)) / std::pow(2,20); //MB
-    const std::size_t atlasPyramidMaxMemSize = texParams.nbBand * atlasContribMemSize;
+    const std::size_t atlasPyramidMaxMemSize = std::max(std::size_t(1), texParams.nbBand * atlasContribMemSize);
 
     const int freeRam = int(memInfo.freeRam / std::pow(2,20));
-    const int availableMem = freeRam - 2 * imageMaxMemSize - imagePyramidMaxMemSize; // keep some memory for the 2 input images in cache and one laplacian pyramid
+    // if no explicit budget is provided, use the free RAM and keep 1 GB margin in memory
+    const bool useFreeRam = (texParams.maxMemory == 0);
+    const int memoryBudget = useFreeRam ? freeRam - 1000 : int(texParams.maxMemory);
+    const int availableMem = memoryBudget - 2 * imageMaxMemSize - imagePyramidMaxMemSize; // keep some memory for the 2 input images in cache and one laplacian pyramid
 
     const int nbAtlas = _atlases.size();
-    int nbAtlasMax = std::floor(availableMem / atlasPyramidMaxMemSize); //maximum number of textures laplacian pyramid in RAM
+    int nbAtlasMax = std::floor(availableMem / double(atlasPyramidMaxMemSize)); //maximum number of textures laplacian pyramid in RAM
     nbAtlasMax = std::min(nbAtlas, nbAtlasMax); //if enough memory, do it with all atlases
-    if (availableMem - nbAtlasMax*atlasPyramidMaxMemSize < 1000) //keep 1 GB margin in memory
-        nbAtlasMax -= 1;
     nbAtlasMax = std::max(1, nbAtlasMax); //if not enough memory, do it one by one
 
     ALICEVISION_LOG_INFO("Total amount of free RAM  : " << freeRam << " MB.");
+    ALICEVISION_LOG_INFO("Memory budget : " << memoryBudget << " MB" << (useFreeRam ? " (based on free RAM)." : "."));
     ALICEVISION_LOG_INFO("Total amount of memory available : " << availableMem << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an image in memory  : " << imageMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an atlas pyramid in memory: " << atlasPyramidMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Processing " << nbAtlas << " atlases by chunks of " << nbAtlasMax);
 
+    // the camera pyramids are reused by the next chunks, keep as many of them as the remaining memory allows
+    std::size_t nbPyramidsMax = 0;
+    if(nbAtlasMax < nbAtlas)
+    {
+        const std::size_t cameraPyramidMaxMemSize = std::max(std::size_t(1), imageMaxMemSize + imagePyramidMaxMemSize);
+        const int remainingMem = availableMem - nbAtlasMax * int(atlasPyramidMaxMemSize);
+        nbPyramidsMax = std::min(std::size_t(mp.ncams), std::size_t(std::max(0, remainingMem)) / cameraPyramidMaxMemSize);
+    }
+    PyramidCache pyramidCache(nbPyramidsMax);
+    ALICEVISION_LOG_INFO("Camera pyramids kept in memory between chunks: " << nbPyramidsMax);
+
     //generateTexture for the maximum number of atlases, and iterate
     const std::div_t divresult = div(nbAtlas, nbAtlasMax);
     std::vector<size_t> atlasIDs;
@@ -301,13 +315,32 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
             atlasIDs.push_back(atlasID);
         }
         ALICEVISION_LOG_INFO("Generating texture for atlases " << n*nbAtlasMax + 1 << " to " << n*nbAtlasMax+imax );
-        generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType);
+        generateTexturesSubSet(mp, atlasIDs, imageCache, pyramidCache, outPath, textureFileType);
     }
 }
 
+std::shared_ptr<const Texturing::CameraPyramid> Texturing::PyramidCache::get(int camId, mvsUtils::ImagesCache& imageCache, int nbBand, unsigned int downscale)
+{
+    const auto it = _pyramids.find(camId);
+    if(it != _pyramids.end())
+        return it->second;
+
+    // copy the image: its buffer is reused by the images cache
+    std::shared_ptr<CameraPyramid> cameraPyramid = std::make_shared<CameraPyramid>();
+    cameraPyramid->img = *imageCache.getImg_sync(camId);
+    cameraPyramid->img.laplacianPyramid(cameraPyramid->pyramidL, nbBand, downscale);
+
+    if(_pyramids.size() < _capacity)
+        _pyramids.emplace(camId, cameraPyramid);
+
+    return cameraPyramid;
+}
+
 void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
-                                const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache, const bfs::path& outPath, imageIO::EImageFileType textureFileType)
+                                const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache, PyramidCache& pyramidCache, const bfs::path& outPath, imageIO::EImageFileType textureFileType)
 {
+    ALICEVISION_PERF_ZONE("texturing.atlases");
+
     if(atlasIDs.size() > _atlases.size())
         throw std::runtime_error("Invalid atlas IDs ");
 
@@ -465,115 +498,173 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
         }
         ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") with contributions to " << cameraContributions.size() << " texture files:");
 
-        // Load camera image from cache
-        mvsUtils::ImagesCache::ImgSharedPtr imgPtr = imageCache.getImg_sync(camId);
-        const Image& camImg = *imgPtr;
+        // Get the camera pyramid, computed once and shared by all the atlases it contributes to
+        const std::shared_ptr<const CameraPyramid> cameraPyramid = pyramidCache.get(camId, imageCache, texParams.nbBand, texParams.multiBandDownscale);
+        const Image& camImg = cameraPyramid->img;
+        const std::vector<Image>& pyramidL = cameraPyramid->pyramidL; //laplacian pyramid
 
-        // Calculate laplacianPyramid
-        std::vector<Image> pyramidL; //laplacian pyramid
-        camImg.laplacianPyramid(pyramidL, texParams.nbBand, texParams.multiBandDownscale);
+        // inverse downscale factor of each frequency band of the pyramid
+        std::vector<double> bandInvDownscale(pyramidL.size());
+        for(std::size_t band = 0; band < pyramidL.size(); ++band)
+            bandInvDownscale[band] = 1.0 / std::pow(texParams.multiBandDownscale, band);
 
-        // for each output texture file
+        // Flatten the triangles contributions of this camera to all output texture files,
+        // with their UV and 3D coordinates.
+        struct TriangleContribution
+        {
+            AccuPyramid* accuPyramid;
+            int band;
+            unsigned int triangleId;
+            float score;
+            Point2d triPixs[3];
+            Point3d triPts[3];
+            Pixel LU, RD;
+        };
+        std::vector<TriangleContribution> trianglesContrib;
+        // first contribution of each atlas
+        std::vector<std::size_t> atlasContribBegin;
         for(const auto& c : cameraContributions)
         {
             AtlasIndex atlasID = c.first;
+            AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
             ALICEVISION_LOG_INFO("  - Texture file: " << atlasID + 1);
+            atlasContribBegin.push_back(trianglesContrib.size());
             //for each frequency band
             for(int band = 0; band < c.second.size(); ++band)
             {
                 const ScorePerTriangle& trianglesId = c.second[band];
                 ALICEVISION_LOG_INFO("      - band " << band + 1 << ": " << trianglesId.size() << " triangles.");
+                for(const auto& triangleScore : trianglesId)
+                    trianglesContrib.push_back({&accuPyramid, band, triangleScore.first, texParams.useScore ? triangleScore.second : 1.0f});
+            }
+        }
+        atlasContribBegin.push_back(trianglesContrib.size());
+
+        #pragma omp parallel for
+        for(int ti = 0; ti < trianglesContrib.size(); ++ti)
+        {
+            TriangleContribution& triContrib = trianglesContrib[ti];
+
+            // retrieve triangle 3D and UV coordinates
+            const unsigned int triangleId = triContrib.triangleId;
+            auto& triangleUvIds = mesh->trisUvIds[triangleId];
+            // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
+            Point2d udimBL;
+            StaticVector<Point2d>& uvCoords = mesh->uvCoords;
+            udimBL.x = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].x, uvCoords[triangleUvIds[1]].x), uvCoords[triangleUvIds[2]].x));
+            udimBL.y = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].y, uvCoords[triangleUvIds[1]].y), uvCoords[triangleUvIds[2]].y));
+
+            for(int k = 0; k < 3; k++)
+            {
+               const int pointIndex = mesh->tris[triangleId].v[k];
+               triContrib.triPts[k] = mesh->pts[pointIndex];                               // 3D coordinates
+               const int uvPointIndex = triangleUvIds.m[k];
+               Point2d uv = uvCoords[uvPointIndex];
+               // UDIM: remap coordinates between [0,1]
+               uv = uv - udimBL;
+
+               triContrib.triPixs[k] = uv * texParams.textureSide;   // UV coordinates
+            }
+
+            // compute triangle bounding box in pixel indexes
+            // min values: floor(value)
+            // max values: ceil(value)
+            const Point2d* triPixs = triContrib.triPixs;
+            Pixel& LU = triContrib.LU;
+            Pixel& RD = triContrib.RD;
+            LU.x = static_cast<int>(std::floor(std::min(std::min(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
+            LU.y = static_cast<int>(std::floor(std::min(std::min(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
+            RD.x = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
+            RD.y = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
+
+            // sanity check: clamp values to [0; textureSide]
+            int texSide = static_cast<int>(texParams.textureSide);
+            LU.x = clamp(LU.x, 0, texSide);
+            LU.y = clamp(LU.y, 0, texSide);
+            RD.x = clamp(RD.x, 0, texSide);
+            RD.y = clamp(RD.y, 0, texSide);
+        }
+
+        // Split each atlas in stripes of rows: a stripe is rasterized by a single thread,
+        // so the neighboring triangles and the bands of a triangle never write the same pixel concurrently.
+        // The triangles are binned in all the stripes they overlap, in their contribution order.
+        const int nbAtlasContrib = atlasContribBegin.size() - 1;
+        const int stripeHeight = 32;
+        const int nbStripes = (static_cast<int>(texParams.textureSide) + stripeHeight - 1) / stripeHeight;
+        std::vector<std::vector<int>> stripesContrib(nbAtlasContrib * nbStripes);
+        #pragma omp parallel for
+        for(int a = 0; a < nbAtlasContrib; ++a)
+        {
+            for(std::size_t ti = atlasContribBegin[a]; ti < atlasContribBegin[a + 1]; ++ti)
+            {
+                const TriangleContribution& triContrib = trianglesContrib[ti];
+                if(triContrib.LU.y >= triContrib.RD.y)
+                    continue;
+                for(int s = triContrib.LU.y / stripeHeight; s <= (triContrib.RD.y - 1) / stripeHeight; ++s)
+                    stripesContrib[a * nbStripes + s].push_back(ti);
+            }
+        }
+
+        // for each stripe of each atlas
+        #pragma omp parallel for schedule(dynamic)
+        for(int si = 0; si < stripesContrib.size(); ++si)
+        {
+            const int stripeBegin = (si % nbStripes) * stripeHeight;
+            const int stripeEnd = std::min(stripeBegin + stripeHeight, static_cast<int>(texParams.textureSide));
 
-                // for each triangle
-                #pragma omp parallel for
-                for(int ti = 0; ti < trianglesId.size(); ++ti)
+            for(const int ti : stripesContrib[si])
+            {
+                const TriangleContribution& triContrib = trianglesContrib[ti];
+                const Point2d* triPixs = triContrib.triPixs;
+                const float triangleScore = triContrib.score;
+                const int band = triContrib.band;
+                AccuPyramid& accuPyramid = *triContrib.accuPyramid;
+
+                // iterate over pixels of the triangle's bounding box in the stripe
+                for(int y = std::max(triContrib.LU.y, stripeBegin); y < std::min(triContrib.RD.y, stripeEnd); y++)
                 {
-                    const unsigned int triangleId = std::get<0>(trianglesId[ti]);
-                    const float triangleScore = texParams.useScore ? std::get<1>(trianglesId[ti]) : 1.0f;
-                    // retrieve triangle 3D and UV coordinates
-                    Point2d triPixs[3];
-                    Point3d triPts[3];
-                    auto& triangleUvIds = mesh->trisUvIds[triangleId];
-                    // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
-                    Point2d udimBL;
-                    StaticVector<Point2d>& uvCoords = mesh->uvCoords;
-                    udimBL.x = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].x, uvCoords[triangleUvIds[1]].x), uvCoords[triangleUvIds[2]].x));
-                    udimBL.y = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].y, uvCoords[triangleUvIds[1]].y), uvCoords[triangleUvIds[2]].y));
-
-                    for(int k = 0; k < 3; k++)
-                    {
-                       const int pointIndex = mesh->tris[triangleId].v[k];
-                       triPts[k] = mesh->pts[pointIndex];                               // 3D coordinates
-                       const int uvPointIndex = triangleUvIds.m[k];
-                       Point2d uv = uvCoords[uvPointIndex];
-                       // UDIM: remap coordinates between [0,1]
-                       uv = uv - udimBL;
-
-                       triPixs[k] = uv * texParams.textureSide;   // UV coordinates
-                    }
+                   // remap 'y' to image coordinates system (inverted Y axis)
+                   const unsigned int y_ = (texParams.textureSide - 1) - y;
+                   const unsigned int yoffset = y_ * texParams.textureSide;
+
+                   for(int x = triContrib.LU.x; x < triContrib.RD.x; x++)
+                   {
+                       Pixel pix(x, y); // top-left corner of the pixel
+                       Point2d barycCoords;
+
+                       // test if the pixel is inside triangle
+                       // and retrieve its barycentric coordinates
+                       if(!isPixelInTriangle(triPixs, pix, barycCoords))
+                       {
+                           continue;
+                       }
 
-                    // compute triangle bounding box in pixel indexes
-                    // min values: floor(value)
-                    // max values: ceil(value)
-                    Pixel LU, RD;
-                    LU.x = static_cast<int>(std::floor(std::min(std::min(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
-                    LU.y = static_cast<int>(std::floor(std::min(std::min(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
-                    RD.x = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
-                    RD.y = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
-
-                    // sanity check: clamp values to [0; textureSide]
-                    int texSide = static_cast<int>(texParams.textureSide);
-                    LU.x = clamp(LU.x, 0, texSide);
-                    LU.y = clamp(LU.y, 0, texSide);
-                    RD.x = clamp(RD.x, 0, texSide);
-                    RD.y = clamp(RD.y, 0, texSide);
-
-                    // iterate over pixels of the triangle's bounding box
-                    for(int y = LU.y; y < RD.y; y++)
-                    {
-                       for(int x = LU.x; x < RD.x; x++)
+                       // 1D pixel index
+                       const unsigned int xyoffset = yoffset + x;
+                       // get 3D coordinates
+                       Point3d pt3d = barycentricToCartesian(triContrib.triPts, barycCoords);
+                       // get 2D coordinates in source image
+                       Point2d pixRC;
+                       mp.getPixelFor3DPoint(&pixRC, pt3d, camId);
+                       // exclude out of bounds pixels
+                       if(!mp.isPixelInImage(pixRC, camId))
+                           continue;
+
+                       // If the color is pure zero (ie. no contributions), we consider it as an invalid pixel.
+                       if(camImg.getInterpolateColor(pixRC) == Color(0.f, 0.f, 0.f))
+                           continue;
+
+                       // Fill the accumulated pyramid for this pixel
+                       // each frequency band also contributes to lower frequencies (higher band indexes)
+                       for(std::size_t bandContrib = band; bandContrib < pyramidL.size(); ++bandContrib)
                        {
-                           Pixel pix(x, y); // top-left corner of the pixel
-                           Point2d barycCoords;
-
-                           // test if the pixel is inside triangle
-                           // and retrieve its barycentric coordinates
-                           if(!isPixelInTriangle(triPixs, pix, barycCoords))
-                           {
-                               continue;
-                           }
-
-                           // remap 'y' to image coordinates system (inverted Y axis)
-                           const unsigned int y_ = (texParams.textureSide - 1) - y;
-                           // 1D pixel index
-                           unsigned int xyoffset = y_ * texParams.textureSide + x;
-                           // get 3D coordinates
-                           Point3d pt3d = barycentricToCartesian(triPts, barycCoords);
-                           // get 2D coordinates in source image
-                           Point2d pixRC;
-                           mp.getPixelFor3DPoint(&pixRC, pt3d, camId);
-                           // exclude out of bounds pixels
-                           if(!mp.isPixelInImage(pixRC, camId))
-                               continue;
-
-                           // If the color is pure zero (ie. no contributions), we consider it as an invalid pixel.
-                           if(camImg.getInterpolateColor(pixRC) == Color(0.f, 0.f, 0.f))
-                               continue;
-
-                           // Fill the accumulated pyramid for this pixel
-                           // each frequency band also contributes to lower frequencies (higher band indexes)
-                           AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
-                           for(std::size_t bandContrib = band; bandContrib < pyramidL.size(); ++bandContrib)
-                           {
-                               int downscaleCoef = std::pow(texParams.multiBandDownscale, bandContrib);
-                               AccuImage& accuImage = accuPyramid.pyramid[bandContrib];
-
-                               // fill the accumulated color map for this pixel
-                               accuImage.img[xyoffset] += pyramidL[bandContrib].getInterpolateColor(pixRC/downscaleCoef) * triangleScore;
-                               accuImage.imgCount[xyoffset] += triangleScore;
-                           }
+                           AccuImage& accuImage = accuPyramid.pyramid[bandContrib];
+
+                           // fill the accumulated color map for this pixel
+                           accuImage.img[xyoffset] += pyramidL[bandContrib].getInterpolateColor(pixRC * bandInvDownscale[bandContrib]) * triangleScore;
+                           accuImage.imgCount[xyoffset] += triangleScore;
                        }
-                    }
+                   }
                 }
             }
         }
@@ -623,7 +714,8 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 #endif
 
         ALICEVISION_LOG_INFO("  - Computing final (average) color.");
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+        #pragma omp parallel for
+        for(int yp = 0; yp < static_cast<int>(texParams.textureSide); ++yp)
         {
             unsigned int yoffset = yp * texParams.textureSide;
             for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
@@ -658,17 +750,16 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 #endif
 
         // Fuse frequency bands into the first buffer, calculate final texture
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+        #pragma omp parallel for
+        for(int yp = 0; yp < static_cast<int>(texParams.textureSide); ++yp)
         {
-            unsigned int yoffset = yp * texParams.textureSide;
-            for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
+            const unsigned int yoffset = yp * texParams.textureSide;
+            for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
             {
-                unsigned int xyoffset = yoffset + xp;
-                for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                    atlasTexture.img[xyoffset] += atlasLevelTexture.img[xyoffset];
-                }
+                const AccuImage& atlasLevelTexture = accuPyramid.pyramid[level];
+                // contiguous row accumulation (vectorizable)
+                for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
+                    atlasTexture.img[yoffset + xp] += atlasLevelTexture.img[yoffset + xp];
             }
         }
         writeTexture(atlasTexture, atlasID, outPath, textureFileType, -1);
@@ -678,6 +769,8 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 void Texturing::writeTexture(AccuImage& atlasTexture, const std::size_t atlasID, const boost::filesystem::path &outPath,
                              imageIO::EImageFileType textureFileType, const int level)
 {
+    ALICEVISION_PERF_ZONE("texturing.writeTexture");
+
     unsigned int outTextureSide = texParams.textureSide;
     // WARNING: we modify the "imgCount" to apply the padding (to avoid the creation of a new buffer)
     // edge padding (dilate gutter)
@@ -886,6 +979,8 @@ void Texturing::replaceMesh(const std::string& otherMeshPath, bool flipNormals)
 
 void Texturing::unwrap(mvsUtils::MultiViewParams& mp, EUnwrapMethod method)
 {
+    ALICEVISION_PERF_ZONE("texturing.unwrap");
+
     if(method == mesh::EUnwrapMethod::Basic)
     {
         // generate UV coordinates based on automatic uv atlas
@@ -18,6 +18,9 @@
 
 #include <boost/filesystem.hpp>
 
+#include <map>
+#include <memory>
+
 namespace bfs = boost::filesystem;
 
 namespace aliceVision {
@@ -86,6 +89,9 @@ struct TexturingParams
     EVisibilityRemappingMethod visibilityRemappingMethod = EVisibilityRemappingMethod::PullPush;
 
     float subdivisionTargetRatio = 0.8;
+
+    /// memory budget (in MB) for the texture atlases and the camera pyramids (0: use the free RAM)
+    std::size_t maxMemory = 0;
 };
 
 struct Texturing
@@ -177,13 +183,51 @@ public:
         }
     };
 
+    /// Camera image and its laplacian pyramid
+    struct CameraPyramid
+    {
+        Image img;
+        std::vector<Image> pyramidL;
+    };
+
+    /**
+     * @brief Bounded cache of the camera pyramids, shared by the chunks of atlases.
+     *
+     * The cameras are visited in the same order for each chunk, so a least recently used policy
+     * would evict each pyramid before its reuse: the first pyramids are kept up to the capacity
+     * and the next ones are only used by the current chunk.
+     */
+    class PyramidCache
+    {
+    public:
+        explicit PyramidCache(std::size_t capacity)
+            : _capacity(capacity)
+        {}
+
+        /**
+         * @brief Get the pyramid of a camera, compute it if it is not in the cache
+         * @param[in] camId the camera index
+         * @param[in] imageCache the cache of the input images
+         * @param[in] nbBand the number of frequency bands
+         * @param[in] downscale the downscale factor between two bands
+         * @return the camera pyramid
+         */
+        std::shared_ptr<const CameraPyramid> get(int camId, mvsUtils::ImagesCache& imageCache, int nbBand, unsigned int downscale);
+
+        std::size_t capacity() const { return _capacity; }
+
+    private:
+        std::size_t _capacity;
+        std::map<int, std::shared_ptr<const CameraPyramid>> _pyramids;
+    };
+
     /// Generate texture files for all texture atlases
     void generateTextures(const mvsUtils::MultiViewParams& mp,
                           const bfs::path &outPath, imageIO::EImageFileType textureFileType = imageIO::EImageFileType::PNG);
 
     /// Generate texture files for the given sub-set of texture atlases
     void generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
-                         const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache,
+                         const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache, PyramidCache& pyramidCache,
                          const bfs::path &outPath, imageIO::EImageFileType textureFileType = imageIO::EImageFileType::PNG);
 
     ///Fill holes and write texture files for the given texture atlas
@@ -124,6 +124,34 @@ struct EpipolarDistanceError {
 };
 typedef EpipolarDistanceError SimpleError;
 
+/// Batched evaluation of an epipolar metric on 2xN point arrays.
+/// For each correspondence, the metric is computed from the squared algebraic error (y'Fx)^2
+/// and the squared norms of the epipolar lines (Fx)_{1,2} and (F'y)_{1,2}.
+template<typename MetricFunc>
+inline void EpipolarErrors(const Mat3 &F, const Mat &x1, const Mat &x2, vector<double> &errors, MetricFunc metric) {
+  assert(x1.rows() == 2 && x2.rows() == 2);
+  assert(x1.cols() == x2.cols());
+  const Mat::Index n = x1.cols();
+  errors.resize(n);
+  const double *p1 = x1.data();
+  const double *p2 = x2.data();
+  const double f00 = F(0,0), f01 = F(0,1), f02 = F(0,2);
+  const double f10 = F(1,0), f11 = F(1,1), f12 = F(1,2);
+  const double f20 = F(2,0), f21 = F(2,1), f22 = F(2,2);
+  // straight loop on contiguous data without branches (vectorizable)
+  for (Mat::Index i = 0; i < n; ++i) {
+    const double x = p1[2*i], y = p1[2*i+1];
+    const double u = p2[2*i], v = p2[2*i+1];
+    const double Fx0 = f00 * x + f01 * y + f02;
+    const double Fx1 = f10 * x + f11 * y + f12;
+    const double Fx2 = f20 * x + f21 * y + f22;
+    const double Fty0 = f00 * u + f10 * v + f20;
+    const double Fty1 = f01 * u + f11 * v + f21;
+    const double d = u * Fx0 + v * Fx1 + Fx2;
+    errors[i] = metric(d * d, Fx0 * Fx0 + Fx1 * Fx1, Fty0 * Fty0 + Fty1 * Fty1);
+  }
+}
+
 //-- Kernel solver for the 8pt Fundamental Matrix Estimation
 typedef twoView::kernel::Kernel<SevenPointSolver, SampsonError, Mat3>
   SevenPointKernel;
@@ -148,4 +176,34 @@ typedef twoView::kernel::Kernel<
 
 }  // namespace kernel
 }  // namespace fundamental
+
+namespace twoView {
+namespace kernel {
+
+template<>
+struct ErrorsEvaluator<fundamental::kernel::SampsonError> {
+  static void Errors(const Mat3 &F, const Mat &x1, const Mat &x2, vector<double> &errors) {
+    fundamental::kernel::EpipolarErrors(F, x1, x2, errors,
+      [](double d2, double nFx, double nFty) { return d2 / (nFx + nFty); });
+  }
+};
+
+template<>
+struct ErrorsEvaluator<fundamental::kernel::SymmetricEpipolarDistanceError> {
+  static void Errors(const Mat3 &F, const Mat &x1, const Mat &x2, vector<double> &errors) {
+    fundamental::kernel::EpipolarErrors(F, x1, x2, errors,
+      [](double d2, double nFx, double nFty) { return d2 * (1.0 / nFx + 1.0 / nFty) / 4.0; });
+  }
+};
+
+template<>
+struct ErrorsEvaluator<fundamental::kernel::EpipolarDistanceError> {
+  static void Errors(const Mat3 &F, const Mat &x1, const Mat &x2, vector<double> &errors) {
+    fundamental::kernel::EpipolarErrors(F, x1, x2, errors,
+      [](double d2, double nFx, double /*nFty*/) { return d2 / nFx; });
+  }
+};
+
+}  // namespace kernel
+}  // namespace twoView
 }  // namespace aliceVision
@@ -8,6 +8,12 @@
 
 #include "aliceVision/multiview/fundamentalKernelSolver.hpp"
 #include "aliceVision/multiview/projection.hpp"
+#include "aliceVision/multiview/NViewDataSet.hpp"
+#include "aliceVision/robustEstimation/ACRansac.hpp"
+#include "aliceVision/robustEstimation/ACRansacKernelAdaptator.hpp"
+#include "aliceVision/system/Timer.hpp"
+
+#include <random>
 
 #define BOOST_TEST_MODULE fundamentalKernelSolver
 #include <boost/test/included/unit_test.hpp>
@@ -121,3 +127,62 @@ BOOST_AUTO_TEST_CASE(EightPointTest_Normalized_EasyCase) {
   typedef fundamental::kernel::NormalizedEightPointKernel Kernel;
   BOOST_CHECK(ExpectKernelProperties<Kernel>(x1, x2));
 }
+
+// Check that the batched residuals evaluation matches the per-correspondence one
+template<typename ErrorArg>
+void ExpectBatchedErrors(const Mat3 &F, const Mat &x1, const Mat &x2) {
+  vector<double> errors;
+  twoView::kernel::ErrorsEvaluator<ErrorArg>::Errors(F, x1, x2, errors);
+  BOOST_CHECK_EQUAL(errors.size(), x1.cols());
+  for (Mat::Index i = 0; i < x1.cols(); ++i) {
+    const double expected = ErrorArg::Error(F, x1.col(i), x2.col(i));
+    BOOST_CHECK_SMALL(errors[i] - expected, 1e-9 * std::max(1.0, expected));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchedErrors_SameAsPerPoint) {
+  Mat3 F = Mat3::Random();
+  Mat x1 = Mat::Random(2, 100) * 500.0;
+  Mat x2 = Mat::Random(2, 100) * 500.0;
+  ExpectBatchedErrors<fundamental::kernel::SampsonError>(F, x1, x2);
+  ExpectBatchedErrors<fundamental::kernel::SymmetricEpipolarDistanceError>(F, x1, x2);
+  ExpectBatchedErrors<fundamental::kernel::EpipolarDistanceError>(F, x1, x2);
+}
+
+// Estimate the fundamental matrix of synthetic pairs with outliers using AC-RANSAC
+// and report the number of pairs processed per second.
+BOOST_AUTO_TEST_CASE(ACRansac_Fundamental_Throughput) {
+  const std::size_t nbPoints = 2000;
+  const std::size_t nbPairs = 20;
+  const double outlierRatio = 0.3;
+  const NViewDataSet d = NRealisticCamerasRing(2, nbPoints, NViewDatasetConfigurator(1000, 1000, 500, 500, 5, 0));
+
+  Mat x1 = d._x[0];
+  Mat x2 = d._x[1];
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> pixelDistribution(0.0, 1000.0);
+  const std::size_t nbOutliers = static_cast<std::size_t>(outlierRatio * nbPoints);
+  for (std::size_t i = 0; i < nbOutliers; ++i) {
+    x2.col(i) << pixelDistribution(generator), pixelDistribution(generator);
+  }
+
+  typedef robustEstimation::ACKernelAdaptor<
+    fundamental::kernel::SevenPointSolver,
+    fundamental::kernel::SimpleError,
+    UnnormalizerT,
+    Mat3> KernelType;
+
+  const KernelType kernel(x1, 1000, 1000, x2, 1000, 1000, true);
+
+  system::Timer timer;
+  for (std::size_t pair = 0; pair < nbPairs; ++pair) {
+    Mat3 F;
+    std::vector<std::size_t> inliers;
+    const std::pair<double, double> acRansacOut = robustEstimation::ACRANSAC(kernel, inliers, 1024, &F, Square(4.0));
+    BOOST_CHECK_LT(acRansacOut.second, 0.0);
+    BOOST_CHECK_GE(inliers.size(), 0.95 * (nbPoints - nbOutliers));
+  }
+  const double elapsed = timer.elapsed();
+  BOOST_TEST_MESSAGE("AC-RANSAC fundamental: " << nbPairs / elapsed << " pairs/s (" << nbPoints << " matches, "
+                     << outlierRatio * 100 << "% outliers).");
+}
@@ -57,4 +57,34 @@ typedef twoView::kernel::Kernel<
 
 }  // namespace kernel
 }  // namespace homography
+
+namespace twoView {
+namespace kernel {
+
+template<>
+struct ErrorsEvaluator<homography::kernel::AsymmetricError> {
+  template<typename ModelArg>
+  static void Errors(const ModelArg &H, const Mat &x1, const Mat &x2, vector<double> &errors) {
+    assert(x1.rows() == 2 && x2.rows() == 2);
+    assert(x1.cols() == x2.cols());
+    const Mat::Index n = x1.cols();
+    errors.resize(n);
+    const double *p1 = x1.data();
+    const double *p2 = x2.data();
+    const double h00 = H(0,0), h01 = H(0,1), h02 = H(0,2);
+    const double h10 = H(1,0), h11 = H(1,1), h12 = H(1,2);
+    const double h20 = H(2,0), h21 = H(2,1), h22 = H(2,2);
+    // straight loop on contiguous data without branches (vectorizable)
+    for (Mat::Index i = 0; i < n; ++i) {
+      const double x = p1[2*i], y = p1[2*i+1];
+      const double invW = 1.0 / (h20 * x + h21 * y + h22);
+      const double dx = p2[2*i] - (h00 * x + h01 * y + h02) * invW;
+      const double dy = p2[2*i+1] - (h10 * x + h11 * y + h12) * invW;
+      errors[i] = dx * dx + dy * dy;
+    }
+  }
+};
+
+}  // namespace kernel
+}  // namespace twoView
 }  // namespace aliceVision
@@ -90,3 +90,20 @@ BOOST_AUTO_TEST_CASE(HomographyKernelTest_Fitting_Normalized) {
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(HomographyKernelTest_BatchedErrors) {
+  Mat3 H;
+  H << 1.1, 0.05, 10.0,
+       -0.02, 0.95, -5.0,
+       1e-4, -2e-4, 1.0;
+  Mat x1 = Mat::Random(2, 100) * 500.0;
+  Mat x2 = Mat::Random(2, 100) * 500.0;
+
+  vector<double> errors;
+  twoView::kernel::ErrorsEvaluator<homography::kernel::AsymmetricError>::Errors(H, x1, x2, errors);
+  BOOST_CHECK_EQUAL(errors.size(), x1.cols());
+  for (Mat::Index i = 0; i < x1.cols(); ++i) {
+    const double expected = homography::kernel::AsymmetricError::Error(H, x1.col(i), x2.col(i));
+    BOOST_CHECK_SMALL(errors[i] - expected, 1e-9 * std::max(1.0, expected));
+  }
+}
@@ -108,6 +108,21 @@ public:
   }
 };
 
+/// Evaluate an error metric on all the correspondences at once.
+/// The generic version calls ErrorArg::Error for each correspondence;
+/// metrics can specialize it with a batched implementation working
+/// directly on the contiguous point arrays.
+template<typename ErrorArg>
+struct ErrorsEvaluator {
+  template<typename ModelArg>
+  static void Errors(const ModelArg &model, const Mat &x1, const Mat &x2, vector<double> &errors) {
+    errors.resize(x1.cols());
+    for (Mat::Index i = 0; i < x1.cols(); ++i) {
+      errors[i] = ErrorArg::Error(model, x1.col(i), x2.col(i));
+    }
+  }
+};
+
 }  // namespace kernel
 }  // namespace twoView
 }  // namespace aliceVision
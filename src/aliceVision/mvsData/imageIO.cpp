@@ -205,7 +205,8 @@ void readImage(const std::string& path,
                int& width,
                int& height,
                std::vector<T>& buffer,
-               EImageColorSpace toColorSpace)
+               EImageColorSpace toColorSpace,
+               int downscale = 1)
 {
     ALICEVISION_LOG_DEBUG("[IO] Read Image: " << path);
 
@@ -227,7 +228,28 @@ void readImage(const std::string& path,
 
     oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
 
-    inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+    // output size, the image is resized after the color conversion
+    int outWidth = 0;
+    int outHeight = 0;
+    int miplevel = 0;
+
+    if(downscale > 1)
+    {
+        if(!inBuf.init_spec(path, 0, 0))
+            throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+        outWidth = inBuf.spec().width / downscale;
+        outHeight = inBuf.spec().height / downscale;
+
+        // use the smallest MIP level of the file not below the requested resolution (if any)
+        while((2 << miplevel) <= downscale && miplevel + 1 < inBuf.nmiplevels())
+            ++miplevel;
+
+        if(miplevel > 0)
+            inBuf.reset(path, 0, miplevel, NULL, &configSpec);
+    }
+
+    inBuf.read(0, miplevel, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
 
     if(!inBuf.initialized())
         throw std::runtime_error("Cannot find/open image file '" + path + "'.");
@@ -283,10 +305,21 @@ void readImage(const std::string& path,
         inBuf.copy(grayscaleBuf);
     }
 
+    // downscale
+    if(downscale > 1 && (outWidth != inBuf.spec().width || outHeight != inBuf.spec().height))
+    {
+        oiio::ImageBuf resizedBuf(oiio::ImageSpec(outWidth, outHeight, inBuf.nchannels(), oiio::TypeDesc::FLOAT));
+        oiio::ImageBufAlgo::resize(resizedBuf, inBuf);
+        inBuf.copy(resizedBuf);
+    }
+
+    const int bufWidth = inBuf.spec().width;
+    const int bufHeight = inBuf.spec().height;
+
     // add missing channels
     if(nchannels > inSpec.nchannels)
     {
-        oiio::ImageSpec requestedSpec(inSpec.width, inSpec.height, nchannels, typeDesc);
+        oiio::ImageSpec requestedSpec(bufWidth, bufHeight, nchannels, typeDesc);
         oiio::ImageBuf requestedBuf(requestedSpec);
 
         // duplicate first channel for RGB
@@ -300,10 +333,10 @@ void readImage(const std::string& path,
         inBuf.copy(requestedBuf);
     }
 
-    width = inSpec.width;
-    height = inSpec.height;
+    width = bufWidth;
+    height = bufHeight;
 
-    buffer.resize(inSpec.width * inSpec.height);
+    buffer.resize(bufWidth * bufHeight);
 
     {
         oiio::ROI exportROI = inBuf.roi();
@@ -339,10 +372,10 @@ void readImage(const std::string& path, int& width, int& height, std::vector<Col
     readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, buffer, toColorSpace);
 }
 
-void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace)
+void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace, int downscale)
 {
     int width, height;
-    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, image.data(), toColorSpace);
+    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, image.data(), toColorSpace, downscale);
     image.setWidth(width);
     image.setHeight(height);
 }
@@ -193,7 +193,16 @@ void readImage(const std::string& path, int& width, int& height, std::vector<uns
 void readImage(const std::string& path, int& width, int& height, std::vector<rgb>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<float>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<Color>& buffer, EImageColorSpace toColorSpace);
-void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace);
+
+/**
+ * @brief read an image with a given path and buffer, downscaled by a given factor
+ * The MIP levels of the file are used when available, the remaining factor is applied after the color conversion.
+ * @param[in] path The given path to the image
+ * @param[out] image The output image, of the image size divided by the downscale factor
+ * @param[in] toColorSpace The output color space
+ * @param[in] downscale The downscale factor
+ */
+void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace, int downscale = 1);
 
 /**
  * @brief write an image with a given path and buffer
@@ -325,14 +325,19 @@ Matrix3x4 load3x4MatrixFromFile(FILE* fi)
 
 void loadImage(const std::string& path, const MultiViewParams* mp, int camId, Image& img, imageIO::EImageColorSpace colorspace, ImagesCache::ECorrectEV correctEV)
 {
+    // scale choosed by the user and apply during the process
+    const int processScale = mp->getProcessDownscale();
+
     // check image size
-    auto checkImageSize = [&path, &mp, camId, &img](){
-        if((mp->getOriginalWidth(camId) != img.width()) || (mp->getOriginalHeight(camId) != img.height()))
+    auto checkImageSize = [&path, &mp, camId, &img](int downscale){
+        const int expectedWidth = mp->getOriginalWidth(camId) / downscale;
+        const int expectedHeight = mp->getOriginalHeight(camId) / downscale;
+        if((expectedWidth != img.width()) || (expectedHeight != img.height()))
         {
             std::stringstream s;
             s << "Bad image dimension for camera : " << camId << "\n";
             s << "\t- image path : " << path << "\n";
-            s << "\t- expected dimension : " << mp->getOriginalWidth(camId) << "x" << mp->getOriginalHeight(camId) << "\n";
+            s << "\t- expected dimension : " << expectedWidth << "x" << expectedHeight << " (downscale: " << downscale << ")\n";
             s << "\t- real dimension : " << img.width() << "x" << img.height() << "\n";
             throw std::runtime_error(s.str());
         }
@@ -340,39 +345,39 @@ void loadImage(const std::string& path, const MultiViewParams* mp, int camId, Im
 
     if(correctEV == ImagesCache::ECorrectEV::NO_CORRECTION)
     {
-        imageIO::readImage(path, img, colorspace);
-        checkImageSize();
+        // the downscale is applied by the reader (after the color conversion), without a full resolution copy
+        if(processScale > 1)
+            ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp->getViewId(camId) << ".");
+
+        imageIO::readImage(path, img, colorspace, processScale);
+        checkImageSize(processScale);
+        return;
     }
+
     // if exposure correction, apply it in linear colorspace and then convert colorspace
-    else
-    {
-        imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR);
-        checkImageSize();
+    imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR);
+    checkImageSize(1);
 
-        oiio::ParamValueList metadata;
-        imageIO::readImageMetadata(path, metadata);
+    oiio::ParamValueList metadata;
+    imageIO::readImageMetadata(path, metadata);
 
-        float exposureCompensation = metadata.get_float("AliceVision:EVComp", -1);
+    float exposureCompensation = metadata.get_float("AliceVision:EVComp", -1);
 
-        if(exposureCompensation == -1)
-        {
-            exposureCompensation = 1.0f;
-            ALICEVISION_LOG_INFO("Cannot compensate exposure. PrepareDenseScene needs to be update");
-        }
-        else
-        {
-            ALICEVISION_LOG_INFO("  exposure compensation for image " << camId + 1 << ": " << exposureCompensation);
+    if(exposureCompensation == -1)
+    {
+        exposureCompensation = 1.0f;
+        ALICEVISION_LOG_INFO("Cannot compensate exposure. PrepareDenseScene needs to be update");
+    }
+    else
+    {
+        ALICEVISION_LOG_INFO("  exposure compensation for image " << camId + 1 << ": " << exposureCompensation);
 
-            for(int pix = 0; pix < img.size(); ++pix)
-                img[pix] = img[pix] * exposureCompensation;
+        for(int pix = 0; pix < img.size(); ++pix)
+            img[pix] = img[pix] * exposureCompensation;
 
-            imageAlgo::colorconvert(img, imageIO::EImageColorSpace::LINEAR, colorspace);
-        }
+        imageAlgo::colorconvert(img, imageIO::EImageColorSpace::LINEAR, colorspace);
     }
 
-    // scale choosed by the user and apply during the process
-    const int processScale = mp->getProcessDownscale();
-
     if(processScale > 1)
     {
         ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp->getViewId(camId) << ".");
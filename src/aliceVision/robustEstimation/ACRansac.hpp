@@ -174,7 +174,8 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
+  std::vector<ErrorIndex> vec_residuals; // [residual,index] under the maximum threshold
+  vec_residuals.reserve(nData);
   std::vector<double> vec_residuals_(nData);
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
@@ -186,6 +187,9 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
   std::vector<float> vec_logc_n, vec_logc_k;
   makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
 
+  // Residual value for which log(alpha) becomes non-negative (see bestNFA)
+  const double meaningfulThreshold = std::pow(10.0, -kernel.logalpha0() / kernel.multError());
+
   // Output parameters
   double minNFA = std::numeric_limits<double>::infinity();
   double errorMax = std::numeric_limits<double>::infinity();
@@ -228,11 +232,23 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
       }
       if (bACRansacMode)
       {
+        // Only the residuals under the maximum threshold are considered by the NFA,
+        // so only those are kept and sorted.
+        // Once a meaningful model has been found (minNFA < 0), residuals with a
+        // non-negative log(alpha) can only lead to a positive NFA and are discarded too.
+        const double threshold = (minNFA < 0) ? std::min(maxThreshold, meaningfulThreshold) : maxThreshold;
+        vec_residuals.clear();
         for (size_t i = 0; i < nData; ++i)
         {
           const double error = vec_residuals_[i];
-          vec_residuals[i] = ErrorIndex(error, i);
+          if (error <= threshold)
+            vec_residuals.emplace_back(error, i);
         }
+
+        // Not enough residuals to be meaningful (bestNFA would return an infinite NFA)
+        if (vec_residuals.size() <= sizeSample)
+          continue;
+
         std::sort(vec_residuals.begin(), vec_residuals.end());
 
         // Most meaningful discrimination inliers/outliers
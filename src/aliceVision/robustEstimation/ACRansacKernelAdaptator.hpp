@@ -28,6 +28,7 @@
 #include <aliceVision/config.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/multiview/conditioning.hpp>
+#include <aliceVision/multiview/twoViewKernel.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <vector>
@@ -154,9 +155,7 @@ public:
 
   void Errors(const Model & model, std::vector<double> & vec_errors) const
   {
-    vec_errors.resize(x1_.cols());
-    for(std::size_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(model, x1_.col(sample), x2_.col(sample));
+    twoView::kernel::ErrorsEvaluator<ErrorT>::Errors(model, x1_, x2_, vec_errors);
   }
 
   std::size_t NumSamples() const
@@ -411,9 +410,7 @@ public:
   {
     Mat3 F;
     FundamentalFromEssential(model, K1_, K2_, &F);
-    vec_errors.resize(x1_.cols());
-    for(std::size_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(F, this->x1_.col(sample), this->x2_.col(sample));
+    twoView::kernel::ErrorsEvaluator<ErrorT>::Errors(F, x1_, x2_, vec_errors);
   }
 
   std::size_t NumSamples() const { return x1_.cols(); }
@@ -14,6 +14,9 @@
 #include "aliceVision/feature/Regions.hpp"
 #include "aliceVision/camera/IntrinsicBase.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace aliceVision {
@@ -282,6 +285,203 @@ void GuidedMatching(
   }
 }
 
+/**
+ * @brief Regular 2D grid index over the (undistorted) feature positions of an image.
+ *        Features are stored per cell in a compact array (counting sort).
+ */
+class FeaturesGrid
+{
+public:
+  /**
+   * @brief Build the grid index
+   * @param[in] positions the feature positions
+   * @param[in] cellSize the size of a grid cell (in pixels)
+   */
+  FeaturesGrid(const std::vector<Vec2>& positions, double cellSize)
+    : _cellSize(cellSize)
+  {
+    _min = Vec2::Constant(std::numeric_limits<double>::max());
+    Vec2 max = Vec2::Constant(std::numeric_limits<double>::lowest());
+    for(const Vec2& pos : positions)
+    {
+      _min = _min.cwiseMin(pos);
+      max = max.cwiseMax(pos);
+    }
+    if(positions.empty())
+    {
+      _min.setZero();
+      max.setZero();
+    }
+    _nbCols = static_cast<int>((max(0) - _min(0)) / _cellSize) + 1;
+    _nbRows = static_cast<int>((max(1) - _min(1)) / _cellSize) + 1;
+
+    // count the features per cell and store them contiguously
+    std::vector<std::size_t> cellIndexes(positions.size());
+    _cellStart.assign(_nbCols * _nbRows + 1, 0);
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+      cellIndexes[i] = cellIndex(col(positions[i](0)), row(positions[i](1)));
+      ++_cellStart[cellIndexes[i] + 1];
+    }
+    for(std::size_t c = 1; c < _cellStart.size(); ++c)
+      _cellStart[c] += _cellStart[c - 1];
+
+    std::vector<std::size_t> cellFill(_cellStart.begin(), _cellStart.end() - 1);
+    _features.resize(positions.size());
+    for(std::size_t i = 0; i < positions.size(); ++i)
+      _features[cellFill[cellIndexes[i]]++] = static_cast<IndexT>(i);
+  }
+
+  /**
+   * @brief Call a functor on each feature index of the cells crossed by a band around a line.
+   * @param[in] line the line (a, b, c) with a*x + b*y + c = 0
+   * @param[in] halfWidth the band half width (in pixels)
+   * @param[in] func the functor called with each feature index
+   */
+  template <typename FuncT>
+  void forEachInBand(const Vec3& line, double halfWidth, FuncT func) const
+  {
+    const double a = line(0), b = line(1), c = line(2);
+    const double n = std::hypot(a, b);
+    if(n == 0.0)
+      return;
+
+    const bool iterateOnCols = std::abs(b) >= std::abs(a);
+    const int nbSteps = iterateOnCols ? _nbCols : _nbRows;
+    const int nbOthers = iterateOnCols ? _nbRows : _nbCols;
+    // band extent along the other axis
+    const double margin = halfWidth * n / (iterateOnCols ? std::abs(b) : std::abs(a));
+
+    for(int step = 0; step < nbSteps; ++step)
+    {
+      // coordinates of the cell borders along the iteration axis
+      const double t0 = (iterateOnCols ? _min(0) : _min(1)) + step * _cellSize;
+      const double t1 = t0 + _cellSize;
+      // line coordinates on the other axis at the cell borders
+      const double u0 = iterateOnCols ? -(a * t0 + c) / b : -(b * t0 + c) / a;
+      const double u1 = iterateOnCols ? -(a * t1 + c) / b : -(b * t1 + c) / a;
+      const double uMin = std::min(u0, u1) - margin - (iterateOnCols ? _min(1) : _min(0));
+      const double uMax = std::max(u0, u1) + margin - (iterateOnCols ? _min(1) : _min(0));
+      if(uMax < 0.0 || uMin >= nbOthers * _cellSize)
+        continue;
+
+      const int first = std::max(0, static_cast<int>(uMin / _cellSize));
+      const int last = std::min(nbOthers - 1, static_cast<int>(uMax / _cellSize));
+      for(int other = first; other <= last; ++other)
+      {
+        const std::size_t cell = iterateOnCols ? cellIndex(step, other) : cellIndex(other, step);
+        for(std::size_t k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k)
+          func(_features[k]);
+      }
+    }
+  }
+
+private:
+  inline int col(double x) const { return std::min(_nbCols - 1, static_cast<int>((x - _min(0)) / _cellSize)); }
+  inline int row(double y) const { return std::min(_nbRows - 1, static_cast<int>((y - _min(1)) / _cellSize)); }
+  inline std::size_t cellIndex(int col, int row) const { return static_cast<std::size_t>(row) * _nbCols + col; }
+
+  double _cellSize;
+  Vec2 _min;
+  int _nbCols = 0;
+  int _nbRows = 0;
+  std::vector<std::size_t> _cellStart;
+  std::vector<IndexT> _features;
+};
+
+/**
+ * @brief Guided Matching (features + descriptors with distance ratio) with a 2D grid index:
+ * The right features are binned in a regular grid, so each left feature is only compared
+ * to the right features of the cells crossed by its epipolar band (epipolar line +/- threshold).
+ * It finds the same correspondences as the exhaustive GuidedMatching with the same metric.
+ *
+ * @note ErrorArg must be the squared distance to the epipolar line in the right image
+ *       (e.g. fundamental::kernel::EpipolarDistanceError).
+ */
+template<typename ErrorArg> // The metric to compute distance to the model
+void GuidedMatching_Fundamental_Grid(
+  const Mat3 & F,       // The fundamental matrix
+  const camera::IntrinsicBase * camL, // Optional camera (in order to undistord on the fly feature positions, can be NULL)
+  const feature::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const camera::IntrinsicBase * camR, // Optional camera (in order to undistord on the fly feature positions, can be NULL)
+  const feature::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold (consider it's a square threshold)
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & out_matches) // Ouput corresponding index
+{
+  if(lRegions.RegionCount() == 0 || rRegions.RegionCount() < 2)
+    return;
+
+  // Build region positions arrays (in order to un-distord on-demand point position once)
+  std::vector<Vec2> lRegionsPos(lRegions.RegionCount());
+  std::vector<Vec2> rRegionsPos(rRegions.RegionCount());
+  for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
+    lRegionsPos[i] = (camL && camL->isValid()) ? camL->get_ud_pixel(lRegions.GetRegionPosition(i)) : lRegions.GetRegionPosition(i);
+  for(std::size_t j = 0; j < rRegions.RegionCount(); ++j)
+    rRegionsPos[j] = (camR && camR->isValid()) ? camR->get_ud_pixel(rRegions.GetRegionPosition(j)) : rRegions.GetRegionPosition(j);
+
+  // Cell size: a few features per cell, and not smaller than the epipolar band
+  const double halfWidth = std::sqrt(errorTh);
+  Vec2 rMin = rRegionsPos.front(), rMax = rRegionsPos.front();
+  for(const Vec2& pos : rRegionsPos)
+  {
+    rMin = rMin.cwiseMin(pos);
+    rMax = rMax.cwiseMax(pos);
+  }
+  const double area = std::max(1.0, (rMax - rMin).prod());
+  const double cellSize = std::max(2.0 * halfWidth, std::sqrt(4.0 * area / rRegionsPos.size()));
+  const FeaturesGrid grid(rRegionsPos, cellSize);
+
+  for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
+  {
+    const Vec3 line = F * Vec3(lRegionsPos[i](0), lRegionsPos[i](1), 1.0);
+    distanceRatio<double> dR;
+    grid.forEachInBand(line, halfWidth, [&](IndexT j)
+    {
+      // Compute the geometric error: error to the model
+      if(ErrorArg::Error(F, lRegionsPos[i], rRegionsPos[j]) < errorTh)
+      {
+        // Update the corresponding points & distance (if required)
+        dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
+      }
+    });
+    // Add correspondence only iff the distance ratio is valid
+    if(dR.isValid(distRatio))
+    {
+      // save the best corresponding index
+      out_matches.emplace_back(i, dR.idx);
+    }
+  }
+
+  // Remove duplicates (when multiple points at same position exist)
+  matching::IndMatch::getDeduplicated(out_matches);
+}
+
+/**
+ * @brief Guided Matching (features + descriptors with distance ratio) with a 2D grid index,
+ *        for all the common describer types.
+ */
+template<typename ErrorArg> // The metric to compute distance to the model
+void GuidedMatching_Fundamental_Grid(
+  const Mat3 & F,       // The fundamental matrix
+  const camera::IntrinsicBase * camL, // Optional camera (in order to undistord on the fly feature positions, can be NULL)
+  const feature::MapRegionsPerDesc & lRegions,  // regions (point features & corresponding descriptors)
+  const camera::IntrinsicBase * camR, // Optional camera (in order to undistord on the fly feature positions, can be NULL)
+  const feature::MapRegionsPerDesc & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold (consider it's a square threshold)
+  double distRatio,     // Maximal authorized distance ratio
+  matching::MatchesPerDescType & out_matchesPerDesc) // Ouput corresponding index
+{
+  const std::vector<feature::EImageDescriberType> descTypes = getCommonDescTypes(lRegions, rRegions);
+  if(descTypes.empty())
+    return;
+
+  for(const feature::EImageDescriberType descType: descTypes)
+  {
+    GuidedMatching_Fundamental_Grid<ErrorArg>(F, camL, *lRegions.at(descType), camR, *rRegions.at(descType), errorTh, distRatio, out_matchesPerDesc[descType]);
+  }
+}
+
 /// Compute a bucket index from an epipolar point
 ///  (the one that is closer to image border intersection)
 inline unsigned int pix_to_bucket(const Vec2i &x, int W, int H)
@@ -0,0 +1,98 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/robustEstimation/guidedMatching.hpp>
+#include <aliceVision/multiview/fundamentalKernelSolver.hpp>
+#include <aliceVision/multiview/projection.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE guidedMatching
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::robustEstimation;
+
+// Test summary:
+// - Create two views with known poses observing random 3D points,
+//   with random descriptors (noisy copies for the true correspondences)
+// - Check that the grid guided matching finds the same matches as the exhaustive one
+// - Log the timings of both implementations
+
+namespace {
+
+void addRandomDescriptor(feature::SIFT_Regions& regions, std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> distribution(0, 255);
+  feature::SIFT_Regions::DescriptorT descriptor;
+  for(std::size_t k = 0; k < descriptor.size(); ++k)
+    descriptor[k] = static_cast<unsigned char>(distribution(generator));
+  regions.Descriptors().push_back(descriptor);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(GuidedMatching_Grid_sameAsExhaustive)
+{
+  const int width = 2000, height = 1500;
+  const double focal = 1800.0;
+  const std::size_t nbPoints = 5000;
+
+  Mat3 K;
+  K << focal, 0, width / 2.0,
+       0, focal, height / 2.0,
+       0, 0, 1;
+
+  // two cameras looking at the origin
+  const Mat34 P1 = K * (Mat34() << Mat3::Identity(), Vec3(0.0, 0.0, 10.0)).finished();
+  const Mat3 R2 = Eigen::AngleAxisd(0.2, Vec3::UnitY()).toRotationMatrix();
+  const Mat34 P2 = K * (Mat34() << R2, Vec3(-2.0, 0.1, 10.0)).finished();
+  const Mat3 F = F_from_P(P1, P2);
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> pointDistribution(-3.0, 3.0);
+  std::normal_distribution<double> pixelNoise(0.0, 0.5);
+  std::uniform_int_distribution<int> descriptorNoise(-10, 10);
+
+  feature::SIFT_Regions lRegions, rRegions;
+  for(std::size_t i = 0; i < nbPoints; ++i)
+  {
+    const Vec4 X(pointDistribution(generator), pointDistribution(generator), pointDistribution(generator), 1.0);
+    const Vec2 x1 = (P1 * X).hnormalized();
+    const Vec2 x2 = (P2 * X).hnormalized();
+    lRegions.Features().emplace_back(x1(0) + pixelNoise(generator), x1(1) + pixelNoise(generator));
+    rRegions.Features().emplace_back(x2(0) + pixelNoise(generator), x2(1) + pixelNoise(generator));
+
+    addRandomDescriptor(lRegions, generator);
+    feature::SIFT_Regions::DescriptorT descriptor = lRegions.Descriptors().back();
+    for(std::size_t k = 0; k < descriptor.size(); ++k)
+      descriptor[k] = static_cast<unsigned char>(std::min(255, std::max(0, descriptor[k] + descriptorNoise(generator))));
+    rRegions.Descriptors().push_back(descriptor);
+  }
+
+  const double errorTh = Square(4.0);
+  const double distRatio = Square(0.8);
+
+  matching::IndMatches exhaustiveMatches;
+  system::Timer timer;
+  GuidedMatching<Mat3, fundamental::kernel::EpipolarDistanceError>(F, nullptr, lRegions, nullptr, rRegions, errorTh, distRatio, exhaustiveMatches);
+  const double exhaustiveElapsed = timer.elapsedMs();
+
+  matching::IndMatches gridMatches;
+  timer.reset();
+  GuidedMatching_Fundamental_Grid<fundamental::kernel::EpipolarDistanceError>(F, nullptr, lRegions, nullptr, rRegions, errorTh, distRatio, gridMatches);
+  const double gridElapsed = timer.elapsedMs();
+
+  ALICEVISION_LOG_INFO("Guided matching of " << nbPoints << " features: exhaustive " << exhaustiveElapsed << " ms, grid " << gridElapsed << " ms.");
+
+  BOOST_CHECK_GT(exhaustiveMatches.size(), 0.9 * nbPoints);
+  BOOST_CHECK_EQUAL(exhaustiveMatches.size(), gridMatches.size());
+  BOOST_CHECK(exhaustiveMatches == gridMatches);
+}
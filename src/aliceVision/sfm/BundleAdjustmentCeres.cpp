@@ -7,6 +7,7 @@
 
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/ResidualErrorFunctor.hpp>
+#include <aliceVision/sfm/ResidualErrorCostFunction.hpp>
 #include <aliceVision/sfm/ResidualErrorConstraintFunctor.hpp>
 #include <aliceVision/sfm/ResidualErrorRotationPriorFunctor.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
@@ -17,7 +18,9 @@
 
 #include <ceres/rotation.h>
 
+#include <chrono>
 #include <fstream>
+#include <unordered_set>
 
 
 
@@ -29,14 +32,72 @@ namespace sfm {
 using namespace aliceVision::camera;
 using namespace aliceVision::geometry;
 
+/**
+ * @brief Create the appropriate cost function with analytic jacobians according the provided input camera intrinsic model
+ * @param[in] intrinsicPtr The intrinsic pointer
+ * @param[in] observation The corresponding observation
+ * @return cost function
+ */
+ceres::CostFunction* createAnalyticCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const Vec2& observation)
+{
+  switch(intrinsicPtr->getType())
+  {
+    case PINHOLE_CAMERA:
+      return new ResidualErrorCostFunction<analyticCameraModel::Pinhole>(observation);
+    case PINHOLE_CAMERA_RADIAL1:
+      return new ResidualErrorCostFunction<analyticCameraModel::PinholeRadialK1>(observation);
+    case PINHOLE_CAMERA_RADIAL3:
+      return new ResidualErrorCostFunction<analyticCameraModel::PinholeRadialK3>(observation);
+    case PINHOLE_CAMERA_BROWN:
+      return new ResidualErrorCostFunction<analyticCameraModel::PinholeBrownT2>(observation);
+    case PINHOLE_CAMERA_FISHEYE:
+      return new ResidualErrorCostFunction<analyticCameraModel::PinholeFisheye>(observation);
+    case PINHOLE_CAMERA_FISHEYE1:
+      return new ResidualErrorCostFunction<analyticCameraModel::PinholeFisheye1>(observation);
+    default:
+      throw std::logic_error("Cannot create cost function, unrecognized intrinsic type in BA.");
+  }
+}
+
+/**
+ * @brief Create the appropriate cost function with analytic jacobians according the provided input rig camera intrinsic model
+ * @param[in] intrinsicPtr The intrinsic pointer
+ * @param[in] observation The corresponding observation
+ * @return cost function
+ */
+ceres::CostFunction* createAnalyticRigCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const Vec2& observation)
+{
+  switch(intrinsicPtr->getType())
+  {
+    case PINHOLE_CAMERA:
+      return new ResidualErrorRigCostFunction<analyticCameraModel::Pinhole>(observation);
+    case PINHOLE_CAMERA_RADIAL1:
+      return new ResidualErrorRigCostFunction<analyticCameraModel::PinholeRadialK1>(observation);
+    case PINHOLE_CAMERA_RADIAL3:
+      return new ResidualErrorRigCostFunction<analyticCameraModel::PinholeRadialK3>(observation);
+    case PINHOLE_CAMERA_BROWN:
+      return new ResidualErrorRigCostFunction<analyticCameraModel::PinholeBrownT2>(observation);
+    case PINHOLE_CAMERA_FISHEYE:
+      return new ResidualErrorRigCostFunction<analyticCameraModel::PinholeFisheye>(observation);
+    case PINHOLE_CAMERA_FISHEYE1:
+      return new ResidualErrorRigCostFunction<analyticCameraModel::PinholeFisheye1>(observation);
+    default:
+      throw std::logic_error("Cannot create rig cost function, unrecognized intrinsic type in BA.");
+  }
+}
+
 /**
  * @brief Create the appropriate cost functor according the provided input camera intrinsic model
  * @param[in] intrinsicPtr The intrinsic pointer
  * @param[in] observation The corresponding observation
+ * @param[in] analyticJacobians Use the cost functions with analytic jacobians instead of the automatic differentiation
  * @return cost functor
  */
-ceres::CostFunction* createCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const Vec2& observation)
+ceres::CostFunction* createCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const Vec2& observation, bool analyticJacobians = false)
 {
+  if(analyticJacobians)
+    return createAnalyticCostFunctionFromIntrinsics(intrinsicPtr, observation);
+
   switch(intrinsicPtr->getType())
   {
     case PINHOLE_CAMERA:
@@ -60,10 +121,14 @@ ceres::CostFunction* createCostFunctionFromIntrinsics(const IntrinsicBase* intri
  * @brief Create the appropriate cost functor according the provided input rig camera intrinsic model
  * @param[in] intrinsicPtr The intrinsic pointer
  * @param[in] observation The corresponding observation
+ * @param[in] analyticJacobians Use the cost functions with analytic jacobians instead of the automatic differentiation
  * @return cost functor
  */
-ceres::CostFunction* createRigCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const Vec2& observation)
+ceres::CostFunction* createRigCostFunctionFromIntrinsics(const IntrinsicBase* intrinsicPtr, const Vec2& observation, bool analyticJacobians = false)
 {
+  if(analyticJacobians)
+    return createAnalyticRigCostFunctionFromIntrinsics(intrinsicPtr, observation);
+
   switch(intrinsicPtr->getType())
   {
     case PINHOLE_CAMERA:
@@ -247,6 +312,7 @@ void BundleAdjustmentCeres::Statistics::show() const
   ALICEVISION_LOG_INFO("Bundle Adjustment Statistics:\n"
                         << ss.str()
                         << "\t- adjustment duration: " << time << " s\n"
+                        << "\t- problem creation duration: " << problemTime << " s (full creation: " << problemRebuildTime << " s)\n"
                         << "\t- poses:\n"
                         << "\t    - # refined:  " << states[EParameter::POSE][EParameterState::REFINED]  << "\n"
                         << "\t    - # constant: " << states[EParameter::POSE][EParameterState::CONSTANT] << "\n"
@@ -259,13 +325,37 @@ void BundleAdjustmentCeres::Statistics::show() const
                         << "\t    - # refined:  " << states[EParameter::INTRINSIC][EParameterState::REFINED]  << "\n"
                         << "\t    - # constant: " << states[EParameter::INTRINSIC][EParameterState::CONSTANT] << "\n"
                         << "\t    - # ignored:  " << states[EParameter::INTRINSIC][EParameterState::IGNORED]  << "\n"
-                        << "\t- # residual blocks: " << nbResidualBlocks << "\n"
+                        << "\t- # residual blocks: " << nbResidualBlocks << " (added: " << nbAddedResidualBlocks << ", removed: " << nbRemovedResidualBlocks << ")\n"
                         << "\t- # successful iterations: " << nbSuccessfullIterations   << "\n"
                         << "\t- # unsuccessful iterations: " << nbUnsuccessfullIterations << "\n"
                         << "\t- initial RMSE: " << RMSEinitial << "\n"
                         << "\t- final   RMSE: " << RMSEfinal);
 }
 
+BundleAdjustmentCeres::BundleAdjustmentCeres(const BundleAdjustmentCeres::CeresOptions& options)
+  : _ceresOptions(options)
+  , _lossFunction(new ceres::HuberLoss(Square(4.0))) // TODO: make the LOSS function and the parameter an option
+{}
+
+void BundleAdjustmentCeres::setCeresOptions(const BundleAdjustmentCeres::CeresOptions& options)
+{
+  // the cost functions of the problem depend on the jacobians option
+  if(!options.persistentProblem || options.useAnalyticJacobians != _ceresOptions.useAnalyticJacobians)
+    _problem.reset();
+
+  _ceresOptions = options;
+}
+
+ceres::Problem::Options BundleAdjustmentCeres::getProblemOptions() const
+{
+  ceres::Problem::Options problemOptions;
+  // the loss function is shared by the residual blocks and owned by the BundleAdjustmentCeres
+  problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  // residual blocks and parameters blocks are removed from a persistent problem
+  problemOptions.enable_fast_removal = _ceresOptions.persistentProblem;
+  return problemOptions;
+}
+
 void BundleAdjustmentCeres::setSolverOptions(ceres::Solver::Options& solverOptions) const
 {
   solverOptions.preconditioner_type = _ceresOptions.preconditionerType;
@@ -294,7 +384,7 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
   const bool refineTranslation = refineOptions & BundleAdjustment::REFINE_TRANSLATION;
   const bool refineRotation = refineOptions & BundleAdjustment::REFINE_ROTATION;
 
-  const auto addPose = [&](const sfmData::CameraPose& cameraPose, bool isConstant, std::array<double,6>& poseBlock)
+  const auto addPose = [&](const sfmData::CameraPose& cameraPose, bool isConstant, std::array<double,6>& poseBlock, bool isNewBlock)
   {
     const Mat3& R = cameraPose.getTransform().rotation();
     const Vec3& t = cameraPose.getTransform().translation();
@@ -309,7 +399,38 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
     poseBlock.at(5) = t(2);
 
     double* poseBlockPtr = poseBlock.data();
-    problem.AddParameterBlock(poseBlockPtr, 6);
+
+    if(isNewBlock)
+    {
+      problem.AddParameterBlock(poseBlockPtr, 6);
+
+      // constant parameters
+      std::vector<int> constantExtrinsic;
+
+      // don't refine rotations
+      if(!refineRotation)
+      {
+        constantExtrinsic.push_back(0);
+        constantExtrinsic.push_back(1);
+        constantExtrinsic.push_back(2);
+      }
+
+      // don't refine translations
+      if(!refineTranslation)
+      {
+        constantExtrinsic.push_back(3);
+        constantExtrinsic.push_back(4);
+        constantExtrinsic.push_back(5);
+      }
+
+      // subset parametrization
+      // the refine options do not change during the lifetime of the problem
+      if(!constantExtrinsic.empty() && constantExtrinsic.size() < 6)
+      {
+        ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(6, constantExtrinsic);
+        problem.SetParameterization(poseBlockPtr, subsetParameterization);
+      }
+    }
 
     // add pose parameter to the all parameters blocks pointers list
     _allParametersBlocks.push_back(poseBlockPtr);
@@ -323,31 +444,9 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
       return;
     }
 
-    // constant parameters
-    std::vector<int> constantExtrinsic;
-
-    // don't refine rotations
-    if(!refineRotation)
-    {
-      constantExtrinsic.push_back(0);
-      constantExtrinsic.push_back(1);
-      constantExtrinsic.push_back(2);
-    }
-
-    // don't refine translations
-    if(!refineTranslation)
-    {
-      constantExtrinsic.push_back(3);
-      constantExtrinsic.push_back(4);
-      constantExtrinsic.push_back(5);
-    }
-
-    // subset parametrization
-    if(!constantExtrinsic.empty())
-    {
-      ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(6, constantExtrinsic);
-      problem.SetParameterization(poseBlockPtr, subsetParameterization);
-    }
+    // the block of a persistent problem may have been constant in the previous adjustment
+    if(!isNewBlock)
+      problem.SetParameterBlockVariable(poseBlockPtr);
 
     _statistics.addState(EParameter::POSE, EParameterState::REFINED);
   };
@@ -367,7 +466,9 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
 
     const bool isConstant = (getPoseState(poseId) == EParameterState::CONSTANT);
 
-    addPose(pose, isConstant, _posesBlocks[poseId]);
+    const bool isNewBlock = (_posesBlocks.find(poseId) == _posesBlocks.end());
+
+    addPose(pose, isConstant, _posesBlocks[poseId], isNewBlock);
   }
 
   // setup sub-poses data
@@ -386,7 +487,10 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
 
       const bool isConstant = (rigSubPose.status == sfmData::ERigSubPoseStatus::CONSTANT);
 
-      addPose(sfmData::CameraPose(rigSubPose.pose), isConstant, _rigBlocks[rigId][subPoseId]);
+      HashMap<IndexT, std::array<double,6>>& rigBlocks = _rigBlocks[rigId];
+      const bool isNewBlock = (rigBlocks.find(subPoseId) == rigBlocks.end());
+
+      addPose(sfmData::CameraPose(rigSubPose.pose), isConstant, rigBlocks[subPoseId], isNewBlock);
     }
   }
 }
@@ -431,86 +535,122 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
 
     assert(isValid(intrinsicPtr->getType()));
 
-    std::vector<double>& intrinsicBlock = _intrinsicsBlocks[intrinsicId];
-    intrinsicBlock = intrinsicPtr->getParams();
-
-    double* intrinsicBlockPtr = intrinsicBlock.data();
-    problem.AddParameterBlock(intrinsicBlockPtr, intrinsicBlock.size());
-
-    // add intrinsic parameter to the all parameters blocks pointers list
-    _allParametersBlocks.push_back(intrinsicBlockPtr);
-
-    // keep the camera intrinsic constant
-    if(intrinsicPtr->isLocked() || !refineIntrinsics || getIntrinsicState(intrinsicId) == EParameterState::CONSTANT)
-    {
-      // set the whole parameter block as constant.
-      _statistics.addState(EParameter::INTRINSIC, EParameterState::CONSTANT);
-      problem.SetParameterBlockConstant(intrinsicBlockPtr);
-      continue;
-    }
+    const std::vector<double> intrinsicParams = intrinsicPtr->getParams();
+    const std::size_t minImagesForOpticalCenter = 3;
+    const bool refineOpticalCenter = refineIntrinsicsOpticalCenter && (usageCount > minImagesForOpticalCenter);
 
     // constant parameters
     std::vector<int> constantIntrinisc;
 
-    // refine the focal length
-    if(refineIntrinsicsFocalLength)
+    if(intrinsicPtr->isLocked() || !refineIntrinsics)
     {
-      if(intrinsicPtr->initialFocalLengthPix() > 0)
-      {
-        // if we have an initial guess, we only authorize a margin around this value.
-        assert(intrinsicBlock.size() >= 1);
-        const unsigned int maxFocalError = 0.2 * std::max(intrinsicPtr->w(), intrinsicPtr->h()); // TODO : check if rounding is needed
-        problem.SetParameterLowerBound(intrinsicBlockPtr, 0, static_cast<double>(intrinsicPtr->initialFocalLengthPix() - maxFocalError));
-        problem.SetParameterUpperBound(intrinsicBlockPtr, 0, static_cast<double>(intrinsicPtr->initialFocalLengthPix() + maxFocalError));
-      }
-      else // no initial guess
-      {
-        // we don't have an initial guess, but we assume that we use
-        // a converging lens, so the focal length should be positive.
-        problem.SetParameterLowerBound(intrinsicBlockPtr, 0, 0.0);
-      }
+      // the whole parameter block is constant
+      for(std::size_t i = 0; i < intrinsicParams.size(); ++i)
+        constantIntrinisc.push_back(i);
     }
     else
     {
-      // set focal length as constant
-      constantIntrinisc.push_back(0);
-    }
+      // don't refine the focal length
+      if(!refineIntrinsicsFocalLength)
+        constantIntrinisc.push_back(0);
 
-    const std::size_t minImagesForOpticalCenter = 3;
+      // don't refine the optical center
+      if(!refineOpticalCenter)
+      {
+        constantIntrinisc.push_back(1);
+        constantIntrinisc.push_back(2);
+      }
 
-    // optical center
-    if(refineIntrinsicsOpticalCenter && (usageCount > minImagesForOpticalCenter))
-    {
-      // refine optical center within 10% of the image size.
-      assert(intrinsicBlock.size() >= 3);
+      // lens distortion
+      if(!refineIntrinsicsDistortion)
+        for(std::size_t i = 3; i < intrinsicParams.size(); ++i)
+          constantIntrinisc.push_back(i);
+    }
 
-      const double opticalCenterMinPercent = 0.45;
-      const double opticalCenterMaxPercent = 0.55;
+    // the parametrization of a block cannot be changed: the block of a persistent problem is re-created
+    // if its constant parameters changed (the optical center is refined once enough views use the intrinsic)
+    const auto constantParamsIt = _intrinsicsConstantParams.find(intrinsicId);
+    if(constantParamsIt != _intrinsicsConstantParams.end() && constantParamsIt->second != constantIntrinisc)
+      removeIntrinsicFromProblem(sfmData, intrinsicId, problem);
 
-      // add bounds to the principal point
-      problem.SetParameterLowerBound(intrinsicBlockPtr, 1, opticalCenterMinPercent * intrinsicPtr->w());
-      problem.SetParameterUpperBound(intrinsicBlockPtr, 1, opticalCenterMaxPercent * intrinsicPtr->w());
-      problem.SetParameterLowerBound(intrinsicBlockPtr, 2, opticalCenterMinPercent * intrinsicPtr->h());
-      problem.SetParameterUpperBound(intrinsicBlockPtr, 2, opticalCenterMaxPercent * intrinsicPtr->h());
-    }
+    const bool isNewBlock = (_intrinsicsBlocks.find(intrinsicId) == _intrinsicsBlocks.end());
+    std::vector<double>& intrinsicBlock = _intrinsicsBlocks[intrinsicId];
+
+    // update the values without reallocating the block of a persistent problem
+    if(isNewBlock)
+      intrinsicBlock = intrinsicParams;
     else
+      std::copy(intrinsicParams.begin(), intrinsicParams.end(), intrinsicBlock.begin());
+
+    double* intrinsicBlockPtr = intrinsicBlock.data();
+
+    // add intrinsic parameter to the all parameters blocks pointers list
+    _allParametersBlocks.push_back(intrinsicBlockPtr);
+
+    if(isNewBlock)
     {
-      // don't refine the optical center
-      constantIntrinisc.push_back(1);
-      constantIntrinisc.push_back(2);
-    }
+      problem.AddParameterBlock(intrinsicBlockPtr, intrinsicBlock.size());
+      _intrinsicsConstantParams[intrinsicId] = constantIntrinisc;
 
-    // lens distortion
-    if(!refineIntrinsicsDistortion)
-      for(std::size_t i = 3; i < intrinsicBlock.size(); ++i)
-        constantIntrinisc.push_back(i);
+      // bounds and subset parametrization of the refined parameters
+      if(constantIntrinisc.size() < intrinsicBlock.size())
+      {
+        // refine the focal length
+        if(refineIntrinsicsFocalLength)
+        {
+          if(intrinsicPtr->initialFocalLengthPix() > 0)
+          {
+            // if we have an initial guess, we only authorize a margin around this value.
+            assert(intrinsicBlock.size() >= 1);
+            const unsigned int maxFocalError = 0.2 * std::max(intrinsicPtr->w(), intrinsicPtr->h()); // TODO : check if rounding is needed
+            problem.SetParameterLowerBound(intrinsicBlockPtr, 0, static_cast<double>(intrinsicPtr->initialFocalLengthPix() - maxFocalError));
+            problem.SetParameterUpperBound(intrinsicBlockPtr, 0, static_cast<double>(intrinsicPtr->initialFocalLengthPix() + maxFocalError));
+          }
+          else // no initial guess
+          {
+            // we don't have an initial guess, but we assume that we use
+            // a converging lens, so the focal length should be positive.
+            problem.SetParameterLowerBound(intrinsicBlockPtr, 0, 0.0);
+          }
+        }
+
+        // optical center
+        if(refineOpticalCenter)
+        {
+          // refine optical center within 10% of the image size.
+          assert(intrinsicBlock.size() >= 3);
+
+          const double opticalCenterMinPercent = 0.45;
+          const double opticalCenterMaxPercent = 0.55;
+
+          // add bounds to the principal point
+          problem.SetParameterLowerBound(intrinsicBlockPtr, 1, opticalCenterMinPercent * intrinsicPtr->w());
+          problem.SetParameterUpperBound(intrinsicBlockPtr, 1, opticalCenterMaxPercent * intrinsicPtr->w());
+          problem.SetParameterLowerBound(intrinsicBlockPtr, 2, opticalCenterMinPercent * intrinsicPtr->h());
+          problem.SetParameterUpperBound(intrinsicBlockPtr, 2, opticalCenterMaxPercent * intrinsicPtr->h());
+        }
+
+        if(!constantIntrinisc.empty())
+        {
+          ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(intrinsicBlock.size(), constantIntrinisc);
+          problem.SetParameterization(intrinsicBlockPtr, subsetParameterization);
+        }
+      }
+    }
 
-    if(!constantIntrinisc.empty())
+    // keep the camera intrinsic constant
+    if(constantIntrinisc.size() == intrinsicBlock.size() || getIntrinsicState(intrinsicId) == EParameterState::CONSTANT)
     {
-      ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(intrinsicBlock.size(), constantIntrinisc);
-      problem.SetParameterization(intrinsicBlockPtr, subsetParameterization);
+      // set the whole parameter block as constant.
+      _statistics.addState(EParameter::INTRINSIC, EParameterState::CONSTANT);
+      problem.SetParameterBlockConstant(intrinsicBlockPtr);
+      continue;
     }
 
+    // the block of a persistent problem may have been constant in the previous adjustment
+    if(!isNewBlock)
+      problem.SetParameterBlockVariable(intrinsicBlockPtr);
+
     _statistics.addState(EParameter::INTRINSIC, EParameterState::REFINED);
   }
 }
@@ -519,10 +659,6 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
 {
   const bool refineStructure = refineOptions & REFINE_STRUCTURE;
 
-  // set a LossFunction to be less penalized by false measurements.
-  // note: set it to NULL if you don't want use a lossFunction.
-  ceres::LossFunction* lossFunction = new ceres::HuberLoss(Square(4.0)); // TODO: make the LOSS function and the parameter an option
-
   // build the residual blocks corresponding to the track observations
   for(const auto& landmarkPair: sfmData.getLandmarks())
   {
@@ -537,6 +673,12 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       continue;
     }
 
+    // a landmark without observation is not part of the problem
+    if(landmark.observations.empty())
+      continue;
+
+    const bool isNewBlock = (_landmarksBlocks.find(landmarkId) == _landmarksBlocks.end());
+
     std::array<double,3>& landmarkBlock = _landmarksBlocks[landmarkId];
     for(std::size_t i = 0; i < 3; ++i)
       landmarkBlock.at(i) = landmark.X(Eigen::Index(i));
@@ -546,6 +688,22 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
     // add landmark parameter to the all parameters blocks pointers list
     _allParametersBlocks.push_back(landmarkBlockPtr);
 
+    // residual blocks of the landmark observations already in the problem
+    HashMap<IndexT, ObservationResidual>& landmarkResiduals = _landmarksResiduals[landmarkId];
+
+    // remove the residual blocks of the observations no longer in the landmark track
+    for(auto it = landmarkResiduals.begin(); it != landmarkResiduals.end();)
+    {
+      if(landmark.observations.find(it->first) == landmark.observations.end())
+      {
+        problem.RemoveResidualBlock(it->second.residualBlockId);
+        it = landmarkResiduals.erase(it);
+        ++_statistics.nbRemovedResidualBlocks;
+      }
+      else
+        ++it;
+    }
+
     // iterate over 2D observation associated to the 3D landmark
     for(const auto& observationPair: landmark.observations)
     {
@@ -562,6 +720,7 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       // needed parameters to create a residual block (K, pose)
       double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
       double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+      double* subPoseBlockPtr = (view.isPartOfRig() && !view.isPoseIndependant()) ? _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data() : nullptr;
 
       // apply a specific parameter ordering:
       if(_ceresOptions.useParametersOrdering)
@@ -571,48 +730,77 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
         _ceresOptions.linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
       }
 
-      if(view.isPartOfRig() && !view.isPoseIndependant())
+      auto residualIt = landmarkResiduals.find(observationPair.first);
+
+      // the view of a persistent problem may have been moved to another pose, rig sub-pose or intrinsic
+      // (e.g. rig resection) since the residual block of the observation was built
+      if(residualIt != landmarkResiduals.end() &&
+         (residualIt->second.poseBlock != poseBlockPtr ||
+          residualIt->second.subPoseBlock != subPoseBlockPtr ||
+          residualIt->second.intrinsicBlock != intrinsicBlockPtr))
       {
-        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation.x);
-
-        problem.AddResidualBlock(costFunction,
-            lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
-            _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data(), // subpose of the cameras rig
-            landmarkBlockPtr); // do we need to copy 3D point to avoid false motion, if failure ?
+        problem.RemoveResidualBlock(residualIt->second.residualBlockId);
+        landmarkResiduals.erase(residualIt);
+        residualIt = landmarkResiduals.end();
+        ++_statistics.nbRemovedResidualBlocks;
       }
-      else
-      {
-        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation.x);
 
-        problem.AddResidualBlock(costFunction,
-            lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
-            landmarkBlockPtr); //do we need to copy 3D point to avoid false motion, if failure ?
+      // the residual block of the observation is already in the persistent problem
+      if(residualIt == landmarkResiduals.end())
+      {
+        ceres::ResidualBlockId residualBlockId;
+
+        if(subPoseBlockPtr != nullptr)
+        {
+          ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation.x, _ceresOptions.useAnalyticJacobians);
+
+          residualBlockId = problem.AddResidualBlock(costFunction,
+              _lossFunction.get(),
+              intrinsicBlockPtr,
+              poseBlockPtr,
+              subPoseBlockPtr, // subpose of the cameras rig
+              landmarkBlockPtr); // do we need to copy 3D point to avoid false motion, if failure ?
+        }
+        else
+        {
+          ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation.x, _ceresOptions.useAnalyticJacobians);
+
+          residualBlockId = problem.AddResidualBlock(costFunction,
+              _lossFunction.get(),
+              intrinsicBlockPtr,
+              poseBlockPtr,
+              landmarkBlockPtr); //do we need to copy 3D point to avoid false motion, if failure ?
+        }
+
+        ObservationResidual& observationResidual = landmarkResiduals[observationPair.first];
+        observationResidual.residualBlockId = residualBlockId;
+        observationResidual.intrinsicBlock = intrinsicBlockPtr;
+        observationResidual.poseBlock = poseBlockPtr;
+        observationResidual.subPoseBlock = subPoseBlockPtr;
+        ++_statistics.nbAddedResidualBlocks;
       }
 
       if(!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT)
-      {
-        // set the whole landmark parameter block as constant.
         _statistics.addState(EParameter::LANDMARK, EParameterState::CONSTANT);
-        problem.SetParameterBlockConstant(landmarkBlockPtr);
-      }
       else
-      {
         _statistics.addState(EParameter::LANDMARK, EParameterState::REFINED);
-      }
+    }
+
+    if(!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT)
+    {
+      // set the whole landmark parameter block as constant.
+      problem.SetParameterBlockConstant(landmarkBlockPtr);
+    }
+    else if(!isNewBlock)
+    {
+      // the block of a persistent problem may have been constant in the previous adjustment
+      problem.SetParameterBlockVariable(landmarkBlockPtr);
     }
   }
 }
 
 void BundleAdjustmentCeres::addConstraints2DToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
 {
-  // set a LossFunction to be less penalized by false measurements.
-  // note: set it to NULL if you don't want use a lossFunction.
-  ceres::LossFunction* lossFunction = new ceres::HuberLoss(Square(4.0)); // TODO: make the LOSS function and the parameter an option
-
   for (const auto & constraint : sfmData.getConstraints2D()) {
     const sfmData::View& view_1 = sfmData.getView(constraint.ViewFirst);
     const sfmData::View& view_2 = sfmData.getView(constraint.ViewSecond);
@@ -632,7 +820,8 @@ void BundleAdjustmentCeres::addConstraints2DToProblem(const sfmData::SfMData& sf
     assert(intrinsicBlockPtr_1 == intrinsicBlockPtr_2);
 
     ceres::CostFunction* costFunction = createConstraintsCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view_1.getIntrinsicId()), constraint.ObservationFirst.x, constraint.ObservationSecond.x);
-    problem.AddResidualBlock(costFunction, lossFunction, intrinsicBlockPtr_1, poseBlockPtr_1, poseBlockPtr_2);
+    _otherResiduals.push_back(problem.AddResidualBlock(costFunction, _lossFunction.get(), intrinsicBlockPtr_1, poseBlockPtr_1, poseBlockPtr_2));
+    ++_statistics.nbAddedResidualBlocks;
   }
 }
 
@@ -654,7 +843,8 @@ void BundleAdjustmentCeres::addRotationPriorsToProblem(const sfmData::SfMData& s
 
 
     ceres::CostFunction* costFunction = new ceres::AutoDiffCostFunction<ResidualErrorRotationPriorFunctor, 3, 6, 6>(new ResidualErrorRotationPriorFunctor(prior._second_R_first));
-    problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2);
+    _otherResiduals.push_back(problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2));
+    ++_statistics.nbAddedResidualBlocks;
   }
 }
 
@@ -685,6 +875,146 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   addRotationPriorsToProblem(sfmData, refineOptions, problem);
 }
 
+void BundleAdjustmentCeres::removeIntrinsicFromProblem(const sfmData::SfMData& sfmData, IndexT intrinsicId, ceres::Problem& problem)
+{
+  double* intrinsicBlockPtr = _intrinsicsBlocks.at(intrinsicId).data();
+
+  // the residual blocks depending on the intrinsic are removed with its parameter block
+  problem.RemoveParameterBlock(intrinsicBlockPtr);
+  removeCachedResiduals({intrinsicBlockPtr});
+
+  _intrinsicsBlocks.erase(intrinsicId);
+  _intrinsicsConstantParams.erase(intrinsicId);
+}
+
+void BundleAdjustmentCeres::removeCachedResiduals(const std::unordered_set<const double*>& blocks)
+{
+  for(auto& landmarkResidualsPair : _landmarksResiduals)
+  {
+    HashMap<IndexT, ObservationResidual>& landmarkResiduals = landmarkResidualsPair.second;
+
+    for(auto it = landmarkResiduals.begin(); it != landmarkResiduals.end();)
+    {
+      const ObservationResidual& residual = it->second;
+
+      if(blocks.count(residual.intrinsicBlock) || blocks.count(residual.poseBlock) || blocks.count(residual.subPoseBlock))
+      {
+        it = landmarkResiduals.erase(it);
+        ++_statistics.nbRemovedResidualBlocks;
+      }
+      else
+        ++it;
+    }
+  }
+}
+
+void BundleAdjustmentCeres::removeUnusedBlocksFromProblem(const sfmData::SfMData& sfmData, ceres::Problem& problem)
+{
+  const std::unordered_set<const double*> usedBlocks(_allParametersBlocks.begin(), _allParametersBlocks.end());
+
+  // landmarks first: the remaining residual blocks only depend on used poses and intrinsics
+  for(auto it = _landmarksBlocks.begin(); it != _landmarksBlocks.end();)
+  {
+    if(usedBlocks.count(it->second.data()) == 0)
+    {
+      // the residual blocks depending on the landmark are removed with its parameter block
+      problem.RemoveParameterBlock(it->second.data());
+
+      const auto residualsIt = _landmarksResiduals.find(it->first);
+      if(residualsIt != _landmarksResiduals.end())
+      {
+        _statistics.nbRemovedResidualBlocks += residualsIt->second.size();
+        _landmarksResiduals.erase(residualsIt);
+      }
+      it = _landmarksBlocks.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  // the residual blocks depending on a removed pose or rig sub-pose are removed with its parameter block
+  std::unordered_set<const double*> removedBlocks;
+
+  for(auto it = _posesBlocks.begin(); it != _posesBlocks.end();)
+  {
+    if(usedBlocks.count(it->second.data()) == 0)
+    {
+      problem.RemoveParameterBlock(it->second.data());
+      removedBlocks.insert(it->second.data());
+      it = _posesBlocks.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  for(auto rigIt = _rigBlocks.begin(); rigIt != _rigBlocks.end();)
+  {
+    for(auto it = rigIt->second.begin(); it != rigIt->second.end();)
+    {
+      if(usedBlocks.count(it->second.data()) == 0)
+      {
+        problem.RemoveParameterBlock(it->second.data());
+        removedBlocks.insert(it->second.data());
+        it = rigIt->second.erase(it);
+      }
+      else
+        ++it;
+    }
+
+    if(rigIt->second.empty())
+      rigIt = _rigBlocks.erase(rigIt);
+    else
+      ++rigIt;
+  }
+
+  if(!removedBlocks.empty())
+    removeCachedResiduals(removedBlocks);
+
+  std::vector<IndexT> unusedIntrinsics;
+  for(const auto& intrinsicBlockPair : _intrinsicsBlocks)
+  {
+    if(usedBlocks.count(intrinsicBlockPair.second.data()) == 0)
+      unusedIntrinsics.push_back(intrinsicBlockPair.first);
+  }
+
+  for(IndexT intrinsicId : unusedIntrinsics)
+    removeIntrinsicFromProblem(sfmData, intrinsicId, problem);
+}
+
+void BundleAdjustmentCeres::updateProblem(const sfmData::SfMData& sfmData,
+                                          ERefineOptions refineOptions,
+                                          ceres::Problem& problem)
+{
+  // clear previous adjustment data, keep the parameters blocks and the residual blocks of the problem
+  _statistics = Statistics();
+  _ceresOptions.linearSolverOrdering = ceres::ParameterBlockOrdering();
+  _allParametersBlocks.clear();
+
+  // the 2D constraints and the rotation priors are few: always re-created
+  for(ceres::ResidualBlockId residualBlockId : _otherResiduals)
+    problem.RemoveResidualBlock(residualBlockId);
+  _statistics.nbRemovedResidualBlocks += _otherResiduals.size();
+  _otherResiduals.clear();
+
+  // update SfM extrincics of the Ceres problem
+  addExtrinsicsToProblem(sfmData, refineOptions, problem);
+
+  // update SfM intrinsics of the Ceres problem
+  addIntrinsicsToProblem(sfmData, refineOptions, problem);
+
+  // update SfM landmarks of the Ceres problem
+  addLandmarksToProblem(sfmData, refineOptions, problem);
+
+  // remove the parameters blocks no longer in the scene or ignored by the local strategy
+  removeUnusedBlocksFromProblem(sfmData, problem);
+
+  // add 2D constraints to the Ceres problem
+  addConstraints2DToProblem(sfmData, refineOptions, problem);
+
+  // add rotation priors to the Ceres problem
+  addRotationPriorsToProblem(sfmData, refineOptions, problem);
+}
+
 void BundleAdjustmentCeres::updateFromSolution(sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
 {
   const bool refinePoses = (refineOptions & REFINE_ROTATION) || (refineOptions & REFINE_TRANSLATION);
@@ -771,8 +1101,11 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
                                            ERefineOptions refineOptions,
                                            ceres::CRSMatrix& jacobian)
 {
+  // the parameters blocks wrappers are re-created: the persistent problem is no longer valid
+  _problem.reset();
+
   // create problem
-  ceres::Problem problem;
+  ceres::Problem problem(getProblemOptions());
   createProblem(sfmData, refineOptions, problem);
 
   // configure Jacobian engine
@@ -788,9 +1121,31 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
 
 bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
 {
-  // create problem
-  ceres::Problem problem;
-  createProblem(sfmData, refineOptions, problem);
+  const auto startProblem = std::chrono::steady_clock::now();
+
+  if(_ceresOptions.persistentProblem && _problem != nullptr && _problemRefineOptions == refineOptions)
+  {
+    // update the problem of the previous adjustment
+    updateProblem(sfmData, refineOptions, *_problem);
+
+    _statistics.problemTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startProblem).count();
+    _statistics.problemRebuildTime = _problemCreationTimePerResidual * _problem->NumResidualBlocks();
+  }
+  else
+  {
+    // create problem
+    _problem.reset(new ceres::Problem(getProblemOptions()));
+    _problemRefineOptions = refineOptions;
+    createProblem(sfmData, refineOptions, *_problem);
+
+    _statistics.problemTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startProblem).count();
+    _statistics.problemRebuildTime = _statistics.problemTime;
+
+    if(_problem->NumResidualBlocks() > 0)
+      _problemCreationTimePerResidual = _statistics.problemTime / _problem->NumResidualBlocks();
+  }
+
+  ceres::Problem& problem = *_problem;
 
   // configure a Bundle Adjustment engine and run it
   // make Ceres automatically detect the bundle structure.
@@ -801,6 +1156,10 @@ bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions ref
   ceres::Solver::Summary summary;  
   ceres::Solve(options, &problem, &summary);
 
+  // the problem is only kept for the next adjustments if persistent
+  if(!_ceresOptions.persistentProblem)
+    _problem.reset();
+
   // print summary
   if(_ceresOptions.summary)
     ALICEVISION_LOG_INFO(summary.FullReport());
@@ -14,6 +14,9 @@
 
 #include <ceres/ceres.h>
 
+#include <memory>
+#include <unordered_set>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -47,6 +50,10 @@ public:
     ceres::ParameterBlockOrdering linearSolverOrdering;
     unsigned int nbThreads;
     bool useParametersOrdering = true;
+    /// use the cost functions with analytic jacobians instead of the automatic differentiation
+    bool useAnalyticJacobians = false;
+    /// keep the Ceres problem between the adjustments and only update the blocks that changed in the scene
+    bool persistentProblem = false;
     bool summary = false;
     bool verbose = true;
   };
@@ -99,6 +106,14 @@ public:
     double RMSEfinal = 0.0;
     /// time spent to solve the BA (s)
     double time = 0.0;
+    /// time spent to create or update the Ceres problem (s)
+    double problemTime = 0.0;
+    /// estimated time to create the Ceres problem from scratch (s)
+    double problemRebuildTime = 0.0;
+    /// number of residual blocks added to the Ceres problem
+    std::size_t nbAddedResidualBlocks = 0;
+    /// number of residual blocks removed from the Ceres problem
+    std::size_t nbRemovedResidualBlocks = 0;
     /// number of states per parameter
     std::map<EParameter, std::map<EParameterState, std::size_t>> parametersStates;
     /// The distribution of the cameras for each graph distance <distance, numOfCam>
@@ -110,9 +125,14 @@ public:
    * @param[in] options The user Ceres options
    * @see BundleAdjustmentCeres::CeresOptions
    */
-  BundleAdjustmentCeres(const BundleAdjustmentCeres::CeresOptions& options = CeresOptions())
-    : _ceresOptions(options)
-  {}
+  BundleAdjustmentCeres(const BundleAdjustmentCeres::CeresOptions& options = CeresOptions());
+
+  /**
+   * @brief Set the user Ceres options used by the next adjustments
+   * @note The persistent problem is kept if the cost functions are not affected by the new options
+   * @param[in] options The user Ceres options
+   */
+  void setCeresOptions(const BundleAdjustmentCeres::CeresOptions& options);
 
   /**
    * @brief Create a jacobian CRSMatrix
@@ -168,14 +188,24 @@ private:
   inline void resetProblem()
   {
     _statistics = Statistics();
+    _ceresOptions.linearSolverOrdering = ceres::ParameterBlockOrdering();
 
     _allParametersBlocks.clear();
     _posesBlocks.clear();
     _intrinsicsBlocks.clear();
+    _intrinsicsConstantParams.clear();
     _landmarksBlocks.clear();
+    _landmarksResiduals.clear();
     _rigBlocks.clear();
+    _otherResiduals.clear();
   }
 
+  /**
+   * @brief Get the options of the Ceres problems
+   * @return the Ceres problem options
+   */
+  ceres::Problem::Options getProblemOptions() const;
+
   /**
    * @brief Set user Ceres options to the solver
    * @param[in,out] solverOptions The solver options structure
@@ -232,6 +262,39 @@ private:
    */
   void createProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+  /**
+   * @brief Update a Ceres bundle adjustement problem previously created with the same refine options:
+   *  - add the parameters blocks and residuals blocks of the new poses, intrinsics, landmarks and observations.
+   *  - remove the parameters blocks and residuals blocks no longer in the scene or ignored by the local strategy.
+   *  - set the parameters blocks constant or variable according to their state.
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @param[in,out] problem The Ceres bundle adjustement problem
+   */
+  void updateProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
+
+  /**
+   * @brief Remove an intrinsic parameter block and the residual blocks of its observations
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] intrinsicId The intrinsic id
+   * @param[in,out] problem The Ceres bundle adjustement problem
+   */
+  void removeIntrinsicFromProblem(const sfmData::SfMData& sfmData, IndexT intrinsicId, ceres::Problem& problem);
+
+  /**
+   * @brief Forget the cached landmarks residual blocks built on the given parameter blocks
+   * @note The residual blocks must have been removed from the problem with their parameter blocks
+   * @param[in] blocks The removed parameter blocks
+   */
+  void removeCachedResiduals(const std::unordered_set<const double*>& blocks);
+
+  /**
+   * @brief Remove the parameters blocks which have not been added or updated since the last reset of the parameters blocks list
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in,out] problem The Ceres bundle adjustement problem
+   */
+  void removeUnusedBlocksFromProblem(const sfmData::SfMData& sfmData, ceres::Problem& problem);
+
   /**
    * @brief Update The given SfMData with the solver solution
    * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction, notably the poses and sub-poses
@@ -280,6 +343,15 @@ private:
   /// last adjustment iteration statisics
   Statistics _statistics;
 
+  /// loss function of the reprojection errors, shared by all the residual blocks
+  std::shared_ptr<ceres::LossFunction> _lossFunction;
+  /// Ceres problem kept between the adjustments (persistent problem) or for the current adjustment
+  std::unique_ptr<ceres::Problem> _problem;
+  /// refine options of the Ceres problem
+  ERefineOptions _problemRefineOptions = REFINE_NONE;
+  /// time to create the last full Ceres problem per residual block (s)
+  double _problemCreationTimePerResidual = 0.0;
+
   // data wrappers for refinement
 
   /// all parameters blocks pointers
@@ -290,9 +362,25 @@ private:
   /// intrinsics blocks wrapper
   /// block: intrinsics params
   HashMap<IndexT, std::vector<double>> _intrinsicsBlocks;
+  /// indexes of the constant parameters of each intrinsic block (all the indexes for a constant block)
+  HashMap<IndexT, std::vector<int>> _intrinsicsConstantParams;
   /// landmarks blocks wrapper
   /// block: 3d position(3)
   HashMap<IndexT, std::array<double,3>> _landmarksBlocks;
+  /// residual block of a landmark observation and the parameter blocks it was built on
+  struct ObservationResidual
+  {
+    ceres::ResidualBlockId residualBlockId = nullptr;
+    const double* intrinsicBlock = nullptr;
+    const double* poseBlock = nullptr;
+    /// rig sub-pose block, nullptr if the view pose is independant
+    const double* subPoseBlock = nullptr;
+  };
+  /// residual blocks of the landmarks observations
+  /// <landmarkId, <viewId, residual block>>
+  HashMap<IndexT, HashMap<IndexT, ObservationResidual>> _landmarksResiduals;
+  /// residual blocks of the 2D constraints and the rotation priors
+  std::vector<ceres::ResidualBlockId> _otherResiduals;
   /// rig sub-poses blocks wrapper
   /// block: ceres angleAxis(3) + translation(3)
   HashMap<IndexT, HashMap<IndexT, std::array<double,6>>> _rigBlocks;
@@ -12,12 +12,57 @@
 
 #include <fstream>
 #include <algorithm>
+#include <cstdint>
 
 namespace fs = boost::filesystem;
 
 namespace aliceVision {
 namespace sfm {
 
+namespace {
+
+template<typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+void readValue(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Write the view ids of the valid edges of a list of lemon edge ids
+ */
+void writeEdgesPerId(std::ostream& stream, const lemon::ListGraph& graph,
+                     const std::map<lemon::ListGraph::Node, IndexT>& viewIdPerNode,
+                     const std::map<IndexT, std::vector<int>>& edgesPerId)
+{
+  writeValue(stream, static_cast<std::uint64_t>(edgesPerId.size()));
+  for(const auto& edgesPair : edgesPerId)
+  {
+    std::vector<Pair> edges;
+    for(const int edgeId : edgesPair.second)
+    {
+      const lemon::ListGraph::Edge edge = graph.edgeFromId(edgeId);
+      if(graph.valid(edge))
+        edges.emplace_back(viewIdPerNode.at(graph.u(edge)), viewIdPerNode.at(graph.v(edge)));
+    }
+
+    writeValue(stream, edgesPair.first);
+    writeValue(stream, static_cast<std::uint64_t>(edges.size()));
+    for(const Pair& edge : edges)
+    {
+      writeValue(stream, edge.first);
+      writeValue(stream, edge.second);
+    }
+  }
+}
+
+} // namespace
+
 LocalBundleAdjustmentGraph::LocalBundleAdjustmentGraph(const sfmData::SfMData& sfmData)
 {
   for(const auto& it : sfmData.getIntrinsics())
@@ -762,5 +807,165 @@ unsigned int LocalBundleAdjustmentGraph::countEdges() const
   return count;
 }
 
+void LocalBundleAdjustmentGraph::saveState(std::ostream& stream) const
+{
+  // nodes
+  writeValue(stream, static_cast<std::uint64_t>(_nodePerViewId.size()));
+  for(const auto& nodePair : _nodePerViewId)
+    writeValue(stream, nodePair.first);
+
+  // edges of the shared matches, the intrinsic-edges and the rig-edges are written separately
+  std::set<int> typedEdges;
+  for(const auto& edgesPair : _intrinsicEdgesId)
+    typedEdges.insert(edgesPair.second.begin(), edgesPair.second.end());
+  for(const auto& edgesPair : _rigEdgesId)
+    typedEdges.insert(edgesPair.second.begin(), edgesPair.second.end());
+
+  std::vector<Pair> edges;
+  for(lemon::ListGraph::EdgeIt e(_graph); e != lemon::INVALID; ++e)
+  {
+    if(typedEdges.count(_graph.id(e)) == 0)
+      edges.emplace_back(_viewIdPerNode.at(_graph.u(e)), _viewIdPerNode.at(_graph.v(e)));
+  }
+
+  writeValue(stream, static_cast<std::uint64_t>(edges.size()));
+  for(const Pair& edge : edges)
+  {
+    writeValue(stream, edge.first);
+    writeValue(stream, edge.second);
+  }
+
+  writeEdgesPerId(stream, _graph, _viewIdPerNode, _intrinsicEdgesId);
+  writeEdgesPerId(stream, _graph, _viewIdPerNode, _rigEdgesId);
+
+  // intrinsics history
+  writeValue(stream, static_cast<std::uint64_t>(_intrinsicsHistory.size()));
+  for(const auto& historyPair : _intrinsicsHistory)
+  {
+    writeValue(stream, historyPair.first);
+    writeValue(stream, static_cast<std::uint64_t>(historyPair.second.size()));
+    for(const IntrinsicHistory& history : historyPair.second)
+    {
+      writeValue(stream, static_cast<std::uint64_t>(history.nbPoses));
+      writeValue(stream, history.focalLength);
+      writeValue(stream, static_cast<std::uint8_t>(history.isConstant));
+    }
+  }
+
+  writeValue(stream, static_cast<std::uint64_t>(_mapFocalIsConstant.size()));
+  for(const auto& focalPair : _mapFocalIsConstant)
+  {
+    writeValue(stream, focalPair.first);
+    writeValue(stream, static_cast<std::uint8_t>(focalPair.second));
+  }
+}
+
+bool LocalBundleAdjustmentGraph::loadState(std::istream& stream)
+{
+  _graph.clear();
+  _nodePerViewId.clear();
+  _viewIdPerNode.clear();
+  _distancePerViewId.clear();
+  _distancePerPoseId.clear();
+  _intrinsicEdgesId.clear();
+  _rigEdgesId.clear();
+  _intrinsicsHistory.clear();
+  _mapFocalIsConstant.clear();
+
+  // nodes
+  std::uint64_t nbNodes = 0;
+  readValue(stream, nbNodes);
+  for(std::uint64_t i = 0; i < nbNodes && stream.good(); ++i)
+  {
+    IndexT viewId = UndefinedIndexT;
+    readValue(stream, viewId);
+
+    const lemon::ListGraph::Node node = _graph.addNode();
+    _nodePerViewId[viewId] = node;
+    _viewIdPerNode[node] = viewId;
+  }
+
+  // add an edge between 2 views, return the lemon id of the edge or -1 if invalid
+  const auto readEdge = [&]() -> int
+  {
+    IndexT viewIdA = UndefinedIndexT;
+    IndexT viewIdB = UndefinedIndexT;
+    readValue(stream, viewIdA);
+    readValue(stream, viewIdB);
+
+    const auto itA = _nodePerViewId.find(viewIdA);
+    const auto itB = _nodePerViewId.find(viewIdB);
+    if(!stream.good() || itA == _nodePerViewId.end() || itB == _nodePerViewId.end())
+      return -1;
+    return _graph.id(_graph.addEdge(itA->second, itB->second));
+  };
+
+  std::uint64_t nbEdges = 0;
+  readValue(stream, nbEdges);
+  for(std::uint64_t i = 0; i < nbEdges; ++i)
+  {
+    if(readEdge() < 0)
+      return false;
+  }
+
+  for(std::map<IndexT, std::vector<int>>* edgesPerId : {&_intrinsicEdgesId, &_rigEdgesId})
+  {
+    std::uint64_t nbIds = 0;
+    readValue(stream, nbIds);
+    for(std::uint64_t i = 0; i < nbIds && stream.good(); ++i)
+    {
+      IndexT id = UndefinedIndexT;
+      readValue(stream, id);
+      readValue(stream, nbEdges);
+
+      std::vector<int>& edgeIds = (*edgesPerId)[id];
+      for(std::uint64_t e = 0; e < nbEdges; ++e)
+      {
+        const int edgeId = readEdge();
+        if(edgeId < 0)
+          return false;
+        edgeIds.push_back(edgeId);
+      }
+    }
+  }
+
+  // intrinsics history
+  std::uint64_t nbIntrinsics = 0;
+  readValue(stream, nbIntrinsics);
+  for(std::uint64_t i = 0; i < nbIntrinsics && stream.good(); ++i)
+  {
+    IndexT intrinsicId = UndefinedIndexT;
+    std::uint64_t nbValues = 0;
+    readValue(stream, intrinsicId);
+    readValue(stream, nbValues);
+
+    std::vector<IntrinsicHistory>& intrinsicHistory = _intrinsicsHistory[intrinsicId];
+    for(std::uint64_t v = 0; v < nbValues && stream.good(); ++v)
+    {
+      std::uint64_t nbPoses = 0;
+      std::uint8_t isConstant = 0;
+      IntrinsicHistory history;
+      readValue(stream, nbPoses);
+      readValue(stream, history.focalLength);
+      readValue(stream, isConstant);
+      history.nbPoses = nbPoses;
+      history.isConstant = (isConstant != 0);
+      intrinsicHistory.push_back(history);
+    }
+  }
+
+  readValue(stream, nbIntrinsics);
+  for(std::uint64_t i = 0; i < nbIntrinsics && stream.good(); ++i)
+  {
+    IndexT intrinsicId = UndefinedIndexT;
+    std::uint8_t isConstant = 0;
+    readValue(stream, intrinsicId);
+    readValue(stream, isConstant);
+    _mapFocalIsConstant[intrinsicId] = (isConstant != 0);
+  }
+
+  return stream.good();
+}
+
 } // namespace sfm
 } // namespace aliceVision
@@ -10,6 +10,8 @@
 #include <aliceVision/track/Track.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 
+#include <iosfwd>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -215,6 +217,20 @@ public:
    */
   unsigned int countEdges() const;
 
+  /**
+   * @brief Write the data kept between the adjustments (nodes, edges, intrinsics history) to a binary stream.
+   * @details The graph-distances and the parameters states are not written: they are computed before each adjustment.
+   * @param[out] stream The output binary stream
+   */
+  void saveState(std::ostream& stream) const;
+
+  /**
+   * @brief Replace the graph and the intrinsics history with the data written by saveState().
+   * @param[in] stream The input binary stream
+   * @return true if the data has been read
+   */
+  bool loadState(std::istream& stream);
+
 private:
   
   /**
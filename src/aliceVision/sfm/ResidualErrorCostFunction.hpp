@@ -0,0 +1,402 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <ceres/sized_cost_function.h>
+
+#include <cmath>
+#include <limits>
+
+// Define ceres cost functions with analytic jacobians for each AliceVision camera model.
+// They compute the same residuals as the autodiff functors of ResidualErrorFunctor.hpp.
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Camera models used by the analytic reprojection cost functions.
+ *
+ * Each model applies the distortion (xd,yd) = disto(xu,yu) of the intrinsic data block
+ * [focal, principal point x, principal point y, distortion parameters...] and computes:
+ *  - dDisto_dU: the jacobian of the distorted point according to the undistorted point
+ *  - dDisto_dParams: the jacobian of the distorted point according to the distortion parameters
+ */
+namespace analyticCameraModel {
+
+struct Pinhole
+{
+  enum { NB_PARAMS = 3 };
+  typedef Eigen::Matrix<double, 2, NB_PARAMS - 3> DistoJacobian;
+
+  static void distort(const double* const /*cam_K*/, const Vec2& u, Vec2& d, Eigen::Matrix2d& dDisto_dU, DistoJacobian& /*dDisto_dParams*/)
+  {
+    d = u;
+    dDisto_dU.setIdentity();
+  }
+};
+
+struct PinholeRadialK1
+{
+  enum { NB_PARAMS = 4 };
+  typedef Eigen::Matrix<double, 2, NB_PARAMS - 3> DistoJacobian;
+
+  static void distort(const double* const cam_K, const Vec2& u, Vec2& d, Eigen::Matrix2d& dDisto_dU, DistoJacobian& dDisto_dParams)
+  {
+    const double k1 = cam_K[3];
+    const double r2 = u.squaredNorm();
+    const double r_coeff = 1.0 + k1 * r2;
+
+    d = u * r_coeff;
+    dDisto_dU = r_coeff * Eigen::Matrix2d::Identity() + (2.0 * k1) * u * u.transpose();
+    dDisto_dParams.col(0) = u * r2;
+  }
+};
+
+struct PinholeRadialK3
+{
+  enum { NB_PARAMS = 6 };
+  typedef Eigen::Matrix<double, 2, NB_PARAMS - 3> DistoJacobian;
+
+  static void distort(const double* const cam_K, const Vec2& u, Vec2& d, Eigen::Matrix2d& dDisto_dU, DistoJacobian& dDisto_dParams)
+  {
+    const double k1 = cam_K[3];
+    const double k2 = cam_K[4];
+    const double k3 = cam_K[5];
+    const double r2 = u.squaredNorm();
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const double dCoeff_dR2 = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+
+    d = u * r_coeff;
+    dDisto_dU = r_coeff * Eigen::Matrix2d::Identity() + (2.0 * dCoeff_dR2) * u * u.transpose();
+    dDisto_dParams.col(0) = u * r2;
+    dDisto_dParams.col(1) = u * r4;
+    dDisto_dParams.col(2) = u * r6;
+  }
+};
+
+struct PinholeBrownT2
+{
+  enum { NB_PARAMS = 8 };
+  typedef Eigen::Matrix<double, 2, NB_PARAMS - 3> DistoJacobian;
+
+  static void distort(const double* const cam_K, const Vec2& u, Vec2& d, Eigen::Matrix2d& dDisto_dU, DistoJacobian& dDisto_dParams)
+  {
+    const double k1 = cam_K[3];
+    const double k2 = cam_K[4];
+    const double k3 = cam_K[5];
+    const double t1 = cam_K[6];
+    const double t2 = cam_K[7];
+    const double x = u(0);
+    const double y = u(1);
+    const double r2 = u.squaredNorm();
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const double dCoeff_dR2 = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+    const double t_x = t2 * (r2 + 2.0 * x * x) + 2.0 * t1 * x * y;
+    const double t_y = t1 * (r2 + 2.0 * y * y) + 2.0 * t2 * x * y;
+
+    d(0) = x * r_coeff + t_x;
+    d(1) = y * r_coeff + t_y;
+
+    dDisto_dU = r_coeff * Eigen::Matrix2d::Identity() + (2.0 * dCoeff_dR2) * u * u.transpose();
+    dDisto_dU(0, 0) += 6.0 * t2 * x + 2.0 * t1 * y;
+    dDisto_dU(0, 1) += 2.0 * t2 * y + 2.0 * t1 * x;
+    dDisto_dU(1, 0) += 2.0 * t1 * x + 2.0 * t2 * y;
+    dDisto_dU(1, 1) += 6.0 * t1 * y + 2.0 * t2 * x;
+
+    dDisto_dParams.col(0) = u * r2;
+    dDisto_dParams.col(1) = u * r4;
+    dDisto_dParams.col(2) = u * r6;
+    dDisto_dParams.col(3) << 2.0 * x * y, r2 + 2.0 * y * y;
+    dDisto_dParams.col(4) << r2 + 2.0 * x * x, 2.0 * x * y;
+  }
+};
+
+struct PinholeFisheye
+{
+  enum { NB_PARAMS = 7 };
+  typedef Eigen::Matrix<double, 2, NB_PARAMS - 3> DistoJacobian;
+
+  static void distort(const double* const cam_K, const Vec2& u, Vec2& d, Eigen::Matrix2d& dDisto_dU, DistoJacobian& dDisto_dParams)
+  {
+    const double k1 = cam_K[3];
+    const double k2 = cam_K[4];
+    const double k3 = cam_K[5];
+    const double k4 = cam_K[6];
+    const double r = u.norm();
+
+    // same threshold as the autodiff functor: the distortion is the identity near the principal point
+    if(r <= 1e-8)
+    {
+      d = u;
+      dDisto_dU.setIdentity();
+      dDisto_dParams.setZero();
+      return;
+    }
+
+    const double theta = std::atan(r);
+    const double theta2 = theta * theta, theta3 = theta2 * theta, theta4 = theta2 * theta2, theta5 = theta4 * theta,
+                 theta6 = theta3 * theta3, theta7 = theta6 * theta, theta8 = theta4 * theta4, theta9 = theta8 * theta;
+    const double theta_dist = theta + k1 * theta3 + k2 * theta5 + k3 * theta7 + k4 * theta9;
+    const double dThetaDist_dTheta = 1.0 + 3.0 * k1 * theta2 + 5.0 * k2 * theta4 + 7.0 * k3 * theta6 + 9.0 * k4 * theta8;
+    const double inv_r = 1.0 / r;
+    const double cdist = theta_dist * inv_r;
+    // d(cdist)/dr, with d(theta)/dr = 1 / (1 + r^2)
+    const double dCdist_dR = (dThetaDist_dTheta / (1.0 + r * r) - cdist) * inv_r;
+
+    d = u * cdist;
+    dDisto_dU = cdist * Eigen::Matrix2d::Identity() + (dCdist_dR * inv_r) * u * u.transpose();
+    dDisto_dParams.col(0) = u * (theta3 * inv_r);
+    dDisto_dParams.col(1) = u * (theta5 * inv_r);
+    dDisto_dParams.col(2) = u * (theta7 * inv_r);
+    dDisto_dParams.col(3) = u * (theta9 * inv_r);
+  }
+};
+
+struct PinholeFisheye1
+{
+  enum { NB_PARAMS = 4 };
+  typedef Eigen::Matrix<double, 2, NB_PARAMS - 3> DistoJacobian;
+
+  static void distort(const double* const cam_K, const Vec2& u, Vec2& d, Eigen::Matrix2d& dDisto_dU, DistoJacobian& dDisto_dParams)
+  {
+    const double k1 = cam_K[3];
+    const double r = u.norm();
+    const double a = 2.0 * std::tan(0.5 * k1);
+    const double atan_ar = std::atan(a * r);
+    const double inv_1_a2r2 = 1.0 / (1.0 + a * a * r * r);
+    const double r_coeff = atan_ar / (k1 * r);
+    // d(r_coeff)/dr and d(r_coeff)/dk1, with d(a)/dk1 = 1 + a^2 / 4
+    const double dCoeff_dR = (a * r * inv_1_a2r2 - atan_ar) / (k1 * r * r);
+    const double dCoeff_dK1 = (r * inv_1_a2r2 * (1.0 + 0.25 * a * a) - atan_ar / k1) / (k1 * r);
+
+    d = u * r_coeff;
+    dDisto_dU = r_coeff * Eigen::Matrix2d::Identity() + (dCoeff_dR / r) * u * u.transpose();
+    dDisto_dParams.col(0) = u * dCoeff_dK1;
+  }
+};
+
+} // namespace analyticCameraModel
+
+namespace detail {
+
+/**
+ * @brief Apply a pose parameterized by [R;t] (rotation as angle axis) to a point, as ceres::AngleAxisRotatePoint.
+ * @param[in] pose_Rt The pose block [rX,rY,rZ,tx,ty,tz]
+ * @param[in] X The input point
+ * @param[out] rotation The rotation matrix, ie. the jacobian of the output point according to the input point
+ * @param[out] dX_dAngleAxis The jacobian of the output point according to the angle axis
+ * @return the transformed point R.X + t
+ */
+inline Vec3 applyPose(const double* const pose_Rt, const Vec3& X, Mat3& rotation, Mat3& dX_dAngleAxis)
+{
+  const Eigen::Map<const Vec3> angleAxis(pose_Rt);
+  const Eigen::Map<const Vec3> t(pose_Rt + 3);
+  const double theta2 = angleAxis.squaredNorm();
+
+  if(theta2 > std::numeric_limits<double>::epsilon())
+  {
+    // Rodrigues' formula
+    const double theta = std::sqrt(theta2);
+    const Vec3 axis = angleAxis / theta;
+    rotation = std::cos(theta) * Mat3::Identity() + std::sin(theta) * CrossProductMatrix(axis) + (1.0 - std::cos(theta)) * axis * axis.transpose();
+
+    // d(R.X)/dw = -R [X]x (w w^T + (R^T - I) [w]x) / theta^2
+    // G. Gallego, A. Yezzi, "A compact formula for the derivative of a 3-D rotation in exponential coordinates", 2015
+    dX_dAngleAxis = -rotation * CrossProductMatrix(X) *
+                    (angleAxis * angleAxis.transpose() + (rotation.transpose() - Mat3::Identity()) * CrossProductMatrix(angleAxis)) / theta2;
+  }
+  else
+  {
+    // first order approximation near the identity, as in ceres: R.X = X + w x X
+    rotation = Mat3::Identity() + CrossProductMatrix(angleAxis);
+    dX_dAngleAxis = -CrossProductMatrix(X);
+  }
+  return rotation * X + t;
+}
+
+/**
+ * @brief Project a point expressed in the camera frame and compute the jacobians of the residual.
+ * @param[in] cam_K The intrinsic data block
+ * @param[in] X The point in the camera frame
+ * @param[in] observation The observed 2d point
+ * @param[out] residuals The reprojection error
+ * @param[out] dResidual_dK The jacobian according to the intrinsic block, if not null
+ * @param[out] dResidual_dX The jacobian according to the point in the camera frame
+ */
+template <typename CameraModel>
+void project(const double* const cam_K, const Vec3& X, const Vec2& observation,
+             double* residuals, double* dResidual_dK, Mat23* dResidual_dX)
+{
+  const double focal = cam_K[0];
+  const double inv_z = 1.0 / X(2);
+  const Vec2 u(X(0) * inv_z, X(1) * inv_z);
+
+  Vec2 d;
+  Eigen::Matrix2d dDisto_dU;
+  typename CameraModel::DistoJacobian dDisto_dParams;
+  CameraModel::distort(cam_K, u, d, dDisto_dU, dDisto_dParams);
+
+  residuals[0] = cam_K[1] + focal * d(0) - observation(0);
+  residuals[1] = cam_K[2] + focal * d(1) - observation(1);
+
+  if(dResidual_dK != nullptr)
+  {
+    Eigen::Map<Eigen::Matrix<double, 2, CameraModel::NB_PARAMS, Eigen::RowMajor>> J(dResidual_dK);
+    J.col(0) = d;
+    J.col(1) << 1.0, 0.0;
+    J.col(2) << 0.0, 1.0;
+    J.template rightCols<CameraModel::NB_PARAMS - 3>() = focal * dDisto_dParams;
+  }
+
+  if(dResidual_dX != nullptr)
+  {
+    Mat23 dU_dX;
+    dU_dX << inv_z, 0.0, -u(0) * inv_z,
+             0.0, inv_z, -u(1) * inv_z;
+    *dResidual_dX = focal * dDisto_dU * dU_dX;
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief Ceres cost function with analytic jacobians for a camera model, a pose and a 3D point.
+ *
+ *  Data parameter blocks are the following <2, NB_PARAMS, 6, 3>
+ *  - 2 => dimension of the residuals,
+ *  - NB_PARAMS => the intrinsic data block [focal, principal point x, principal point y, distortion...],
+ *  - 6 => the camera extrinsic data block (camera orientation and position) [R;t],
+ *         - rotation(angle axis), and translation [rX,rY,rZ,tx,ty,tz].
+ *  - 3 => a 3D point data block.
+ *
+ * Same residuals as ceres::AutoDiffCostFunction<ResidualErrorFunctor_*, 2, NB_PARAMS, 6, 3>
+ * without the evaluation of the jets.
+ */
+template <typename CameraModel>
+class ResidualErrorCostFunction : public ceres::SizedCostFunction<2, CameraModel::NB_PARAMS, 6, 3>
+{
+public:
+  explicit ResidualErrorCostFunction(const Vec2& observation)
+    : _observation(observation)
+  {}
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
+  {
+    const double* const cam_K = parameters[0];
+    const double* const cam_Rt = parameters[1];
+    const Eigen::Map<const Vec3> pos_3dpoint(parameters[2]);
+
+    Mat3 R;
+    Mat3 dX_dAngleAxis;
+    const Vec3 X = detail::applyPose(cam_Rt, pos_3dpoint, R, dX_dAngleAxis);
+
+    if(jacobians == nullptr)
+    {
+      detail::project<CameraModel>(cam_K, X, _observation, residuals, nullptr, nullptr);
+      return true;
+    }
+
+    Mat23 dResidual_dX;
+    detail::project<CameraModel>(cam_K, X, _observation, residuals, jacobians[0], &dResidual_dX);
+
+    if(jacobians[1] != nullptr)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> J(jacobians[1]);
+      J.leftCols<3>() = dResidual_dX * dX_dAngleAxis;
+      J.rightCols<3>() = dResidual_dX;
+    }
+
+    if(jacobians[2] != nullptr)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[2]);
+      J = dResidual_dX * R;
+    }
+    return true;
+  }
+
+private:
+  const Vec2 _observation;
+};
+
+/**
+ * @brief Ceres cost function with analytic jacobians for a camera model, a rig pose, a rig sub-pose and a 3D point.
+ *
+ *  Data parameter blocks are the following <2, NB_PARAMS, 6, 6, 3>
+ *  - 2 => dimension of the residuals,
+ *  - NB_PARAMS => the intrinsic data block [focal, principal point x, principal point y, distortion...],
+ *  - 6 => the rig extrinsic data block [R;t],
+ *  - 6 => the camera sub-pose in the rig [R;t],
+ *  - 3 => a 3D point data block.
+ *
+ * Same residuals as ceres::AutoDiffCostFunction<ResidualErrorFunctor_*, 2, NB_PARAMS, 6, 6, 3>.
+ */
+template <typename CameraModel>
+class ResidualErrorRigCostFunction : public ceres::SizedCostFunction<2, CameraModel::NB_PARAMS, 6, 6, 3>
+{
+public:
+  explicit ResidualErrorRigCostFunction(const Vec2& observation)
+    : _observation(observation)
+  {}
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
+  {
+    const double* const cam_K = parameters[0];
+    const double* const cam_Rt = parameters[1];
+    const double* const subpose_Rt = parameters[2];
+    const Eigen::Map<const Vec3> pos_3dpoint(parameters[3]);
+
+    Mat3 rigR, subposeR;
+    Mat3 dRigX_dAngleAxis, dX_dSubposeAngleAxis;
+    const Vec3 rigX = detail::applyPose(cam_Rt, pos_3dpoint, rigR, dRigX_dAngleAxis);
+    const Vec3 X = detail::applyPose(subpose_Rt, rigX, subposeR, dX_dSubposeAngleAxis);
+
+    if(jacobians == nullptr)
+    {
+      detail::project<CameraModel>(cam_K, X, _observation, residuals, nullptr, nullptr);
+      return true;
+    }
+
+    Mat23 dResidual_dX;
+    detail::project<CameraModel>(cam_K, X, _observation, residuals, jacobians[0], &dResidual_dX);
+
+    // jacobian according to the point in the rig frame
+    const Mat23 dResidual_dRigX = dResidual_dX * subposeR;
+
+    if(jacobians[1] != nullptr)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> J(jacobians[1]);
+      J.leftCols<3>() = dResidual_dRigX * dRigX_dAngleAxis;
+      J.rightCols<3>() = dResidual_dRigX;
+    }
+
+    if(jacobians[2] != nullptr)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> J(jacobians[2]);
+      J.leftCols<3>() = dResidual_dX * dX_dSubposeAngleAxis;
+      J.rightCols<3>() = dResidual_dX;
+    }
+
+    if(jacobians[3] != nullptr)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[3]);
+      J = dResidual_dRigX * rigR;
+    }
+    return true;
+  }
+
+private:
+  const Vec2 _observation;
+};
+
+} // namespace sfm
+} // namespace aliceVision
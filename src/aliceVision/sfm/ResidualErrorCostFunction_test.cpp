@@ -0,0 +1,253 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/ResidualErrorFunctor.hpp>
+#include <aliceVision/sfm/ResidualErrorCostFunction.hpp>
+
+#include <ceres/autodiff_cost_function.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE residualErrorCostFunction
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+/**
+ * @brief Parameter blocks of a reprojection residual: intrinsics, pose, rig sub-pose and 3D point.
+ */
+struct ResidualBlocks
+{
+  std::vector<double> intrinsics;
+  std::vector<double> pose;
+  std::vector<double> subpose;
+  std::vector<double> point;
+  Vec2 observation;
+
+  std::vector<std::vector<double>*> get(bool rig)
+  {
+    if(rig)
+      return {&intrinsics, &pose, &subpose, &point};
+    return {&intrinsics, &pose, &point};
+  }
+};
+
+/// random parameter blocks with the 3D point in front of the camera
+ResidualBlocks createBlocks(std::mt19937& generator, const std::vector<double>& intrinsics, double rotationScale)
+{
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  auto random = [&](double scale) { return scale * distribution(generator); };
+
+  ResidualBlocks blocks;
+  blocks.intrinsics = intrinsics;
+  blocks.pose = {random(rotationScale), random(rotationScale), random(rotationScale), random(0.3), random(0.3), random(0.3)};
+  blocks.subpose = {random(0.3 * rotationScale), random(0.3 * rotationScale), random(0.3 * rotationScale), random(0.1), random(0.1), random(0.1)};
+  blocks.point = {random(1.0), random(1.0), 5.0 + random(1.0)};
+  blocks.observation = Vec2(500.0 + random(400.0), 400.0 + random(300.0));
+  return blocks;
+}
+
+/**
+ * @brief Evaluate 2 cost functions on the same parameter blocks and check that their residuals and jacobians are identical.
+ */
+void checkCostFunctions(const ceres::CostFunction& autodiff, const ceres::CostFunction& analytic, ResidualBlocks& blocks, bool rig)
+{
+  const std::vector<std::vector<double>*> parameterBlocks = blocks.get(rig);
+  std::vector<const double*> parameters;
+  std::vector<std::vector<double>> autodiffJacobians, analyticJacobians;
+  for(const std::vector<double>* block : parameterBlocks)
+  {
+    parameters.push_back(block->data());
+    autodiffJacobians.emplace_back(2 * block->size(), 0.0);
+    analyticJacobians.emplace_back(2 * block->size(), 0.0);
+  }
+  std::vector<double*> autodiffJacobiansPtr, analyticJacobiansPtr;
+  for(std::size_t i = 0; i < parameterBlocks.size(); ++i)
+  {
+    autodiffJacobiansPtr.push_back(autodiffJacobians[i].data());
+    analyticJacobiansPtr.push_back(analyticJacobians[i].data());
+  }
+
+  double autodiffResiduals[2], analyticResiduals[2];
+  BOOST_REQUIRE(autodiff.Evaluate(parameters.data(), autodiffResiduals, autodiffJacobiansPtr.data()));
+  BOOST_REQUIRE(analytic.Evaluate(parameters.data(), analyticResiduals, analyticJacobiansPtr.data()));
+
+  for(int r = 0; r < 2; ++r)
+    BOOST_CHECK_SMALL((autodiffResiduals[r] - analyticResiduals[r]) / std::max(1.0, std::abs(autodiffResiduals[r])), 1e-8);
+
+  for(std::size_t i = 0; i < parameterBlocks.size(); ++i)
+    for(std::size_t k = 0; k < autodiffJacobians[i].size(); ++k)
+      BOOST_CHECK_SMALL((autodiffJacobians[i][k] - analyticJacobians[i][k]) / std::max(1.0, std::abs(autodiffJacobians[i][k])), 1e-8);
+
+  // residuals only and partial jacobians
+  BOOST_REQUIRE(analytic.Evaluate(parameters.data(), analyticResiduals, nullptr));
+  for(int r = 0; r < 2; ++r)
+    BOOST_CHECK_SMALL((autodiffResiduals[r] - analyticResiduals[r]) / std::max(1.0, std::abs(autodiffResiduals[r])), 1e-8);
+
+  std::fill(analyticJacobians.back().begin(), analyticJacobians.back().end(), 0.0);
+  analyticJacobiansPtr.front() = nullptr;
+  BOOST_REQUIRE(analytic.Evaluate(parameters.data(), analyticResiduals, analyticJacobiansPtr.data()));
+  for(std::size_t k = 0; k < autodiffJacobians.back().size(); ++k)
+    BOOST_CHECK_SMALL((autodiffJacobians.back()[k] - analyticJacobians.back()[k]) / std::max(1.0, std::abs(autodiffJacobians.back()[k])), 1e-8);
+}
+
+template <typename Functor, typename CameraModel>
+void checkCameraModel(const std::vector<double>& intrinsics)
+{
+  const int N = CameraModel::NB_PARAMS;
+  BOOST_REQUIRE_EQUAL(intrinsics.size(), std::size_t(N));
+
+  std::mt19937 generator(42);
+  // large rotations and rotations near the identity (first order branch)
+  for(double rotationScale : {0.5, 0.1, 1e-9, 0.0})
+  {
+    for(int i = 0; i < 20; ++i)
+    {
+      ResidualBlocks blocks = createBlocks(generator, intrinsics, rotationScale);
+      {
+        const ceres::AutoDiffCostFunction<Functor, 2, N, 6, 3> autodiff(new Functor(blocks.observation.data()));
+        const ResidualErrorCostFunction<CameraModel> analytic(blocks.observation);
+        checkCostFunctions(autodiff, analytic, blocks, false);
+      }
+      {
+        const ceres::AutoDiffCostFunction<Functor, 2, N, 6, 6, 3> autodiff(new Functor(blocks.observation.data()));
+        const ResidualErrorRigCostFunction<CameraModel> analytic(blocks.observation);
+        checkCostFunctions(autodiff, analytic, blocks, true);
+      }
+    }
+  }
+}
+
+/// number of evaluations per second of a cost function, with or without jacobians
+double evaluationsPerSecond(const ceres::CostFunction& costFunction, ResidualBlocks& blocks, bool rig, bool withJacobians, int nbEvaluations)
+{
+  const std::vector<std::vector<double>*> parameterBlocks = blocks.get(rig);
+  std::vector<const double*> parameters;
+  std::vector<std::vector<double>> jacobians;
+  std::vector<double*> jacobiansPtr;
+  for(const std::vector<double>* block : parameterBlocks)
+  {
+    parameters.push_back(block->data());
+    jacobians.emplace_back(2 * block->size());
+  }
+  for(std::vector<double>& jacobian : jacobians)
+    jacobiansPtr.push_back(jacobian.data());
+
+  double residuals[2];
+  double sum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < nbEvaluations; ++i)
+  {
+    // move the point to avoid evaluating the same residual
+    (*parameterBlocks.back())[0] += 1e-9;
+    costFunction.Evaluate(parameters.data(), residuals, withJacobians ? jacobiansPtr.data() : nullptr);
+    sum += residuals[0];
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  BOOST_CHECK(std::isfinite(sum));
+  return nbEvaluations / seconds;
+}
+
+template <typename Functor, typename CameraModel>
+void benchmarkCameraModel(const std::string& name, const std::vector<double>& intrinsics)
+{
+  const int N = CameraModel::NB_PARAMS;
+  const int nbEvaluations = 200000;
+
+  std::mt19937 generator(42);
+  ResidualBlocks blocks = createBlocks(generator, intrinsics, 0.5);
+
+  const ceres::AutoDiffCostFunction<Functor, 2, N, 6, 3> autodiff(new Functor(blocks.observation.data()));
+  const ResidualErrorCostFunction<CameraModel> analytic(blocks.observation);
+  const ceres::AutoDiffCostFunction<Functor, 2, N, 6, 6, 3> autodiffRig(new Functor(blocks.observation.data()));
+  const ResidualErrorRigCostFunction<CameraModel> analyticRig(blocks.observation);
+
+  const ceres::CostFunction* costFunctions[4] = {&autodiff, &analytic, &autodiffRig, &analyticRig};
+  double residualsPerSecond[4], jacobiansPerSecond[4];
+  for(int i = 0; i < 4; ++i)
+  {
+    const bool rig = (i >= 2);
+    residualsPerSecond[i] = evaluationsPerSecond(*costFunctions[i], blocks, rig, false, nbEvaluations);
+    jacobiansPerSecond[i] = evaluationsPerSecond(*costFunctions[i], blocks, rig, true, nbEvaluations);
+  }
+
+  BOOST_TEST_MESSAGE(name << " evaluations per second (residuals / residuals and jacobians):\n"
+    << "  autodiff:     " << residualsPerSecond[0] << " / " << jacobiansPerSecond[0] << "\n"
+    << "  analytic:     " << residualsPerSecond[1] << " / " << jacobiansPerSecond[1] << "\n"
+    << "  rig autodiff: " << residualsPerSecond[2] << " / " << jacobiansPerSecond[2] << "\n"
+    << "  rig analytic: " << residualsPerSecond[3] << " / " << jacobiansPerSecond[3]);
+}
+
+const std::vector<double> pinholeK = {1000.0, 500.0, 400.0};
+const std::vector<double> radialK1K = {1000.0, 500.0, 400.0, -0.1};
+const std::vector<double> radialK3K = {1000.0, 500.0, 400.0, -0.1, 0.02, -0.003};
+const std::vector<double> brownK = {1000.0, 500.0, 400.0, -0.1, 0.02, -0.003, 0.001, -0.002};
+const std::vector<double> fisheyeK = {1000.0, 500.0, 400.0, -0.1, 0.02, -0.003, 0.0005};
+const std::vector<double> fisheye1K = {1000.0, 500.0, 400.0, 0.9};
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - For each camera model, with and without rig sub-pose
+// - Evaluate the analytic cost function and the autodiff cost function on random parameter blocks
+// - Assert that the residuals and all the jacobians are identical
+//-----------------
+BOOST_AUTO_TEST_CASE(residualErrorCostFunction_Pinhole)
+{
+  checkCameraModel<ResidualErrorFunctor_Pinhole, analyticCameraModel::Pinhole>(pinholeK);
+}
+
+BOOST_AUTO_TEST_CASE(residualErrorCostFunction_PinholeRadialK1)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeRadialK1, analyticCameraModel::PinholeRadialK1>(radialK1K);
+}
+
+BOOST_AUTO_TEST_CASE(residualErrorCostFunction_PinholeRadialK3)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeRadialK3, analyticCameraModel::PinholeRadialK3>(radialK3K);
+}
+
+BOOST_AUTO_TEST_CASE(residualErrorCostFunction_PinholeBrownT2)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeBrownT2, analyticCameraModel::PinholeBrownT2>(brownK);
+}
+
+BOOST_AUTO_TEST_CASE(residualErrorCostFunction_PinholeFisheye)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeFisheye, analyticCameraModel::PinholeFisheye>(fisheyeK);
+}
+
+BOOST_AUTO_TEST_CASE(residualErrorCostFunction_PinholeFisheye1)
+{
+  checkCameraModel<ResidualErrorFunctor_PinholeFisheye1, analyticCameraModel::PinholeFisheye1>(fisheye1K);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Report the number of residual and jacobian evaluations per second of the autodiff and analytic cost functions
+//-----------------
+BOOST_AUTO_TEST_CASE(residualErrorCostFunction_benchmark)
+{
+  benchmarkCameraModel<ResidualErrorFunctor_Pinhole, analyticCameraModel::Pinhole>("Pinhole", pinholeK);
+  benchmarkCameraModel<ResidualErrorFunctor_PinholeRadialK1, analyticCameraModel::PinholeRadialK1>("PinholeRadialK1", radialK1K);
+  benchmarkCameraModel<ResidualErrorFunctor_PinholeRadialK3, analyticCameraModel::PinholeRadialK3>("PinholeRadialK3", radialK3K);
+  benchmarkCameraModel<ResidualErrorFunctor_PinholeBrownT2, analyticCameraModel::PinholeBrownT2>("PinholeBrownT2", brownK);
+  benchmarkCameraModel<ResidualErrorFunctor_PinholeFisheye, analyticCameraModel::PinholeFisheye>("PinholeFisheye", fisheyeK);
+  benchmarkCameraModel<ResidualErrorFunctor_PinholeFisheye1, analyticCameraModel::PinholeFisheye1>("PinholeFisheye1", fisheye1K);
+}
@@ -241,6 +241,151 @@ BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_Camer
   BOOST_CHECK(dResidual_before > dResidual_after);
 }
 
+// Test summary:
+// - Create a SfMData scene from a synthetic dataset
+// - Adjust a copy of the scene with a persistent problem and another one with a problem created at each adjustment
+// - Between the adjustments: remove observations, landmarks and a pose, add a landmark,
+//   move a view to a rig pose and use the local strategy (constant and ignored poses)
+// - Check that the persistent problem gives the same residuals as the re-created problem
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_PersistentProblem)
+{
+  const int nviews = 6;
+  const int npoints = 64;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfMData sfmDataPersistent = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+  SfMData sfmDataRebuilt = sfmDataPersistent;
+
+  BundleAdjustmentCeres::CeresOptions options;
+  options.persistentProblem = true;
+  options.verbose = false;
+  BundleAdjustmentCeres persistentBA(options);
+  std::shared_ptr<LocalBundleAdjustmentGraph> localBAGraph;
+
+  const auto adjustBoth = [&]()
+  {
+    BundleAdjustmentCeres rebuiltBA;
+    if(localBAGraph)
+      rebuiltBA.useLocalStrategyGraph(localBAGraph);
+
+    BOOST_CHECK(persistentBA.adjust(sfmDataPersistent));
+    BOOST_CHECK(rebuiltBA.adjust(sfmDataRebuilt));
+
+    const BundleAdjustmentCeres::Statistics& persistentStats = persistentBA.getStatistics();
+    const BundleAdjustmentCeres::Statistics& rebuiltStats = rebuiltBA.getStatistics();
+
+    BOOST_CHECK_EQUAL(persistentStats.nbResidualBlocks, rebuiltStats.nbResidualBlocks);
+    BOOST_CHECK_LE(persistentStats.nbAddedResidualBlocks, rebuiltStats.nbAddedResidualBlocks);
+    BOOST_CHECK_CLOSE(RMSE(sfmDataPersistent), RMSE(sfmDataRebuilt), 1.0);
+
+    BOOST_TEST_MESSAGE("Problem creation: " << persistentStats.problemTime << " s with the persistent problem ("
+                       << persistentStats.nbAddedResidualBlocks << " residual blocks added, " << persistentStats.nbRemovedResidualBlocks << " removed), "
+                       << rebuiltStats.problemTime << " s with the re-created problem");
+  };
+
+  const auto editScene = [](SfMData& sfmData)
+  {
+    // remove some observations
+    sfmData.structure.at(0).observations.erase(2);
+    sfmData.structure.at(3).observations.erase(0);
+
+    // remove a landmark
+    sfmData.structure.erase(1);
+
+    // add a landmark
+    Landmark landmark = sfmData.structure.at(2);
+    landmark.X += Vec3(0.01, -0.01, 0.02);
+    sfmData.structure[npoints] = landmark;
+  };
+
+  const auto removePose = [](SfMData& sfmData, IndexT viewId)
+  {
+    for(auto& landmarkPair : sfmData.structure)
+      landmarkPair.second.observations.erase(viewId);
+    sfmData.erasePose(sfmData.getView(viewId).getPoseId());
+  };
+
+  // first adjustment: same creation of the problem
+  adjustBoth();
+
+  // the persistent problem is updated
+  editScene(sfmDataPersistent);
+  editScene(sfmDataRebuilt);
+  adjustBoth();
+
+  // move a view to a new rig pose (as done by the rig resection)
+  const auto moveToRig = [](SfMData& sfmData, IndexT viewId, IndexT rigPoseId)
+  {
+    View& view = sfmData.getView(viewId);
+
+    Rig rig(1);
+    rig.getSubPose(0) = RigSubPose(geometry::Pose3(), ERigSubPoseStatus::CONSTANT);
+    sfmData.getRigs()[0] = rig;
+
+    sfmData.getPoses()[rigPoseId] = sfmData.getPose(view);
+    sfmData.erasePose(view.getPoseId());
+
+    view.setRigAndSubPoseId(0, 0);
+    view.setIndependantPose(false);
+    view.setPoseId(rigPoseId);
+  };
+
+  // keep the observations of consecutive views only: v0 - v1 - v2 - v3 - v4
+  const auto chainViews = [](SfMData& sfmData)
+  {
+    for(auto it = sfmData.structure.begin(); it != sfmData.structure.end();)
+    {
+      Observations& observations = it->second.observations;
+      for(auto obsIt = observations.begin(); obsIt != observations.end();)
+      {
+        if(obsIt->first != it->first % nviews && obsIt->first != (it->first + 1) % nviews)
+          obsIt = observations.erase(obsIt);
+        else
+          ++obsIt;
+      }
+
+      if(observations.size() < 2)
+        it = sfmData.structure.erase(it);
+      else
+        ++it;
+    }
+
+    // the shared intrinsic would connect all the views of the local graph
+    sfmData.getIntrinsics().begin()->second->lock();
+  };
+
+  removePose(sfmDataPersistent, 5);
+  removePose(sfmDataRebuilt, 5);
+  adjustBoth();
+
+  // the view observations are rebuilt on the rig pose and sub-pose blocks
+  moveToRig(sfmDataPersistent, 4, nviews);
+  moveToRig(sfmDataRebuilt, 4, nviews);
+  adjustBoth();
+
+  // local strategy: v0, v1 refined, v2 constant, v3, v4 ignored
+  chainViews(sfmDataPersistent);
+  chainViews(sfmDataRebuilt);
+
+  const std::set<IndexT> newReconstructedViews = {0};
+  localBAGraph = std::make_shared<LocalBundleAdjustmentGraph>(sfmDataPersistent);
+  localBAGraph->updateGraphWithNewViews(sfmDataPersistent, getTracksPerViews(sfmDataPersistent), newReconstructedViews, 1);
+  localBAGraph->computeGraphDistances(sfmDataPersistent, newReconstructedViews);
+  localBAGraph->convertDistancesToStates(sfmDataPersistent);
+
+  BOOST_CHECK_EQUAL(localBAGraph->getNbPosesPerState(BundleAdjustment::EParameterState::CONSTANT), 1);
+  BOOST_CHECK_EQUAL(localBAGraph->getNbPosesPerState(BundleAdjustment::EParameterState::IGNORED), 2);
+
+  persistentBA.useLocalStrategyGraph(localBAGraph);
+  adjustBoth();
+
+  // back to the full problem: the ignored blocks are added again
+  localBAGraph->setAllParametersToRefine(sfmDataPersistent);
+  adjustBoth();
+}
+
 /// Compute the Root Mean Square Error of the residuals
 double RMSE(const SfMData & sfm_data)
 {
@@ -32,6 +32,11 @@
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -297,6 +302,73 @@ void GlobalSfMTranslationAveragingSolver::Compute_translations(const SfMData& sf
     tripletWise_matches);
 }
 
+namespace {
+
+/**
+ * @brief Shared, read-only index of the pairwise matches per pose pair.
+ * It allows to list the correspondences of a triplet of poses without
+ * scanning all the pairwise matches for each triplet.
+ */
+class PosePairMatchesIndex
+{
+public:
+  PosePairMatchesIndex(const SfMData& sfmData,
+                       const std::set<IndexT>& poseIds,
+                       const matching::PairwiseMatches& pairwiseMatches)
+  {
+    for(const auto& matchIt : pairwiseMatches)
+    {
+      const View* v1 = sfmData.getViews().at(matchIt.first.first).get();
+      const View* v2 = sfmData.getViews().at(matchIt.first.second).get();
+
+      // consider the pair iff it is supported by the rotation graph & 2 different pose id
+      if((v1->getPoseId() != v2->getPoseId())
+         && poseIds.count(v1->getPoseId())
+         && poseIds.count(v2->getPoseId()))
+      {
+        _matchesPerPosePair[posePair(v1->getPoseId(), v2->getPoseId())].push_back(&matchIt);
+      }
+    }
+  }
+
+  /// Pairs of poses supported by at least one pairwise match
+  PairSet getPosePairs() const
+  {
+    PairSet posePairs;
+    for(const auto& it : _matchesPerPosePair)
+      posePairs.insert(it.first);
+    return posePairs;
+  }
+
+  /// List the pairwise matches shared by the poses of the given triplet
+  void getTripletMatches(const graph::Triplet& triplet, matching::PairwiseMatches& tripletMatches) const
+  {
+    tripletMatches.clear();
+    insertMatches(posePair(triplet.i, triplet.j), tripletMatches);
+    insertMatches(posePair(triplet.i, triplet.k), tripletMatches);
+    insertMatches(posePair(triplet.j, triplet.k), tripletMatches);
+  }
+
+private:
+  static Pair posePair(IndexT a, IndexT b)
+  {
+    return (a < b) ? Pair(a, b) : Pair(b, a);
+  }
+
+  void insertMatches(const Pair& pair, matching::PairwiseMatches& tripletMatches) const
+  {
+    const auto it = _matchesPerPosePair.find(pair);
+    if(it == _matchesPerPosePair.end())
+      return;
+    for(const matching::PairwiseMatches::value_type* match : it->second)
+      tripletMatches.insert(*match);
+  }
+
+  std::map<Pair, std::vector<const matching::PairwiseMatches::value_type*>> _matchesPerPosePair;
+};
+
+} // namespace
+
 //-- Perform a trifocal estimation of the graph contained in vec_triplets with an
 // edge coverage algorithm. Its complexity is sub-linear in term of edges count.
 void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCoverage(const SfMData & sfmData,
@@ -315,70 +387,44 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
   // 1. List plausible triplets over the global rotation pose graph Ids.
   //   - list all edges that have support in the rotation pose graph
   //
-  PairSet rotation_pose_id_graph;
   std::set<IndexT> set_pose_ids;
   std::transform(map_globalR.begin(), map_globalR.end(),
     std::inserter(set_pose_ids, set_pose_ids.begin()), stl::RetrieveKey());
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
-  {
-    const Pair pair = match_iterator.first;
-    const View * v1 = sfmData.getViews().at(pair.first).get();
-    const View * v2 = sfmData.getViews().at(pair.second).get();
-
-    if (// Consider the pair iff it is supported by the rotation graph
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
-    {
-      rotation_pose_id_graph.insert(
-        std::make_pair(v1->getPoseId(), v2->getPoseId()));
-    }
-  }
+
+  // Index the shared correspondences (pairs) between poses once for all triplets
+  const PosePairMatchesIndex posePairMatchesIndex(sfmData, set_pose_ids, pairwiseMatches);
+  const PairSet rotation_pose_id_graph = posePairMatchesIndex.getPosePairs();
+
   // List putative triplets (from global rotations Ids)
   const std::vector< graph::Triplet > vec_triplets =
     graph::tripletListing(rotation_pose_id_graph);
   ALICEVISION_LOG_DEBUG("#Triplets: " << vec_triplets.size());
 
+  std::size_t nbEvaluatedTriplets = 0;
+  std::size_t nbValidTriplets = 0;
+  double timeTracks = 0.0;
   {
     // Compute triplets of translations
     // Avoid to cover each edge of the graph by using an edge coverage algorithm
     // An estimated triplets of translation mark three edges as estimated.
 
     //-- precompute the number of track per triplet:
-    HashMap<IndexT, IndexT> map_tracksPerTriplets;
+    std::vector<std::size_t> vec_tracksPerTriplets(vec_triplets.size(), 0);
 
     #pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < (int)vec_triplets.size(); ++i)
     {
       // List matches that belong to the triplet of poses
-      const graph::Triplet & triplet = vec_triplets[i];
-      matching::PairwiseMatches map_triplet_matches;
-      const std::set<IndexT> set_triplet_pose_ids = {triplet.i, triplet.j, triplet.k};
-      // List shared correspondences (pairs) between the triplet poses
-      for (const auto & match_iterator : pairwiseMatches)
-      {
-        const Pair pair = match_iterator.first;
-        const View * v1 = sfmData.getViews().at(pair.first).get();
-        const View * v2 = sfmData.getViews().at(pair.second).get();
-        if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-            (v1->getPoseId() != v2->getPoseId())
-            && set_triplet_pose_ids.count(v1->getPoseId())
-            && set_triplet_pose_ids.count(v2->getPoseId()))
-        {
-          map_triplet_matches.insert( match_iterator );
-        }
-      }
-      // Compute tracks:
-      {
-        aliceVision::track::TracksBuilder tracksBuilder;
-        tracksBuilder.build(map_triplet_matches);
-        tracksBuilder.filter(3);
-
-        #pragma omp critical
-        map_tracksPerTriplets[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
-      }
+      matching::PairwiseMatches tripletMatches;
+      posePairMatchesIndex.getTripletMatches(vec_triplets[i], tripletMatches);
+
+      // Compute tracks (already in a parallel section)
+      aliceVision::track::TracksBuilder tracksBuilder;
+      tracksBuilder.build(tripletMatches);
+      tracksBuilder.filter(3, false);
+      vec_tracksPerTriplets[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
     }
+    timeTracks = timerLP_triplet.elapsed();
 
     typedef Pair myEdge;
 
@@ -403,11 +449,11 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
       std::cout,
       "\nRelative translations computation (edge coverage algorithm)\n");
 
-    // set number of threads, 1 if openMP is not enabled  
+    // thread-local results, merged once all the edges are covered
     std::vector<translationAveraging::RelativeInfoVec> initial_estimates(omp_get_max_threads());
-    const bool bVerbose = false;
+    std::vector<matching::PairwiseMatches> newpairMatchesPerThread(omp_get_max_threads());
 
-    #pragma omp parallel for schedule(dynamic)
+    #pragma omp parallel for schedule(dynamic) reduction(+:nbEvaluatedTriplets, nbValidTriplets)
     for (int k = 0; k < vec_edges.size(); ++k)
     {
       const myEdge & edge = vec_edges[k];
@@ -424,7 +470,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         std::vector<size_t> vec_commonTracksPerTriplets;
         for (const size_t triplet_index : vec_possibleTripletIndexes)
         {
-          vec_commonTracksPerTriplets.push_back(map_tracksPerTriplets[triplet_index]);
+          vec_commonTracksPerTriplets.push_back(vec_tracksPerTriplets[triplet_index]);
         }
 
         using namespace stl::indexed_sort;
@@ -449,6 +495,10 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
             break;
           }
 
+          // Tracks are required by the estimation; skip triplets that cannot provide enough of them
+          if (vec_tracksPerTriplets[triplet_index] < 30)
+            continue;
+
           //--
           // Try to estimate this triplet of translations
           //--
@@ -458,12 +508,17 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
           std::vector<size_t> vec_inliers;
           aliceVision::track::TracksMap pose_triplet_tracks;
 
+          matching::PairwiseMatches tripletMatches;
+          posePairMatchesIndex.getTripletMatches(triplet, tripletMatches);
+
+          ++nbEvaluatedTriplets;
+
           const std::string sOutDirectory = "./";
           const bool bTriplet_estimation = Estimate_T_triplet(
               sfmData,
               map_globalR,
               normalizedFeaturesPerView,
-              pairwiseMatches,
+              tripletMatches,
               triplet,
               vec_tis,
               dPrecision,
@@ -473,11 +528,16 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
 
           if (bTriplet_estimation)
           {
+            ++nbValidTriplets;
+
             // Since new translation edges have been computed, mark their corresponding edges as estimated
             m_mutexSet.insert(std::make_pair(triplet.i, triplet.j));
             m_mutexSet.insert(std::make_pair(triplet.j, triplet.k));
             m_mutexSet.insert(std::make_pair(triplet.i, triplet.k));
 
+            // set number of threads, 1 if openMP is not enabled
+            const int thread_id = omp_get_thread_num();
+
             // Compute the triplet relative motions (IJ, JK, IK)
             {
               const Mat3
@@ -501,50 +561,36 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
               Vec3 tik;
               RelativeCameraMotion(RI, ti, RK, tk, &Rik, &tik);
 
-              // set number of threads, 1 if openMP is not enabled
-              const int thread_id = omp_get_thread_num();
-
               initial_estimates[thread_id].emplace_back(
                 std::make_pair(triplet.i, triplet.j), std::make_pair(Rij, tij));
               initial_estimates[thread_id].emplace_back(
                 std::make_pair(triplet.j, triplet.k), std::make_pair(Rjk, tjk));
               initial_estimates[thread_id].emplace_back(
                 std::make_pair(triplet.i, triplet.k), std::make_pair(Rik, tik));
+            }
 
-              //--- ATOMIC
-              #pragma omp critical
+            // Add inliers as valid pairwise matches
+            {
+              using namespace aliceVision::track;
+              matching::PairwiseMatches& threadPairMatches = newpairMatchesPerThread[thread_id];
+
+              // walk the tracks only once
+              std::sort(vec_inliers.begin(), vec_inliers.end());
+              TracksMap::const_iterator it_tracks = pose_triplet_tracks.begin();
+              std::size_t trackIndex = 0;
+              for (const std::size_t inlierIndex : vec_inliers)
               {
-                // Add inliers as valid pairwise matches
-                for (std::vector<size_t>::const_iterator iterInliers = vec_inliers.begin();
-                  iterInliers != vec_inliers.end(); ++iterInliers)
-                {
-                  using namespace aliceVision::track;
-                  TracksMap::iterator it_tracks = pose_triplet_tracks.begin();
-                  std::advance(it_tracks, *iterInliers);
-                  const Track & track = it_tracks->second;
+                std::advance(it_tracks, inlierIndex - trackIndex);
+                trackIndex = inlierIndex;
+                const Track & track = it_tracks->second;
 
-                  // create pairwise matches from inlier track
-                  for (size_t index_I = 0; index_I < track.featPerView.size() ; ++index_I)
+                // create pairwise matches from inlier track
+                for (auto iter_I = track.featPerView.begin(); iter_I != track.featPerView.end(); ++iter_I)
+                {
+                  // loop on subtracks
+                  for (auto iter_J = std::next(iter_I); iter_J != track.featPerView.end(); ++iter_J)
                   {
-                    Track::FeatureIdPerView::const_iterator iter_I = track.featPerView.begin();
-                    std::advance(iter_I, index_I);
-
-                    // extract camera indexes
-                    const size_t id_view_I = iter_I->first;
-                    const size_t id_feat_I = iter_I->second;
-
-                    // loop on subtracks
-                    for (size_t index_J = index_I+1; index_J < track.featPerView.size() ; ++index_J)
-                    {
-                      Track::FeatureIdPerView::const_iterator iter_J = track.featPerView.begin();
-                      std::advance(iter_J, index_J);
-
-                      // extract camera indexes
-                      const size_t id_view_J = iter_J->first;
-                      const size_t id_feat_J = iter_J->second;
-
-                      newpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
-                    }
+                    threadPairMatches[std::make_pair(iter_I->first, iter_J->first)][track.descType].emplace_back(iter_I->second, iter_J->second);
                   }
                 }
               }
@@ -557,19 +603,39 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
       }
     }
     // Merge thread estimates
-    for(const auto vec : initial_estimates)
+    for(const auto& vec : initial_estimates)
     {
-      for(const auto val : vec)
+      for(const auto& val : vec)
       {
         vec_initialEstimates.emplace_back(val);
       }
     }
+    // Merge thread pairwise matches
+    for(const auto& threadPairMatches : newpairMatchesPerThread)
+    {
+      for(const auto& pairIt : threadPairMatches)
+      {
+        for(const auto& descIt : pairIt.second)
+        {
+          matching::IndMatches& matches = newpairMatches[pairIt.first][descIt.first];
+          matches.insert(matches.end(), descIt.second.begin(), descIt.second.end());
+        }
+      }
+    }
   }
 
 
   const double timeLP_triplet = timerLP_triplet.elapsed();
   ALICEVISION_LOG_DEBUG("TRIPLET COVERAGE TIMING: " << timeLP_triplet << " seconds");
 
+  const double timeEstimation = timeLP_triplet - timeTracks;
+  ALICEVISION_LOG_INFO("Triplets of translations:\n"
+      "\t- # listed triplets: " << vec_triplets.size() << " (tracks counted in " << timeTracks << " s, "
+      << (timeTracks > 0.0 ? vec_triplets.size() / timeTracks : 0.0) << " triplets/s)\n"
+      "\t- # evaluated triplets: " << nbEvaluatedTriplets << " (estimated in " << timeEstimation << " s, "
+      << (timeEstimation > 0.0 ? nbEvaluatedTriplets / timeEstimation : 0.0) << " triplets/s)\n"
+      "\t- # valid triplets: " << nbValidTriplets);
+
   ALICEVISION_LOG_DEBUG(
       "-------------------------------\n"
       "-- #Relative translations estimates: " << m_vec_initialRijTijEstimates.size()/3 <<
@@ -584,7 +650,7 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   const SfMData& sfmData,
   const HashMap<IndexT, Mat3>& map_globalR,
   const feature::FeaturesPerView& normalizedFeaturesPerView,
-  const matching::PairwiseMatches& pairwiseMatches,
+  const matching::PairwiseMatches& tripletMatches,
   const graph::Triplet& poses_id,
   std::vector<Vec3>& vec_tis,
   double& precision, // UpperBound of the precision found by the AContrario estimator
@@ -592,27 +658,11 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   aliceVision::track::TracksMap& tracks,
   const std::string& outDirectory) const
 {
-  // List matches that belong to the triplet of poses
-  matching::PairwiseMatches map_triplet_matches;
-  const std::set<IndexT> set_pose_ids = {poses_id.i, poses_id.j, poses_id.k};
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
-  {
-    const Pair& pair = match_iterator.first;
-    const View* v1 = sfmData.getViews().at(pair.first).get();
-    const View* v2 = sfmData.getViews().at(pair.second).get();
-    if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
-    {
-      map_triplet_matches.insert( match_iterator );
-    }
-  }
-
+  // Compute tracks from the matches that belong to the triplet of poses
+  // (called from a parallel section, do not filter in parallel)
   aliceVision::track::TracksBuilder tracksBuilder;
-  tracksBuilder.build(map_triplet_matches);
-  tracksBuilder.filter(3);
+  tracksBuilder.build(tripletMatches);
+  tracksBuilder.filter(3, false);
   tracksBuilder.exportToSTL(tracks);
 
   if (tracks.size() < 30)
@@ -698,7 +748,7 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   tiny_scene.poses[poses_id.k] = Pose3(vec_global_R_Triplet[2], -vec_global_R_Triplet[2].transpose() * vec_tis[2]);
 
   // insert views used by the relative pose pairs
-  for (const auto & pairIterator : map_triplet_matches )
+  for (const auto & pairIterator : tripletMatches )
   {
     // initialize camera indexes
     const IndexT I = pairIterator.first.first;
@@ -92,6 +92,8 @@ private:
    * Compute relative translations by using triplets of poses.
    * Use an edge coverage algorithm to reduce the graph covering complexity
    * Complexity: sub-linear in term of edges count.
+   * Matches are indexed once per pose pair and shared by all the triplets,
+   * triplets are then estimated in parallel with per-thread result buffers.
    */
   void ComputePutativeTranslation_EdgesCoverage(const sfmData::SfMData& sfmData,
            const HashMap<IndexT, Mat3>& map_globalR,
@@ -102,11 +104,12 @@ private:
 
   /**
    * @brief Robust estimation and refinement of a translation and 3D points of an image triplets.
+   * @param[in] tripletMatches the pairwise matches between the views of the triplet poses
    */
   bool Estimate_T_triplet(const sfmData::SfMData& sfmData,
            const HashMap<IndexT, Mat3>& map_globalR,
            const feature::FeaturesPerView& normalizedFeaturesPerView,
-           const matching::PairwiseMatches& pairwiseMatches,
+           const matching::PairwiseMatches& tripletMatches,
            const graph::Triplet& poses_id,
            std::vector<Vec3>& vec_tis,
            double& precision, // UpperBound of the precision found by the AContrario estimator
@@ -76,12 +76,9 @@ bool SfMLocalizer::Localize(const Pair& imageSize,
     const bool hasDistortion = pinholeCam->have_disto();
     if(hasDistortion)
     {
-      const std::size_t numPts = resectionData.pt2D.cols();
-      pt2Dundistorted = Mat2X(2, numPts);
-      for(std::size_t iPoint = 0; iPoint < numPts; ++iPoint)
-      {
-        pt2Dundistorted.col(iPoint) = pinholeCam->get_ud_pixel(resectionData.pt2D.col(iPoint));
-      }
+      Mat2X undistorted;
+      pinholeCam->getUndistortedPixelsBatch(resectionData.pt2D, undistorted);
+      pt2Dundistorted = undistorted;
     }
 
     switch(estimator)
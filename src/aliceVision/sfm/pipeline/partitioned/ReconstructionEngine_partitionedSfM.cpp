@@ -0,0 +1,449 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/partitioned/ReconstructionEngine_partitionedSfM.hpp>
+#include <aliceVision/sfm/pipeline/partitioned/viewGraphPartition.hpp>
+#include <aliceVision/sfm/utils/alignment.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/sfmFilters.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace fs = boost::filesystem;
+
+using namespace aliceVision::sfmData;
+
+ReconstructionEngine_partitionedSfM::ReconstructionEngine_partitionedSfM(const SfMData& sfmData,
+                                                                         const Params& params,
+                                                                         const std::string& outputFolder)
+  : ReconstructionEngine(sfmData, outputFolder)
+  , _params(params)
+{}
+
+bool ReconstructionEngine_partitionedSfM::process()
+{
+  system::Timer timer;
+
+  partition();
+
+  const double partitionTime = timer.elapsed();
+
+  if(_clusters.size() <= 1)
+  {
+    // no partition: reconstruct all the views with a single sequential engine
+    ReconstructionEngine_sequentialSfM sfmEngine(_sfmData, _params.sequentialParams, _outputFolder,
+                                                 (fs::path(_outputFolder) / "sfm_log.html").string());
+    sfmEngine.setFeatures(_featuresPerView);
+    sfmEngine.setMatches(_pairwiseMatches);
+
+    const bool success = sfmEngine.process();
+    _sfmData = std::move(sfmEngine.getSfMData());
+    return success;
+  }
+
+  timer.reset();
+  reconstructClusters();
+  const double clustersTime = timer.elapsed();
+
+  double mergeTime = 0.0;
+  double bundleAdjustmentTime = 0.0;
+  bool success = false;
+  std::set<std::size_t> droppedClusters;
+  std::vector<std::size_t> mergedClusters;
+
+  while(true)
+  {
+    timer.reset();
+    mergedClusters = mergeClusters(droppedClusters);
+    mergeTime += timer.elapsed();
+
+    if(mergedClusters.empty())
+      break;
+
+    timer.reset();
+    success = bundleAdjustment();
+    bundleAdjustmentTime += timer.elapsed();
+
+    if(success || mergedClusters.size() == 1)
+      break;
+
+    // drop the last merged cluster (registered from the fewest common views) and merge the other ones again
+    ALICEVISION_LOG_WARNING("Global bundle adjustment failed with " << mergedClusters.size() << " merged clusters, "
+                            << "the cluster " << mergedClusters.back() << " is dropped.");
+    droppedClusters.insert(mergedClusters.back());
+  }
+
+  const std::size_t nbMergedClusters = mergedClusters.size();
+  _clustersSfMData.clear();
+
+  ALICEVISION_LOG_INFO("Partitioned Structure from Motion statistics:" << std::endl
+    << "\t- # input images: " << _sfmData.getViews().size() << std::endl
+    << "\t- # clusters: " << _clusters.size() << std::endl
+    << "\t- # merged clusters: " << nbMergedClusters << std::endl
+    << "\t- # dropped clusters: " << droppedClusters.size() << std::endl
+    << "\t- # cameras calibrated: " << _sfmData.getValidViews().size() << std::endl
+    << "\t- # poses: " << _sfmData.getPoses().size() << std::endl
+    << "\t- # landmarks: " << _sfmData.getLandmarks().size() << std::endl
+    << "\t- partition time (s): " << partitionTime << std::endl
+    << "\t- clusters reconstruction time (s): " << clustersTime << std::endl
+    << "\t- merge time (s): " << mergeTime << std::endl
+    << "\t- global bundle adjustment time (s): " << bundleAdjustmentTime << std::endl
+    << "\t- residual RMSE: " << RMSE(_sfmData));
+
+  if(!success && nbMergedClusters > 0)
+    ALICEVISION_LOG_ERROR("Partitioned reconstruction: the global bundle adjustment failed.");
+
+  return success && !_sfmData.getPoses().empty();
+}
+
+void ReconstructionEngine_partitionedSfM::partition()
+{
+  std::set<IndexT> viewIds;
+  for(const auto& viewPair : _sfmData.getViews())
+    viewIds.insert(viewPair.first);
+
+  if(!_sfmData.getRigs().empty())
+  {
+    ALICEVISION_LOG_WARNING("Partitioned reconstruction: the views of a rig can't be reconstructed in different clusters, "
+                            "all the views are reconstructed in a single cluster.");
+    _clusters = {viewIds};
+    return;
+  }
+
+  _clusters = partitionViewGraph(viewIds,
+                                 computeViewGraphWeights(*_pairwiseMatches),
+                                 _params.maxClusterSize,
+                                 _params.clusterOverlapRatio,
+                                 _params.minClusterOverlap);
+
+  std::size_t minSize = std::numeric_limits<std::size_t>::max();
+  std::size_t maxSize = 0;
+  for(const std::set<IndexT>& cluster : _clusters)
+  {
+    minSize = std::min(minSize, cluster.size());
+    maxSize = std::max(maxSize, cluster.size());
+  }
+
+  ALICEVISION_LOG_INFO("View graph partition:" << std::endl
+                       << "\t- # views: " << viewIds.size() << std::endl
+                       << "\t- # clusters: " << _clusters.size() << std::endl
+                       << "\t- # views per cluster: [" << minSize << ", " << maxSize << "]");
+}
+
+void ReconstructionEngine_partitionedSfM::reconstructClusters()
+{
+  _clustersSfMData.assign(_clusters.size(), SfMData());
+
+  // matched pairs of each cluster
+  std::vector<std::vector<Pair>> pairsPerCluster(_clusters.size());
+  {
+    std::map<IndexT, std::vector<std::size_t>> clustersPerView;
+    for(std::size_t c = 0; c < _clusters.size(); ++c)
+      for(const IndexT viewId : _clusters.at(c))
+        clustersPerView[viewId].push_back(c);
+
+    for(const auto& matchesPair : *_pairwiseMatches)
+    {
+      const auto clustersIt = clustersPerView.find(matchesPair.first.first);
+      if(clustersIt == clustersPerView.end())
+        continue;
+
+      for(const std::size_t c : clustersIt->second)
+        if(_clusters.at(c).count(matchesPair.first.second))
+          pairsPerCluster.at(c).push_back(matchesPair.first);
+    }
+  }
+
+  const int nbThreads = std::max(1, std::min(static_cast<int>(_clusters.size()),
+                                             (_params.nbParallelClusters > 0) ? _params.nbParallelClusters : omp_get_max_threads()));
+  // the threads budget is shared by the clusters: each cluster reconstruction
+  // (and the Ceres solver of its bundle adjustments) uses its part of the threads
+  const int nbInnerThreads = std::max(1, omp_get_max_threads() / nbThreads);
+
+  #pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+  for(int c = 0; c < static_cast<int>(_clusters.size()); ++c)
+  {
+    // number of threads used by this thread for the reconstruction of the cluster
+    omp_set_num_threads(nbInnerThreads);
+
+    const std::set<IndexT>& cluster = _clusters.at(c);
+    const std::string clusterFolder = (fs::path(_outputFolder) / ("cluster_" + std::to_string(c))).string();
+
+    ReconstructionEngine_sequentialSfM::Params params = _params.sequentialParams;
+    params.resumeFrom.clear();
+
+    if(cluster.count(params.userInitialImagePair.first) == 0 || cluster.count(params.userInitialImagePair.second) == 0)
+      params.userInitialImagePair = Pair(UndefinedIndexT, UndefinedIndexT);
+
+    matching::PairwiseMatches clusterMatches;
+    for(const Pair& pair : pairsPerCluster.at(c))
+      clusterMatches.emplace(pair, _pairwiseMatches->at(pair));
+
+    try
+    {
+      if(!fs::exists(clusterFolder))
+        fs::create_directory(clusterFolder);
+
+      ReconstructionEngine_sequentialSfM sfmEngine(getClusterSfMData(cluster), params, clusterFolder,
+                                                   (fs::path(clusterFolder) / "sfm_log.html").string());
+      sfmEngine.setFeatures(_featuresPerView);
+      sfmEngine.setMatches(&clusterMatches);
+
+      if(sfmEngine.process())
+        _clustersSfMData.at(c) = std::move(sfmEngine.getSfMData());
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_WARNING("Unable to reconstruct the cluster " << c << " (" << cluster.size() << " views): " << e.what());
+    }
+
+    ALICEVISION_LOG_INFO("Cluster " << c << " reconstructed: " << _clustersSfMData.at(c).getPoses().size()
+                         << " poses for " << cluster.size() << " views.");
+  }
+}
+
+std::vector<std::size_t> ReconstructionEngine_partitionedSfM::mergeClusters(const std::set<std::size_t>& excludedClusters)
+{
+  _sfmData.getPoses().clear();
+  _sfmData.structure.clear();
+  _mergedIntrinsics.clear();
+  _landmarkPerObservation.clear();
+  _nextLandmarkId = 0;
+
+  // reconstructed clusters, from the largest one
+  std::vector<std::size_t> remainingClusters;
+  for(std::size_t c = 0; c < _clustersSfMData.size(); ++c)
+    if(!_clustersSfMData.at(c).getPoses().empty() && excludedClusters.count(c) == 0)
+      remainingClusters.push_back(c);
+
+  std::vector<std::size_t> mergedClusters;
+
+  if(remainingClusters.empty())
+    return mergedClusters;
+
+  std::stable_sort(remainingClusters.begin(), remainingClusters.end(), [&](std::size_t a, std::size_t b)
+  {
+    return _clustersSfMData.at(a).getPoses().size() > _clustersSfMData.at(b).getPoses().size();
+  });
+
+  // the largest cluster defines the coordinate system
+  addClusterReconstruction(_clustersSfMData.at(remainingClusters.front()));
+  mergedClusters.push_back(remainingClusters.front());
+  remainingClusters.erase(remainingClusters.begin());
+  // clusters which can't be registered with the current merged reconstruction
+  std::set<std::size_t> failedClusters;
+
+  while(!remainingClusters.empty())
+  {
+    // the remaining cluster with the most common views
+    auto bestClusterIt = remainingClusters.end();
+    std::size_t bestNbCommonViews = 0;
+
+    for(auto clusterIt = remainingClusters.begin(); clusterIt != remainingClusters.end(); ++clusterIt)
+    {
+      if(failedClusters.count(*clusterIt))
+        continue;
+
+      std::vector<IndexT> commonViewIds;
+      getCommonViewsWithPoses(_clustersSfMData.at(*clusterIt), _sfmData, commonViewIds);
+
+      if(commonViewIds.size() > bestNbCommonViews)
+      {
+        bestClusterIt = clusterIt;
+        bestNbCommonViews = commonViewIds.size();
+      }
+    }
+
+    if(bestClusterIt == remainingClusters.end() || bestNbCommonViews < _params.minNbCommonViews)
+      break;
+
+    const std::size_t c = *bestClusterIt;
+    const SfMData& clusterSfMData = _clustersSfMData.at(c);
+
+    double S;
+    Mat3 R;
+    Vec3 t;
+
+    if(!computeSimilarityFromCommonCameras_viewId(clusterSfMData, _sfmData, &S, &R, &t))
+    {
+      ALICEVISION_LOG_WARNING("Unable to register the cluster " << c << " from " << bestNbCommonViews << " common views.");
+      failedClusters.insert(c);
+      continue;
+    }
+
+    ALICEVISION_LOG_DEBUG("Cluster " << c << " registered from " << bestNbCommonViews << " common views:" << std::endl
+                          << "\t- scale: " << S << std::endl
+                          << "\t- rotation:\n" << R << std::endl
+                          << "\t- translation: " << t.transpose());
+
+    // the cluster reconstruction is kept unchanged, to merge it again if the global bundle adjustment fails
+    SfMData registeredSfMData = clusterSfMData;
+    applyTransform(registeredSfMData, S, R, t);
+    addClusterReconstruction(registeredSfMData);
+
+    mergedClusters.push_back(c);
+    remainingClusters.erase(bestClusterIt);
+    failedClusters.clear();
+  }
+
+  for(const std::size_t c : remainingClusters)
+    ALICEVISION_LOG_WARNING("The cluster " << c << " is not connected to the merged reconstruction, "
+                            << _clustersSfMData.at(c).getPoses().size() << " poses are discarded.");
+
+  return mergedClusters;
+}
+
+void ReconstructionEngine_partitionedSfM::addClusterReconstruction(const SfMData& clusterSfMData)
+{
+  // poses and intrinsics of the new views
+  for(const auto& viewPair : clusterSfMData.getViews())
+  {
+    const View& clusterView = *viewPair.second;
+
+    if(!clusterSfMData.isPoseAndIntrinsicDefined(&clusterView))
+      continue;
+
+    const View& view = _sfmData.getView(viewPair.first);
+
+    // already reconstructed by another cluster
+    if(_sfmData.existsPose(view))
+      continue;
+
+    _sfmData.setAbsolutePose(view.getPoseId(), clusterSfMData.getAbsolutePose(clusterView.getPoseId()));
+
+    const IndexT intrinsicId = view.getIntrinsicId();
+    if(_mergedIntrinsics.insert(intrinsicId).second)
+      _sfmData.intrinsics.at(intrinsicId)->updateFromParams(clusterSfMData.intrinsics.at(intrinsicId)->getParams());
+  }
+
+  // landmarks, fused through their observed features
+  for(const auto& landmarkPair : clusterSfMData.getLandmarks())
+  {
+    const Landmark& clusterLandmark = landmarkPair.second;
+
+    IndexT landmarkId = UndefinedIndexT;
+    for(const auto& observationPair : clusterLandmark.observations)
+    {
+      const auto landmarkIt = _landmarkPerObservation.find(std::make_pair(observationPair.first, observationPair.second.id_feat));
+      if(landmarkIt != _landmarkPerObservation.end())
+      {
+        landmarkId = landmarkIt->second;
+        break;
+      }
+    }
+
+    if(landmarkId == UndefinedIndexT)
+    {
+      landmarkId = _nextLandmarkId++;
+      Landmark& landmark = _sfmData.structure[landmarkId];
+      landmark = clusterLandmark;
+      landmark.observations.clear();
+    }
+
+    Landmark& landmark = _sfmData.structure.at(landmarkId);
+
+    for(const auto& observationPair : clusterLandmark.observations)
+    {
+      // the view already observes the landmark
+      if(landmark.observations.count(observationPair.first))
+        continue;
+
+      // the feature is already used by another landmark
+      if(!_landmarkPerObservation.emplace(std::make_pair(observationPair.first, observationPair.second.id_feat), landmarkId).second)
+        continue;
+
+      landmark.observations[observationPair.first] = observationPair.second;
+    }
+  }
+}
+
+bool ReconstructionEngine_partitionedSfM::bundleAdjustment()
+{
+  const ReconstructionEngine_sequentialSfM::Params& params = _params.sequentialParams;
+
+  BundleAdjustmentCeres::CeresOptions options;
+  options.useAnalyticJacobians = params.useAnalyticJacobians;
+
+  if(_sfmData.getPoses().size() > 100)
+    options.setSparseBA();
+  else
+    options.setDenseBA();
+
+  BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
+
+  if(!params.lockAllIntrinsics)
+    refineOptions |= BundleAdjustment::REFINE_INTRINSICS_ALL;
+
+  const std::size_t nbOutliersThreshold = 50;
+  std::size_t iteration = 0;
+  std::size_t nbOutliers = 0;
+
+  BundleAdjustmentCeres BA(options);
+
+  do
+  {
+    ALICEVISION_LOG_INFO("Start global bundle adjustment iteration: " << iteration);
+
+    if(!BA.adjust(_sfmData, refineOptions))
+      return false; // not usable solution
+
+    const BundleAdjustmentCeres::Statistics& statistics = BA.getStatistics();
+    statistics.exportToFile(_outputFolder, "bundle_adjustment.csv");
+    statistics.show();
+
+    const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, params.maxReprojectionError, 2);
+    const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, params.minAngleForLandmark);
+    nbOutliers = nbOutliersResidualErr + nbOutliersAngleErr;
+
+    ALICEVISION_LOG_INFO("Remove outliers: " << std::endl
+                          << "\t- # outliers residual error: " << nbOutliersResidualErr << std::endl
+                          << "\t- # outliers angular error: " << nbOutliersAngleErr);
+
+    eraseUnstablePosesAndObservations(_sfmData, params.minPointsPerPose, params.minTrackLength);
+
+    ++iteration;
+  }
+  while(nbOutliers > nbOutliersThreshold);
+
+  return true;
+}
+
+SfMData ReconstructionEngine_partitionedSfM::getClusterSfMData(const std::set<IndexT>& cluster) const
+{
+  SfMData clusterSfMData;
+
+  for(const IndexT viewId : cluster)
+  {
+    const View& view = _sfmData.getView(viewId);
+
+    // views and intrinsics are copied: they are modified by the reconstruction of the cluster
+    clusterSfMData.views.emplace(viewId, std::make_shared<View>(view));
+
+    const IndexT intrinsicId = view.getIntrinsicId();
+    const auto intrinsicIt = _sfmData.intrinsics.find(intrinsicId);
+
+    if(intrinsicIt != _sfmData.intrinsics.end() && clusterSfMData.intrinsics.count(intrinsicId) == 0)
+      clusterSfMData.intrinsics.emplace(intrinsicId, std::shared_ptr<camera::IntrinsicBase>(intrinsicIt->second->clone()));
+
+    if(_sfmData.existsPose(view))
+      clusterSfMData.setAbsolutePose(view.getPoseId(), _sfmData.getAbsolutePose(view.getPoseId()));
+  }
+
+  return clusterSfMData;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,135 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
+#include <aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Partitioned SfM Pipeline Reconstruction Engine.
+ * @details Divide and conquer reconstruction of large datasets:
+ *          - the view graph is cut into overlapping clusters of strongly connected views,
+ *          - each cluster is reconstructed by a sequential engine, concurrently,
+ *          - the clusters are registered together with a similarity computed from their common views,
+ *          - a global bundle adjustment refines the merged reconstruction.
+ */
+class ReconstructionEngine_partitionedSfM : public ReconstructionEngine
+{
+public:
+  struct Params
+  {
+    /// parameters of the reconstruction of each cluster
+    ReconstructionEngine_sequentialSfM::Params sequentialParams;
+    /// maximum number of views per cluster, without the overlap (0 to reconstruct all the views in a single cluster)
+    std::size_t maxClusterSize = 100;
+    /// number of views added to each cluster from its neighbors, relative to the cluster size
+    double clusterOverlapRatio = 0.2;
+    /// minimum number of views added to each cluster from its neighbors
+    std::size_t minClusterOverlap = 6;
+    /// minimum number of common reconstructed views to register two clusters
+    std::size_t minNbCommonViews = 3;
+    /// number of clusters reconstructed at the same time (0 to use all the cores)
+    int nbParallelClusters = 0;
+  };
+
+  ReconstructionEngine_partitionedSfM(const sfmData::SfMData& sfmData,
+                                      const Params& params,
+                                      const std::string& outputFolder);
+
+  void setFeatures(feature::FeaturesPerView* featuresPerView)
+  {
+    _featuresPerView = featuresPerView;
+  }
+
+  void setMatches(matching::PairwiseMatches* pairwiseMatches)
+  {
+    _pairwiseMatches = pairwiseMatches;
+  }
+
+  /**
+   * @brief Process the entire partitioned reconstruction
+   * @return true if done
+   */
+  virtual bool process();
+
+  /**
+   * @brief Cut the view graph into overlapping clusters
+   */
+  void partition();
+
+  /**
+   * @brief Reconstruct each cluster with a sequential engine
+   */
+  void reconstructClusters();
+
+  /**
+   * @brief Register the cluster reconstructions together, from the largest one
+   * @param[in] excludedClusters The clusters which are not merged
+   * @return the merged clusters, in merge order
+   */
+  std::vector<std::size_t> mergeClusters(const std::set<std::size_t>& excludedClusters = std::set<std::size_t>());
+
+  /**
+   * @brief Global bundle adjustment of the merged reconstruction
+   * @return true if the bundle adjustment solution is usable
+   */
+  bool bundleAdjustment();
+
+  /**
+   * @brief Get the views of each cluster
+   * @return the clusters
+   */
+  const std::vector<std::set<IndexT>>& getClusters() const
+  {
+    return _clusters;
+  }
+
+private:
+  /**
+   * @brief Build the input SfMData of a cluster, with its own copy of the views and intrinsics
+   * @param[in] cluster The views of the cluster
+   * @return the cluster SfMData
+   */
+  sfmData::SfMData getClusterSfMData(const std::set<IndexT>& cluster) const;
+
+  /**
+   * @brief Add a registered cluster reconstruction to the merged reconstruction
+   * @details Existing poses and intrinsics are kept. Landmarks observing the same features are fused.
+   * @param[in] clusterSfMData The cluster reconstruction, in the merged coordinate system
+   */
+  void addClusterReconstruction(const sfmData::SfMData& clusterSfMData);
+
+  // Parameters
+  Params _params;
+
+  // Data providers
+  feature::FeaturesPerView* _featuresPerView = nullptr;
+  matching::PairwiseMatches* _pairwiseMatches = nullptr;
+
+  /// views of each cluster
+  std::vector<std::set<IndexT>> _clusters;
+  /// reconstruction of each cluster
+  std::vector<sfmData::SfMData> _clustersSfMData;
+  /// intrinsics already estimated in the merged reconstruction
+  std::set<IndexT> _mergedIntrinsics;
+  /// landmark of each merged observation <viewId, featureId>
+  std::map<std::pair<IndexT, IndexT>, IndexT> _landmarkPerObservation;
+  /// next landmark id of the merged reconstruction
+  IndexT _nextLandmarkId = 0;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,137 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfm/pipeline/partitioned/viewGraphPartition.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <iostream>
+
+#define BOOST_TEST_MODULE PARTITIONED_SFM
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::geometry;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+BOOST_AUTO_TEST_CASE(PARTITIONED_SFM_ViewGraphPartition)
+{
+  // a ring of views, each view is matched with its 4 closest neighbors
+  const IndexT nbViews = 40;
+  const std::size_t maxClusterSize = 10;
+  const std::size_t minOverlap = 2;
+
+  std::set<IndexT> viewIds;
+  ViewGraphWeights weights;
+  for(IndexT i = 0; i < nbViews; ++i)
+  {
+    viewIds.insert(i);
+    weights[Pair(i, (i + 1) % nbViews)] = 200;
+    weights[Pair(i, (i + 2) % nbViews)] = 100;
+  }
+
+  const std::vector<std::set<IndexT>> clusters = partitionViewGraph(viewIds, weights, maxClusterSize, 0.2, minOverlap);
+
+  BOOST_CHECK_GE(clusters.size(), nbViews / maxClusterSize - 1);
+
+  std::set<IndexT> partitionedViewIds;
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    const std::set<IndexT>& cluster = clusters.at(c);
+    partitionedViewIds.insert(cluster.begin(), cluster.end());
+
+    BOOST_CHECK_LE(cluster.size(), 2 * maxClusterSize);
+
+    // each cluster can be registered with another cluster
+    std::size_t maxNbCommonViews = 0;
+    for(std::size_t o = 0; o < clusters.size(); ++o)
+    {
+      if(o == c)
+        continue;
+      std::vector<IndexT> commonViewIds;
+      std::set_intersection(cluster.begin(), cluster.end(), clusters.at(o).begin(), clusters.at(o).end(), std::back_inserter(commonViewIds));
+      maxNbCommonViews = std::max(maxNbCommonViews, commonViewIds.size());
+    }
+    BOOST_CHECK_GE(maxNbCommonViews, minOverlap);
+  }
+
+  BOOST_CHECK(partitionedViewIds == viewIds);
+
+  // small graphs are not partitioned
+  BOOST_CHECK_EQUAL(partitionViewGraph(viewIds, weights, nbViews, 0.2, minOverlap).size(), 1);
+}
+
+// Test summary:
+// - Create features points and matching from the synthetic dataset
+// - Reconstruct the scene with the sequential engine and with the partitioned engine
+// - Assert that the partitioned reconstruction:
+//   - mean residual error is below the gaussian noise added to observation
+//   - the desired number of tracks are found,
+//   - the desired number of poses are found.
+BOOST_AUTO_TEST_CASE(PARTITIONED_SFM_Known_Intrinsics)
+{
+  const int nviews = 24;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  ReconstructionEngine_partitionedSfM::Params sfmParams;
+  sfmParams.sequentialParams.lockAllIntrinsics = true;
+  sfmParams.maxClusterSize = 8;
+  sfmParams.clusterOverlapRatio = 0.5;
+
+  // monolithic reconstruction
+  system::Timer timer;
+  {
+    ReconstructionEngine_sequentialSfM sfmEngine(sfmData2, sfmParams.sequentialParams, "./");
+    sfmEngine.setFeatures(&featuresPerView);
+    sfmEngine.setMatches(&pairwiseMatches);
+    BOOST_CHECK(sfmEngine.process());
+  }
+  const double sequentialTime = timer.elapsed();
+
+  // partitioned reconstruction
+  timer.reset();
+  ReconstructionEngine_partitionedSfM sfmEngine(sfmData2, sfmParams, "./");
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+  BOOST_CHECK(sfmEngine.process());
+  const double partitionedTime = timer.elapsed();
+
+  ALICEVISION_LOG_INFO("Wall time (s): sequential: " << sequentialTime << ", partitioned: " << partitionedTime);
+
+  BOOST_CHECK_GT(sfmEngine.getClusters().size(), 1);
+
+  const double residual = RMSE(sfmEngine.getSfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << residual);
+  BOOST_CHECK_LT(residual, 0.5);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), npoints);
+}
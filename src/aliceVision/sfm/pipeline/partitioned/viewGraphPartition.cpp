@@ -0,0 +1,200 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/partitioned/viewGraphPartition.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+/// weighted neighbors of each view
+using ViewGraphAdjacency = std::map<IndexT, std::map<IndexT, std::size_t>>;
+
+ViewGraphAdjacency buildAdjacency(const std::set<IndexT>& viewIds, const ViewGraphWeights& weights)
+{
+  ViewGraphAdjacency adjacency;
+
+  for(const IndexT viewId : viewIds)
+    adjacency[viewId];
+
+  for(const auto& weightPair : weights)
+  {
+    const Pair& pair = weightPair.first;
+
+    if(weightPair.second == 0 || pair.first == pair.second ||
+       viewIds.count(pair.first) == 0 || viewIds.count(pair.second) == 0)
+      continue;
+
+    adjacency[pair.first][pair.second] += weightPair.second;
+    adjacency[pair.second][pair.first] += weightPair.second;
+  }
+  return adjacency;
+}
+
+} // namespace
+
+ViewGraphWeights computeViewGraphWeights(const matching::PairwiseMatches& pairwiseMatches)
+{
+  ViewGraphWeights weights;
+  for(const auto& matchesPair : pairwiseMatches)
+  {
+    const std::size_t nbMatches = matchesPair.second.getNbAllMatches();
+    if(nbMatches > 0)
+      weights[matchesPair.first] = nbMatches;
+  }
+  return weights;
+}
+
+std::vector<std::set<IndexT>> partitionViewGraph(const std::set<IndexT>& viewIds,
+                                                 const ViewGraphWeights& weights,
+                                                 std::size_t maxClusterSize,
+                                                 double overlapRatio,
+                                                 std::size_t minOverlap)
+{
+  if(maxClusterSize == 0 || viewIds.size() <= maxClusterSize)
+    return {viewIds};
+
+  const ViewGraphAdjacency adjacency = buildAdjacency(viewIds, weights);
+
+  // number of matches of each view with the views not yet in a cluster
+  std::map<IndexT, std::size_t> remainingDegree;
+  for(const auto& viewNeighbors : adjacency)
+  {
+    std::size_t degree = 0;
+    for(const auto& neighbor : viewNeighbors.second)
+      degree += neighbor.second;
+    remainingDegree[viewNeighbors.first] = degree;
+  }
+
+  std::vector<std::set<IndexT>> clusters;
+  std::map<IndexT, std::size_t> clusterPerView;
+
+  // greedy graph growing
+  while(!remainingDegree.empty())
+  {
+    // start from the least connected remaining view, to grow the clusters from the border of the graph
+    const IndexT seedViewId = std::min_element(remainingDegree.begin(), remainingDegree.end(),
+                                               [](const std::pair<const IndexT, std::size_t>& a,
+                                                  const std::pair<const IndexT, std::size_t>& b)
+                                               { return a.second < b.second; })->first;
+
+    std::set<IndexT> cluster;
+    // number of matches of each candidate view with the cluster
+    std::map<IndexT, std::size_t> frontier;
+
+    const auto addView = [&](IndexT viewId)
+    {
+      cluster.insert(viewId);
+      clusterPerView[viewId] = clusters.size();
+      remainingDegree.erase(viewId);
+      frontier.erase(viewId);
+
+      for(const auto& neighbor : adjacency.at(viewId))
+      {
+        auto remainingIt = remainingDegree.find(neighbor.first);
+        if(remainingIt == remainingDegree.end())
+          continue;
+        remainingIt->second -= neighbor.second;
+        frontier[neighbor.first] += neighbor.second;
+      }
+    };
+
+    addView(seedViewId);
+
+    while(cluster.size() < maxClusterSize && !frontier.empty())
+    {
+      const IndexT bestViewId = std::max_element(frontier.begin(), frontier.end(),
+                                                 [](const std::pair<const IndexT, std::size_t>& a,
+                                                    const std::pair<const IndexT, std::size_t>& b)
+                                                 { return a.second < b.second; })->first;
+      addView(bestViewId);
+    }
+
+    clusters.push_back(std::move(cluster));
+  }
+
+  // merge the small clusters into their most connected neighbor
+  {
+    const std::size_t minClusterSize = maxClusterSize / 2;
+
+    std::vector<std::size_t> clusterIndexes(clusters.size());
+    std::iota(clusterIndexes.begin(), clusterIndexes.end(), 0);
+    std::stable_sort(clusterIndexes.begin(), clusterIndexes.end(),
+                     [&](std::size_t a, std::size_t b) { return clusters.at(a).size() < clusters.at(b).size(); });
+
+    for(const std::size_t c : clusterIndexes)
+    {
+      std::set<IndexT>& cluster = clusters.at(c);
+
+      if(cluster.empty() || cluster.size() >= minClusterSize)
+        continue;
+
+      std::map<std::size_t, std::size_t> connectionPerCluster;
+      for(const IndexT viewId : cluster)
+        for(const auto& neighbor : adjacency.at(viewId))
+        {
+          const std::size_t neighborCluster = clusterPerView.at(neighbor.first);
+          if(neighborCluster != c)
+            connectionPerCluster[neighborCluster] += neighbor.second;
+        }
+
+      if(connectionPerCluster.empty())
+        continue; // disconnected from the other clusters
+
+      const std::size_t bestCluster = std::max_element(connectionPerCluster.begin(), connectionPerCluster.end(),
+                                                       [](const std::pair<const std::size_t, std::size_t>& a,
+                                                          const std::pair<const std::size_t, std::size_t>& b)
+                                                       { return a.second < b.second; })->first;
+
+      for(const IndexT viewId : cluster)
+        clusterPerView[viewId] = bestCluster;
+
+      clusters.at(bestCluster).insert(cluster.begin(), cluster.end());
+      cluster.clear();
+    }
+
+    clusters.erase(std::remove_if(clusters.begin(), clusters.end(),
+                                  [](const std::set<IndexT>& cluster) { return cluster.empty(); }),
+                   clusters.end());
+
+    for(std::size_t c = 0; c < clusters.size(); ++c)
+      for(const IndexT viewId : clusters.at(c))
+        clusterPerView[viewId] = c;
+  }
+
+  // extend each cluster with its most connected views of the other clusters
+  std::vector<std::set<IndexT>> overlappingClusters = clusters;
+
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    std::map<IndexT, std::size_t> connectionPerView;
+    for(const IndexT viewId : clusters.at(c))
+      for(const auto& neighbor : adjacency.at(viewId))
+        if(clusterPerView.at(neighbor.first) != c)
+          connectionPerView[neighbor.first] += neighbor.second;
+
+    std::vector<std::pair<IndexT, std::size_t>> candidates(connectionPerView.begin(), connectionPerView.end());
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const std::pair<IndexT, std::size_t>& a, const std::pair<IndexT, std::size_t>& b)
+                     { return a.second > b.second; });
+
+    const std::size_t nbOverlapViews = std::min(candidates.size(),
+      std::max(minOverlap, static_cast<std::size_t>(std::ceil(overlapRatio * clusters.at(c).size()))));
+
+    for(std::size_t i = 0; i < nbOverlapViews; ++i)
+      overlappingClusters.at(c).insert(candidates.at(i).first);
+  }
+
+  return overlappingClusters;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,50 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/// Weighted view graph: number of matches per pair of views
+using ViewGraphWeights = std::map<Pair, std::size_t>;
+
+/**
+ * @brief Compute the view graph weights from the pairwise matches
+ * @param[in] pairwiseMatches The pairwise matches
+ * @return the number of matches (all describer types) per pair of views
+ */
+ViewGraphWeights computeViewGraphWeights(const matching::PairwiseMatches& pairwiseMatches);
+
+/**
+ * @brief Cut the view graph into overlapping clusters of strongly connected views.
+ * @details Greedy graph growing partition: each cluster starts from the least connected remaining view
+ *          and grows with the remaining view which has the most matches with the cluster, until the maximum size.
+ *          Clusters smaller than half the maximum size are merged into their most connected neighbor.
+ *          Each cluster is then extended with its most connected views of the other clusters, so clusters
+ *          can be registered together through their common views.
+ * @param[in] viewIds The views to partition
+ * @param[in] weights The view graph weights
+ * @param[in] maxClusterSize The maximum number of views per cluster, without the overlap
+ * @param[in] overlapRatio The number of views added to each cluster from its neighbors, relative to its size
+ * @param[in] minOverlap The minimum number of views added to each cluster from its neighbors
+ * @return the views of each cluster
+ */
+std::vector<std::set<IndexT>> partitionViewGraph(const std::set<IndexT>& viewIds,
+                                                 const ViewGraphWeights& weights,
+                                                 std::size_t maxClusterSize,
+                                                 double overlapRatio,
+                                                 std::size_t minOverlap);
+
+} // namespace sfm
+} // namespace aliceVision
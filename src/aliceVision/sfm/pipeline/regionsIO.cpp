@@ -123,6 +123,28 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
   return regionsPtr;
 }
 
+std::size_t getRegionsFilesSize(const std::vector<std::string>& folders,
+                                IndexT viewId,
+                                feature::EImageDescriberType imageDescriberType)
+{
+  const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
+  const std::string basename = std::to_string(viewId);
+
+  std::size_t filesSize = 0;
+
+  // same lookup as loadRegions: the last folder containing both files wins
+  for(const std::string& folder : folders)
+  {
+    const fs::path featPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".feat");
+    const fs::path descPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".desc");
+
+    if(fs::exists(featPath) && fs::exists(descPath))
+      filesSize = fs::file_size(featPath) + fs::file_size(descPath);
+  }
+
+  return filesSize;
+}
+
 bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
             const SfMData& sfmData,
             const std::vector<std::string>& folders,
@@ -37,6 +37,15 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
  */
 std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
 
+/**
+ * @brief Get the size on disk of the Regions (Features & Descriptors) files of one view.
+ * @param[in] folders The list of featureFolders
+ * @param[in] viewId The view id
+ * @param[in] imageDescriberType The imageDescriber type
+ * @return size in bytes of the regions files (0 if not found)
+ */
+std::size_t getRegionsFilesSize(const std::vector<std::string>& folders, IndexT viewId, feature::EImageDescriberType imageDescriberType);
+
 /**
  * @brief Load Regions (Features & Descriptors) for each view of the provided SfMData container.
  * @param[in,out] regionsPerView
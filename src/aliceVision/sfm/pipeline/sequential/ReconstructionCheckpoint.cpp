@@ -0,0 +1,440 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ReconstructionCheckpoint.hpp"
+#include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+const char checkpointFileMagic[4] = {'A', 'V', 'S', 'C'};
+const std::uint32_t checkpointFileVersion = 1;
+
+template<typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+void readValue(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+void writePose(std::ostream& stream, const geometry::Pose3& pose)
+{
+  stream.write(reinterpret_cast<const char*>(pose.rotation().data()), 9 * sizeof(double));
+  stream.write(reinterpret_cast<const char*>(pose.center().data()), 3 * sizeof(double));
+}
+
+geometry::Pose3 readPose(std::istream& stream)
+{
+  geometry::Pose3 pose;
+  stream.read(reinterpret_cast<char*>(pose.rotation().data()), 9 * sizeof(double));
+  stream.read(reinterpret_cast<char*>(pose.center().data()), 3 * sizeof(double));
+  return pose;
+}
+
+} // namespace
+
+std::size_t computeTracksHash(const track::TracksMap& tracks)
+{
+  std::size_t hash = 0;
+  for(const auto& trackPair : tracks)
+  {
+    boost::hash_combine(hash, trackPair.first);
+    boost::hash_combine(hash, static_cast<int>(trackPair.second.descType));
+    for(const auto& featPair : trackPair.second.featPerView)
+    {
+      boost::hash_combine(hash, featPair.first);
+      boost::hash_combine(hash, featPair.second);
+    }
+  }
+  return hash;
+}
+
+void writeReconstructionCheckpoint(std::ostream& stream,
+                                   const sfmData::SfMData& sfmData,
+                                   const SequentialReconstructionState& state,
+                                   const LocalBundleAdjustmentGraph* localBAGraph)
+{
+  stream.write(checkpointFileMagic, sizeof(checkpointFileMagic));
+  writeValue(stream, checkpointFileVersion);
+
+  // engine state
+  writeValue(stream, static_cast<std::uint64_t>(state.tracksHash));
+  writeValue(stream, state.resectionId);
+  writeValue(stream, static_cast<std::uint64_t>(state.globalIteration));
+  writeValue(stream, static_cast<std::uint64_t>(state.nbValidPoses));
+
+  writeValue(stream, static_cast<std::uint64_t>(state.remainingViewIds.size()));
+  for(const IndexT viewId : state.remainingViewIds)
+    writeValue(stream, viewId);
+
+  writeValue(stream, static_cast<std::uint64_t>(state.acThresholdPerView.size()));
+  for(const auto& thresholdPair : state.acThresholdPerView)
+  {
+    writeValue(stream, thresholdPair.first);
+    writeValue(stream, thresholdPair.second);
+  }
+
+  // views
+  writeValue(stream, static_cast<std::uint64_t>(sfmData.getViews().size()));
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+    writeValue(stream, view.getViewId());
+    writeValue(stream, view.getPoseId());
+    writeValue(stream, view.getResectionId());
+    writeValue(stream, static_cast<std::uint8_t>(view.isPoseIndependant()));
+  }
+
+  // intrinsics
+  writeValue(stream, static_cast<std::uint64_t>(sfmData.getIntrinsics().size()));
+  for(const auto& intrinsicPair : sfmData.getIntrinsics())
+  {
+    const std::vector<double> params = intrinsicPair.second->getParams();
+    writeValue(stream, intrinsicPair.first);
+    writeValue(stream, static_cast<std::uint8_t>(intrinsicPair.second->isLocked()));
+    writeValue(stream, static_cast<std::uint32_t>(params.size()));
+    stream.write(reinterpret_cast<const char*>(params.data()), params.size() * sizeof(double));
+  }
+
+  // poses
+  writeValue(stream, static_cast<std::uint64_t>(sfmData.getPoses().size()));
+  for(const auto& posePair : sfmData.getPoses())
+  {
+    writeValue(stream, posePair.first);
+    writeValue(stream, static_cast<std::uint8_t>(posePair.second.isLocked()));
+    writePose(stream, posePair.second.getTransform());
+  }
+
+  // rigs
+  writeValue(stream, static_cast<std::uint64_t>(sfmData.getRigs().size()));
+  for(const auto& rigPair : sfmData.getRigs())
+  {
+    writeValue(stream, rigPair.first);
+    writeValue(stream, static_cast<std::uint32_t>(rigPair.second.getNbSubPoses()));
+    for(const sfmData::RigSubPose& subPose : rigPair.second.getSubPoses())
+    {
+      writeValue(stream, static_cast<std::uint8_t>(subPose.status));
+      writePose(stream, subPose.pose);
+    }
+  }
+
+  // landmarks
+  writeValue(stream, static_cast<std::uint64_t>(sfmData.getLandmarks().size()));
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const sfmData::Landmark& landmark = landmarkPair.second;
+    writeValue(stream, landmarkPair.first);
+    stream.write(reinterpret_cast<const char*>(landmark.X.data()), 3 * sizeof(double));
+    writeValue(stream, static_cast<std::int32_t>(landmark.descType));
+    writeValue(stream, landmark.rgb.r());
+    writeValue(stream, landmark.rgb.g());
+    writeValue(stream, landmark.rgb.b());
+    writeValue(stream, static_cast<std::uint32_t>(landmark.observations.size()));
+    for(const auto& observationPair : landmark.observations)
+    {
+      writeValue(stream, observationPair.first);
+      writeValue(stream, observationPair.second.id_feat);
+      stream.write(reinterpret_cast<const char*>(observationPair.second.x.data()), 2 * sizeof(double));
+    }
+  }
+
+  // local bundle adjustment graph
+  writeValue(stream, static_cast<std::uint8_t>(localBAGraph != nullptr));
+  if(localBAGraph != nullptr)
+    localBAGraph->saveState(stream);
+}
+
+bool readReconstructionCheckpoint(std::istream& stream,
+                                  sfmData::SfMData& sfmData,
+                                  SequentialReconstructionState& state,
+                                  LocalBundleAdjustmentGraph* localBAGraph,
+                                  bool& hasLocalBAGraph)
+{
+  char magic[sizeof(checkpointFileMagic)];
+  std::uint32_t version = 0;
+  stream.read(magic, sizeof(magic));
+  readValue(stream, version);
+
+  if(!stream.good() || !std::equal(magic, magic + sizeof(magic), checkpointFileMagic) || version != checkpointFileVersion)
+  {
+    ALICEVISION_LOG_ERROR("Invalid reconstruction checkpoint.");
+    return false;
+  }
+
+  std::uint64_t value = 0;
+  std::uint64_t size = 0;
+
+  // engine state
+  state = SequentialReconstructionState();
+  readValue(stream, value);
+  state.tracksHash = static_cast<std::size_t>(value);
+  readValue(stream, state.resectionId);
+  readValue(stream, value);
+  state.globalIteration = static_cast<std::size_t>(value);
+  readValue(stream, value);
+  state.nbValidPoses = static_cast<std::size_t>(value);
+
+  readValue(stream, size);
+  for(std::uint64_t i = 0; i < size && stream.good(); ++i)
+  {
+    IndexT viewId = UndefinedIndexT;
+    readValue(stream, viewId);
+    state.remainingViewIds.insert(viewId);
+  }
+
+  readValue(stream, size);
+  for(std::uint64_t i = 0; i < size && stream.good(); ++i)
+  {
+    IndexT viewId = UndefinedIndexT;
+    double threshold = 0.0;
+    readValue(stream, viewId);
+    readValue(stream, threshold);
+    state.acThresholdPerView[viewId] = threshold;
+  }
+
+  // views
+  readValue(stream, size);
+  if(!stream.good() || size != sfmData.getViews().size())
+  {
+    ALICEVISION_LOG_ERROR("The reconstruction checkpoint does not correspond to the input views.");
+    return false;
+  }
+
+  for(std::uint64_t i = 0; i < size; ++i)
+  {
+    IndexT viewId = UndefinedIndexT;
+    IndexT poseId = UndefinedIndexT;
+    IndexT resectionId = UndefinedIndexT;
+    std::uint8_t isPoseIndependant = 0;
+    readValue(stream, viewId);
+    readValue(stream, poseId);
+    readValue(stream, resectionId);
+    readValue(stream, isPoseIndependant);
+
+    const auto viewIt = sfmData.getViews().find(viewId);
+    if(!stream.good() || viewIt == sfmData.getViews().end())
+    {
+      ALICEVISION_LOG_ERROR("The reconstruction checkpoint does not correspond to the input views.");
+      return false;
+    }
+
+    sfmData::View& view = *viewIt->second;
+    view.setPoseId(poseId);
+    view.setResectionId(resectionId);
+    view.setIndependantPose(isPoseIndependant != 0);
+  }
+
+  // intrinsics
+  readValue(stream, size);
+  for(std::uint64_t i = 0; i < size && stream.good(); ++i)
+  {
+    IndexT intrinsicId = UndefinedIndexT;
+    std::uint8_t isLocked = 0;
+    std::uint32_t nbParams = 0;
+    readValue(stream, intrinsicId);
+    readValue(stream, isLocked);
+    readValue(stream, nbParams);
+
+    std::vector<double> params(nbParams);
+    stream.read(reinterpret_cast<char*>(params.data()), nbParams * sizeof(double));
+
+    const auto intrinsicIt = sfmData.getIntrinsics().find(intrinsicId);
+    if(!stream.good() || intrinsicIt == sfmData.getIntrinsics().end() ||
+       intrinsicIt->second->getParams().size() != nbParams ||
+       !intrinsicIt->second->updateFromParams(params))
+    {
+      ALICEVISION_LOG_ERROR("The reconstruction checkpoint does not correspond to the input intrinsics.");
+      return false;
+    }
+
+    if(isLocked != 0)
+      intrinsicIt->second->lock();
+    else
+      intrinsicIt->second->unlock();
+  }
+
+  // poses
+  sfmData.getPoses().clear();
+  readValue(stream, size);
+  for(std::uint64_t i = 0; i < size && stream.good(); ++i)
+  {
+    IndexT poseId = UndefinedIndexT;
+    std::uint8_t isLocked = 0;
+    readValue(stream, poseId);
+    readValue(stream, isLocked);
+    sfmData.getPoses()[poseId] = sfmData::CameraPose(readPose(stream), isLocked != 0);
+  }
+
+  // rigs
+  readValue(stream, size);
+  for(std::uint64_t i = 0; i < size && stream.good(); ++i)
+  {
+    IndexT rigId = UndefinedIndexT;
+    std::uint32_t nbSubPoses = 0;
+    readValue(stream, rigId);
+    readValue(stream, nbSubPoses);
+
+    const auto rigIt = sfmData.getRigs().find(rigId);
+    if(!stream.good() || rigIt == sfmData.getRigs().end() || rigIt->second.getNbSubPoses() != nbSubPoses)
+    {
+      ALICEVISION_LOG_ERROR("The reconstruction checkpoint does not correspond to the input rigs.");
+      return false;
+    }
+
+    for(std::uint32_t s = 0; s < nbSubPoses; ++s)
+    {
+      std::uint8_t status = 0;
+      readValue(stream, status);
+      const geometry::Pose3 pose = readPose(stream);
+      rigIt->second.setSubPose(s, sfmData::RigSubPose(pose, static_cast<sfmData::ERigSubPoseStatus>(status)));
+    }
+  }
+
+  // landmarks
+  sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+  landmarks.clear();
+  readValue(stream, size);
+  for(std::uint64_t i = 0; i < size && stream.good(); ++i)
+  {
+    IndexT landmarkId = UndefinedIndexT;
+    std::int32_t descType = 0;
+    unsigned char rgb[3];
+    std::uint32_t nbObservations = 0;
+
+    readValue(stream, landmarkId);
+    sfmData::Landmark& landmark = landmarks[landmarkId];
+    stream.read(reinterpret_cast<char*>(landmark.X.data()), 3 * sizeof(double));
+    readValue(stream, descType);
+    stream.read(reinterpret_cast<char*>(rgb), 3);
+    readValue(stream, nbObservations);
+
+    landmark.descType = static_cast<feature::EImageDescriberType>(descType);
+    landmark.rgb = image::RGBColor(rgb[0], rgb[1], rgb[2]);
+
+    for(std::uint32_t o = 0; o < nbObservations && stream.good(); ++o)
+    {
+      IndexT viewId = UndefinedIndexT;
+      sfmData::Observation observation;
+      readValue(stream, viewId);
+      readValue(stream, observation.id_feat);
+      stream.read(reinterpret_cast<char*>(observation.x.data()), 2 * sizeof(double));
+      landmark.observations[viewId] = observation;
+    }
+  }
+
+  // local bundle adjustment graph
+  std::uint8_t hasGraph = 0;
+  readValue(stream, hasGraph);
+  hasLocalBAGraph = (hasGraph != 0);
+
+  if(!stream.good())
+  {
+    ALICEVISION_LOG_ERROR("Truncated reconstruction checkpoint.");
+    return false;
+  }
+
+  if(hasLocalBAGraph && localBAGraph != nullptr && !localBAGraph->loadState(stream))
+  {
+    ALICEVISION_LOG_ERROR("Invalid local bundle adjustment graph in the reconstruction checkpoint.");
+    return false;
+  }
+
+  return true;
+}
+
+AsyncFileWriter::AsyncFileWriter()
+  : _thread(&AsyncFileWriter::run, this)
+{}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _condition.notify_all();
+  _thread.join();
+}
+
+void AsyncFileWriter::write(const std::string& filepath, std::string&& buffer)
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    // replace the pending file not written yet
+    _pendingFilepath = filepath;
+    _pendingBuffer = std::move(buffer);
+    _hasPending = true;
+  }
+  _condition.notify_all();
+}
+
+bool AsyncFileWriter::wait()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _condition.wait(lock, [this]{ return !_hasPending && !_isWriting; });
+  return _success;
+}
+
+void AsyncFileWriter::run()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  while(true)
+  {
+    _condition.wait(lock, [this]{ return _hasPending || _stop; });
+
+    // the pending file is written before stopping
+    if(!_hasPending)
+      return;
+
+    const std::string filepath = std::move(_pendingFilepath);
+    const std::string buffer = std::move(_pendingBuffer);
+    _hasPending = false;
+    _isWriting = true;
+    lock.unlock();
+
+    const std::string tmpFilepath = filepath + ".tmp";
+    bool success = false;
+    {
+      std::ofstream file(tmpFilepath, std::ios::out | std::ios::binary | std::ios::trunc);
+      file.write(buffer.data(), buffer.size());
+      success = file.good();
+    }
+
+    boost::system::error_code ec;
+    if(success)
+      fs::rename(tmpFilepath, filepath, ec);
+
+    if(!success || ec)
+      ALICEVISION_LOG_WARNING("Unable to write the file: " << filepath);
+
+    lock.lock();
+    _isWriting = false;
+    _success = _success && success && !ec;
+    _condition.notify_all();
+  }
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,128 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/track/Track.hpp>
+
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace aliceVision {
+
+namespace sfmData {
+class SfMData;
+} // namespace sfmData
+
+namespace sfm {
+
+class LocalBundleAdjustmentGraph;
+
+/**
+ * @brief State of the sequential reconstruction engine which is not stored in the SfMData
+ */
+struct SequentialReconstructionState
+{
+  /// id of the next resection group
+  IndexT resectionId = 0;
+  /// global iteration of the incremental reconstruction
+  std::size_t globalIteration = 0;
+  /// number of poses at the beginning of the global iteration
+  std::size_t nbValidPoses = 0;
+  /// views which have not been tried in a resection yet
+  std::set<IndexT> remainingViewIds;
+  /// a contrario error threshold of each resected view
+  HashMap<IndexT, double> acThresholdPerView;
+  /// fingerprint of the tracks used by the reconstruction
+  std::size_t tracksHash = 0;
+};
+
+/**
+ * @brief Compute a fingerprint of tracks, to check that a checkpoint is resumed with the tracks of the reconstruction
+ * @param[in] tracks The tracks
+ * @return the tracks fingerprint
+ */
+std::size_t computeTracksHash(const track::TracksMap& tracks);
+
+/**
+ * @brief Write a checkpoint of the sequential reconstruction to a compact binary stream
+ * @details Only the data modified by the reconstruction are written: views pose and resection ids, intrinsics parameters,
+ *          poses, rigs sub-poses and landmarks. The views and intrinsics definitions come from the input SfMData.
+ * @param[out] stream The output binary stream
+ * @param[in] sfmData The reconstruction
+ * @param[in] state The state of the engine
+ * @param[in] localBAGraph The local bundle adjustment graph, or nullptr if not used
+ */
+void writeReconstructionCheckpoint(std::ostream& stream,
+                                   const sfmData::SfMData& sfmData,
+                                   const SequentialReconstructionState& state,
+                                   const LocalBundleAdjustmentGraph* localBAGraph);
+
+/**
+ * @brief Read a checkpoint of the sequential reconstruction written by writeReconstructionCheckpoint()
+ * @param[in] stream The input binary stream
+ * @param[in,out] sfmData The input SfMData of the reconstruction, updated with the checkpoint
+ * @param[out] state The state of the engine
+ * @param[out] localBAGraph The local bundle adjustment graph, or nullptr if not used
+ * @param[out] hasLocalBAGraph True if the checkpoint contains a local bundle adjustment graph
+ * @return true if the checkpoint has been read and is compatible with the input SfMData
+ */
+bool readReconstructionCheckpoint(std::istream& stream,
+                                  sfmData::SfMData& sfmData,
+                                  SequentialReconstructionState& state,
+                                  LocalBundleAdjustmentGraph* localBAGraph,
+                                  bool& hasLocalBAGraph);
+
+/**
+ * @brief Write files on a background thread.
+ * @details Only the latest buffer is kept while a file is being written: an intermediate file may be skipped,
+ *          but the caller never waits for the disk. Each file is written next to its destination and renamed,
+ *          so the destination file is always complete.
+ */
+class AsyncFileWriter
+{
+public:
+  AsyncFileWriter();
+
+  /**
+   * @brief Wait for the pending file and stop the writing thread
+   */
+  ~AsyncFileWriter();
+
+  /**
+   * @brief Write a buffer to a file on the writing thread
+   * @param[in] filepath The destination file path
+   * @param[in] buffer The file content
+   */
+  void write(const std::string& filepath, std::string&& buffer);
+
+  /**
+   * @brief Wait for the pending file
+   * @return true if all the files have been written
+   */
+  bool wait();
+
+private:
+  void run();
+
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  std::string _pendingFilepath;
+  std::string _pendingBuffer;
+  bool _hasPending = false;
+  bool _isWriting = false;
+  bool _stop = false;
+  bool _success = true;
+  std::thread _thread;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -22,6 +22,7 @@
 #include <aliceVision/robustEstimation/ScoreEvaluator.hpp>
 #include <aliceVision/graph/connectedComponent.hpp>
 #include <aliceVision/stl/stl.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cpu.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
@@ -36,6 +37,8 @@
 
 #include <tuple>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 
 #ifdef _MSC_VER
@@ -164,8 +167,16 @@ bool ReconstructionEngine_sequentialSfM::process()
     throw std::runtime_error("No valid tracks.");
   }
 
+  if(_params.checkpointInterval > 0 || !_params.resumeFrom.empty())
+    _tracksHash = computeTracksHash(_map_tracks);
+
+  if(!_params.resumeFrom.empty())
+  {
+    // restore the reconstruction and the state of the incremental loop
+    resumeFromCheckpoint(_params.resumeFrom);
+  }
   // initial pair choice
-  if(_sfmData.getPoses().empty())
+  else if(_sfmData.getPoses().empty())
   {
     std::vector<Pair> initialImagePairCandidates = getInitialImagePairsCandidates();
     createInitialReconstruction(initialImagePairCandidates);
@@ -384,22 +395,42 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
   std::set<IndexT> remainingViewIds;
   std::vector<IndexT> bestViewCandidates;
 
-  // get all viewIds and max resection id
-  for(const auto& viewPair : _sfmData.getViews())
+  std::size_t nbValidPoses = 0;
+  std::size_t globalIteration = 0;
+  bool isResumedIteration = false;
+
+  if(_resumedState != nullptr)
   {
-    IndexT viewId = viewPair.second->getViewId();
-    IndexT viewResectionId = viewPair.second->getResectionId();
+    // continue the global iteration of the checkpoint
+    resectionId = _resumedState->resectionId;
+    remainingViewIds = _resumedState->remainingViewIds;
+    nbValidPoses = _resumedState->nbValidPoses;
+    globalIteration = _resumedState->globalIteration;
+    isResumedIteration = true;
+    _resumedState.reset();
+  }
+  else
+  {
+    // get all viewIds and max resection id
+    for(const auto& viewPair : _sfmData.getViews())
+    {
+      IndexT viewId = viewPair.second->getViewId();
+      IndexT viewResectionId = viewPair.second->getResectionId();
 
-    if(!_sfmData.isPoseAndIntrinsicDefined(viewId))
-      remainingViewIds.insert(viewId);
+      if(!_sfmData.isPoseAndIntrinsicDefined(viewId))
+        remainingViewIds.insert(viewId);
 
-    if(viewResectionId != UndefinedIndexT &&
-       viewResectionId > resectionId)
-    {
-      resectionId = viewResectionId + 1;
+      if(viewResectionId != UndefinedIndexT &&
+         viewResectionId > resectionId)
+      {
+        resectionId = viewResectionId + 1;
+      }
     }
   }
 
+  if(_params.checkpointInterval > 0)
+    _checkpointWriter.reset(new AsyncFileWriter());
+
   // initial print
   {
     std::stringstream ss;
@@ -422,11 +453,13 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 
   aliceVision::system::Timer timer;
 
-  std::size_t nbValidPoses = 0;
-  std::size_t globalIteration = 0;
   do
   {
-    nbValidPoses = _sfmData.getPoses().size();
+    // the number of poses at the beginning of a resumed iteration is restored from the checkpoint
+    if(!isResumedIteration)
+      nbValidPoses = _sfmData.getPoses().size();
+    isResumedIteration = false;
+
     ALICEVISION_LOG_INFO("Incremental Reconstruction start iteration " << globalIteration << ":" << std::endl
                          << "\t- # number of resection groups: " << resectionId << std::endl
                          << "\t- # number of poses: " << nbValidPoses << std::endl
@@ -463,6 +496,17 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       }
 
       ++resectionId;
+
+      // checkpoint of the reconstruction
+      if(_params.checkpointInterval > 0 && (resectionId % _params.checkpointInterval) == 0)
+      {
+        SequentialReconstructionState state;
+        state.resectionId = resectionId;
+        state.globalIteration = globalIteration;
+        state.nbValidPoses = nbValidPoses;
+        state.remainingViewIds = remainingViewIds;
+        saveCheckpoint(std::move(state));
+      }
     }
 
     if(_params.useRigConstraint && !_sfmData.getRigs().empty())
@@ -491,6 +535,13 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
   }
   while(nbValidPoses != _sfmData.getPoses().size());
 
+  // wait for the last checkpoint
+  if(_checkpointWriter != nullptr)
+  {
+    _checkpointWriter->wait();
+    _checkpointWriter.reset();
+  }
+
   ALICEVISION_LOG_INFO("Incremental Reconstruction completed with " << globalIteration << " iterations:" << std::endl
                        << "\t- # number of resection groups: " << resectionId << std::endl
                        << "\t- # number of poses: " << nbValidPoses << std::endl
@@ -501,6 +552,59 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
   return timer.elapsed();
 }
 
+void ReconstructionEngine_sequentialSfM::resumeFromCheckpoint(const std::string& filepath)
+{
+  std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    throw std::runtime_error("Unable to open the reconstruction checkpoint: " + filepath);
+
+  _resumedState.reset(new SequentialReconstructionState());
+  bool hasLocalBAGraph = false;
+
+  if(!readReconstructionCheckpoint(stream, _sfmData, *_resumedState, _localStrategyGraph.get(), hasLocalBAGraph))
+    throw std::runtime_error("Unable to read the reconstruction checkpoint: " + filepath);
+
+  if(_resumedState->tracksHash != _tracksHash)
+    throw std::runtime_error("The reconstruction checkpoint has been computed with other tracks: " + filepath);
+
+  _map_ACThreshold = _resumedState->acThresholdPerView;
+
+  // the local BA graph is rebuilt if the checkpoint has been written without the local strategy
+  if(_params.useLocalBundleAdjustment && !hasLocalBAGraph)
+  {
+    const std::set<IndexT> reconstructedViews = _sfmData.getValidViews();
+    if(!reconstructedViews.empty())
+    {
+      _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, reconstructedViews, _params.kMinNbOfMatches);
+      _localStrategyGraph->updateRigEdgesToTheGraph(_sfmData);
+    }
+  }
+
+  ALICEVISION_LOG_INFO("Reconstruction resumed from the checkpoint: " << filepath << std::endl
+                       << "\t- resection id: " << _resumedState->resectionId << std::endl
+                       << "\t- # poses: " << _sfmData.getPoses().size() << std::endl
+                       << "\t- # landmarks: " << _sfmData.getLandmarks().size() << std::endl
+                       << "\t- # remaining images: " << _resumedState->remainingViewIds.size());
+}
+
+void ReconstructionEngine_sequentialSfM::saveCheckpoint(SequentialReconstructionState state)
+{
+  auto chronoStart = std::chrono::steady_clock::now();
+
+  state.acThresholdPerView = _map_ACThreshold;
+  state.tracksHash = _tracksHash;
+
+  // serialize in memory: the reconstruction can be modified as soon as this function returns
+  std::ostringstream stream(std::ios::out | std::ios::binary);
+  writeReconstructionCheckpoint(stream, _sfmData, state, _params.useLocalBundleAdjustment ? _localStrategyGraph.get() : nullptr);
+
+  const std::string filepath = (fs::path(_outputFolder) / "sfm_checkpoint.bin").string();
+  _checkpointWriter->write(filepath, stream.str());
+
+  ALICEVISION_LOG_DEBUG("Checkpoint of the resection group " << state.resectionId << " serialized in "
+                        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chronoStart).count() << " msec.");
+}
+
  std::set<IndexT> ReconstructionEngine_sequentialSfM::resection(IndexT resectionId,
                                                                 const std::vector<IndexT>& bestViewIds,
                                                                 const std::set<IndexT>& prevReconstructedViews,
@@ -562,6 +666,7 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       if(hasResected)
       {
         updateScene(viewId, newResectionData);
+        ALICEVISION_PERF_COUNTER("sfm.nbResectedViews", 1);
         ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
         _sfmData.getViews().at(viewId)->setResectionId(resectionId);
       }
@@ -594,6 +699,7 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 
 void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& prevReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
+  ALICEVISION_PERF_ZONE("sfm.triangulation");
   auto chrono_start = std::chrono::steady_clock::now();
 
   // allow to use to the old triangulatation algorithm (using 2 views only)
@@ -607,10 +713,13 @@ void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& pre
 
 bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newReconstructedViews, bool isInitialPair)
 {
+  ALICEVISION_PERF_ZONE("sfm.bundleAdjustment");
   ALICEVISION_LOG_INFO("Bundle adjustment start.");
   auto chronoStart = std::chrono::steady_clock::now();
 
   BundleAdjustmentCeres::CeresOptions options;
+  options.useAnalyticJacobians = _params.useAnalyticJacobians;
+  options.persistentProblem = _params.usePersistentBundleAdjustment;
   BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
 
   if(!isInitialPair && !_params.lockAllIntrinsics)
@@ -664,11 +773,16 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     }
   }
 
-  BundleAdjustmentCeres BA(options);
+  // the persistent bundle adjustment keeps its problem from the previous iterations
+  if(_params.usePersistentBundleAdjustment && _bundleAdjustment != nullptr)
+    _bundleAdjustment->setCeresOptions(options);
+  else
+    _bundleAdjustment = std::make_shared<BundleAdjustmentCeres>(options);
+
+  BundleAdjustmentCeres& BA = *_bundleAdjustment;
 
   // give the local strategy graph is local strategy is enable
-  if(enableLocalStrategy)
-    BA.useLocalStrategyGraph(_localStrategyGraph);
+  BA.useLocalStrategyGraph(enableLocalStrategy ? _localStrategyGraph : nullptr);
 
   // perform BA until all point are under the given precision
   do
@@ -713,6 +827,9 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
   }
   while(nbOutliers > nbOutliersThreshold);
 
+  if(!_params.usePersistentBundleAdjustment)
+    _bundleAdjustment.reset();
+
   ALICEVISION_LOG_INFO("Bundle adjustment with " << iteration << " iterations took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chronoStart).count() << " msec.");
   return true;
 }
@@ -916,6 +1033,7 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   std::vector<IndexT> & out_selectedViewIds,
   const std::set<IndexT>& remainingViewIds) const
 {
+  ALICEVISION_PERF_ZONE("sfm.nextBestViews");
   out_selectedViewIds.clear();
   auto chrono_start = std::chrono::steady_clock::now();
   std::vector<ViewConnectionScore> vec_viewsScore;
@@ -1509,6 +1627,7 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
  */
 bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, ResectionData& resectionData)
 {
+  ALICEVISION_PERF_ZONE("sfm.resection");
   using namespace track;
 
   // A. Compute 2D/3D matches
@@ -10,6 +10,7 @@
 #include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
 #include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
+#include <aliceVision/sfm/pipeline/sequential/ReconstructionCheckpoint.hpp>
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
@@ -26,6 +27,8 @@ namespace pt = boost::property_tree;
 namespace aliceVision {
 namespace sfm {
 
+class BundleAdjustmentCeres;
+
 /// Image score contains <ImageId, NbPutativeCommonPoint, score, isIntrinsicsReconstructed>
 typedef std::tuple<IndexT, std::size_t, std::size_t, bool> ViewConnectionScore;
 
@@ -43,6 +46,10 @@ public:
     int minPointsPerPose = 30;
     bool useLocalBundleAdjustment = false;
     int localBundelAdjustementGraphDistanceLimit = 1;
+    /// use the cost functions with analytic jacobians in the bundle adjustment
+    bool useAnalyticJacobians = false;
+    /// keep the bundle adjustment problem between the iterations and only update what changed in the scene
+    bool usePersistentBundleAdjustment = false;
 
     bool useRigConstraint = true;
 
@@ -72,6 +79,13 @@ public:
     /// The minimum number of shared matches to create an edge between two views (nodes)
     const std::size_t kMinNbOfMatches = 50;
 
+    // Checkpoints
+
+    /// number of resection groups between two checkpoints of the reconstruction (0 to disable the checkpoints)
+    std::size_t checkpointInterval = 0;
+    /// checkpoint file to resume the reconstruction from (empty to start a new reconstruction)
+    std::string resumeFrom;
+
     // Intermediate reconstructions
     /// extension of the intermediate reconstruction files
     std::string sfmStepFileExtension = ".ply";
@@ -143,6 +157,19 @@ public:
    */
   double incrementalReconstruction();
 
+  /**
+   * @brief Restore the reconstruction and the engine state from a checkpoint.
+   * @details The tracks must have been computed: the checkpoint can only be resumed with the same tracks.
+   * @param[in] filepath The checkpoint file path
+   */
+  void resumeFromCheckpoint(const std::string& filepath);
+
+  /**
+   * @brief Write a checkpoint of the reconstruction and the engine state on a background thread
+   * @param[in] state The state of the incremental reconstruction loop
+   */
+  void saveCheckpoint(SequentialReconstructionState state);
+
   /**
    * @brief Update the reconstruction with a new resection group of images
    * @param[in] resectionId The resection id
@@ -388,6 +415,17 @@ private:
 
   /// Contains all the data used by the Local BA approach
   std::shared_ptr<LocalBundleAdjustmentGraph> _localStrategyGraph;
+  /// Bundle adjustment kept between the iterations if persistent
+  std::shared_ptr<BundleAdjustmentCeres> _bundleAdjustment;
+
+  // Checkpoints
+
+  /// fingerprint of the tracks
+  std::size_t _tracksHash = 0;
+  /// state of the incremental reconstruction loop restored from a checkpoint
+  std::unique_ptr<SequentialReconstructionState> _resumedState;
+  /// checkpoints writer
+  std::unique_ptr<AsyncFileWriter> _checkpointWriter;
 
   // Log
 
@@ -12,6 +12,7 @@
 
 #include <cmath>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
 
 #define BOOST_TEST_MODULE SEQUENTIAL_SFM
@@ -193,3 +194,88 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
   BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), nbPoints);
 }
 
+
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Checkpoint_Resume)
+{
+  // the first cameras are added one by one: the initial pair and 6 resection groups
+  const int nviews = 8;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  // single checkpoint, after the 4th resection group
+  ReconstructionEngine_sequentialSfM::Params sfmParams;
+  sfmParams.userInitialImagePair = Pair(0, 1);
+  sfmParams.lockAllIntrinsics = true;
+  sfmParams.checkpointInterval = 4;
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Uninterrupted reconstruction
+  ReconstructionEngine_sequentialSfM sfmEngine(
+    sfmData2,
+    sfmParams,
+    "./",
+    "./Reconstruction_Report.html");
+
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK(sfmEngine.process());
+
+  const double residual = RMSE(sfmEngine.getSfMData());
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+
+  // Read back the intermediate checkpoint in the input scene
+  {
+    SfMData checkpointSfMData = sfmData2;
+    SequentialReconstructionState state;
+    bool hasLocalBAGraph = false;
+    std::ifstream stream("./sfm_checkpoint.bin", std::ios::binary);
+    BOOST_REQUIRE(readReconstructionCheckpoint(stream, checkpointSfMData, state, nullptr, hasLocalBAGraph));
+    BOOST_CHECK_EQUAL(state.resectionId, 4);
+    BOOST_CHECK_EQUAL(checkpointSfMData.getPoses().size(), 6);
+    BOOST_CHECK_EQUAL(state.remainingViewIds.size(), nviews - 6);
+    BOOST_CHECK(!checkpointSfMData.getLandmarks().empty());
+  }
+
+  // Resume the reconstruction from the intermediate checkpoint
+  sfmParams.checkpointInterval = 0;
+  sfmParams.resumeFrom = "./sfm_checkpoint.bin";
+
+  ReconstructionEngine_sequentialSfM resumedSfmEngine(
+    sfmData2,
+    sfmParams,
+    "./",
+    "./Reconstruction_Report.html");
+
+  resumedSfmEngine.setFeatures(&featuresPerView);
+  resumedSfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK(resumedSfmEngine.process());
+
+  // same reconstructed views and a comparable residual as the uninterrupted reconstruction
+  const double resumedResidual = RMSE(resumedSfmEngine.getSfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << resumedResidual << " (uninterrupted reconstruction: " << residual << ")");
+  BOOST_CHECK_LT(resumedResidual, 0.5);
+  BOOST_CHECK_CLOSE(resumedResidual, residual, 10.0);
+  BOOST_CHECK(resumedSfmEngine.getSfMData().getValidViews() == sfmEngine.getSfMData().getValidViews());
+  BOOST_CHECK_EQUAL(resumedSfmEngine.getSfMData().getPoses().size(), nviews);
+  BOOST_CHECK_EQUAL(resumedSfmEngine.getSfMData().getLandmarks().size(), npoints);
+}
@@ -26,15 +26,6 @@ using namespace aliceVision::feature;
 using namespace aliceVision::geometry;
 using namespace aliceVision::sfmData;
 
-/// Camera pair epipole (Projection of camera center 2 in the image plane 1)
-inline Vec3 epipole_from_P(const Mat34& P1, const Pose3& P2)
-{
-  const Vec3 c = P2.center();
-  Vec4 center;
-  center << c(0), c(1), c(2), 1.0;
-  return P1*center;
-}
-
 /// Export point feature based vector to a matrix [(x,y)'T, (x,y)'T]
 /// Use the camera intrinsics in order to get undistorted pixel coordinates
 template<typename MatT >
@@ -125,20 +116,15 @@ void StructureEstimationFromKnownPoses::match(
             matches
           );
       #else
-        const Vec3 epipole2  = epipole_from_P(P_R, poseL);
-
-        //const feature::Regions& regions = regionsPerView.getRegions(it->first);
-        robustEstimation::GuidedMatching_Fundamental_Fast
+        // Only compare the features close to the epipolar lines (grid index on the right image features)
+        robustEstimation::GuidedMatching_Fundamental_Grid
           <fundamental::kernel::EpipolarDistanceError>
           (
             F_lr,
-            epipole2,
             iterIntrinsicL->second.get(),
             regionsPerView.getRegions(it->first, descType),
             iterIntrinsicR->second.get(),
             regionsPerView.getRegions(it->second, descType),
-            iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
-            //descType,
             Square(thresholdF), Square(0.8),
             matches
           );
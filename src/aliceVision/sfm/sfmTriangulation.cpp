@@ -8,12 +8,13 @@
 #include "sfmTriangulation.hpp"
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
 #include <aliceVision/robustEstimation/randSampling.hpp>
+#include <aliceVision/robustEstimation/ransacTools.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
 
-#include <deque>
 #include <memory>
+#include <vector>
 
 namespace aliceVision {
 namespace sfm {
@@ -21,6 +22,117 @@ namespace sfm {
 using namespace aliceVision::geometry;
 using namespace aliceVision::camera;
 
+namespace {
+
+/// Flat snapshot of the landmarks to triangulate, so they can be processed
+/// with a parallel for loop and the results committed in bulk afterwards.
+struct LandmarksSnapshot
+{
+  std::vector<IndexT> ids;
+  std::vector<sfmData::Landmark*> landmarks;
+
+  explicit LandmarksSnapshot(sfmData::Landmarks& structure)
+  {
+    ids.reserve(structure.size());
+    landmarks.reserve(structure.size());
+    for(auto& landmarkIt : structure)
+    {
+      ids.push_back(landmarkIt.first);
+      landmarks.push_back(&landmarkIt.second);
+    }
+  }
+
+  std::size_t size() const { return ids.size(); }
+
+  /// Erase the landmarks flagged as rejected from the scene structure
+  void eraseRejected(sfmData::Landmarks& structure, const std::vector<char>& rejected) const
+  {
+    for(std::size_t i = 0; i < ids.size(); ++i)
+    {
+      if(rejected[i])
+        structure.erase(ids[i]);
+    }
+  }
+};
+
+/// Observation of a landmark resolved once (camera, pose, projection matrix and undistorted point)
+struct ResolvedObservation
+{
+  const IntrinsicBase* intrinsic;
+  Pose3 pose;
+  Mat34 P;
+  Vec2 x;
+  Vec2 undistortedX;
+};
+
+/// Resolve the observations of a landmark with a valid pose and intrinsic into a flat array
+void resolveObservations(const sfmData::SfMData& sfmData,
+                         const sfmData::Observations& observations,
+                         std::vector<ResolvedObservation>& resolvedObservations)
+{
+  resolvedObservations.clear();
+  resolvedObservations.reserve(observations.size());
+  for(const auto& itObs : observations)
+  {
+    const sfmData::View* view = sfmData.views.at(itObs.first).get();
+    if(!sfmData.isPoseAndIntrinsicDefined(view))
+      continue;
+
+    ResolvedObservation resolved;
+    resolved.intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
+    resolved.pose = sfmData.getPose(*view).getTransform();
+    resolved.P = resolved.intrinsic->get_projective_equivalent(resolved.pose);
+    resolved.x = itObs.second.x;
+    resolved.undistortedX = resolved.intrinsic->get_ud_pixel(itObs.second.x);
+    resolvedObservations.push_back(resolved);
+  }
+}
+
+/// Triangulate a given track from a selection of observations
+Vec3 track_sample_triangulation(const std::vector<ResolvedObservation>& observations,
+                                const std::set<IndexT>& samples)
+{
+  Triangulation trianObj;
+  for (const IndexT idx : samples)
+  {
+    assert(idx < observations.size());
+    trianObj.add(observations[idx].P, observations[idx].undistortedX);
+  }
+  return trianObj.compute();
+}
+
+/// Thread-safe progress display, updated by batches to limit the synchronizations
+class TriangulationProgress
+{
+public:
+  TriangulationProgress(bool verbose, std::size_t size, const std::string& message)
+  {
+    if(verbose)
+      _progressBar.reset(new boost::progress_display(size, std::cout, message));
+  }
+
+  void increment(std::size_t i)
+  {
+    if(_progressBar && ((i + 1) % _step == 0))
+    {
+      #pragma omp critical(triangulationProgress)
+      (*_progressBar) += _step;
+    }
+  }
+
+  void finish()
+  {
+    if(_progressBar && _progressBar->count() < _progressBar->expected_count())
+      (*_progressBar) += _progressBar->expected_count() - _progressBar->count();
+  }
+
+private:
+  static const std::size_t _step = 1024;
+  std::unique_ptr<boost::progress_display> _progressBar;
+};
+
+} // namespace
+
 StructureComputation_basis::StructureComputation_basis(bool verbose)
   : _bConsoleVerbose(verbose)
 {}
@@ -31,70 +143,46 @@ StructureComputation_blind::StructureComputation_blind(bool verbose)
 
 void StructureComputation_blind::triangulate(sfmData::SfMData& sfmData) const
 {
-  std::deque<IndexT> rejectedId;
-  std::unique_ptr<boost::progress_display> my_progress_bar;
-  if (_bConsoleVerbose)
-    my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
-    std::cout,
-    "Blind triangulation progress:\n" ));
-  #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
+  const LandmarksSnapshot snapshot(sfmData.structure);
+  std::vector<char> rejected(snapshot.size(), 0);
+  TriangulationProgress progress(_bConsoleVerbose, snapshot.size(), "Blind triangulation progress:\n");
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for(int i = 0; i < snapshot.size(); ++i)
   {
-    #pragma omp single nowait
+    progress.increment(i);
+
+    // Triangulate each landmark
+    sfmData::Landmark& landmark = *snapshot.landmarks[i];
+    Triangulation trianObj;
+    for(const auto& itObs : landmark.observations)
     {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      // Triangulate each landmark
-      Triangulation trianObj;
-      const sfmData::Observations & observations = iterTracks->second.observations;
-      for(const auto& itObs : observations)
-      {
-        const sfmData::View * view = sfmData.views.at(itObs.first).get();
-        if (sfmData.isPoseAndIntrinsicDefined(view))
-        {
-          const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-          const Pose3 pose = sfmData.getPose(*view).getTransform();
-          trianObj.add(
-            cam->get_projective_equivalent(pose),
-            cam->get_ud_pixel(itObs.second.x));
-        }
-      }
-      if (trianObj.size() < 2)
-      {
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
-      }
-      else
+      const sfmData::View * view = sfmData.views.at(itObs.first).get();
+      if (sfmData.isPoseAndIntrinsicDefined(view))
       {
-        // Compute the 3D point
-        const Vec3 X = trianObj.compute();
-        if (trianObj.minDepth() > 0) // Keep the point only if it have a positive depth
-        {
-          iterTracks->second.X = X;
-        }
-        else
-        {
-          #pragma omp critical
-          {
-            rejectedId.push_front(iterTracks->first);
-          }
-        }
+        const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
+        const Pose3 pose = sfmData.getPose(*view).getTransform();
+        trianObj.add(
+          cam->get_projective_equivalent(pose),
+          cam->get_ud_pixel(itObs.second.x));
       }
     }
+    if (trianObj.size() < 2)
+    {
+      rejected[i] = 1;
+      continue;
+    }
+    // Compute the 3D point
+    const Vec3 X = trianObj.compute();
+    if (trianObj.minDepth() > 0) // Keep the point only if it have a positive depth
+      landmark.X = X;
+    else
+      rejected[i] = 1;
   }
+  progress.finish();
+
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
-  {
-    sfmData.structure.erase(it);
-  }
+  snapshot.eraseRejected(sfmData.structure, rejected);
 }
 
 StructureComputation_robust::StructureComputation_robust(bool verbose)
@@ -111,43 +199,31 @@ void StructureComputation_robust::triangulate(sfmData::SfMData& sfmData) const
 /// Invalid landmark are removed.
 void StructureComputation_robust::robust_triangulation(sfmData::SfMData& sfmData) const
 {
-  std::deque<IndexT> rejectedId;
-  std::unique_ptr<boost::progress_display> my_progress_bar;
-  if(_bConsoleVerbose)
-    my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
-    std::cout,
-    "Robust triangulation progress:\n" ));
-  #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
+  const LandmarksSnapshot snapshot(sfmData.structure);
+  std::vector<char> rejected(snapshot.size(), 0);
+  TriangulationProgress progress(_bConsoleVerbose, snapshot.size(), "Robust triangulation progress:\n");
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for(int i = 0; i < snapshot.size(); ++i)
   {
-    #pragma omp single nowait
+    progress.increment(i);
+
+    sfmData::Landmark& landmark = *snapshot.landmarks[i];
+    Vec3 X;
+    if (robust_triangulation(sfmData, landmark.observations, X))
     {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      Vec3 X;
-      if (robust_triangulation(sfmData, iterTracks->second.observations, X)) {
-        iterTracks->second.X = X;
-      }
-      else {
-        iterTracks->second.X = Vec3::Zero();
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
-      }
+      landmark.X = X;
+    }
+    else
+    {
+      landmark.X = Vec3::Zero();
+      rejected[i] = 1;
     }
   }
+  progress.finish();
+
   // Erase the unsuccessful triangulated tracks
-  for(auto& it : rejectedId)
-  {
-    sfmData.structure.erase(it);
-  }
+  snapshot.eraseRejected(sfmData.structure, rejected);
 }
 
 /// Robustly try to estimate the best 3D point using a ransac Scheme
@@ -165,22 +241,37 @@ bool StructureComputation_robust::robust_triangulation(const sfmData::SfMData& s
   }
 
   const double dThresholdPixel = 4.0; // TODO: make this parameter customizable
+  const double outliersProbability = 0.01; // probability to never draw an outlier free sample
+
+  // Resolve the observations once, so the RANSAC loop only works on contiguous data
+  std::vector<ResolvedObservation> resolvedObservations;
+  resolveObservations(sfmData, observations, resolvedObservations);
+  const std::size_t nbObservations = resolvedObservations.size();
+  if (nbObservations < 3)
+  {
+    return false;
+  }
+
+  const std::size_t sampleSize = std::min(std::size_t(min_sample_index), nbObservations);
 
-  const IndexT nbIter = observations.size(); // TODO: automatic computation of the number of iterations?
+  // The number of iterations is bounded by the number of observations,
+  // and adapted to the inlier ratio of the best hypothesis.
+  std::size_t nbIter = nbObservations;
 
   // - Ransac variables
   Vec3 best_model;
-  std::set<IndexT> best_inlier_set;
+  std::size_t best_nbInliers = 0;
   double best_error = std::numeric_limits<double>::max();
 
   // - Ransac loop
-  for(IndexT i = 0; i < nbIter; ++i)
+  std::set<IndexT> samples;
+  for(std::size_t i = 0; i < nbIter; ++i)
   {
-    std::set<IndexT> samples;
-    robustEstimation::UniformSample(std::min(std::size_t(min_sample_index), observations.size()), observations.size(), samples);
+    samples.clear();
+    robustEstimation::UniformSample(sampleSize, nbObservations, samples);
 
     // Hypothesis generation.
-    const Vec3 current_model = track_sample_triangulation(sfmData, observations, samples);
+    const Vec3 current_model = track_sample_triangulation(resolvedObservations, samples);
 
     // Test validity of the hypothesis
     // - chierality (for the samples)
@@ -189,73 +280,49 @@ bool StructureComputation_robust::robust_triangulation(const sfmData::SfMData& s
     // Chierality (Check the point is in front of the sampled cameras)
     bool bChierality = true;
 
-    for(auto& it : samples)
+    for(const IndexT idx : samples)
     {
-      sfmData::Observations::const_iterator itObs = observations.begin();
-      std::advance(itObs, it);
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-      const Pose3 pose = sfmData.getPose(*view).getTransform();
-      const double z = pose.depth(current_model); // TODO: cam->depth(pose(X));
+      const double z = resolvedObservations[idx].pose.depth(current_model); // TODO: cam->depth(pose(X));
       bChierality &= z > 0;
     }
 
     if (!bChierality)
       continue;
 
-    std::set<IndexT> inlier_set;
+    std::size_t nbInliers = 0;
     double current_error = 0.0;
-    
+
     // Classification as inlier/outlier according pixel residual errors.
-    for (const auto& itObs : observations)
+    for (const ResolvedObservation& obs : resolvedObservations)
     {
-      const sfmData::View * view = sfmData.views.at(itObs.first).get();
-      const IntrinsicBase * intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-      const Pose3 pose = sfmData.getPose(*view).getTransform();
-      const Vec2 residual = intrinsic->residual(pose, current_model, itObs.second.x);
+      const Vec2 residual = obs.intrinsic->residual(obs.pose, current_model, obs.x);
       const double residual_d = residual.norm();
 
       if (residual_d < dThresholdPixel)
       {
-        inlier_set.insert(itObs.first);
+        ++nbInliers;
         current_error += residual_d;
       }
       else
       {
         current_error += dThresholdPixel;
       }
+      // early exit if this hypothesis cannot be better than the best one
+      if (current_error >= best_error)
+        break;
     }
     // Does the hypothesis is the best one we have seen and have sufficient inliers.
-    if (current_error < best_error && inlier_set.size() >= min_required_inliers)
+    if (current_error < best_error && nbInliers >= min_required_inliers)
     {
       X = best_model = current_model;
-      best_inlier_set = inlier_set;
+      best_nbInliers = nbInliers;
       best_error = current_error;
-    }
-  }
-  return !best_inlier_set.empty();
-}
-
 
-/// Triangulate a given track from a selection of observations
-Vec3 StructureComputation_robust::track_sample_triangulation(const sfmData::SfMData& sfmData,
-                                                             const sfmData::Observations& observations,
-                                                             const std::set<IndexT>& samples) const
-{
-  Triangulation trianObj;
-  for (const IndexT idx : samples)
-  {
-    assert(idx < observations.size());
-    sfmData::Observations::const_iterator itObs = observations.begin();
-    std::advance(itObs, idx);
-    const sfmData::View * view = sfmData.views.at(itObs->first).get();
-    const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-    const Pose3 pose = sfmData.getPose(*view).getTransform();
-    trianObj.add(
-      cam->get_projective_equivalent(pose),
-      cam->get_ud_pixel(itObs->second.x));
+      const double inlierRatio = nbInliers / static_cast<double>(nbObservations);
+      nbIter = std::min(nbIter, robustEstimation::IterationsRequired(sampleSize, outliersProbability, inlierRatio));
+    }
   }
-  return trianObj.compute();
+  return best_nbInliers > 0;
 }
 
 } // namespace sfm
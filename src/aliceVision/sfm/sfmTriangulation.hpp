@@ -39,6 +39,7 @@ struct StructureComputation_blind: public StructureComputation_basis
 /// Triangulation of track data contained in the structure of a SfMData scene.
 // Use a robust estimation:
 // - Triangulate tracks using a RANSAC scheme
+//   (the number of iterations is adapted to the inlier ratio, bounded by the number of observations)
 // - Check cheirality and a pixel residual error (TODO: make it a parameter)
 struct StructureComputation_robust: public StructureComputation_basis
 {
@@ -58,12 +59,6 @@ struct StructureComputation_robust: public StructureComputation_basis
                             Vec3& X,
                             const IndexT min_required_inliers = 3,
                             const IndexT min_sample_index = 3) const;
-
-private:
-  /// Triangulate a given track from a selection of observations
-  Vec3 track_sample_triangulation(const sfmData::SfMData& sfmData,
-                                  const sfmData::Observations& observations,
-                                  const std::set<IndexT>& samples) const;
 };
 
 } // namespace sfm
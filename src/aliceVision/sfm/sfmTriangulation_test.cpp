@@ -0,0 +1,94 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/sfmTriangulation.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#define BOOST_TEST_MODULE sfmTriangulation
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+// Test summary:
+// - Create a SfMData scene from a synthetic dataset
+// - Reset the landmarks positions
+// - Check that the triangulated landmarks match the ground truth
+// - Log the triangulation throughput (landmarks per second)
+
+namespace {
+
+SfMData getSyntheticScene(std::size_t nbViews, std::size_t nbPoints)
+{
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints, config);
+  SfMData sfmData = getInputScene(d, config, camera::PINHOLE_CAMERA);
+  return sfmData;
+}
+
+void checkStructure(const SfMData& sfmData, const SfMData& gtSfmData, double tolerance)
+{
+  for(const auto& landmarkIt : sfmData.getLandmarks())
+  {
+    const Vec3& gtX = gtSfmData.getLandmarks().at(landmarkIt.first).X;
+    BOOST_CHECK_SMALL((landmarkIt.second.X - gtX).norm(), tolerance);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TRIANGULATION_blind)
+{
+  const SfMData gtSfmData = getSyntheticScene(8, 20000);
+  SfMData sfmData = gtSfmData;
+  for(auto& landmarkIt : sfmData.structure)
+    landmarkIt.second.X = Vec3::Zero();
+
+  system::Timer timer;
+  StructureComputation_blind triangulation(false);
+  triangulation.triangulate(sfmData);
+  const double elapsed = timer.elapsed();
+
+  ALICEVISION_LOG_INFO("Blind triangulation: " << sfmData.getLandmarks().size() << " landmarks in " << elapsed << " s ("
+                       << sfmData.getLandmarks().size() / elapsed << " landmarks/s).");
+
+  BOOST_CHECK_EQUAL(sfmData.getLandmarks().size(), gtSfmData.getLandmarks().size());
+  checkStructure(sfmData, gtSfmData, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(TRIANGULATION_robust)
+{
+  const SfMData gtSfmData = getSyntheticScene(8, 20000);
+  SfMData sfmData = gtSfmData;
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_real_distribution<double> outlierDistribution(-100.0, 100.0);
+  for(auto& landmarkIt : sfmData.structure)
+  {
+    landmarkIt.second.X = Vec3::Zero();
+    // add an outlier observation to the landmark
+    Observation& obs = landmarkIt.second.observations.begin()->second;
+    obs.x += Vec2(outlierDistribution(randomNumberGenerator), outlierDistribution(randomNumberGenerator));
+  }
+
+  system::Timer timer;
+  StructureComputation_robust triangulation(false);
+  triangulation.triangulate(sfmData);
+  const double elapsed = timer.elapsed();
+
+  ALICEVISION_LOG_INFO("Robust triangulation: " << sfmData.getLandmarks().size() << " landmarks in " << elapsed << " s ("
+                       << sfmData.getLandmarks().size() / elapsed << " landmarks/s).");
+
+  // most landmarks must be recovered despite the outlier observation
+  BOOST_CHECK_GT(sfmData.getLandmarks().size(), 0.95 * gtSfmData.getLandmarks().size());
+  checkStructure(sfmData, gtSfmData, 1e-2);
+}
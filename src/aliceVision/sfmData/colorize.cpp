@@ -8,119 +8,116 @@
 #include "colorize.hpp"
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
-#include <aliceVision/stl/indexedSort.hpp>
-#include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/image/io.hpp>
+#include <aliceVision/system/Logger.hpp>
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <map>
+#include <queue>
 #include <vector>
-#include <functional>
 namespace aliceVision {
 namespace sfmData {
 
-void colorizeTracks(SfMData& sfmData)
+void colorizeTracks(SfMData& sfmData, int downscale)
 {
-  boost::progress_display progressBar(sfmData.getLandmarks().size(), std::cout, "\nCompute scene structure color\n");
+  const std::size_t nbLandmarks = sfmData.getLandmarks().size();
+  boost::progress_display progressBar(nbLandmarks, std::cout, "\nCompute scene structure color\n");
 
-  std::vector<std::reference_wrapper<Landmark>> remainingLandmarksToColor;
-  remainingLandmarksToColor.reserve(sfmData.getLandmarks().size());
+  std::vector<Landmark*> landmarks;
+  landmarks.reserve(nbLandmarks);
 
+  // landmark indexes observed by each view
+  std::map<IndexT, std::vector<std::size_t>> viewLandmarks;
   for(auto& landmarkPair : sfmData.getLandmarks())
-    remainingLandmarksToColor.push_back(landmarkPair.second);
+  {
+    for(const auto& observationPair : landmarkPair.second.observations)
+      viewLandmarks[observationPair.first].push_back(landmarks.size());
+    landmarks.push_back(&landmarkPair.second);
+  }
 
   struct ViewInfo
   {
-    ViewInfo(IndexT viewId, std::size_t cardinal)
-      : viewId(viewId)
-      , cardinal(cardinal)
-    {}
-
     IndexT viewId;
-    std::size_t cardinal;
-    std::vector<std::reference_wrapper<Landmark>> landmarks;
+    std::vector<std::size_t> landmarks;
   };
 
-  std::vector<ViewInfo> sortedViewsCardinal;
-  sortedViewsCardinal.reserve(sfmData.getViews().size());
+  // minimal set of views covering all the landmarks: greedy set cover, the view observing
+  // the largest number of uncolored landmarks is selected first.
+  // The number of uncolored landmarks of a view can only decrease, so the queued counts
+  // are upper bounds that are updated lazily when a view reaches the top of the queue.
+  std::vector<ViewInfo> selectedViews;
   {
-    // create cardinal per viewId map
-    std::map<IndexT, std::size_t> viewsCardinalMap; // <ViewId, Cardinal>
-    for(const auto& landmarkPair : sfmData.getLandmarks())
-    {
-      const Observations& observations = landmarkPair.second.observations;
-      for(const auto& observationPair : observations)
-        ++viewsCardinalMap[observationPair.first]; // TODO: 0
-    }
+    std::vector<bool> covered(landmarks.size(), false);
+    std::priority_queue<std::pair<std::size_t, IndexT>> queue; // <nb uncolored landmarks, viewId>
 
-    // copy key-value pairs from the map to the vector
-    for(const auto& cardinalPair : viewsCardinalMap)
-      sortedViewsCardinal.push_back(ViewInfo(cardinalPair.first, cardinalPair.second));
+    for(const auto& viewLandmarksPair : viewLandmarks)
+      queue.emplace(viewLandmarksPair.second.size(), viewLandmarksPair.first);
 
-    // sort the vector, biggest cardinality first
-    std::sort(sortedViewsCardinal.begin(),
-              sortedViewsCardinal.end(),
-              [] (const ViewInfo& l, const ViewInfo& r) { return l.cardinal > r.cardinal; });
-  }
+    while(!queue.empty())
+    {
+      const std::pair<std::size_t, IndexT> top = queue.top();
+      queue.pop();
 
-  // assign each landmark to a view
-  for(ViewInfo& viewCardinal : sortedViewsCardinal)
-  {
-    std::vector<std::reference_wrapper<Landmark>> toKeep;
-    const IndexT viewId = viewCardinal.viewId;
+      std::vector<std::size_t>& candidates = viewLandmarks.at(top.second);
+      candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&covered](std::size_t i) { return covered[i]; }), candidates.end());
 
-    for(int i = 0; i < remainingLandmarksToColor.size(); ++i)
-    {
-      Landmark& landmark = remainingLandmarksToColor.at(i);
-      auto it = landmark.observations.find(viewId);
-      if(it != landmark.observations.end())
-      {
-        viewCardinal.landmarks.push_back(landmark);
-      }
-      else
+      if(candidates.empty())
+        continue;
+
+      if(candidates.size() < top.first)
       {
-        toKeep.push_back(landmark);
+        queue.emplace(candidates.size(), top.second);
+        continue;
       }
-    }
-    std::swap(toKeep, remainingLandmarksToColor);
 
-    if(remainingLandmarksToColor.empty())
-      break;
+      for(std::size_t i : candidates)
+        covered[i] = true;
+
+      selectedViews.push_back({top.second, std::move(candidates)});
+    }
   }
 
-  // create an unsorted index container
-  std::vector<int> unsortedIndexes(sortedViewsCardinal.size()) ;
-  std::iota(std::begin(unsortedIndexes), std::end(unsortedIndexes), 0);
-  std::random_shuffle(unsortedIndexes.begin(), unsortedIndexes.end());
+  ALICEVISION_LOG_DEBUG("Colorize " << landmarks.size() << " landmarks from " << selectedViews.size() << " / " << viewLandmarks.size() << " views.");
 
   // landmark colorization
-#pragma omp parallel for
-  for(int i = 0; i < unsortedIndexes.size(); ++i)
+  // each landmark is colored from a single view: the colors are written without synchronization.
+  // The views are sorted by decreasing number of landmarks for the dynamic scheduling.
+  std::atomic<std::size_t> nbColored(0);
+
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < selectedViews.size(); ++i)
   {
-    const ViewInfo& viewCardinal = sortedViewsCardinal.at(unsortedIndexes.at(i));
-    if(!viewCardinal.landmarks.empty())
+    const ViewInfo& viewInfo = selectedViews.at(i);
+    const View& view = sfmData.getView(viewInfo.viewId);
+
+    // only the scanlines (or tiles) containing the observations are decoded
+    std::vector<Vec2i> pixels;
+    pixels.reserve(viewInfo.landmarks.size());
+    for(std::size_t landmarkIndex : viewInfo.landmarks)
     {
-      const View& view = sfmData.getView(viewCardinal.viewId);
-      image::Image<image::RGBColor> image;
-      image::readImage(view.getImagePath(), image, image::EImageColorSpace::SRGB);
+      const Vec2& pt = landmarks[landmarkIndex]->observations.at(viewInfo.viewId).x;
+      // the pixel position is clamped by the reader if the feature/marker center is outside the image.
+      pixels.emplace_back(static_cast<int>(std::floor(pt.x())), static_cast<int>(std::floor(pt.y())));
+    }
 
-      for(Landmark& landmark : viewCardinal.landmarks)
-      {
-        // color the point
-        Vec2 pt = landmark.observations.at(view.getViewId()).x;
-        // clamp the pixel position if the feature/marker center is outside the image.
-        pt.x() = clamp(pt.x(), 0.0, static_cast<double>(image.Width() - 1));
-        pt.y() = clamp(pt.y(), 0.0, static_cast<double>(image.Height() - 1));
-        landmark.rgb = image(pt.y(), pt.x());
-      }
+    std::vector<image::RGBColor> colors;
+    image::readImagePixels(view.getImagePath(), pixels, colors, image::EImageColorSpace::SRGB, downscale);
 
-#pragma omp critical
-      {
-        progressBar += viewCardinal.landmarks.size();
-      }
-    }
+    for(std::size_t k = 0; k < viewInfo.landmarks.size(); ++k)
+      landmarks[viewInfo.landmarks[k]]->rgb = colors[k];
+
+    const std::size_t colored = (nbColored += viewInfo.landmarks.size());
+
+    // the progress display is only updated by the master thread
+    if(omp_get_thread_num() == 0)
+      progressBar += colored - progressBar.count();
   }
+
+  progressBar += nbLandmarks - progressBar.count();
 }
 
 } // namespace sfm
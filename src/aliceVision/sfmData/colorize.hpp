@@ -16,9 +16,12 @@ class SfMData;
  * @brief colorizeTracks Add the associated color to each 3D point of
  * the sfmData, using the track to determine the best view from which
  * to get the color.
+ * The landmarks are colored from a minimal set of views and only the parts of the images
+ * containing the observations are decoded.
  * @param[in,out] sfmData The container of the data
+ * @param[in] downscale Sample the colors in the MIP level of this downscale factor if the images have MIP levels
  */
-void colorizeTracks(SfMData& sfmData);
+void colorizeTracks(SfMData& sfmData, int downscale = 1);
 
 } // namespace sfmData
 } // namespace aliceVision
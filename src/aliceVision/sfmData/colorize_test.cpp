@@ -0,0 +1,129 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/colorize.hpp>
+#include <aliceVision/image/io.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <random>
+
+#define BOOST_TEST_MODULE colorize
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfmData;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// color each landmark from its first view, reading the full images
+void colorizeTracksFullImages(SfMData& sfmData)
+{
+  std::map<IndexT, std::vector<Landmark*>> viewLandmarks;
+  for(auto& landmarkPair : sfmData.getLandmarks())
+    viewLandmarks[landmarkPair.second.observations.begin()->first].push_back(&landmarkPair.second);
+
+  for(const auto& viewLandmarksPair : viewLandmarks)
+  {
+    image::Image<image::RGBColor> image;
+    image::readImage(sfmData.getView(viewLandmarksPair.first).getImagePath(), image, image::EImageColorSpace::SRGB);
+    for(Landmark* landmark : viewLandmarksPair.second)
+    {
+      const Vec2& pt = landmark->observations.at(viewLandmarksPair.first).x;
+      landmark->rgb = image(int(pt.y()), int(pt.x()));
+    }
+  }
+}
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create synthetic images and landmarks observed in several views, in the upper part of the images
+// - Colorize the landmarks
+// - Assert that each color is the color of one of the observations of the landmark
+// - Report the time and the bytes decoded compared to a colorization from the full images
+//-----------------
+BOOST_AUTO_TEST_CASE(colorize_sparseSampling)
+{
+  const int width = 1600;
+  const int height = 1200;
+  const int nbViews = 12;
+  const int nbLandmarks = 5000;
+
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path("colorize_%%%%%%");
+  fs::create_directory(folder);
+
+  SfMData sfmData;
+  std::vector<image::Image<image::RGBColor>> images;
+  for(int v = 0; v < nbViews; ++v)
+  {
+    image::Image<image::RGBColor> image(width, height);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < width; ++x)
+        image(y, x) = image::RGBColor((x + 7 * v) % 256, (y + 13 * v) % 256, (x * y + v) % 256);
+
+    const std::string imagePath = (folder / ("view_" + std::to_string(v) + ".png")).string();
+    image::writeImage(imagePath, image, image::EImageColorSpace::NO_CONVERSION);
+    images.push_back(image);
+    sfmData.getViews().emplace(v, std::make_shared<View>(imagePath, v, 0, v, width, height));
+  }
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> viewDistribution(0, nbViews - 1);
+  std::uniform_real_distribution<double> xDistribution(0.0, width - 1.0);
+  std::uniform_real_distribution<double> yDistribution(0.0, height / 4.0);
+
+  for(int i = 0; i < nbLandmarks; ++i)
+  {
+    Landmark landmark(Vec3::Zero());
+    const int nbObservations = 2 + i % 3;
+    while(landmark.observations.size() < nbObservations)
+      landmark.observations[viewDistribution(generator)] = Observation(Vec2(xDistribution(generator), yDistribution(generator)), i);
+    sfmData.getLandmarks()[i] = landmark;
+  }
+
+  SfMData reference = sfmData;
+
+  image::resetImageReadStats();
+  const auto startSparse = std::chrono::steady_clock::now();
+  colorizeTracks(sfmData);
+  const auto startFull = std::chrono::steady_clock::now();
+  const image::ImageReadStats sparseStats = image::getImageReadStats();
+
+  image::resetImageReadStats();
+  colorizeTracksFullImages(reference);
+  const auto end = std::chrono::steady_clock::now();
+  const image::ImageReadStats fullStats = image::getImageReadStats();
+
+  fs::remove_all(folder);
+
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const Landmark& landmark = landmarkPair.second;
+    bool found = false;
+    for(const auto& observationPair : landmark.observations)
+    {
+      const Vec2& pt = observationPair.second.x;
+      found |= (images.at(observationPair.first)(int(pt.y()), int(pt.x())) == landmark.rgb);
+    }
+    BOOST_CHECK(found);
+  }
+
+  BOOST_CHECK_LE(sparseStats.nbReads, fullStats.nbReads);
+  BOOST_CHECK_LT(sparseStats.decodedBytes, fullStats.decodedBytes);
+
+  const double sparseMs = std::chrono::duration<double, std::milli>(startFull - startSparse).count();
+  const double fullMs = std::chrono::duration<double, std::milli>(end - startFull).count();
+  BOOST_TEST_MESSAGE("Colorization of " << nbLandmarks << " landmarks in " << nbViews << " views: "
+                     << sparseStats.nbReads << " images, " << sparseStats.decodedBytes << " bytes decoded in " << sparseMs << " ms, "
+                     << fullStats.nbReads << " images, " << fullStats.decodedBytes << " bytes decoded in " << fullMs << " ms from the full images");
+}
@@ -13,9 +13,12 @@
 
 #if defined(__WINDOWS__)
 #include <windows.h>
+#include <psapi.h>
 #elif defined(__LINUX__)
 #include <sys/sysinfo.h>
+#include <sys/resource.h>
 #elif defined(__APPLE__)
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/sysctl.h>
 #include <mach/vm_statistics.h>
@@ -99,6 +102,28 @@ MemoryInfo getMemoryInfo()
     return infos;
 }
 
+std::size_t getPeakResidentMemory()
+{
+#if defined(__WINDOWS__)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#elif defined(__LINUX__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+    return 0;
+#elif defined(__APPLE__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<std::size_t>(usage.ru_maxrss); // bytes on macOS
+    return 0;
+#else
+    return 0;
+#endif
+}
+
 std::ostream& operator<<(std::ostream& os, const MemoryInfo& infos)
 {
   const float convertionGb = std::pow(2,30);
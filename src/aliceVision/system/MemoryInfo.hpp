@@ -24,6 +24,12 @@ struct MemoryInfo
 
 MemoryInfo getMemoryInfo();
 
+/**
+ * @brief Get the peak resident set size of the current process.
+ * @return size in bytes (0 if unavailable on this system)
+ */
+std::size_t getPeakResidentMemory();
+
 std::ostream& operator<<(std::ostream& os, const MemoryInfo& infos);
 
 }
@@ -0,0 +1,364 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PerfTrace.hpp"
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_PERF_TRACE)
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace aliceVision {
+namespace system {
+namespace perf {
+
+namespace detail {
+std::atomic<bool> enabled(false);
+} // namespace detail
+
+namespace {
+
+/// maximum number of timeline events per thread, the next zones are only taken into account in the summary
+const std::size_t maxEventsPerThread = 1 << 20;
+/// minimum time between two memory samples of a thread (in microseconds)
+const std::int64_t memorySamplingPeriod = 10000;
+
+struct ZoneEvent
+{
+  const char* name;
+  std::int64_t start;
+  std::int64_t duration;
+};
+
+struct CounterEvent
+{
+  const char* name;
+  std::int64_t time;
+  double value;
+};
+
+struct MemoryEvent
+{
+  std::int64_t time;
+  std::size_t peakMemory;
+};
+
+struct ZoneStats
+{
+  std::size_t count = 0;
+  std::int64_t total = 0;
+  std::int64_t min = std::numeric_limits<std::int64_t>::max();
+  std::int64_t max = 0;
+
+  void add(std::int64_t duration, std::size_t nb = 1)
+  {
+    count += nb;
+    total += duration;
+    min = std::min(min, duration);
+    max = std::max(max, duration);
+  }
+
+  void merge(const ZoneStats& other)
+  {
+    count += other.count;
+    total += other.total;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+};
+
+struct CounterStats
+{
+  std::size_t count = 0;
+  double total = 0.0;
+};
+
+/// events recorded by a thread
+struct ThreadTimeline
+{
+  explicit ThreadTimeline(std::size_t index)
+    : threadIndex(index)
+  {}
+
+  const std::size_t threadIndex;
+  /// only locked by the thread itself, except when the report is written
+  std::mutex mutex;
+  std::vector<ZoneEvent> zones;
+  std::vector<CounterEvent> counters;
+  std::vector<MemoryEvent> memory;
+  std::unordered_map<const char*, ZoneStats> zoneStats;
+  std::unordered_map<const char*, CounterStats> counterStats;
+  std::size_t nbDroppedEvents = 0;
+  std::int64_t lastMemorySample = 0;
+};
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadTimeline>> timelines;
+  std::int64_t startTime = now();
+};
+
+Registry& getRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+ThreadTimeline& getThreadTimeline()
+{
+  thread_local ThreadTimeline* timeline = nullptr;
+  if(timeline == nullptr)
+  {
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.timelines.emplace_back(new ThreadTimeline(registry.timelines.size()));
+    timeline = registry.timelines.back().get();
+  }
+  return *timeline;
+}
+
+std::string escapeJson(const std::string& str)
+{
+  std::string out;
+  out.reserve(str.size());
+  for(const char c : str)
+  {
+    if(c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out;
+}
+
+} // namespace
+
+void enable()
+{
+  detail::enabled.store(true);
+}
+
+void disable()
+{
+  detail::enabled.store(false);
+}
+
+void clear()
+{
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for(auto& timeline : registry.timelines)
+  {
+    std::lock_guard<std::mutex> timelineLock(timeline->mutex);
+    timeline->zones.clear();
+    timeline->counters.clear();
+    timeline->memory.clear();
+    timeline->zoneStats.clear();
+    timeline->counterStats.clear();
+    timeline->nbDroppedEvents = 0;
+  }
+  registry.startTime = now();
+}
+
+void recordZone(const char* name, std::int64_t start, std::int64_t end)
+{
+  ThreadTimeline& timeline = getThreadTimeline();
+  const std::int64_t duration = end - start;
+  bool needMemorySample = false;
+  {
+    std::lock_guard<std::mutex> lock(timeline.mutex);
+    if(timeline.zones.size() < maxEventsPerThread)
+      timeline.zones.push_back({name, start, duration});
+    else
+      ++timeline.nbDroppedEvents;
+    timeline.zoneStats[name].add(duration);
+
+    if(end - timeline.lastMemorySample > memorySamplingPeriod)
+    {
+      timeline.lastMemorySample = end;
+      needMemorySample = true;
+    }
+  }
+  if(needMemorySample)
+    sampleMemory();
+}
+
+void addCounter(const char* name, double value)
+{
+  ThreadTimeline& timeline = getThreadTimeline();
+  std::lock_guard<std::mutex> lock(timeline.mutex);
+  if(timeline.counters.size() < maxEventsPerThread)
+    timeline.counters.push_back({name, now(), value});
+  else
+    ++timeline.nbDroppedEvents;
+  CounterStats& stats = timeline.counterStats[name];
+  ++stats.count;
+  stats.total += value;
+}
+
+void sampleMemory()
+{
+  const std::size_t peakMemory = getPeakResidentMemory();
+  ThreadTimeline& timeline = getThreadTimeline();
+  std::lock_guard<std::mutex> lock(timeline.mutex);
+  if(timeline.memory.size() < maxEventsPerThread)
+    timeline.memory.push_back({now(), peakMemory});
+}
+
+bool writeReport(const std::string& basename)
+{
+  sampleMemory();
+
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  std::map<std::string, ZoneStats> zoneStats;
+  std::map<std::string, CounterStats> counterStats;
+  std::vector<std::pair<CounterEvent, std::size_t>> counterEvents;
+  std::size_t peakMemory = 0;
+  std::size_t nbDroppedEvents = 0;
+
+  std::ofstream traceFile(basename + ".trace.json");
+  if(!traceFile.is_open())
+  {
+    ALICEVISION_LOG_WARNING("Cannot write the performance trace file: " << basename << ".trace.json");
+    return false;
+  }
+
+  traceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  traceFile << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"aliceVision\"}}";
+
+  for(auto& timelinePtr : registry.timelines)
+  {
+    ThreadTimeline& timeline = *timelinePtr;
+    std::lock_guard<std::mutex> timelineLock(timeline.mutex);
+
+    traceFile << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << timeline.threadIndex
+              << ",\"args\":{\"name\":\"thread " << timeline.threadIndex << "\"}}";
+
+    for(const ZoneEvent& event : timeline.zones)
+    {
+      traceFile << ",\n{\"name\":\"" << escapeJson(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << timeline.threadIndex
+                << ",\"ts\":" << (event.start - registry.startTime) << ",\"dur\":" << event.duration << "}";
+    }
+
+    for(const CounterEvent& event : timeline.counters)
+      counterEvents.emplace_back(event, timeline.threadIndex);
+
+    for(const MemoryEvent& event : timeline.memory)
+    {
+      peakMemory = std::max(peakMemory, event.peakMemory);
+      traceFile << ",\n{\"name\":\"peak memory (MB)\",\"ph\":\"C\",\"pid\":1,\"tid\":" << timeline.threadIndex
+                << ",\"ts\":" << (event.time - registry.startTime) << ",\"args\":{\"value\":" << (event.peakMemory / (1024.0 * 1024.0)) << "}}";
+    }
+
+    for(const auto& stats : timeline.zoneStats)
+      zoneStats[stats.first].merge(stats.second);
+
+    for(const auto& stats : timeline.counterStats)
+    {
+      CounterStats& counter = counterStats[stats.first];
+      counter.count += stats.second.count;
+      counter.total += stats.second.total;
+    }
+
+    nbDroppedEvents += timeline.nbDroppedEvents;
+  }
+
+  // counters are accumulated over all threads
+  std::stable_sort(counterEvents.begin(), counterEvents.end(), [](const std::pair<CounterEvent, std::size_t>& a, const std::pair<CounterEvent, std::size_t>& b){ return a.first.time < b.first.time; });
+  std::map<std::string, double> counterValues;
+  for(const auto& event : counterEvents)
+  {
+    double& value = counterValues[event.first.name];
+    value += event.first.value;
+    traceFile << ",\n{\"name\":\"" << escapeJson(event.first.name) << "\",\"ph\":\"C\",\"pid\":1,\"tid\":" << event.second
+              << ",\"ts\":" << (event.first.time - registry.startTime) << ",\"args\":{\"value\":" << value << "}}";
+  }
+  traceFile << "\n]}\n";
+
+  std::ofstream summaryFile(basename + ".summary.csv");
+  if(!summaryFile.is_open())
+  {
+    ALICEVISION_LOG_WARNING("Cannot write the performance summary file: " << basename << ".summary.csv");
+    return false;
+  }
+
+  // zones sorted by total time
+  std::vector<std::pair<std::string, ZoneStats>> sortedZoneStats(zoneStats.begin(), zoneStats.end());
+  std::stable_sort(sortedZoneStats.begin(), sortedZoneStats.end(), [](const std::pair<std::string, ZoneStats>& a, const std::pair<std::string, ZoneStats>& b){ return a.second.total > b.second.total; });
+
+  summaryFile << "type,name,count,total,min,max,mean\n";
+  for(const auto& stats : sortedZoneStats)
+  {
+    const ZoneStats& zone = stats.second;
+    summaryFile << "zone_ms," << stats.first << "," << zone.count << ","
+                << zone.total / 1000.0 << "," << zone.min / 1000.0 << "," << zone.max / 1000.0 << ","
+                << zone.total / 1000.0 / zone.count << "\n";
+  }
+  for(const auto& stats : counterStats)
+  {
+    const CounterStats& counter = stats.second;
+    summaryFile << "counter," << stats.first << "," << counter.count << ","
+                << counter.total << ",,," << counter.total / counter.count << "\n";
+  }
+  summaryFile << "memory_MB,peak memory,1," << peakMemory / (1024.0 * 1024.0) << ",,,\n";
+
+  if(nbDroppedEvents > 0)
+    ALICEVISION_LOG_WARNING("Performance trace: " << nbDroppedEvents << " events are only in the summary (timeline limit reached).");
+
+  return true;
+}
+
+Session::Session(const std::string& nodeName)
+{
+  const char* outputFolder = std::getenv("ALICEVISION_PERF_TRACE");
+  if(outputFolder == nullptr || std::string(outputFolder).empty())
+    return;
+
+#ifdef _WIN32
+  const int pid = _getpid();
+#else
+  const int pid = getpid();
+#endif
+
+  _basename = std::string(outputFolder) + "/" + nodeName + "_" + std::to_string(pid);
+  clear();
+  enable();
+  ALICEVISION_LOG_INFO("Performance trace enabled: " << _basename);
+}
+
+Session::~Session()
+{
+  if(_basename.empty())
+    return;
+
+  disable();
+  if(writeReport(_basename))
+    ALICEVISION_LOG_INFO("Performance trace written: " << _basename << ".trace.json, " << _basename << ".summary.csv");
+}
+
+} // namespace perf
+} // namespace system
+} // namespace aliceVision
+
+#endif
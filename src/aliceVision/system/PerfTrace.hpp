@@ -0,0 +1,164 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/config.hpp>
+
+/**
+ * Performance trace instrumentation
+ *
+ * - ALICEVISION_PERF_ZONE(name): time the enclosing scope
+ * - ALICEVISION_PERF_COUNTER(name, value): accumulate a counter
+ * - ALICEVISION_PERF_SESSION(nodeName): record the trace of an executable
+ *
+ * Names must be string literals.
+ * The trace is recorded only if the ALICEVISION_PERF_TRACE environment variable is set to an output folder,
+ * the session then writes <folder>/<nodeName>_<pid>.trace.json (Chrome trace event format,
+ * one timeline per thread) and <folder>/<nodeName>_<pid>.summary.csv (zones, counters and memory high-water mark).
+ * The macros are empty if AliceVision is built without ALICEVISION_USE_PERF_TRACE.
+ */
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_PERF_TRACE)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+namespace perf {
+
+namespace detail {
+extern std::atomic<bool> enabled;
+} // namespace detail
+
+/**
+ * @brief Check if the trace is recorded
+ */
+inline bool isEnabled()
+{
+  return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Current time in microseconds (steady clock)
+ */
+inline std::int64_t now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Start recording the trace
+ */
+void enable();
+
+/**
+ * @brief Stop recording the trace (the recorded events are kept)
+ */
+void disable();
+
+/**
+ * @brief Clear all the recorded events
+ */
+void clear();
+
+/**
+ * @brief Record a zone on the timeline of the current thread
+ * @param[in] name The zone name (string literal)
+ * @param[in] start The start time in microseconds
+ * @param[in] end The end time in microseconds
+ */
+void recordZone(const char* name, std::int64_t start, std::int64_t end);
+
+/**
+ * @brief Accumulate a counter
+ * @param[in] name The counter name (string literal)
+ * @param[in] value The value to add
+ */
+void addCounter(const char* name, double value);
+
+/**
+ * @brief Sample the memory high-water mark of the process
+ */
+void sampleMemory();
+
+/**
+ * @brief Write the Chrome trace event file (<basename>.trace.json)
+ *        and the summary file (<basename>.summary.csv)
+ * @param[in] basename The output path without extension
+ * @return true if the files are written
+ */
+bool writeReport(const std::string& basename);
+
+/**
+ * @brief Time a scope
+ */
+class ScopedZone
+{
+public:
+  explicit ScopedZone(const char* name)
+    : _name(name)
+    , _start(isEnabled() ? now() : -1)
+  {}
+
+  ~ScopedZone()
+  {
+    if(_start >= 0)
+      recordZone(_name, _start, now());
+  }
+
+  ScopedZone(const ScopedZone&) = delete;
+  ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+  const char* _name;
+  std::int64_t _start;
+};
+
+/**
+ * @brief Trace of an executable
+ * @details Enable the trace if the ALICEVISION_PERF_TRACE environment variable is set,
+ *          and write the report at the end of the scope.
+ */
+class Session
+{
+public:
+  explicit Session(const std::string& nodeName);
+  ~Session();
+
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+
+private:
+  std::string _basename;
+};
+
+} // namespace perf
+} // namespace system
+} // namespace aliceVision
+
+#define ALICEVISION_PERF_CONCAT_IMPL(a, b) a##b
+#define ALICEVISION_PERF_CONCAT(a, b) ALICEVISION_PERF_CONCAT_IMPL(a, b)
+
+#define ALICEVISION_PERF_ZONE(name) \
+  const ::aliceVision::system::perf::ScopedZone ALICEVISION_PERF_CONCAT(aliceVisionPerfZone, __LINE__)(name)
+
+#define ALICEVISION_PERF_COUNTER(name, value) \
+  do { if(::aliceVision::system::perf::isEnabled()) ::aliceVision::system::perf::addCounter(name, value); } while(0)
+
+#define ALICEVISION_PERF_SESSION(nodeName) \
+  const ::aliceVision::system::perf::Session aliceVisionPerfSession(nodeName)
+
+#else
+
+#define ALICEVISION_PERF_ZONE(name)
+#define ALICEVISION_PERF_COUNTER(name, value) do {} while(0)
+#define ALICEVISION_PERF_SESSION(nodeName)
+
+#endif
@@ -0,0 +1,112 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/PerfTrace.hpp>
+
+#define BOOST_TEST_MODULE PerfTrace
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_PERF_TRACE)
+
+namespace {
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+std::size_t countOccurrences(const std::string& str, const std::string& pattern)
+{
+  std::size_t nb = 0;
+  for(std::size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size()))
+    ++nb;
+  return nb;
+}
+
+void work(int n)
+{
+  ALICEVISION_PERF_ZONE("work");
+  ALICEVISION_PERF_COUNTER("nbItems", n);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PerfTrace_disabled)
+{
+  using namespace aliceVision::system;
+  perf::disable();
+  perf::clear();
+
+  work(1);
+
+  const std::string basename = "PerfTrace_disabled";
+  BOOST_CHECK(perf::writeReport(basename));
+  BOOST_CHECK_EQUAL(countOccurrences(readFile(basename + ".trace.json"), "\"work\""), 0);
+  BOOST_CHECK_EQUAL(countOccurrences(readFile(basename + ".summary.csv"), "work"), 0);
+
+  std::remove((basename + ".trace.json").c_str());
+  std::remove((basename + ".summary.csv").c_str());
+}
+
+BOOST_AUTO_TEST_CASE(PerfTrace_report)
+{
+  using namespace aliceVision::system;
+  perf::clear();
+  perf::enable();
+
+  {
+    ALICEVISION_PERF_ZONE("total");
+    #pragma omp parallel for
+    for(int i = 0; i < 100; ++i)
+      work(i);
+  }
+  perf::disable();
+
+  // not recorded
+  work(1000);
+
+  const std::string basename = "PerfTrace_report";
+  BOOST_REQUIRE(perf::writeReport(basename));
+
+  const std::string trace = readFile(basename + ".trace.json");
+  BOOST_CHECK_EQUAL(trace.front(), '{');
+  BOOST_CHECK_EQUAL(countOccurrences(trace, "\"name\":\"work\",\"ph\":\"X\""), 100);
+  BOOST_CHECK_EQUAL(countOccurrences(trace, "\"name\":\"total\",\"ph\":\"X\""), 1);
+  BOOST_CHECK_EQUAL(countOccurrences(trace, "\"name\":\"nbItems\",\"ph\":\"C\""), 100);
+  // counters are cumulative: sum of [0, 99]
+  BOOST_CHECK_EQUAL(countOccurrences(trace, "\"args\":{\"value\":4950}"), 1);
+  BOOST_CHECK_GE(countOccurrences(trace, "\"name\":\"thread_name\""), 1);
+
+  const std::string summary = readFile(basename + ".summary.csv");
+  BOOST_CHECK_EQUAL(summary.find("type,name,count,total,min,max,mean\n"), 0);
+  BOOST_CHECK_NE(summary.find("zone_ms,work,100,"), std::string::npos);
+  BOOST_CHECK_NE(summary.find("zone_ms,total,1,"), std::string::npos);
+  BOOST_CHECK_NE(summary.find("counter,nbItems,100,4950,"), std::string::npos);
+  BOOST_CHECK_NE(summary.find("memory_MB,peak memory,"), std::string::npos);
+
+  std::remove((basename + ".trace.json").c_str());
+  std::remove((basename + ".summary.csv").c_str());
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(PerfTrace_compiledOut)
+{
+  // the macros are empty
+  ALICEVISION_PERF_ZONE("work");
+  ALICEVISION_PERF_COUNTER("nbItems", 1);
+  BOOST_CHECK(true);
+}
+
+#endif
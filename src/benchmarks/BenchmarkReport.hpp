@@ -0,0 +1,211 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/version.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmark {
+
+/**
+ * @brief Timings of a benchmarked kernel
+ */
+struct BenchmarkResult
+{
+  std::string name;
+  /// elapsed time of each repetition (s)
+  std::vector<double> times;
+  /// number of processed items (views, pairs, points, ...) per repetition
+  std::size_t nbItems = 0;
+  /// name of the processed items
+  std::string itemsName;
+  /// kernel outputs of the last repetition (nb matches, residual, ...), to detect functional changes
+  std::map<std::string, double> metrics;
+
+  double minTime() const
+  {
+    return times.empty() ? 0.0 : *std::min_element(times.begin(), times.end());
+  }
+
+  double medianTime() const
+  {
+    if(times.empty())
+      return 0.0;
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    const std::size_t n = sorted.size();
+    return (n % 2 == 1) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+  }
+
+  double meanTime() const
+  {
+    return times.empty() ? 0.0 : std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+  }
+
+  double itemsPerSecond() const
+  {
+    const double median = medianTime();
+    return (median > 0.0) ? (nbItems / median) : 0.0;
+  }
+};
+
+/**
+ * @brief Time the kernels of a benchmark suite and export the results.
+ * @details Each kernel is run several times on the same input: the setup function
+ *          restores the input before each repetition and is not timed.
+ *          The metrics are computed from the kernel outputs after the timer stops.
+ *          The median time is the reference value to compare two runs.
+ */
+class BenchmarkReport
+{
+public:
+  using SetupFunction = std::function<void()>;
+  using KernelFunction = std::function<void(BenchmarkResult&)>;
+  using MetricsFunction = std::function<void(BenchmarkResult&)>;
+
+  BenchmarkReport(const std::string& suiteName, int nbRepetitions)
+    : _suiteName(suiteName)
+    , _nbRepetitions(std::max(1, nbRepetitions))
+  {}
+
+  /**
+   * @brief Add a parameter of the benchmark (scene size, noise, ...)
+   */
+  void addParameter(const std::string& name, double value)
+  {
+    std::ostringstream os;
+    os << value;
+    _parameters.emplace_back(name, os.str());
+  }
+
+  void addParameter(const std::string& name, const std::string& value)
+  {
+    _parameters.emplace_back(name, "\"" + value + "\"");
+  }
+
+  /**
+   * @brief Time a kernel
+   * @param[in] name The kernel name
+   * @param[in] setup Restore the kernel input (not timed)
+   * @param[in] kernel The timed kernel, it sets the number of processed items
+   * @param[in] collectMetrics Set the metrics from the outputs of the last repetition (not timed)
+   * @return the kernel result
+   */
+  const BenchmarkResult& run(const std::string& name, const SetupFunction& setup, const KernelFunction& kernel,
+                             const MetricsFunction& collectMetrics = MetricsFunction())
+  {
+    BenchmarkResult result;
+    result.name = name;
+
+    for(int i = 0; i < _nbRepetitions; ++i)
+    {
+      setup();
+      result.metrics.clear();
+
+      system::Timer timer;
+      kernel(result);
+      result.times.push_back(timer.elapsed());
+    }
+
+    if(collectMetrics)
+      collectMetrics(result);
+
+    ALICEVISION_LOG_INFO(name << ": " << result.medianTime() * 1000.0 << " ms (median of " << result.times.size() << "), "
+                         << result.itemsPerSecond() << " " << result.itemsName << "/s");
+
+    _results.push_back(result);
+    return _results.back();
+  }
+
+  /**
+   * @brief Write the results in a JSON file
+   * @param[in] filepath The output file path
+   * @return true if the file is written
+   */
+  bool writeJSON(const std::string& filepath) const
+  {
+    std::ofstream file(filepath);
+    if(!file.is_open())
+    {
+      ALICEVISION_LOG_ERROR("Cannot write the benchmark results: " << filepath);
+      return false;
+    }
+    write(file);
+    return file.good();
+  }
+
+  /**
+   * @brief Write the results in JSON
+   */
+  void write(std::ostream& os) const
+  {
+    os.precision(9);
+    os << "{\n"
+       << "  \"suite\": \"" << _suiteName << "\",\n"
+       << "  \"version\": \"" << ALICEVISION_VERSION_STRING << "\",\n"
+       << "  \"nbThreads\": " << omp_get_max_threads() << ",\n"
+       << "  \"repetitions\": " << _nbRepetitions << ",\n"
+       << "  \"peakMemory\": " << system::getPeakResidentMemory() << ",\n"
+       << "  \"parameters\": {";
+
+    for(std::size_t i = 0; i < _parameters.size(); ++i)
+      os << (i > 0 ? ", " : "") << "\"" << _parameters[i].first << "\": " << _parameters[i].second;
+
+    os << "},\n"
+       << "  \"results\": [";
+
+    for(std::size_t i = 0; i < _results.size(); ++i)
+    {
+      const BenchmarkResult& result = _results[i];
+      os << (i > 0 ? "," : "") << "\n    {"
+         << "\"name\": \"" << result.name << "\", "
+         << "\"medianTime\": " << result.medianTime() << ", "
+         << "\"minTime\": " << result.minTime() << ", "
+         << "\"meanTime\": " << result.meanTime() << ", "
+         << "\"nbItems\": " << result.nbItems << ", "
+         << "\"itemsName\": \"" << result.itemsName << "\", "
+         << "\"itemsPerSecond\": " << result.itemsPerSecond() << ", "
+         << "\"metrics\": {";
+
+      std::size_t j = 0;
+      for(const auto& metric : result.metrics)
+        os << (j++ > 0 ? ", " : "") << "\"" << metric.first << "\": " << metric.second;
+
+      os << "}}";
+    }
+    os << "\n  ]\n}\n";
+  }
+
+  const std::vector<BenchmarkResult>& getResults() const
+  {
+    return _results;
+  }
+
+private:
+  std::string _suiteName;
+  int _nbRepetitions;
+  /// parameter names and JSON values
+  std::vector<std::pair<std::string, std::string>> _parameters;
+  std::vector<BenchmarkResult> _results;
+};
+
+} // namespace benchmark
+} // namespace aliceVision
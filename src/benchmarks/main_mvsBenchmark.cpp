@@ -0,0 +1,434 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "BenchmarkReport.hpp"
+
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/geometry/Pose3.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshRasterizer.hpp>
+#include <aliceVision/mesh/Texturing.hpp>
+#include <aliceVision/mvsData/Color.hpp>
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/mvsData/Point2d.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+/**
+ * @brief Create the graph of a synthetic volume: a regular grid of cells where the cells inside
+ *        a sphere are full (sink) and the others are empty (source), with noisy votes.
+ * @param[in] gridSize The number of cells along each axis
+ * @param[in] noise The standard deviation of the votes noise, relative to the votes
+ * @param[in] seed The random seed
+ * @return the max-flow graph
+ */
+std::unique_ptr<fuseCut::MaxFlow_AdjList> createVolumeGraph(int gridSize, double noise, int seed)
+{
+  std::mt19937 generator(seed);
+  std::normal_distribution<float> voteNoise(0.0f, static_cast<float>(noise));
+
+  const std::size_t nbCells = std::size_t(gridSize) * gridSize * gridSize;
+  std::unique_ptr<fuseCut::MaxFlow_AdjList> graph(new fuseCut::MaxFlow_AdjList(nbCells));
+
+  const double center = 0.5 * (gridSize - 1);
+  const double radius = 0.35 * gridSize;
+  const auto cellId = [gridSize](int x, int y, int z) { return (z * gridSize + y) * gridSize + x; };
+
+  for(int z = 0; z < gridSize; ++z)
+  {
+    for(int y = 0; y < gridSize; ++y)
+    {
+      for(int x = 0; x < gridSize; ++x)
+      {
+        const double distance = std::sqrt((x - center) * (x - center) + (y - center) * (y - center) + (z - center) * (z - center));
+        const bool inside = distance < radius;
+        const float vote = std::max(0.0f, 1.0f + voteNoise(generator));
+        const int id = cellId(x, y, z);
+
+        graph->addNode(id, inside ? 0.0f : vote, inside ? vote : 0.0f);
+
+        // smoothness between neighboring cells
+        if(x + 1 < gridSize)
+          graph->addEdge(id, cellId(x + 1, y, z), 0.5f, 0.5f);
+        if(y + 1 < gridSize)
+          graph->addEdge(id, cellId(x, y + 1, z), 0.5f, 0.5f);
+        if(z + 1 < gridSize)
+          graph->addEdge(id, cellId(x, y, z + 1), 0.5f, 0.5f);
+      }
+    }
+  }
+  return graph;
+}
+
+/**
+ * @brief Create a UV sphere of radius 1 centered at the origin
+ */
+void createSphere(mesh::Mesh& mesh, int nbRings, int nbSegments)
+{
+  mesh.pts.reserve((nbRings + 1) * nbSegments);
+  mesh.tris.reserve(2 * nbRings * nbSegments);
+
+  for(int r = 0; r <= nbRings; ++r)
+  {
+    const double theta = M_PI * r / nbRings;
+    for(int s = 0; s < nbSegments; ++s)
+    {
+      const double phi = 2.0 * M_PI * s / nbSegments;
+      mesh.pts.push_back(Point3d(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+    }
+  }
+  for(int r = 0; r < nbRings; ++r)
+  {
+    for(int s = 0; s < nbSegments; ++s)
+    {
+      const int a = r * nbSegments + s;
+      const int b = r * nbSegments + (s + 1) % nbSegments;
+      mesh.tris.push_back(mesh::Mesh::triangle(a, a + nbSegments, b));
+      mesh.tris.push_back(mesh::Mesh::triangle(b, a + nbSegments, b + nbSegments));
+    }
+  }
+}
+
+/**
+ * @brief Create the pose of a camera looking at the origin
+ */
+geometry::Pose3 createLookAtPose(const Vec3& C)
+{
+  const Vec3 z = -C.normalized();
+  const Vec3 x = Vec3(0.0, 1.0, 0.0).cross(z).normalized();
+  const Vec3 y = z.cross(x);
+
+  Mat3 R;
+  R.row(0) = x;
+  R.row(1) = y;
+  R.row(2) = z;
+  return geometry::Pose3(R, C);
+}
+
+/**
+ * @brief Create a synthetic scene of cameras around the origin, with their images written in a folder
+ * @param[in] folder The output folder of the images
+ * @param[in] nbCameras The number of cameras
+ * @param[in] width The images width
+ * @param[in] height The images height
+ * @param[in] seed The random seed of the images content
+ * @return the scene
+ */
+sfmData::SfMData createCamerasScene(const fs::path& folder, int nbCameras, int width, int height, int seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> colorDistribution(0.0f, 1.0f);
+
+  sfmData::SfMData sfmData;
+  sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>(width, height, 1.2 * width, width / 2.0, height / 2.0);
+
+  std::vector<Color> image(std::size_t(width) * height);
+
+  for(int i = 0; i < nbCameras; ++i)
+  {
+    // checkerboard of random colors
+    const int cellSize = 32;
+    const int nbCellsX = (width + cellSize - 1) / cellSize;
+    const int nbCellsY = (height + cellSize - 1) / cellSize;
+    std::vector<Color> cells(nbCellsX * nbCellsY);
+    for(Color& cell : cells)
+      cell = Color(colorDistribution(generator), colorDistribution(generator), colorDistribution(generator));
+
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < width; ++x)
+        image[y * width + x] = cells[(y / cellSize) * nbCellsX + x / cellSize];
+
+    const std::string imagePath = (folder / (std::to_string(i) + ".png")).string();
+    imageIO::OutputFileColorSpace colorspace(imageIO::EImageColorSpace::SRGB, imageIO::EImageColorSpace::AUTO);
+    imageIO::writeImage(imagePath, width, height, image, imageIO::EImageQuality::LOSSLESS, colorspace);
+
+    const double angle = 2.0 * M_PI * i / nbCameras;
+    const Vec3 C(2.5 * std::cos(angle), 0.5 * std::sin(3.0 * angle), 2.5 * std::sin(angle));
+
+    const auto view = std::make_shared<sfmData::View>(imagePath, i, 0, i, width, height);
+    sfmData.views[i] = view;
+    sfmData.setPose(*view, sfmData::CameraPose(createLookAtPose(C)));
+  }
+  return sfmData;
+}
+
+/**
+ * @brief Set the mesh vertices visibilities: the cameras in front of the vertex normal
+ *        where the vertex projects inside the image (the mesh is a sphere centered at the origin)
+ */
+void setSphereVisibilities(mesh::Mesh& mesh, const mvsUtils::MultiViewParams& mp)
+{
+  mesh.pointsVisibilities.resize(mesh.pts.size());
+
+  #pragma omp parallel for
+  for(int i = 0; i < mesh.pts.size(); ++i)
+  {
+    const Point3d& p = mesh.pts[i];
+    mesh::PointVisibility& visibility = mesh.pointsVisibilities[i];
+    visibility.clear();
+
+    for(int camId = 0; camId < mp.ncams; ++camId)
+    {
+      if(dot(p, mp.CArr[camId] - p) <= 0.0)
+        continue;
+
+      Point2d pix;
+      mp.getPixelFor3DPoint(&pix, p, camId);
+      if(mp.isPixelInImage(pix, camId))
+        visibility.push_back(camId);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string outputFilename;
+  int gridSize = 96;
+  double noise = 0.5;
+  int nbTriangles = 500000;
+  int nbCameras = 24;
+  int imageWidth = 1920;
+  int imageHeight = 1080;
+  int textureSide = 2048;
+  int seed = 42;
+  int nbRepetitions = 3;
+
+  po::options_description allParams(
+    "Benchmark of the Multi-View Stereo kernels on a synthetic scene:\n"
+    "meshing max-flow, mesh rasterization, triangles visibility and texturing.\n"
+    "AliceVision mvsBenchmark");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("output,o", po::value<std::string>(&outputFilename)->default_value(outputFilename),
+      "Output JSON file of the benchmark results.")
+    ("gridSize", po::value<int>(&gridSize)->default_value(gridSize),
+      "Number of cells along each axis of the meshing volume.")
+    ("noise", po::value<double>(&noise)->default_value(noise),
+      "Standard deviation of the meshing votes, relative to the votes.")
+    ("nbTriangles", po::value<int>(&nbTriangles)->default_value(nbTriangles),
+      "Approximate number of triangles of the textured mesh.")
+    ("nbCameras", po::value<int>(&nbCameras)->default_value(nbCameras),
+      "Number of cameras around the textured mesh.")
+    ("imageWidth", po::value<int>(&imageWidth)->default_value(imageWidth),
+      "Width of the images.")
+    ("imageHeight", po::value<int>(&imageHeight)->default_value(imageHeight),
+      "Height of the images.")
+    ("textureSide", po::value<int>(&textureSide)->default_value(textureSide),
+      "Output texture size.")
+    ("seed", po::value<int>(&seed)->default_value(seed),
+      "Random seed of the synthetic scene.")
+    ("repetitions", po::value<int>(&nbRepetitions)->default_value(nbRepetitions),
+      "Number of runs of each kernel (the median time is reported).");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  benchmark::BenchmarkReport report("mvs", nbRepetitions);
+  report.addParameter("gridSize", gridSize);
+  report.addParameter("noise", noise);
+  report.addParameter("nbTriangles", nbTriangles);
+  report.addParameter("nbCameras", nbCameras);
+  report.addParameter("imageWidth", imageWidth);
+  report.addParameter("imageHeight", imageHeight);
+  report.addParameter("textureSide", textureSide);
+  report.addParameter("seed", seed);
+
+  // meshing max-flow
+  std::unique_ptr<fuseCut::MaxFlow_AdjList> graph;
+  float flow = 0.f;
+  report.run("maxflow",
+    [&]() { graph = createVolumeGraph(gridSize, noise, seed); },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      flow = graph->compute();
+
+      result.nbItems = gridSize * gridSize * gridSize;
+      result.itemsName = "cells";
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      int nbEmptyCells = 0;
+      for(int i = 0; i < static_cast<int>(result.nbItems); ++i)
+        nbEmptyCells += graph->isSource(i) ? 1 : 0;
+
+      result.metrics["flow"] = flow;
+      result.metrics["nbEmptyCells"] = nbEmptyCells;
+    });
+  graph.reset();
+
+  // synthetic cameras around a sphere, the images are written in a temporary folder
+  // as the texturing reads them from disk through the images cache
+  const fs::path tmpFolder = fs::temp_directory_path() / fs::unique_path("aliceVision_mvsBenchmark_%%%%-%%%%-%%%%");
+  const fs::path imagesFolder = tmpFolder / "images";
+  const fs::path texturesFolder = tmpFolder / "textures";
+  fs::create_directories(imagesFolder);
+  fs::create_directories(texturesFolder);
+
+  const sfmData::SfMData sfmData = createCamerasScene(imagesFolder, nbCameras, imageWidth, imageHeight, seed);
+  mvsUtils::MultiViewParams mp(sfmData);
+
+  mesh::Texturing texturing;
+  texturing.mesh = new mesh::Mesh();
+  mesh::Mesh& sphere = *texturing.mesh;
+
+  const int nbSegments = std::max(3, static_cast<int>(std::sqrt(nbTriangles)));
+  const int nbRings = std::max(2, nbTriangles / (2 * nbSegments));
+  createSphere(sphere, nbRings, nbSegments);
+  setSphereVisibilities(sphere, mp);
+
+  // mesh rasterization (depth maps of the mesh)
+  report.run("rasterization",
+    []() {},
+    [&](benchmark::BenchmarkResult& result)
+    {
+      const mesh::MeshRasterizer rasterizer(sphere);
+      std::vector<int> nbVisibleTriangles(mp.ncams, 0);
+
+      rasterizer.rasterizeCameras(mp.camArr, imageWidth, imageHeight, [&](int camId, const mesh::ZBuffer& zbuffer)
+      {
+        StaticVector<int> visibleTriangles;
+        sphere.getVisibleTrianglesIndexes(visibleTriangles, zbuffer);
+        nbVisibleTriangles[camId] = visibleTriangles.size();
+      });
+
+      result.nbItems = mp.ncams;
+      result.itemsName = "cameras";
+      result.metrics["nbTriangles"] = sphere.tris.size();
+      result.metrics["nbVisibleTriangles"] = std::accumulate(nbVisibleTriangles.begin(), nbVisibleTriangles.end(), 0);
+    });
+
+  // mesh rasterization one camera at a time, with parallel tiles
+  mesh::ZBuffer zbuffer;
+  report.run("rasterizationTiled",
+    []() {},
+    [&](benchmark::BenchmarkResult& result)
+    {
+      const mesh::MeshRasterizer rasterizer(sphere);
+
+      for(int rc = 0; rc < mp.ncams; ++rc)
+        rasterizer.rasterize(mp.camArr[rc], imageWidth, imageHeight, zbuffer);
+
+      result.nbItems = mp.ncams;
+      result.itemsName = "cameras";
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      // z-buffer of the last camera
+      result.metrics["nbCoveredPixels"] = std::count_if(zbuffer.trisIds.begin(), zbuffer.trisIds.end(), [](int id) { return id >= 0; });
+    });
+
+  // triangles visibility from the vertices visibilities (texturing UV atlas)
+  StaticVector<StaticVector<int>> trisCams;
+  report.run("trianglesVisibility",
+    [&]() { trisCams.clear(); },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      sphere.computeTrisCamsFromPtsCams(trisCams);
+
+      result.nbItems = sphere.tris.size();
+      result.itemsName = "triangles";
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      std::size_t nbTrianglesCameras = 0;
+      for(int i = 0; i < trisCams.size(); ++i)
+        nbTrianglesCameras += trisCams[i].size();
+
+      result.metrics["nbTrianglesCameras"] = nbTrianglesCameras;
+    });
+
+  // texturing
+  mesh::TexturingParams texParams;
+  texParams.textureSide = textureSide;
+  texturing.texParams = texParams;
+  texturing.generateUVsBasicMethod(mp);
+
+  report.run("texturing",
+    // the texturing parameters are updated by each run
+    [&]() { texturing.texParams = texParams; },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      texturing.generateTextures(mp, texturesFolder);
+
+      result.nbItems = texturing._atlases.size();
+      result.itemsName = "atlases";
+      result.metrics["nbTriangles"] = sphere.tris.size();
+    });
+
+  fs::remove_all(tmpFolder);
+
+  report.write(std::cout);
+
+  if(!outputFilename.empty() && !report.writeJSON(outputFilename))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
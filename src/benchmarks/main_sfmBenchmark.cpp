@@ -0,0 +1,478 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "BenchmarkReport.hpp"
+
+#include <aliceVision/feature/akaze/ImageDescriber_AKAZE.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/syntheticImage.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/matcherType.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilter.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_F_AC.hpp>
+#include <aliceVision/matchingImageCollection/matchingCommon.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
+#include <aliceVision/sfm/sfmTriangulation.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/track/Track.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Parameters of a synthetic scene
+ */
+struct SyntheticSceneParams
+{
+  /// number of views on a ring around the points
+  std::size_t nbViews = 12;
+  /// number of 3D points, seen by all the views
+  std::size_t nbPoints = 2000;
+  /// standard deviation of the features position (pixels)
+  double noise = 0.5;
+  /// number of outlier features per view, relative to the number of points
+  double outliersRatio = 0.3;
+  /// random seed
+  int seed = 42;
+};
+
+/**
+ * @brief Create the ground truth scene and the regions of its views.
+ * @details Each 3D point has a random SIFT-like descriptor, seen with noise in each view.
+ *          The outlier features have random positions and descriptors.
+ *          The features of a view are stored in a random order.
+ * @param[in] params The scene parameters
+ * @param[out] sfmData The ground truth scene (views, intrinsics, poses and landmarks)
+ * @param[out] regionsPerView The regions of the views
+ */
+void createSyntheticScene(const SyntheticSceneParams& params, sfmData::SfMData& sfmData, feature::RegionsPerView& regionsPerView)
+{
+  // the dataset uses the Eigen random generator
+  std::srand(params.seed);
+
+  const NViewDatasetConfigurator config;
+  const NViewDataSet dataset = NRealisticCamerasRing(params.nbViews, params.nbPoints, config);
+  sfmData = sfm::getInputScene(dataset, config, camera::PINHOLE_CAMERA);
+
+  std::mt19937 generator(params.seed);
+  std::normal_distribution<double> positionNoise(0.0, params.noise);
+  std::normal_distribution<double> descriptorNoise(0.0, 6.0);
+  std::uniform_int_distribution<int> descriptorValue(0, 64);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  using Descriptor = feature::SIFT_Regions::DescriptorT;
+
+  const auto randomDescriptor = [&]()
+  {
+    Descriptor descriptor;
+    for(std::size_t k = 0; k < descriptor.size(); ++k)
+      descriptor[k] = static_cast<unsigned char>(descriptorValue(generator));
+    return descriptor;
+  };
+
+  std::vector<Descriptor> landmarkDescriptors(params.nbPoints);
+  std::generate(landmarkDescriptors.begin(), landmarkDescriptors.end(), randomDescriptor);
+
+  const std::size_t nbOutliers = static_cast<std::size_t>(params.nbPoints * params.outliersRatio);
+  const std::size_t nbFeatures = params.nbPoints + nbOutliers;
+
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const IndexT viewId = viewPair.first;
+    const sfmData::View& view = *viewPair.second;
+
+    std::vector<std::size_t> featIds(nbFeatures);
+    std::iota(featIds.begin(), featIds.end(), 0);
+    std::shuffle(featIds.begin(), featIds.end(), generator);
+
+    feature::SIFT_Regions* regions = new feature::SIFT_Regions();
+    regions->Features().resize(nbFeatures);
+    regions->Descriptors().resize(nbFeatures);
+
+    for(std::size_t i = 0; i < nbFeatures; ++i)
+    {
+      Vec2 x;
+      Descriptor descriptor;
+
+      if(i < params.nbPoints)
+      {
+        x = sfmData.getLandmarks().at(i).observations.at(viewId).x + Vec2(positionNoise(generator), positionNoise(generator));
+        descriptor = landmarkDescriptors.at(i);
+        for(std::size_t k = 0; k < descriptor.size(); ++k)
+          descriptor[k] = static_cast<unsigned char>(std::min(255.0, std::max(0.0, descriptor[k] + descriptorNoise(generator))));
+      }
+      else
+      {
+        x = Vec2(uniform(generator) * view.getWidth(), uniform(generator) * view.getHeight());
+        descriptor = randomDescriptor();
+      }
+
+      regions->Features().at(featIds[i]) = feature::SIOPointFeature(x(0), x(1), 2.f, 0.f);
+      regions->Descriptors().at(featIds[i]) = descriptor;
+    }
+    regionsPerView.addRegions(viewId, feature::EImageDescriberType::SIFT, regions);
+  }
+}
+
+/**
+ * @brief Count the matches of all the image pairs
+ */
+std::size_t countMatches(const matching::PairwiseMatches& pairwiseMatches)
+{
+  std::size_t nbMatches = 0;
+  for(const auto& matchesPair : pairwiseMatches)
+    nbMatches += matchesPair.second.getNbAllMatches();
+  return nbMatches;
+}
+
+/**
+ * @brief Create the landmarks of the tracks (without 3D position)
+ */
+void createLandmarksFromTracks(const track::TracksMap& tracks, const feature::RegionsPerView& regionsPerView, sfmData::SfMData& sfmData)
+{
+  sfmData.getLandmarks().clear();
+  for(const auto& trackPair : tracks)
+  {
+    const track::Track& track = trackPair.second;
+    sfmData::Landmark landmark(track.descType);
+    for(const auto& featPair : track.featPerView)
+    {
+      const feature::Regions& regions = regionsPerView.getRegions(featPair.first, track.descType);
+      landmark.observations[featPair.first] = sfmData::Observation(regions.GetRegionPosition(featPair.second), featPair.second);
+    }
+    sfmData.getLandmarks()[trackPair.first] = landmark;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string outputFilename;
+  SyntheticSceneParams sceneParams;
+  std::string matcherTypeName = matching::EMatcherType_enumToString(matching::EMatcherType::ANN_L2);
+  int imageWidth = 1600;
+  int imageHeight = 1200;
+  int nbRepetitions = 3;
+
+  po::options_description allParams(
+    "Benchmark of the Structure-from-Motion kernels on a synthetic scene:\n"
+    "feature extraction, matching, geometric filtering, tracks, triangulation, resection and bundle adjustment.\n"
+    "AliceVision sfmBenchmark");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("output,o", po::value<std::string>(&outputFilename)->default_value(outputFilename),
+      "Output JSON file of the benchmark results.")
+    ("nbViews", po::value<std::size_t>(&sceneParams.nbViews)->default_value(sceneParams.nbViews),
+      "Number of views.")
+    ("nbPoints", po::value<std::size_t>(&sceneParams.nbPoints)->default_value(sceneParams.nbPoints),
+      "Number of 3D points.")
+    ("noise", po::value<double>(&sceneParams.noise)->default_value(sceneParams.noise),
+      "Standard deviation of the features position (pixels).")
+    ("outliersRatio", po::value<double>(&sceneParams.outliersRatio)->default_value(sceneParams.outliersRatio),
+      "Number of outlier features per view, relative to the number of points.")
+    ("seed", po::value<int>(&sceneParams.seed)->default_value(sceneParams.seed),
+      "Random seed of the synthetic scene.")
+    ("matcherType", po::value<std::string>(&matcherTypeName)->default_value(matcherTypeName),
+      "Nearest neighbor matching method (BRUTE_FORCE_L2, ANN_L2, CASCADE_HASHING_L2, FAST_CASCADE_HASHING_L2).")
+    ("imageWidth", po::value<int>(&imageWidth)->default_value(imageWidth),
+      "Width of the synthetic image of the feature extraction.")
+    ("imageHeight", po::value<int>(&imageHeight)->default_value(imageHeight),
+      "Height of the synthetic image of the feature extraction.")
+    ("repetitions", po::value<int>(&nbRepetitions)->default_value(nbRepetitions),
+      "Number of runs of each kernel (the median time is reported).");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  const feature::EImageDescriberType descType = feature::EImageDescriberType::SIFT;
+  const matching::EMatcherType matcherType = matching::EMatcherType_stringToEnum(matcherTypeName);
+
+  // synthetic scene
+  sfmData::SfMData groundTruth;
+  feature::RegionsPerView regionsPerView;
+  createSyntheticScene(sceneParams, groundTruth, regionsPerView);
+
+  ALICEVISION_LOG_INFO("Synthetic scene: " << groundTruth.getViews().size() << " views, " << groundTruth.getLandmarks().size() << " points.");
+
+  PairSet pairs;
+  for(const auto& viewI : groundTruth.getViews())
+    for(const auto& viewJ : groundTruth.getViews())
+      if(viewI.first < viewJ.first)
+        pairs.insert(Pair(viewI.first, viewJ.first));
+
+  benchmark::BenchmarkReport report("sfm", nbRepetitions);
+  report.addParameter("nbViews", sceneParams.nbViews);
+  report.addParameter("nbPoints", sceneParams.nbPoints);
+  report.addParameter("noise", sceneParams.noise);
+  report.addParameter("outliersRatio", sceneParams.outliersRatio);
+  report.addParameter("seed", sceneParams.seed);
+  report.addParameter("matcherType", matcherTypeName);
+  report.addParameter("imageWidth", imageWidth);
+  report.addParameter("imageHeight", imageHeight);
+
+  // AKAZE feature extraction on a synthetic image
+  const image::Image<float> image = feature::createSyntheticImage(imageWidth, imageHeight, sceneParams.seed);
+  const std::vector<std::pair<std::string, feature::EAKAZE_DESCRIPTOR>> akazeDescriptors = {
+    {"AKAZE", feature::AKAZE_MSURF}, {"AKAZE_LIOP", feature::AKAZE_LIOP}, {"AKAZE_MLDB", feature::AKAZE_MLDB}};
+
+  for(const auto& akazeDescriptor : akazeDescriptors)
+  {
+    feature::ImageDescriber_AKAZE imageDescriber(feature::AKAZEParams(feature::AKAZEOptions(), akazeDescriptor.second));
+    std::unique_ptr<feature::Regions> regions;
+
+    report.run("featureExtraction_" + akazeDescriptor.first,
+      [&]() { regions.reset(); },
+      [&](benchmark::BenchmarkResult& result)
+      {
+        imageDescriber.describe(image, regions);
+
+        result.nbItems = std::size_t(image.Width()) * image.Height();
+        result.itemsName = "pixels";
+      },
+      [&](benchmark::BenchmarkResult& result)
+      {
+        result.metrics["nbRegions"] = regions ? regions->RegionCount() : 0;
+      });
+  }
+
+  // putative matching
+  matching::PairwiseMatches putativeMatches;
+  report.run("matching",
+    [&]() { putativeMatches.clear(); },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      std::unique_ptr<matchingImageCollection::IImageCollectionMatcher> matcher = matchingImageCollection::createImageCollectionMatcher(matcherType, 0.8f);
+      matcher->setDisplayProgress(false);
+      matcher->Match(regionsPerView, pairs, descType, putativeMatches);
+
+      result.nbItems = pairs.size();
+      result.itemsName = "pairs";
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      result.metrics["nbMatches"] = countMatches(putativeMatches);
+    });
+
+  // geometric filtering
+  matching::PairwiseMatches geometricMatches;
+  report.run("geometricFiltering",
+    [&]() { geometricMatches.clear(); },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      matchingImageCollection::robustModelEstimation(geometricMatches, &groundTruth, regionsPerView,
+                                                     matchingImageCollection::GeometricFilterMatrix_F_AC(std::numeric_limits<double>::infinity(), 2048),
+                                                     putativeMatches);
+      result.nbItems = putativeMatches.size();
+      result.itemsName = "pairs";
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      result.metrics["nbValidPairs"] = geometricMatches.size();
+      result.metrics["nbMatches"] = countMatches(geometricMatches);
+    });
+
+  // track building
+  const std::size_t nbGeometricMatches = countMatches(geometricMatches);
+  track::TracksMap tracks;
+  report.run("tracks",
+    [&]() { tracks.clear(); },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      track::TracksBuilder tracksBuilder;
+      tracksBuilder.build(geometricMatches);
+      tracksBuilder.filter(2);
+      tracksBuilder.exportToSTL(tracks);
+
+      result.nbItems = nbGeometricMatches;
+      result.itemsName = "matches";
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      result.metrics["nbTracks"] = tracks.size();
+    });
+
+  // triangulation with the ground truth poses
+  sfmData::SfMData scene;
+  report.run("triangulation",
+    [&]()
+    {
+      scene = groundTruth;
+      createLandmarksFromTracks(tracks, regionsPerView, scene);
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      result.nbItems = scene.getLandmarks().size();
+      result.itemsName = "tracks";
+
+      sfm::StructureComputation_robust structureEstimator;
+      structureEstimator.triangulate(scene);
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      result.metrics["nbLandmarks"] = scene.getLandmarks().size();
+      result.metrics["rmse"] = sfm::RMSE(scene);
+    });
+
+  // resection of each view from the triangulated landmarks
+  report.run("resection",
+    []() {},
+    [&](benchmark::BenchmarkResult& result)
+    {
+      std::vector<IndexT> viewIds;
+      for(const auto& viewPair : scene.getViews())
+        viewIds.push_back(viewPair.first);
+
+      int nbResectedViews = 0;
+      double nbInliers = 0.0;
+
+      #pragma omp parallel for schedule(dynamic) reduction(+:nbResectedViews, nbInliers)
+      for(int i = 0; i < static_cast<int>(viewIds.size()); ++i)
+      {
+        const sfmData::View& view = scene.getView(viewIds[i]);
+
+        std::vector<const sfmData::Landmark*> landmarks;
+        for(const auto& landmarkPair : scene.getLandmarks())
+          if(landmarkPair.second.observations.count(view.getViewId()))
+            landmarks.push_back(&landmarkPair.second);
+
+        sfm::ImageLocalizerMatchData matchData;
+        matchData.pt3D.resize(3, landmarks.size());
+        matchData.pt2D.resize(2, landmarks.size());
+        for(std::size_t j = 0; j < landmarks.size(); ++j)
+        {
+          matchData.pt3D.col(j) = landmarks[j]->X;
+          matchData.pt2D.col(j) = landmarks[j]->observations.at(view.getViewId()).x;
+          matchData.vec_descType.push_back(descType);
+        }
+        matchData.max_iteration = 1024;
+
+        geometry::Pose3 pose;
+        const bool resected = sfm::SfMLocalizer::Localize(Pair(view.getWidth(), view.getHeight()),
+                                                          scene.getIntrinsicPtr(view.getIntrinsicId()),
+                                                          matchData, pose);
+        if(resected)
+        {
+          ++nbResectedViews;
+          nbInliers += matchData.vec_inliers.size();
+        }
+      }
+
+      result.nbItems = viewIds.size();
+      result.itemsName = "views";
+      result.metrics["nbResectedViews"] = nbResectedViews;
+      result.metrics["nbInliers"] = nbInliers;
+    });
+
+  // bundle adjustment of perturbed poses and landmarks
+  sfmData::SfMData sceneBA;
+  double initialRmse = 0.0;
+  report.run("bundleAdjustment",
+    [&]()
+    {
+      sceneBA = scene;
+      std::mt19937 generator(sceneParams.seed);
+      std::normal_distribution<double> rotationNoise(0.0, 0.002);
+      std::normal_distribution<double> positionNoise(0.0, 0.005);
+
+      // keep the first pose to fix the gauge
+      for(auto& posePair : sceneBA.getPoses())
+      {
+        if(posePair.first == sceneBA.getPoses().begin()->first)
+          continue;
+        const geometry::Pose3& pose = posePair.second.getTransform();
+        const Mat3 R = RotationAroundX(rotationNoise(generator)) * RotationAroundY(rotationNoise(generator)) * RotationAroundZ(rotationNoise(generator));
+        posePair.second.setTransform(geometry::Pose3(R * pose.rotation(), pose.center() + Vec3(positionNoise(generator), positionNoise(generator), positionNoise(generator))));
+      }
+      for(auto& landmarkPair : sceneBA.getLandmarks())
+        landmarkPair.second.X += Vec3(positionNoise(generator), positionNoise(generator), positionNoise(generator));
+
+      initialRmse = sfm::RMSE(sceneBA);
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      sfm::BundleAdjustmentCeres::CeresOptions options(false);
+      options.setSparseBA();
+      sfm::BundleAdjustmentCeres bundleAdjustment(options);
+      const bool success = bundleAdjustment.adjust(sceneBA, sfm::BundleAdjustment::REFINE_ROTATION |
+                                                            sfm::BundleAdjustment::REFINE_TRANSLATION |
+                                                            sfm::BundleAdjustment::REFINE_STRUCTURE);
+
+      result.nbItems = sceneBA.getLandmarks().size();
+      result.itemsName = "landmarks";
+      result.metrics["success"] = success;
+    },
+    [&](benchmark::BenchmarkResult& result)
+    {
+      result.metrics["initialRmse"] = initialRmse;
+      result.metrics["finalRmse"] = sfm::RMSE(sceneBA);
+    });
+
+  report.write(std::cout);
+
+  if(!outputFilename.empty() && !report.writeJSON(outputFilename))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
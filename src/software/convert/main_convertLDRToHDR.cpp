@@ -8,6 +8,8 @@
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 /*SFMData*/
 #include <aliceVision/sfmData/SfMData.hpp>
@@ -21,6 +23,7 @@
 #include <aliceVision/hdr/GrossbergCalibrate.hpp>
 #include <aliceVision/hdr/emorCurve.hpp>
 #include <aliceVision/hdr/LaguerreBACalibration.hpp>
+#include <aliceVision/hdr/sampling.hpp>
 
 /*Command line parameters*/
 #include <boost/program_options.hpp>
@@ -30,7 +33,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 0
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -115,6 +118,9 @@ int main(int argc, char * argv[])
   int calibrationDownscale = 4;
   bool refineExposures = false;
   bool byPass = false;
+  int streamingBandHeight = 256;
+  int maxThreads = 0;
+  std::string calibrationSamplesFolder;
 
   std::string calibrationWeightFunction = "default";
   hdr::EFunctionType fusionWeightFunction = hdr::EFunctionType::GAUSSIAN;
@@ -155,6 +161,12 @@ int main(int argc, char * argv[])
         "Image downscale used to calibration the response function.")
     ("calibrationRefineExposures", po::value<bool>(&refineExposures)->default_value(refineExposures),
         "Refine exposures provided by metadata (shutter speed, f-number, iso). Only available for 'laguerre' calibration method. Default value is set to 0.")
+    ("calibrationSamplesFolder", po::value<std::string>(&calibrationSamplesFolder)->default_value(calibrationSamplesFolder),
+        "Folder of the calibration samples files, reused if they have been extracted from the same images with the same parameters (the output folder if empty).")
+    ("streamingBandHeight", po::value<int>(&streamingBandHeight)->default_value(streamingBandHeight),
+        "Number of rows merged at once, rounded to the output tile size. The memory used per HDR image is proportional to this value.")
+    ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+        "Maximum number of HDR images merged in parallel (0 means automatic, depending on the available memory).")
     ;
 
   po::options_description logParams("Log parameters");
@@ -514,6 +526,34 @@ int main(int argc, char * argv[])
 
   const float lambda = channelQuantization * 1.f;
 
+  // the calibration samples are saved, so that the calibration can be run again (with another method or weight)
+  // without decoding the images
+  if(calibrationSamplesFolder.empty())
+    calibrationSamplesFolder = outputPath;
+
+  const auto getCalibrationSamples = [&](int nbPoints, int downscale, image::EImageColorSpace colorSpace) -> std::vector<std::vector<hdr::ImageSamples>>
+  {
+      std::vector<std::vector<hdr::ImageSamples>> samples;
+      const std::string colorSpaceName = (colorSpace == image::EImageColorSpace::SRGB) ? "srgb" : "linear";
+      const std::string samplesPath = (fs::path(calibrationSamplesFolder) / ("calibrationSamples_" + colorSpaceName + ".bin")).string();
+
+      if(hdr::readSamples(samplesPath, samples, groupedFilenames, nbPoints, downscale, fisheye, colorSpace))
+      {
+          ALICEVISION_LOG_INFO("Calibration samples loaded from " << samplesPath);
+          return samples;
+      }
+
+      ALICEVISION_LOG_INFO("Extract calibration samples");
+      hdr::extractSamples(samples, groupedFilenames, groupedExposures, nbPoints, downscale, fisheye, colorSpace);
+
+      if(hdr::writeSamples(samplesPath, samples, groupedFilenames, nbPoints, downscale, fisheye, colorSpace))
+          ALICEVISION_LOG_INFO("Calibration samples written as " << samplesPath);
+      else
+          ALICEVISION_LOG_WARNING("Cannot write the calibration samples file " << samplesPath);
+
+      return samples;
+  };
+
   // calculate the response function according to the method given in argument or take the response provided by the user
   {
       switch (calibrationMethod)
@@ -543,7 +583,7 @@ int main(int argc, char * argv[])
           if(calibrationNbPoints <= 0)
               calibrationNbPoints = 10000;
           hdr::DebevecCalibrate calibration;
-          calibration.process(groupedFilenames, channelQuantization, groupedExposures, calibrationNbPoints, calibrationDownscale, fisheye, calibrationWeight, lambda, response);
+          calibration.process(getCalibrationSamples(calibrationNbPoints, calibrationDownscale, image::EImageColorSpace::SRGB), channelQuantization, groupedExposures, calibrationWeight, lambda, response);
 
           {
               std::string methodName = ECalibrationMethod_enumToString(calibrationMethod);
@@ -589,7 +629,7 @@ int main(int argc, char * argv[])
           if (calibrationNbPoints <= 0)
               calibrationNbPoints = 1000000;
           hdr::GrossbergCalibrate calibration(3);
-          calibration.process(groupedFilenames, channelQuantization, groupedExposures, calibrationNbPoints, fisheye, response);
+          calibration.process(getCalibrationSamples(calibrationNbPoints, 1, image::EImageColorSpace::SRGB), channelQuantization, groupedExposures, response);
       }
       break;
       case ECalibrationMethod::LAGUERRE:
@@ -598,7 +638,7 @@ int main(int argc, char * argv[])
           if (calibrationNbPoints <= 0)
               calibrationNbPoints = 1000000;
           hdr::LaguerreBACalibration calibration;
-          calibration.process(groupedFilenames, channelQuantization, groupedExposures, calibrationNbPoints, calibrationDownscale, fisheye, refineExposures, response);
+          calibration.process(getCalibrationSamples(calibrationNbPoints, calibrationDownscale, image::EImageColorSpace::LINEAR), channelQuantization, groupedExposures, refineExposures, response);
       }
       break;
       }
@@ -642,40 +682,81 @@ int main(int argc, char * argv[])
       mergeColorspace = image::EImageColorSpace::SRGB;
       break;
   }
-  for(int g = 0; g < groupedFilenames.size(); ++g)
-  {
-    std::vector<image::Image<image::RGBfColor>> images(groupedViews[g].size());
-    std::shared_ptr<sfmData::View> targetView = targetViews[g];
 
-    // Load all images of the group
-    for (int i = 0; i < images.size(); i++)
-    {
-      ALICEVISION_LOG_INFO("Load " << groupedFilenames[g][i]);
-      image::readImage(groupedFilenames[g][i], images[i], mergeColorspace);
-    }
+  // each group is merged by bands of rows: the memory used only depends on the image width (or height for rotated images)
+  std::size_t maxImageWidth = 0;
+  for(const std::shared_ptr<sfmData::View>& targetView : targetViews)
+    maxImageWidth = std::max<std::size_t>(maxImageWidth, std::max(targetView->getWidth(), targetView->getHeight()));
+  const std::size_t jobMaxMemoryConsumption = hdr::hdrMerge::streamingMemorySize(maxImageWidth, groupedFilenames.front().size(), streamingBandHeight);
+  const system::MemoryInfo memoryInformation = system::getMemoryInfo();
 
-    // Merge HDR images
-    hdr::hdrMerge merge;
-    float targetCameraExposure = targetView->getCameraExposureSetting();
-    image::Image<image::RGBfColor> HDRimage;
-    merge.process(images, groupedExposures[g], fusionWeight, response, HDRimage, targetCameraExposure);
+  ALICEVISION_LOG_DEBUG("Job max memory consumption: " << jobMaxMemoryConsumption << " B");
+  ALICEVISION_LOG_DEBUG("Memory information: " << std::endl << memoryInformation);
 
-    if(highlightCorrectionFactor > 0.0)
-    {
-      merge.postProcessHighlight(images, groupedExposures[g], fusionWeight, response, HDRimage, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
-    }
+  std::size_t nbThreads = std::max<std::size_t>(1, (0.9 * memoryInformation.freeRam) / std::max<std::size_t>(1, jobMaxMemoryConsumption));
+
+  // nbThreads should not be higher than user maxThreads param
+  if(maxThreads > 0)
+    nbThreads = std::min(static_cast<std::size_t>(maxThreads), nbThreads);
+
+  // nbThreads should not be higher than the core number
+  nbThreads = std::min(static_cast<std::size_t>(omp_get_num_procs()), nbThreads);
+
+  // nbThreads should not be higher than the group number
+  nbThreads = std::max<std::size_t>(1, std::min(groupedFilenames.size(), nbThreads));
+
+  ALICEVISION_LOG_INFO("Merge " << groupedFilenames.size() << " HDR images with " << nbThreads << " thread(s).");
+
+  // remaining cores are used by the parallel loops of each merge
+  const int nbInnerThreads = std::max(1, omp_get_num_procs() / static_cast<int>(nbThreads));
+  omp_set_nested(1);
+
+  std::string errorMessage;
+
+#pragma omp parallel for num_threads(nbThreads) schedule(dynamic)
+  for(int g = 0; g < groupedFilenames.size(); ++g)
+  {
+    // number of threads of the nested parallel regions started by this thread
+    omp_set_num_threads(nbInnerThreads);
+
+    std::shared_ptr<sfmData::View> targetView = targetViews[g];
 
     // Output image file path
     std::stringstream  sstream;
     sstream << "hdr_" << std::setfill('0') << std::setw(4) << g << ".exr";
     std::string hdrImagePath = (fs::path(outputPath) / sstream.str()).string();
 
-    // Write an image with parameters from the target view
-    oiio::ParamValueList targetMetadata = image::readImageMetadata(targetView->getImagePath());
-    image::writeImage(hdrImagePath, HDRimage, image::EImageColorSpace::AUTO, targetMetadata);
+    // exceptions can't leave the parallel region
+    try
+    {
+      // Write an image with parameters from the target view
+      oiio::ParamValueList targetMetadata = image::readImageMetadata(targetView->getImagePath());
+
+      // Merge HDR images band by band, the brackets are never fully loaded
+      hdr::hdrMerge merge;
+      float targetCameraExposure = targetView->getCameraExposureSetting();
+      merge.processStreaming(groupedFilenames[g], groupedExposures[g], fusionWeight, response, targetCameraExposure,
+                             highlightCorrectionFactor, highlightTargetLux, mergeColorspace,
+                             hdrImagePath, targetMetadata, streamingBandHeight);
+    }
+    catch(const std::exception& e)
+    {
+#pragma omp critical
+      errorMessage = "Can not merge the HDR image " + hdrImagePath + ": " + e.what();
+      continue;
+    }
 
-    targetViews[g]->setImagePath(hdrImagePath);
-    vs[targetViews[g]->getViewId()] = targetViews[g];
+#pragma omp critical
+    {
+      targetView->setImagePath(hdrImagePath);
+      vs[targetView->getViewId()] = targetView;
+    }
+  }
+
+  if(!errorMessage.empty())
+  {
+    ALICEVISION_LOG_ERROR(errorMessage);
+    return EXIT_FAILURE;
   }
 
   // Export output sfmData
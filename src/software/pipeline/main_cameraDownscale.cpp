@@ -107,14 +107,18 @@ int main(int argc, char * argv[]) {
   
   for (auto & v : sfmData.getViews()) {
     
-    /*Read original image*/
+    /*Read original image, at the MIP level of the integer part of the downscale if the file has one*/
+    /*Without MIP level, the full resolution image is resampled once (no additional resize at the read)*/
+    image::ImageReadOptions readOptions;
+    readOptions.downscale = image::getImageMipDownscale(v.second->getImagePath(), int(std::floor(1.f / rescaleFactor)));
+
     image::Image<image::RGBfColor> originalImage;
-    image::readImage(v.second->getImagePath(), originalImage, image::EImageColorSpace::LINEAR);
+    image::readImage(v.second->getImagePath(), originalImage, image::EImageColorSpace::LINEAR, readOptions);
 
-    unsigned int w = v.second->getWidth();
-    unsigned int h = v.second->getHeight();
-    unsigned int nw = (unsigned int)(floor(float(w) * rescaleFactor));
-    unsigned int nh = (unsigned int)(floor(float(h) * rescaleFactor));
+    unsigned int w = originalImage.Width();
+    unsigned int h = originalImage.Height();
+    unsigned int nw = (unsigned int)(floor(float(v.second->getWidth()) * rescaleFactor));
+    unsigned int nh = (unsigned int)(floor(float(v.second->getHeight()) * rescaleFactor));
 
     /*Create a rotated image*/
     image::Image<image::RGBfColor> rescaled(nw, nh);
@@ -11,6 +11,7 @@
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
 #include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/localization/BoundedBuffer.hpp>
 #include <aliceVision/localization/optimization.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/dataio/FeedProvider.hpp>
@@ -36,7 +37,9 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <exception>
 #include <memory>
+#include <thread>
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
 #include <aliceVision/sfmDataIO/AlembicExporter.hpp>
@@ -53,6 +56,17 @@ namespace bfs = boost::filesystem;
 namespace bacc = boost::accumulators;
 namespace po = boost::program_options;
 
+/// a frame of the media with its extracted query regions
+struct QueryFrame
+{
+  feature::MapRegionsPerDesc regions;
+  std::pair<std::size_t, std::size_t> imageSize;
+  camera::PinholeRadialK3 intrinsics;
+  bool hasIntrinsics = false;
+  std::string imageName;
+  double extractionMs = 0.0;
+};
+
 std::string myToString(std::size_t i, std::size_t zeroPadding)
 {
   std::stringstream ss;
@@ -103,11 +117,17 @@ int main(int argc, char** argv)
   std::string vocTreeFilepath;
   /// the vocabulary tree weights file
   std::string weightsFilepath;
+  /// the landmark descriptor index file
+  std::string landmarkIndexFilepath;
+  /// maximum number of indexed landmarks per describer type
+  std::size_t landmarkIndexMaxLandmarks = 0;
   /// Number of previous frame of the sequence to use for matching
   std::size_t nbFrameBufferMatching = 10;
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
+  /// number of frames whose features are extracted ahead of the localization
+  std::size_t pipelineDepth = 1;
   
   /// the Alembic export file
   std::string exportAlembicFile = "trackedcameras.abc";
@@ -166,7 +186,12 @@ int main(int argc, char** argv)
           "Enable/Disable camera intrinsics refinement for each localized image")
       ("reprojectionError", po::value<double>(&resectionErrorMax)->default_value(resectionErrorMax), 
           "Maximum reprojection error (in pixels) allowed for resectioning. If set "
-          "to 0 it lets the ACRansac select an optimal value.");
+          "to 0 it lets the ACRansac select an optimal value.")
+      ("pipelineDepth", po::value<std::size_t>(&pipelineDepth)->default_value(pipelineDepth),
+          "Number of frames whose features are extracted while the current frame is "
+          "localized (0 = extract and localize each frame sequentially). The extraction "
+          "runs in its own thread and up to pipelineDepth + 1 frames of features are kept "
+          "in memory in addition to the localized one.");
   
 // voctree specific options
   po::options_description voctreeParams("Parameters specific for the vocabulary tree-based localizer");
@@ -184,7 +209,13 @@ int main(int argc, char** argv)
       ("voctreeWeights", po::value<std::string>(&weightsFilepath), 
           "[voctree] Filename for the vocabulary tree weights")
       ("algorithm", po::value<std::string>(&algostring)->default_value(algostring), 
-          "[voctree] Algorithm type: FirstBest, AllResults" )
+          "[voctree] Algorithm type: FirstBest, AllResults, LandmarkIndex" )
+      ("landmarkIndex", po::value<std::string>(&landmarkIndexFilepath),
+          "[voctree] For algorithm LandmarkIndex, filename of the landmark descriptor index. "
+          "It is loaded if it exists, otherwise it is built and saved.")
+      ("landmarkIndexMaxLandmarks", po::value<std::size_t>(&landmarkIndexMaxLandmarks)->default_value(landmarkIndexMaxLandmarks),
+          "[voctree] For algorithm LandmarkIndex, maximum number of indexed landmarks "
+          "per describer type, the most visible ones are kept. If 0 it is ignored.")
       ("matchingError", po::value<double>(&matchingErrorMax)->default_value(matchingErrorMax), 
           "[voctree] Maximum matching error (in pixels) allowed for image matching with "
           "geometric verification. If set to 0 it lets the ACRansac select "
@@ -355,6 +386,13 @@ int main(int argc, char** argv)
     tmpParam->_matchingError = matchingErrorMax;
     tmpParam->_nbFrameBufferMatching = nbFrameBufferMatching;
     tmpParam->_useRobustMatching = robustMatching;
+
+    if(tmpParam->_algorithm == localization::VoctreeLocalizer::Algorithm::LandmarkIndex &&
+       tmpLoc->isInit() && !tmpLoc->initLandmarkIndex(landmarkIndexFilepath, landmarkIndexMaxLandmarks))
+    {
+      ALICEVISION_CERR("ERROR while initializing the landmark descriptor index!");
+      return EXIT_FAILURE;
+    }
   }
   
   assert(localizer);
@@ -389,10 +427,6 @@ int main(int argc, char** argv)
   exporter.initAnimatedCamera("camera");
 #endif
   
-  image::Image<float> imageGrey;
-  camera::PinholeRadialK3 queryIntrinsics;
-  bool hasIntrinsics = false;
-  
   std::size_t frameCounter = 0;
   std::size_t goodFrameCounter = 0;
   std::vector<std::string> goodFrameList;
@@ -407,23 +441,97 @@ int main(int argc, char** argv)
   bacc::accumulator_set<double, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::sum > > stats;
   
   std::vector<localization::LocalizationResult> vec_localizationResults;
-  
-  while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+
+  // the features of the next frames are extracted while the current one is localized
+  localization::ConcurrentBoundedBuffer<QueryFrame> queryFrames(std::max<std::size_t>(1, pipelineDepth));
+  std::exception_ptr extractionError;
+
+  auto extractFrames = [&]()
+  {
+    try
+    {
+      image::Image<float> imageGrey;
+      QueryFrame frame;
+      while(feed.readImage(imageGrey, frame.intrinsics, frame.imageName, frame.hasIntrinsics))
+      {
+        const auto extract_start = std::chrono::steady_clock::now();
+        localizer->extractRegions(imageGrey, param.get(), frame.regions, frame.imageName);
+        frame.extractionMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - extract_start).count();
+        frame.imageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
+
+        feed.goToNextFrame();
+        if(!queryFrames.push(std::move(frame)))
+          break;
+        frame = QueryFrame();
+      }
+    }
+    catch(...)
+    {
+      extractionError = std::current_exception();
+    }
+    queryFrames.close();
+  };
+
+  // sequential mode: extract each frame just before its localization
+  std::thread extractionThread;
+  if(pipelineDepth > 0)
+    extractionThread = std::thread(extractFrames);
+
+  // stop and join the extraction thread on every exit of this scope, also if the localization throws
+  struct ExtractionThreadGuard
+  {
+    localization::ConcurrentBoundedBuffer<QueryFrame>& queryFrames;
+    std::thread& extractionThread;
+
+    ~ExtractionThreadGuard()
+    {
+      queryFrames.close();
+      if(extractionThread.joinable())
+        extractionThread.join();
+    }
+  } extractionThreadGuard{queryFrames, extractionThread};
+
+  const auto sequence_start = std::chrono::steady_clock::now();
+
+  QueryFrame frame;
+  while(true)
   {
+    if(pipelineDepth == 0)
+    {
+      image::Image<float> imageGrey;
+      frame = QueryFrame();
+      if(!feed.readImage(imageGrey, frame.intrinsics, frame.imageName, frame.hasIntrinsics))
+        break;
+      const auto extract_start = std::chrono::steady_clock::now();
+      localizer->extractRegions(imageGrey, param.get(), frame.regions, frame.imageName);
+      frame.extractionMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - extract_start).count();
+      frame.imageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
+      feed.goToNextFrame();
+    }
+    else if(!queryFrames.pop(frame))
+    {
+      break;
+    }
+
+    currentImgName = frame.imageName;
+    camera::PinholeRadialK3& queryIntrinsics = frame.intrinsics;
+
     ALICEVISION_COUT("******************************");
     ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
     ALICEVISION_COUT("******************************");
     localization::LocalizationResult localizationResult;
     auto detect_start = std::chrono::steady_clock::now();
-    localizer->localize(imageGrey, 
+    localizer->localize(frame.regions,
+                       frame.imageSize,
                        param.get(),
-                       hasIntrinsics /*useInputIntrinsics*/,
+                       frame.hasIntrinsics /*useInputIntrinsics*/,
                        queryIntrinsics,
                        localizationResult,
                        currentImgName);
     auto detect_end = std::chrono::steady_clock::now();
     auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
+    ALICEVISION_COUT("\nFeature extraction took  " << frame.extractionMs << " [ms]");
+    ALICEVISION_COUT("Localization took  " << detect_elapsed.count() << " [ms]");
     stats(detect_elapsed.count());
     
     vec_localizationResults.emplace_back(localizationResult);
@@ -446,9 +554,15 @@ int main(int argc, char** argv)
 #endif
     }
     ++frameCounter;
-    feed.goToNextFrame();
   }
 
+  if(extractionThread.joinable())
+    extractionThread.join();
+  if(extractionError)
+    std::rethrow_exception(extractionError);
+
+  const double sequenceDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - sequence_start).count();
+
   if(wantsJsonOutput)
   {
     localization::LocalizationResult::save(vec_localizationResults, basenameJson + ".json");
@@ -519,4 +633,6 @@ int main(int argc, char** argv)
   ALICEVISION_COUT("Mean time for localization:   " << bacc::mean(stats) << " [ms]");
   ALICEVISION_COUT("Max time for localization:   " << bacc::max(stats) << " [ms]");
   ALICEVISION_COUT("Min time for localization:   " << bacc::min(stats) << " [ms]");
+  ALICEVISION_COUT("Sustained throughput: " << (sequenceDuration > 0.0 ? frameCounter / sequenceDuration : 0.0)
+                   << " [fps] (" << frameCounter << " frames in " << sequenceDuration << " [s])");
 }
@@ -0,0 +1,324 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/config.hpp>
+#include <aliceVision/localization/ILocalizer.hpp>
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
+#include <aliceVision/localization/CCTagLocalizer.hpp>
+#endif
+#include <aliceVision/localization/LocalizationServer.hpp>
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/robustEstimation/estimators.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+int main(int argc, char** argv)
+{
+  /// the AliceVision .json data file
+  std::string sfmFilePath;
+  /// the folder containing the descriptors
+  std::string descriptorsFolder;
+  /// the folders containing the precomputed regions of the queries
+  std::vector<std::string> queryFeaturesFolders;
+  /// the requests input, stdin if empty
+  std::string requestsFilepath;
+  /// the responses output, stdout if empty
+  std::string responsesFilepath;
+
+  /// the describer types name to use for the matching
+  std::string matchDescTypeNames = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  /// the preset for the feature extractor
+  feature::EImageDescriberPreset featurePreset = feature::EImageDescriberPreset::NORMAL;
+  /// the estimator to use for resection
+  robustEstimation::ERobustEstimator resectionEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
+  /// the estimator to use for matching
+  robustEstimation::ERobustEstimator matchingEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
+  /// the possible choices for the estimators as strings
+  const std::string str_estimatorChoices = robustEstimation::ERobustEstimator_enumToString(robustEstimation::ERobustEstimator::ACRANSAC)
+                                          +", "+robustEstimation::ERobustEstimator_enumToString(robustEstimation::ERobustEstimator::LORANSAC);
+  bool refineIntrinsics = false;
+  /// the maximum reprojection error allowed for resection
+  double resectionErrorMax = 4.0;
+  /// the maximum reprojection error allowed for image matching with geometric validation
+  double matchingErrorMax = 4.0;
+
+  // voctree parameters
+  std::string algostring = "AllResults";
+  /// number of similar images to search when querying the voctree
+  std::size_t numResults = 4;
+  /// maximum number of successfully matched similar images
+  std::size_t maxResults = 10;
+  std::size_t numCommonViews = 3;
+  /// the vocabulary tree file
+  std::string vocTreeFilepath;
+  /// the vocabulary tree weights file
+  std::string weightsFilepath;
+  /// Number of previous frame of the sequence to use for matching
+  std::size_t nbFrameBufferMatching = 10;
+  /// enable/disable the robust matching (geometric validation) when matching query image
+  /// and databases images
+  bool robustMatching = true;
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
+  // parameters for cctag localizer
+  std::size_t nNearestKeyFrames = 5;
+#endif
+
+  po::options_description allParams(
+      "This program keeps a localization database (vocabulary tree, 3D scene data) loaded \n"
+      "and answers localization requests (one per line) with a json localization result per line.\n"
+      "Requests:\n"
+      "  image <imagePath> [<focal> <ppx> <ppy> <k1> <k2> <k3>]\n"
+      "  regions <viewId> <width> <height> [<focal> <ppx> <ppy> <k1> <k2> <k3>]\n"
+      "  stats\n"
+      "  quit");
+
+  po::options_description inputParams("Required input parameters");
+  inputParams.add_options()
+      ("sfmdata", po::value<std::string>(&sfmFilePath)->required(),
+          "The sfm_data.json kind of file generated by AliceVision.");
+
+  po::options_description commonParams("Common optional parameters for the localizer");
+  commonParams.add_options()
+      ("descriptorPath", po::value<std::string>(&descriptorsFolder),
+          "Folder containing the descriptors for all the images (ie the *.desc.)")
+      ("queryFeaturesFolders", po::value<std::vector<std::string>>(&queryFeaturesFolders)->multitoken(),
+          "Folder(s) containing the precomputed regions of the queries (<viewId>.<describerType>.feat/desc).")
+      ("matchDescTypes", po::value<std::string>(&matchDescTypeNames)->default_value(matchDescTypeNames),
+          "The describer types to use for the matching")
+      ("preset", po::value<feature::EImageDescriberPreset>(&featurePreset)->default_value(featurePreset),
+          "Preset for the feature extractor when localizing a new image "
+          "{LOW,MEDIUM,NORMAL,HIGH,ULTRA}")
+      ("resectionEstimator", po::value<robustEstimation::ERobustEstimator>(&resectionEstimator)->default_value(resectionEstimator),
+          std::string("The type of *sac framework to use for resection "
+          "("+str_estimatorChoices+")").c_str())
+      ("matchingEstimator", po::value<robustEstimation::ERobustEstimator>(&matchingEstimator)->default_value(matchingEstimator),
+          std::string("The type of *sac framework to use for matching "
+          "("+str_estimatorChoices+")").c_str())
+      ("refineIntrinsics", po::value<bool>(&refineIntrinsics),
+          "Enable/Disable camera intrinsics refinement for each localized image")
+      ("reprojectionError", po::value<double>(&resectionErrorMax)->default_value(resectionErrorMax),
+          "Maximum reprojection error (in pixels) allowed for resectioning. If set "
+          "to 0 it lets the ACRansac select an optimal value.");
+
+  po::options_description voctreeParams("Parameters specific for the vocabulary tree-based localizer");
+  voctreeParams.add_options()
+      ("nbImageMatch", po::value<std::size_t>(&numResults)->default_value(numResults),
+          "[voctree] Number of images to retrieve in database")
+      ("maxResults", po::value<std::size_t>(&maxResults)->default_value(maxResults),
+          "[voctree] For algorithm AllResults, it stops the image matching when "
+          "this number of matched images is reached. If 0 it is ignored.")
+      ("commonviews", po::value<std::size_t>(&numCommonViews)->default_value(numCommonViews),
+          "[voctree] Number of minimum images in which a point must be seen to "
+          "be used in cluster tracking")
+      ("voctree", po::value<std::string>(&vocTreeFilepath),
+          "[voctree] Filename for the vocabulary tree")
+      ("voctreeWeights", po::value<std::string>(&weightsFilepath),
+          "[voctree] Filename for the vocabulary tree weights")
+      ("algorithm", po::value<std::string>(&algostring)->default_value(algostring),
+          "[voctree] Algorithm type: FirstBest, AllResults" )
+      ("matchingError", po::value<double>(&matchingErrorMax)->default_value(matchingErrorMax),
+          "[voctree] Maximum matching error (in pixels) allowed for image matching with "
+          "geometric verification. If set to 0 it lets the ACRansac select "
+          "an optimal value.")
+      ("nbFrameBufferMatching", po::value<std::size_t>(&nbFrameBufferMatching)->default_value(nbFrameBufferMatching),
+          "[voctree] Number of previous frame of the sequence to use for matching "
+          "(0 = Disable)")
+      ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching),
+          "[voctree] Enable/Disable the robust matching between query and database images, "
+          "all putative matches will be considered.")
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
+      ("nNearestKeyFrames", po::value<size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames),
+          "[cctag] Number of images to retrieve in the database")
+#endif
+  ;
+
+  po::options_description outputParams("Options for the input/output of the service");
+  outputParams.add_options()
+      ("help,h", "Print this message")
+      ("requests", po::value<std::string>(&requestsFilepath)->default_value(requestsFilepath),
+          "File (or named pipe) to read the requests from. Standard input if empty.")
+      ("responses", po::value<std::string>(&responsesFilepath)->default_value(responsesFilepath),
+          "File (or named pipe) to write the responses to. Standard output if empty.");
+
+  allParams.add(inputParams).add(outputParams).add(commonParams).add(voctreeParams);
+
+  po::variables_map vm;
+
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  // the responses own the standard output, everything else printed by the
+  // localizer (progress bars, messages) is sent to the standard error
+  std::streambuf* stdoutBuffer = std::cout.rdbuf();
+  std::ostream stdoutStream(stdoutBuffer);
+  std::cout.rdbuf(std::cerr.rdbuf());
+
+  const double defaultLoRansacMatchingError = 4.0;
+  const double defaultLoRansacResectionError = 4.0;
+  if(!robustEstimation::adjustRobustEstimatorThreshold(matchingEstimator, matchingErrorMax, defaultLoRansacMatchingError) ||
+     !robustEstimation::adjustRobustEstimatorThreshold(resectionEstimator, resectionErrorMax, defaultLoRansacResectionError))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Init descTypes from command-line string
+  const std::vector<feature::EImageDescriberType> matchDescTypes = feature::EImageDescriberType_stringToEnums(matchDescTypeNames);
+
+  // decide the localizer to use based on the type of feature
+  bool useVoctreeLocalizer = true;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
+  useVoctreeLocalizer = !(matchDescTypes.size() == 1 &&
+                        ((matchDescTypes.front() == feature::EImageDescriberType::CCTAG3) ||
+                        (matchDescTypes.front() == feature::EImageDescriberType::CCTAG4)));
+#endif
+
+  ALICEVISION_CERR("Program called with the following parameters:");
+  ALICEVISION_CERR(vm);
+
+  system::Timer startupTimer;
+
+  // load SfMData
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmFilePath, sfmDataIO::ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmFilePath + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  //***********************************************************************
+  // Localizer initialization
+  //***********************************************************************
+
+  std::unique_ptr<localization::LocalizerParameters> param;
+  std::unique_ptr<localization::ILocalizer> localizer;
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
+  if(!useVoctreeLocalizer)
+  {
+    localizer.reset(new localization::CCTagLocalizer(sfmData, descriptorsFolder));
+
+    localization::CCTagLocalizer::Parameters* tmpParam = new localization::CCTagLocalizer::Parameters();
+    param.reset(tmpParam);
+    tmpParam->_nNearestKeyFrames = nNearestKeyFrames;
+  }
+  else
+#endif
+  {
+    localizer.reset(new localization::VoctreeLocalizer(sfmData,
+                                                       descriptorsFolder,
+                                                       vocTreeFilepath,
+                                                       weightsFilepath,
+                                                       matchDescTypes));
+
+    localization::VoctreeLocalizer::Parameters* tmpParam = new localization::VoctreeLocalizer::Parameters();
+    param.reset(tmpParam);
+    tmpParam->_algorithm = localization::VoctreeLocalizer::initFromString(algostring);
+    tmpParam->_numResults = numResults;
+    tmpParam->_maxResults = maxResults;
+    tmpParam->_numCommonViews = numCommonViews;
+    tmpParam->_ccTagUseCuda = false;
+    tmpParam->_matchingError = matchingErrorMax;
+    tmpParam->_nbFrameBufferMatching = nbFrameBufferMatching;
+    tmpParam->_useRobustMatching = robustMatching;
+  }
+
+  // set other common parameters
+  param->_featurePreset = featurePreset;
+  param->_refineIntrinsics = refineIntrinsics;
+  param->_errorMax = resectionErrorMax;
+  param->_resectionEstimator = resectionEstimator;
+  param->_matchingEstimator = matchingEstimator;
+
+  if(!localizer->isInit())
+  {
+    ALICEVISION_LOG_ERROR("Unable to initialize the localizer.");
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Localizer initialized in " << startupTimer.elapsed() << " s, waiting for requests.");
+
+  //***********************************************************************
+  // Serve the requests
+  //***********************************************************************
+
+  std::ifstream requestsFile;
+  if(!requestsFilepath.empty())
+  {
+    requestsFile.open(requestsFilepath);
+    if(!requestsFile.is_open())
+    {
+      ALICEVISION_LOG_ERROR("Unable to open the requests file '" << requestsFilepath << "'.");
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::ofstream responsesFile;
+  if(!responsesFilepath.empty())
+  {
+    responsesFile.open(responsesFilepath);
+    if(!responsesFile.is_open())
+    {
+      ALICEVISION_LOG_ERROR("Unable to open the responses file '" << responsesFilepath << "'.");
+      return EXIT_FAILURE;
+    }
+  }
+
+  localization::LocalizationServer server(*localizer, *param, matchDescTypes, queryFeaturesFolders);
+
+  const std::size_t nbRequests = server.serve(requestsFilepath.empty() ? std::cin : requestsFile,
+                                              responsesFilepath.empty() ? stdoutStream : responsesFile);
+
+  ALICEVISION_LOG_INFO(nbRequests << " requests served.");
+  server.getLatencyStats().log();
+
+  std::cout.rdbuf(stdoutBuffer);
+  return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
@@ -166,6 +167,8 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    ALICEVISION_PERF_SESSION("depthMapEstimation");
+
     // print GPU Information
     ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
 
@@ -10,6 +10,7 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/feature.hpp>
+#include <aliceVision/feature/TiledImageDescriber.hpp>
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_POPSIFT) \
  || ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
 #define ALICEVISION_HAVE_GPU_FEATURES
@@ -17,6 +18,7 @@
 #endif
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
@@ -37,7 +39,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -189,11 +191,24 @@ public:
       nbThreads = std::min(_cpuJobs.size(), nbThreads);
 
       ALICEVISION_LOG_DEBUG("# threads for extraction: " << nbThreads);
-      omp_set_nested(1);
+
+      // tiled extraction: the remaining cores are used by the parallel tiles of each view,
+      // the other describers keep the default (non nested) behavior
+      bool useTiles = false;
+      for(const auto& imageDescriber : _imageDescribers)
+        useTiles |= (dynamic_cast<const feature::TiledImageDescriber*>(imageDescriber.get()) != nullptr);
+
+      const int nbInnerThreads = std::max(1, omp_get_num_procs() / static_cast<int>(std::max<std::size_t>(1, nbThreads)));
+      if(useTiles)
+        omp_set_nested(1);
 
 #pragma omp parallel for num_threads(nbThreads)
       for(int i = 0; i < _cpuJobs.size(); ++i)
+      {
+        if(useTiles)
+          omp_set_num_threads(nbInnerThreads);
         computeViewJob(_cpuJobs.at(i));
+      }
     }
 
     if(!_gpuJobs.empty())
@@ -207,10 +222,15 @@ private:
 
   void computeViewJob(const ViewJob& job, bool useGPU = false)
   {
+    ALICEVISION_PERF_ZONE("featureExtraction.view");
+
     image::Image<float> imageGrayFloat;
     image::Image<unsigned char> imageGrayUChar;
 
-    image::readImage(job.view.getImagePath(), imageGrayFloat, image::EImageColorSpace::SRGB);
+    {
+      ALICEVISION_PERF_ZONE("featureExtraction.readImage");
+      image::readImage(job.view.getImagePath(), imageGrayFloat, image::EImageColorSpace::SRGB);
+    }
 
     const auto imageDescriberIndexes = useGPU ? job.gpuImageDescriberIndexes : job.cpuImageDescriberIndexes;
 
@@ -224,18 +244,22 @@ private:
       ALICEVISION_LOG_INFO("Extracting " << imageDescriberTypeName  << " features from view '" << job.view.getImagePath() << "' " << (useGPU ? "[gpu]" : "[cpu]"));
 
       std::unique_ptr<feature::Regions> regions;
-      if(imageDescriber->useFloatImage())
-      {
-        // image buffer use float image, use the read buffer
-        imageDescriber->describe(imageGrayFloat, regions);
-      }
-      else
       {
-        // image buffer can't use float image
-        if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
-          imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
-        imageDescriber->describe(imageGrayUChar, regions);
+        ALICEVISION_PERF_ZONE("featureExtraction.describe");
+        if(imageDescriber->useFloatImage())
+        {
+          // image buffer use float image, use the read buffer
+          imageDescriber->describe(imageGrayFloat, regions);
+        }
+        else
+        {
+          // image buffer can't use float image
+          if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
+            imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
+          imageDescriber->describe(imageGrayUChar, regions);
+        }
       }
+      ALICEVISION_PERF_COUNTER("featureExtraction.nbFeatures", regions->RegionCount());
       imageDescriber->Save(regions.get(), job.getFeaturesPath(imageDescriberType), job.getDescriptorPath(imageDescriberType));
       ALICEVISION_LOG_INFO(std::left << std::setw(6) << " " << regions->RegionCount() << " " << imageDescriberTypeName  << " features extracted from view '" << job.view.getImagePath() << "'");
     }
@@ -270,6 +294,8 @@ int main(int argc, char **argv)
   int rangeSize = 1;
   int maxThreads = 0;
   bool forceCpuExtraction = false;
+  feature::TiledExtractionParams tiledParams;
+  tiledParams.tileSize = 0;
 
   po::options_description allParams("AliceVision featureExtraction");
 
@@ -294,7 +320,15 @@ int main(int argc, char **argv)
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
-      "Specifies the maximum number of threads to run simultaneously (0 for automatic mode).");
+      "Specifies the maximum number of threads to run simultaneously (0 for automatic mode).")
+    ("tileSize", po::value<int>(&tiledParams.tileSize)->default_value(tiledParams.tileSize),
+      "Extract the features of the images larger than this size tile by tile, with a bounded amount of memory per tile (0 to disable).")
+    ("tileOverlap", po::value<int>(&tiledParams.tileOverlap)->default_value(tiledParams.tileOverlap),
+      "Overlap in pixels between neighboring tiles. Features larger than the overlap may be lost at the seams.")
+    ("maxParallelTiles", po::value<int>(&tiledParams.maxParallelTiles)->default_value(tiledParams.maxParallelTiles),
+      "Maximum number of tiles of an image extracted in parallel (0 for automatic mode).")
+    ("maxNbFeatures", po::value<std::size_t>(&tiledParams.maxNbFeatures)->default_value(tiledParams.maxNbFeatures),
+      "Maximum number of features per image with tiled extraction, selected on the whole image (0: maximum number of features of the describer preset).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -334,6 +368,8 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  ALICEVISION_PERF_SESSION("featureExtraction");
+
   if(describerTypesName.empty())
   {
     ALICEVISION_LOG_ERROR("--describerTypes option is empty.");
@@ -397,6 +433,10 @@ int main(int argc, char **argv)
       if(forceCpuExtraction)
         imageDescriber->setUseCuda(false);
 
+      // tiled extraction, the output files are the same
+      if(tiledParams.tileSize > 0)
+        imageDescriber = std::make_shared<feature::TiledImageDescriber>(imageDescriber, tiledParams);
+
       extractor.addImageDescriber(imageDescriber);
     }
   }
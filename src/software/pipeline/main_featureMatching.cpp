@@ -22,9 +22,13 @@
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
+#include <aliceVision/matchingImageCollection/pairwiseMatching.hpp>
+#include <aliceVision/matchingImageCollection/RegionsPerViewCache.hpp>
 #include <aliceVision/matching/pairwiseAdjacencyDisplay.hpp>
 #include <aliceVision/matching/io.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/feature/selection.hpp>
 #include <aliceVision/graph/graph.hpp>
@@ -40,7 +44,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -80,6 +84,134 @@ void getStatsMap(const PairwiseMatches& map)
 #endif
 }
 
+/**
+ * @brief Geometric filtering of the putative matches of an image pair
+ *        - AContrario Estimation of the desired geometric model
+ *        - Use an upper bound for the a contrario estimated threshold
+ * @return true if the image pair is geometrically valid
+ */
+bool geometricFiltering(MatchesPerDescType& geometricMatches,
+                        const Pair& imagePair,
+                        const MatchesPerDescType& putativeMatches,
+                        const SfMData& sfmData,
+                        const RegionsPerView& regionPerView,
+                        EGeometricFilterType geometricFilterType,
+                        robustEstimation::ERobustEstimator geometricEstimator,
+                        double geometricErrorMax,
+                        int maxIteration,
+                        bool guidedMatching)
+{
+  switch(geometricFilterType)
+  {
+
+    case EGeometricFilterType::NO_FILTERING:
+      geometricMatches = putativeMatches;
+      return true;
+
+    case EGeometricFilterType::FUNDAMENTAL_MATRIX:
+    {
+      return matchingImageCollection::robustModelEstimation(geometricMatches,
+        &sfmData,
+        regionPerView,
+        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
+        imagePair,
+        putativeMatches,
+        guidedMatching);
+    }
+
+    case EGeometricFilterType::ESSENTIAL_MATRIX:
+    {
+      if(!matchingImageCollection::robustModelEstimation(geometricMatches,
+        &sfmData,
+        regionPerView,
+        GeometricFilterMatrix_E_AC(std::numeric_limits<double>::infinity(), maxIteration),
+        imagePair,
+        putativeMatches,
+        guidedMatching))
+        return false;
+
+      // perform an additional check to remove pairs with poor overlap
+      const size_t putativePhotometricCount = putativeMatches.getNbAllMatches();
+      const size_t putativeGeometricCount = geometricMatches.getNbAllMatches();
+      const float ratio = putativeGeometricCount / (float)putativePhotometricCount;
+      return !(putativeGeometricCount < 50 || ratio < .3f);
+    }
+
+    case EGeometricFilterType::HOMOGRAPHY_MATRIX:
+    {
+      const bool onlyGuidedMatching = true;
+      return matchingImageCollection::robustModelEstimation(geometricMatches,
+        &sfmData,
+        regionPerView,
+        GeometricFilterMatrix_H_AC(std::numeric_limits<double>::infinity(), maxIteration),
+        imagePair,
+        putativeMatches, guidedMatching,
+        onlyGuidedMatching ? -1.0 : 0.6);
+    }
+
+    case EGeometricFilterType::HOMOGRAPHY_GROWING:
+    {
+      return matchingImageCollection::robustModelEstimation(geometricMatches,
+        &sfmData,
+        regionPerView,
+        GeometricFilterMatrix_HGrowing(std::numeric_limits<double>::infinity(), maxIteration),
+        imagePair,
+        putativeMatches,
+        guidedMatching);
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Sort the geometric matches of an image pair by features scale, apply the grid filtering
+ *        and keep at most numMatchesToKeep matches (if not 0)
+ */
+void gridFiltering(MatchesPerDescType& finalMatches,
+                   const Pair& indexImagePair,
+                   const MatchesPerDescType& geometricMatches,
+                   const SfMData& sfmData,
+                   const RegionsPerView& regionPerView,
+                   bool useGridSort,
+                   std::size_t numMatchesToKeep)
+{
+  for(const auto& match: geometricMatches)
+  {
+    const feature::EImageDescriberType descType = match.first;
+    assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+    const aliceVision::matching::IndMatches& inputMatches = match.second;
+
+    const feature::FeatRegions<feature::SIOPointFeature>* rRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.second, descType));
+    const feature::FeatRegions<feature::SIOPointFeature>* lRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.first, descType));
+
+    // get the regions for the current view pair:
+    if(rRegions && lRegions)
+    {
+      // sorting function:
+      aliceVision::matching::IndMatches outMatches;
+      sortMatches_byFeaturesScale(inputMatches, *lRegions, *rRegions, outMatches);
+
+      if(useGridSort)
+      {
+        // TODO: rename as matchesGridOrdering
+        matchesGridFiltering(*lRegions, *rRegions, indexImagePair, sfmData, outMatches);
+      }
+      if(numMatchesToKeep > 0)
+      {
+        size_t finalSize = std::min(numMatchesToKeep, outMatches.size());
+        outMatches.resize(finalSize);
+      }
+
+      // std::cout << "Left features: " << lRegions->Features().size() << ", right features: " << rRegions->Features().size() << ", num matches: " << inputMatches.size() << ", num filtered matches: " << outMatches.size() << std::endl;
+      finalMatches.insert(std::make_pair(descType, outMatches));
+    }
+    else
+    {
+      ALICEVISION_LOG_INFO("You cannot perform the grid filtering with these regions");
+    }
+  }
+}
+
 /// Compute corresponding features between a series of views:
 /// - Load view images description (regions: features & descriptors)
 /// - Compute putative local feature matches (descriptors matching)
@@ -112,6 +244,7 @@ int main(int argc, char **argv)
   size_t numMatchesToKeep = 0;
   bool useGridSort = true;
   bool exportDebugFiles = false;
+  std::size_t maxRegionsMemory = 0;
   const std::string fileExtension = "txt";
 
   po::options_description allParams(
@@ -171,6 +304,10 @@ int main(int argc, char **argv)
       "Export debug files (svg, dot).")
     ("maxMatches", po::value<std::size_t>(&numMatchesToKeep)->default_value(numMatchesToKeep),
       "Maximum number pf matches to keep.")
+    ("maxRegionsMemory", po::value<std::size_t>(&maxRegionsMemory)->default_value(maxRegionsMemory),
+      "Maximum memory (in MB) used by the regions of the views being matched. "
+      "If set, the image pairs are matched block by block and only the regions of the current block are kept in memory. "
+      "If set to 0, all the regions are loaded at once.")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -218,6 +355,8 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  ALICEVISION_PERF_SESSION("featureMatching");
+
   // check and set input options
   if(matchesFolder.empty() || !fs::is_directory(matchesFolder))
   {
@@ -283,10 +422,6 @@ int main(int argc, char **argv)
     filter.insert(pair.second);
   }
 
-  ALICEVISION_LOG_INFO("Putative matches");
-
-  PairwiseMatches mapPutativesMatches;
-
   // allocate the right Matcher according the Matching requested method
   EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
   std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio);
@@ -295,240 +430,232 @@ int main(int argc, char **argv)
 
   ALICEVISION_LOG_INFO("There are " + std::to_string(sfmData.getViews().size()) + " views and " + std::to_string(pairs.size()) + " image pairs.");
 
-  // load the corresponding view regions
-  RegionsPerView regionPerView;
-  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
-  {
-    ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
-    return EXIT_FAILURE;
-  }
-
-  // perform the matching
-  system::Timer timer;
+  // when a range is specified, generate a file prefix to reflect the current iteration (rangeStart/rangeSize)
+  // => with matchFilePerImage: avoids overwriting files if a view is present in several iterations
+  // => without matchFilePerImage: avoids overwriting the unique resulting file
+  const std::string filePrefix = rangeSize > 0 ? std::to_string(rangeStart/rangeSize) + "." : "";
 
-  for(const feature::EImageDescriberType descType : describerTypes)
-  {
-    assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-    ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
+  // c. Geometric filtering of putative matches
+  //    Each image pair goes through putative matching, geometric filtering and grid filtering,
+  //    then its matches are written and its putative matches are dropped.
 
-    // photometric matching of putative pairs
-    imageCollectionMatcher->Match(regionPerView, pairs, descType, mapPutativesMatches);
+  ALICEVISION_LOG_INFO("Putative matches: " << describerTypesName << ", geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
 
-    // TODO: DELI
-    // if(!guided_matching) regionPerView.clearDescriptors()
-  }
+  system::Timer timer;
 
-  if(mapPutativesMatches.empty())
+  // export putative and geometric filtered matches pair by pair
+  std::unique_ptr<MatchesWriter> putativeMatchesWriter;
+  if(savePutativeMatches)
   {
-    ALICEVISION_LOG_INFO("No putative matches.");
-    // If we only compute a selection of matches, we may have no match.
-    return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
+    const std::string putativeMatchesFolder = (fs::path(matchesFolder) / "putativeMatches").string();
+    fs::create_directory(putativeMatchesFolder);
+    putativeMatchesWriter.reset(new MatchesWriter(putativeMatchesFolder, fileExtension, matchFilePerImage, filePrefix));
   }
+  MatchesWriter matchesWriter(matchesFolder, fileExtension, matchFilePerImage, filePrefix);
 
-  if(geometricFilterType == EGeometricFilterType::HOMOGRAPHY_GROWING)
+  // only kept to export debug files
+  PairwiseMatches finalMatches;
+#ifdef ALICEVISION_DEBUG_MATCHING
+  PairwiseMatches putativeMatchesDebug;
+  PairwiseMatches geometricMatchesDebug;
+#endif
+
+  PairwiseMatchingStats matchingStats;
+  const RegionsPerView* currentRegionsPerView = nullptr;
+
+  const PairMatchesProcessor processPairMatches = [&](const Pair& pair, MatchesPerDescType& putativeMatches)
   {
-    // sort putative matches according to their Lowe ratio
-    // This is suggested by [F.Srajer, 2016]: the matches used to be the seeds of the homographies growing are chosen according
-    // to the putative matches order. This modification should improve recall.
-    for(auto& imgPair: mapPutativesMatches)
+    if(geometricFilterType == EGeometricFilterType::HOMOGRAPHY_GROWING)
     {
-      for(auto& descType: imgPair.second)
+      // sort putative matches according to their Lowe ratio
+      // This is suggested by [F.Srajer, 2016]: the matches used to be the seeds of the homographies growing are chosen according
+      // to the putative matches order. This modification should improve recall.
+      for(auto& descType: putativeMatches)
       {
         IndMatches & matches = descType.second;
         sortMatches_byDistanceRatio(matches);
       }
     }
-  }
 
-  // when a range is specified, generate a file prefix to reflect the current iteration (rangeStart/rangeSize)
-  // => with matchFilePerImage: avoids overwriting files if a view is present in several iterations
-  // => without matchFilePerImage: avoids overwriting the unique resulting file
-  const std::string filePrefix = rangeSize > 0 ? std::to_string(rangeStart/rangeSize) + "." : "";
-
-  ALICEVISION_LOG_INFO(std::to_string(mapPutativesMatches.size()) << " putative image pair matches");
-
-  for(const auto& imageMatch: mapPutativesMatches)
-    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(imageMatch.first.first) << ", " + std::to_string(imageMatch.first.second) + ") contains " + std::to_string(imageMatch.second.getNbAllMatches()) + " putative matches.");
+    if(putativeMatchesWriter)
+      putativeMatchesWriter->write(pair, putativeMatches);
 
-  // export putative matches
-  if(savePutativeMatches)
-    Save(mapPutativesMatches, (fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix);
-
-  ALICEVISION_LOG_INFO("Task (Regions Matching) done in (s): " + std::to_string(timer.elapsed()));
+    MatchesPerDescType geometricMatches;
+    MatchesPerDescType pairFinalMatches;
 
-  /*
-  // TODO: DELI
-  if(exportDebugFiles)
-  {
-    //-- export putative matches Adjacency matrix
-    PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
-      mapPutativesMatches,
-      (fs::path(matchesFolder) / "PutativeAdjacencyMatrix.svg").string());
-    //-- export view pair graph once putative graph matches have been computed
+    if(geometricFiltering(geometricMatches, pair, putativeMatches, sfmData, *currentRegionsPerView, geometricFilterType,
+                          geometricEstimator, geometricErrorMax, maxIteration, guidedMatching))
     {
-      std::set<IndexT> set_ViewIds;
-
-      std::transform(sfmData.getViews().begin(), sfmData.getViews().end(),
-        std::inserter(set_ViewIds, set_ViewIds.begin()), stl::RetrieveKey());
-
-      graph::indexedGraph putativeGraph(set_ViewIds, getPairs(mapPutativesMatches));
-
-      graph::exportToGraphvizData(
-        (fs::path(matchesFolder) / "putative_matches.dot").string(),
-        putativeGraph.g);
+      gridFiltering(pairFinalMatches, pair, geometricMatches, sfmData, *currentRegionsPerView, useGridSort, numMatchesToKeep);
     }
-  }
-  */
+
+    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(pair.first) + ", " + std::to_string(pair.second) + ") contains "
+                         + std::to_string(putativeMatches.getNbAllMatches()) + " putative matches, "
+                         + std::to_string(pairFinalMatches.getNbAllMatches()) + " geometric matches.");
 
 #ifdef ALICEVISION_DEBUG_MATCHING
+    #pragma omp critical
     {
-      ALICEVISION_LOG_DEBUG("PUTATIVE");
-      getStatsMap(mapPutativesMatches);
+      putativeMatchesDebug[pair] = putativeMatches;
+      geometricMatchesDebug[pair] = geometricMatches;
     }
 #endif
 
-  // c. Geometric filtering of putative matches
-  //    - AContrario Estimation of the desired geometric model
-  //    - Use an upper bound for the a contrario estimated threshold
+    if(pairFinalMatches.empty())
+      return false;
 
-  timer.reset();
+    matchesWriter.write(pair, pairFinalMatches);
 
-  matching::PairwiseMatches geometricMatches;
+    if(exportDebugFiles)
+    {
+      #pragma omp critical
+      finalMatches[pair] = std::move(pairFinalMatches);
+    }
+    return true;
+  };
 
-  ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
+  // Putative matching, geometric filtering and grid filtering of a block of pairs
+  // Only the regions of the views of the block are needed.
+  const auto matchPairs = [&](const RegionsPerView& regionPerView, const PairSet& blockPairs)
+  {
+    currentRegionsPerView = &regionPerView;
+    matchAndProcessPairs(*imageCollectionMatcher, regionPerView, blockPairs, describerTypes, processPairMatches, matchingStats);
+    currentRegionsPerView = nullptr;
+  };
 
-  switch(geometricFilterType)
+  if(maxRegionsMemory == 0)
   {
+    // load the corresponding view regions
+    RegionsPerView regionPerView;
+    if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
+    {
+      ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
+      return EXIT_FAILURE;
+    }
 
-    case EGeometricFilterType::NO_FILTERING:
-      geometricMatches = mapPutativesMatches;
-    break;
+    try
+    {
+      matchPairs(regionPerView, pairs);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Matching failed: " << e.what());
+      return EXIT_FAILURE;
+    }
+  }
+  else
+  {
+    std::vector<std::string> allFeaturesFolders = sfmData.getFeaturesFolders();
+    allFeaturesFolders.insert(allFeaturesFolders.end(), featuresFolders.begin(), featuresFolders.end());
 
-    case EGeometricFilterType::FUNDAMENTAL_MATRIX:
+    // estimate the memory used by the regions of each view from the size of its regions files
+    std::map<IndexT, std::size_t> memoryPerView;
+    for(const IndexT viewId : filter)
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
-        mapPutativesMatches,
-        guidedMatching);
+      std::size_t& viewMemory = memoryPerView[viewId];
+      for(const feature::EImageDescriberType descType : describerTypes)
+        viewMemory += sfm::getRegionsFilesSize(allFeaturesFolders, viewId, descType);
     }
-    break;
 
-    case EGeometricFilterType::ESSENTIAL_MATRIX:
+    const std::size_t maxMemory = maxRegionsMemory * 1024 * 1024;
+    const std::vector<PairSet> blocks = blockPairs(pairs, memoryPerView, maxMemory);
+
+    ALICEVISION_LOG_INFO("Out-of-core matching: " << blocks.size() << " blocks of image pairs (regions memory budget: " << maxRegionsMemory << " MB).");
+
+    std::map<feature::EImageDescriberType, std::unique_ptr<feature::ImageDescriber>> imageDescribers;
+    for(const feature::EImageDescriberType descType : describerTypes)
+      imageDescribers[descType] = createImageDescriber(descType);
+
+    const RegionsPerViewCache::RegionsLoader loader = [&](IndexT viewId, feature::EImageDescriberType descType)
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_E_AC(std::numeric_limits<double>::infinity(), maxIteration),
-        mapPutativesMatches,
-        guidedMatching);
+      return sfm::loadRegions(allFeaturesFolders, viewId, *imageDescribers.at(descType));
+    };
 
-      // perform an additional check to remove pairs with poor overlap
-      std::vector<PairwiseMatches::key_type> toRemoveVec;
-      for(PairwiseMatches::const_iterator iterMap = geometricMatches.begin();
-        iterMap != geometricMatches.end(); ++iterMap)
+    RegionsPerViewCache regionsCache(loader, describerTypes, memoryPerView, maxMemory);
+
+    for(std::size_t b = 0; b < blocks.size(); ++b)
+    {
+      const PairSet& block = blocks.at(b);
+
+      std::set<IndexT> blockViewIds;
+      for(const Pair& pair : block)
       {
-        const size_t putativePhotometricCount = mapPutativesMatches.find(iterMap->first)->second.getNbAllMatches();
-        const size_t putativeGeometricCount = iterMap->second.getNbAllMatches();
-        const float ratio = putativeGeometricCount / (float)putativePhotometricCount;
-        if (putativeGeometricCount < 50 || ratio < .3f)
-          toRemoveVec.push_back(iterMap->first); // the image pair will be removed
+        blockViewIds.insert(pair.first);
+        blockViewIds.insert(pair.second);
       }
 
-      // remove discarded pairs
-      for(std::vector<PairwiseMatches::key_type>::const_iterator iter = toRemoveVec.begin();
-          iter != toRemoveVec.end(); ++iter)
-        geometricMatches.erase(*iter);
-    }
-    break;
+      ALICEVISION_LOG_INFO("Block " << (b + 1) << " / " << blocks.size() << ": " << block.size() << " image pairs, " << blockViewIds.size() << " views.");
 
-    case EGeometricFilterType::HOMOGRAPHY_MATRIX:
-    {
-      const bool onlyGuidedMatching = true;
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_H_AC(std::numeric_limits<double>::infinity(), maxIteration),
-        mapPutativesMatches, guidedMatching,
-        onlyGuidedMatching ? -1.0 : 0.6);
-    }
-    break;
+      try
+      {
+        regionsCache.request(blockViewIds);
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "': " << e.what());
+        return EXIT_FAILURE;
+      }
 
-    case EGeometricFilterType::HOMOGRAPHY_GROWING:
-    {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_HGrowing(std::numeric_limits<double>::infinity(), maxIteration),
-        mapPutativesMatches,
-        guidedMatching);
+      try
+      {
+        matchPairs(regionsCache.getRegionsPerView(), block);
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Matching failed: " << e.what());
+        return EXIT_FAILURE;
+      }
     }
-    break;
+
+    ALICEVISION_LOG_INFO("Regions cache statistics:" << std::endl
+                         << "\t- loaded views: " << regionsCache.getNbLoads() << " (" << filter.size() << " distinct views)" << std::endl
+                         << "\t- evicted views: " << regionsCache.getNbEvictions() << std::endl
+                         << "\t- peak regions memory (estimated): " << (regionsCache.getPeakMemorySize() / (1024 * 1024)) << " MB");
   }
 
-  ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches:");
-  for(const auto& matchGeo: geometricMatches)
-    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGeo.first.first) + ", " + std::to_string(matchGeo.first.second) + ") contains " + std::to_string(matchGeo.second.getNbAllMatches()) + " geometric matches.");
+  if(matchingStats.nbPutativePairs == 0)
+  {
+    ALICEVISION_LOG_INFO("No putative matches.");
+    // If we only compute a selection of matches, we may have no match.
+    return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
 
-  // grid filtering
-  ALICEVISION_LOG_INFO("Grid filtering");
+  ALICEVISION_LOG_INFO(std::to_string(matchingStats.nbPutativePairs) << " putative image pair matches");
+  ALICEVISION_LOG_INFO(std::to_string(matchingStats.nbValidPairs) << " geometric image pair matches");
 
-  PairwiseMatches finalMatches;
-  
+  /*
+  // TODO: DELI
+  if(exportDebugFiles)
   {
-    for(const auto& geometricMatch: geometricMatches)
+    //-- export putative matches Adjacency matrix
+    PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
+      mapPutativesMatches,
+      (fs::path(matchesFolder) / "PutativeAdjacencyMatrix.svg").string());
+    //-- export view pair graph once putative graph matches have been computed
     {
-      //Get the image pair and their matches.
-      const Pair& indexImagePair = geometricMatch.first;
-      const aliceVision::matching::MatchesPerDescType& matchesPerDesc = geometricMatch.second;
+      std::set<IndexT> set_ViewIds;
 
-      for(const auto& match: matchesPerDesc)
-      {
-        const feature::EImageDescriberType descType = match.first;
-        assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-        const aliceVision::matching::IndMatches& inputMatches = match.second;
-
-        const feature::FeatRegions<feature::SIOPointFeature>* rRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.second, descType));
-        const feature::FeatRegions<feature::SIOPointFeature>* lRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.first, descType));
-
-        // get the regions for the current view pair:
-        if(rRegions && lRegions)
-        {
-          // sorting function:
-          aliceVision::matching::IndMatches outMatches;
-          sortMatches_byFeaturesScale(inputMatches, *lRegions, *rRegions, outMatches);
-
-          if(useGridSort)
-          {
-            // TODO: rename as matchesGridOrdering
-            matchesGridFiltering(*lRegions, *rRegions, indexImagePair, sfmData, outMatches);
-          }
-          if(numMatchesToKeep > 0)
-          {
-            size_t finalSize = std::min(numMatchesToKeep, outMatches.size());
-            outMatches.resize(finalSize);
-          }
-
-          // std::cout << "Left features: " << lRegions->Features().size() << ", right features: " << rRegions->Features().size() << ", num matches: " << inputMatches.size() << ", num filtered matches: " << outMatches.size() << std::endl;
-          finalMatches[indexImagePair].insert(std::make_pair(descType, outMatches));
-        }
-        else
-        {
-          ALICEVISION_LOG_INFO("You cannot perform the grid filtering with these regions");
-        }
-      }
-    }
+      std::transform(sfmData.getViews().begin(), sfmData.getViews().end(),
+        std::inserter(set_ViewIds, set_ViewIds.begin()), stl::RetrieveKey());
+
+      graph::indexedGraph putativeGraph(set_ViewIds, getPairs(mapPutativesMatches));
 
-    ALICEVISION_LOG_INFO("After grid filtering:");
-    for(const auto& matchGridFiltering: finalMatches)
-      ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGridFiltering.first.first) + ", " + std::to_string(matchGridFiltering.first.second) + ") contains " + std::to_string(matchGridFiltering.second.getNbAllMatches()) + " geometric matches.");
+      graph::exportToGraphvizData(
+        (fs::path(matchesFolder) / "putative_matches.dot").string(),
+        putativeGraph.g);
+    }
   }
+  */
 
-  // export geometric filtered matches
+  // finalize the exported matches files
   ALICEVISION_LOG_INFO("Save geometric matches.");
-  Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix);
+  if(putativeMatchesWriter)
+    putativeMatchesWriter->close();
+  matchesWriter.close();
+
+  ALICEVISION_LOG_INFO("Pairwise matching statistics:" << std::endl << matchingStats);
   ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+  ALICEVISION_LOG_INFO("Peak resident memory: " << (system::getPeakResidentMemory() / (1024 * 1024)) << " MB");
 
   // d. Export some statistics
   if(exportDebugFiles)
@@ -554,8 +681,10 @@ int main(int argc, char **argv)
 
 #ifdef ALICEVISION_DEBUG_MATCHING
   {
+    ALICEVISION_LOG_DEBUG("PUTATIVE");
+    getStatsMap(putativeMatchesDebug);
     ALICEVISION_LOG_DEBUG("GEOMETRIC");
-    getStatsMap(geometricMatches);
+    getStatsMap(geometricMatchesDebug);
   }
 #endif
 
@@ -10,6 +10,7 @@
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
@@ -20,11 +21,12 @@
 #include <boost/filesystem.hpp>
 
 #include <cstdlib>
+#include <memory>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -82,7 +84,9 @@ int main(int argc, char **argv)
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   std::pair<std::string,std::string> initialPairString("","");
 
-  sfm::ReconstructionEngine_sequentialSfM::Params sfmParams;
+  sfm::ReconstructionEngine_partitionedSfM::Params partitionParams;
+  partitionParams.maxClusterSize = 0;
+  sfm::ReconstructionEngine_sequentialSfM::Params& sfmParams = partitionParams.sequentialParams;
   bool lockScenePreviouslyReconstructed = true;
   int maxNbMatches = 0;
   bool useOnlyMatchesFromInputFolder = false;
@@ -143,6 +147,25 @@ int main(int argc, char **argv)
       "It reduces the reconstruction time, especially for big datasets (500+ images).")
     ("localBAGraphDistance", po::value<int>(&sfmParams.localBundelAdjustementGraphDistanceLimit)->default_value(sfmParams.localBundelAdjustementGraphDistanceLimit),
       "Graph-distance limit setting the Active region in the Local Bundle Adjustment strategy.")
+    ("useAnalyticJacobians", po::value<bool>(&sfmParams.useAnalyticJacobians)->default_value(sfmParams.useAnalyticJacobians),
+      "Use hand-derived jacobians instead of the automatic differentiation in the Bundle Adjustment.\n"
+      "It reduces the time spent in the evaluation of the jacobians.")
+    ("usePersistentBA", po::value<bool>(&sfmParams.usePersistentBundleAdjustment)->default_value(sfmParams.usePersistentBundleAdjustment),
+      "Keep the Bundle Adjustment problem between the iterations and only update the cameras, points and observations that changed.\n"
+      "It reduces the time spent to create the problem for big datasets.")
+    ("checkpointInterval", po::value<std::size_t>(&sfmParams.checkpointInterval)->default_value(sfmParams.checkpointInterval),
+      "Number of resection groups between two checkpoints of the reconstruction, written in the extraInfoFolder (0 to disable).")
+    ("resumeFrom", po::value<std::string>(&sfmParams.resumeFrom)->default_value(sfmParams.resumeFrom),
+      "Checkpoint file (sfm_checkpoint.bin) to resume the reconstruction from.\n"
+      "The input SfMData, features and matches must be the ones used to create the checkpoint.")
+    ("maxClusterSize", po::value<std::size_t>(&partitionParams.maxClusterSize)->default_value(partitionParams.maxClusterSize),
+      "Maximum number of images per cluster in the partitioned reconstruction (0 to disable).\n"
+      "The images are split in overlapping clusters reconstructed concurrently, which are merged and refined by a global bundle adjustment.\n"
+      "It reduces the reconstruction time for very big datasets.")
+    ("clusterOverlapRatio", po::value<double>(&partitionParams.clusterOverlapRatio)->default_value(partitionParams.clusterOverlapRatio),
+      "Number of images added to each cluster from its neighbors, relative to the cluster size.")
+    ("nbParallelClusters", po::value<int>(&partitionParams.nbParallelClusters)->default_value(partitionParams.nbParallelClusters),
+      "Number of clusters reconstructed at the same time (0 to use all the cores).")
     ("localizerEstimator", po::value<robustEstimation::ERobustEstimator>(&sfmParams.localizerEstimator)->default_value(sfmParams.localizerEstimator),
       "Estimator type used to localize cameras (acransac (default), ransac, lsmeds, loransac, maxconsensus)")
     ("localizerEstimatorError", po::value<double>(&sfmParams.localizerEstimatorError)->default_value(0.0),
@@ -197,6 +220,8 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  ALICEVISION_PERF_SESSION("incrementalSfM");
+
   const double defaultLoRansacLocalizationError = 4.0;
   if(!robustEstimation::adjustRobustEstimatorThreshold(sfmParams.localizerEstimator, sfmParams.localizerEstimatorError, defaultLoRansacLocalizationError))
   {
@@ -285,49 +310,67 @@ int main(int argc, char **argv)
     }
   }
 
-  sfm::ReconstructionEngine_sequentialSfM sfmEngine(
-    sfmData,
-    sfmParams,
-    extraInfoFolder,
-    (fs::path(extraInfoFolder) / "sfm_log.html").string());
+  std::unique_ptr<sfm::ReconstructionEngine> sfmEngine;
 
-  // configure the featuresPerView & the matches_provider
-  sfmEngine.setFeatures(&featuresPerView);
-  sfmEngine.setMatches(&pairwiseMatches);
+  if(partitionParams.maxClusterSize > 0)
+  {
+    sfm::ReconstructionEngine_partitionedSfM* partitionedEngine = new sfm::ReconstructionEngine_partitionedSfM(
+      sfmData,
+      partitionParams,
+      extraInfoFolder);
+
+    // configure the featuresPerView & the matches_provider
+    partitionedEngine->setFeatures(&featuresPerView);
+    partitionedEngine->setMatches(&pairwiseMatches);
+    sfmEngine.reset(partitionedEngine);
+  }
+  else
+  {
+    sfm::ReconstructionEngine_sequentialSfM* sequentialEngine = new sfm::ReconstructionEngine_sequentialSfM(
+      sfmData,
+      sfmParams,
+      extraInfoFolder,
+      (fs::path(extraInfoFolder) / "sfm_log.html").string());
+
+    // configure the featuresPerView & the matches_provider
+    sequentialEngine->setFeatures(&featuresPerView);
+    sequentialEngine->setMatches(&pairwiseMatches);
+    sfmEngine.reset(sequentialEngine);
+  }
 
-  if(!sfmEngine.process())
+  if(!sfmEngine->process())
     return EXIT_FAILURE;
 
   // set featuresFolders and matchesFolders relative paths
   {
-      sfmEngine.getSfMData().addFeaturesFolders(featuresFolders);
-      sfmEngine.getSfMData().addMatchesFolders(matchesFolders);
-      sfmEngine.getSfMData().setAbsolutePath(outputSfM);
+      sfmEngine->getSfMData().addFeaturesFolders(featuresFolders);
+      sfmEngine->getSfMData().addMatchesFolders(matchesFolders);
+      sfmEngine->getSfMData().setAbsolutePath(outputSfM);
   }
 
   // get the color for the 3D points
-  sfmEngine.colorize();
-  sfmEngine.retrieveMarkersId();
+  sfmEngine->colorize();
+  sfmEngine->retrieveMarkersId();
 
   ALICEVISION_LOG_INFO("Structure from motion took (s): " + std::to_string(timer.elapsed()));
   ALICEVISION_LOG_INFO("Generating HTML report...");
 
-  sfm::generateSfMReport(sfmEngine.getSfMData(), (fs::path(extraInfoFolder) / "sfm_report.html").string());
+  sfm::generateSfMReport(sfmEngine->getSfMData(), (fs::path(extraInfoFolder) / "sfm_report.html").string());
 
   // export to disk computed scene (data & visualizable results)
   ALICEVISION_LOG_INFO("Export SfMData to disk: " + outputSfM);
 
-  sfmDataIO::Save(sfmEngine.getSfMData(), (fs::path(extraInfoFolder) / ("cloud_and_poses" + sfmParams.sfmStepFileExtension)).string(), sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS|sfmDataIO::STRUCTURE));
-  sfmDataIO::Save(sfmEngine.getSfMData(), outputSfM, sfmDataIO::ESfMData::ALL);
+  sfmDataIO::Save(sfmEngine->getSfMData(), (fs::path(extraInfoFolder) / ("cloud_and_poses" + sfmParams.sfmStepFileExtension)).string(), sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS|sfmDataIO::STRUCTURE));
+  sfmDataIO::Save(sfmEngine->getSfMData(), outputSfM, sfmDataIO::ESfMData::ALL);
 
   if(!outputSfMViewsAndPoses.empty())
-   sfmDataIO:: Save(sfmEngine.getSfMData(), outputSfMViewsAndPoses, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS));
+   sfmDataIO:: Save(sfmEngine->getSfMData(), outputSfMViewsAndPoses, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS));
 
   ALICEVISION_LOG_INFO("Structure from Motion results:" << std::endl
-    << "\t- # input images: " << sfmEngine.getSfMData().getViews().size() << std::endl
-    << "\t- # cameras calibrated: " << sfmEngine.getSfMData().getValidViews().size() << std::endl
-    << "\t- # poses: " << sfmEngine.getSfMData().getPoses().size() << std::endl
-    << "\t- # landmarks: " << sfmEngine.getSfMData().getLandmarks().size());
+    << "\t- # input images: " << sfmEngine->getSfMData().getViews().size() << std::endl
+    << "\t- # cameras calibrated: " << sfmEngine->getSfMData().getValidViews().size() << std::endl
+    << "\t- # poses: " << sfmEngine->getSfMData().getPoses().size() << std::endl
+    << "\t- # landmarks: " << sfmEngine->getSfMData().getLandmarks().size());
 
   return EXIT_SUCCESS;
 }
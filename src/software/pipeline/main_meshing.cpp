@@ -19,6 +19,7 @@
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/system/Timer.hpp>
 
 #include <boost/program_options.hpp>
@@ -260,6 +261,8 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    ALICEVISION_PERF_SESSION("meshing");
+
     if(depthMapsFolder.empty() || depthMapsFilterFolder.empty())
     {
       if(depthMapsFolder.empty() &&
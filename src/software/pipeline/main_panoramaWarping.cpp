@@ -486,25 +486,30 @@ public:
       size_t row_min_y = panoramaSize.second;
 
 
+      Mat3X rays(3, coarse_bbox.width);
       for (size_t x = 0; x < coarse_bbox.width; x++) {
-
         size_t cx = x + coarse_bbox.left;
+        rays.col(x) = SphericalMapping::fromEquirectangular(Vec2(cx, cy), panoramaSize.first, panoramaSize.second);
+      }
+
+      /**
+       * Project the rays of the row to camera pixel coordinates
+       */
+      Mat2X pixs_disto;
+      intrinsics.projectBatch(pose, rays, pixs_disto, true);
+      const Mat3X transformedRays = pose(rays);
 
-        Vec3 ray = SphericalMapping::fromEquirectangular(Vec2(cx, cy), panoramaSize.first, panoramaSize.second);
+      for (size_t x = 0; x < coarse_bbox.width; x++) {
 
         /**
         * Check that this ray should be visible.
         * This test is camera type dependent
         */
-        Vec3 transformedRay = pose(ray);
-        if (!intrinsics.isVisibleRay(transformedRay)) {
+        if (!intrinsics.isVisibleRay(transformedRays.col(x))) {
           continue;
         }
 
-        /**
-         * Project this ray to camera pixel coordinates
-         */
-        const Vec2 pix_disto = intrinsics.project(pose, ray, true);
+        const Vec2 pix_disto = pixs_disto.col(x);
 
         /**
          * Ignore invalid coordinates
@@ -4,9 +4,12 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/image/all.hpp>
+#include <aliceVision/camera/UndistortionMap.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/config.hpp>
@@ -22,11 +25,15 @@
 #include <set>
 #include <iterator>
 #include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -37,6 +44,54 @@ using namespace aliceVision::sfmData;
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
+/**
+ * @brief Undistortion maps shared by all the views with the same intrinsic and image size.
+ * Each map is computed once, or loaded from the maps folder if it has been saved by a previous run.
+ */
+class UndistortionMapsCache
+{
+public:
+  explicit UndistortionMapsCache(const std::string& mapsFolder)
+    : _mapsFolder(mapsFolder)
+  {}
+
+  std::shared_ptr<const camera::UndistortionMap> get(IndexT intrinsicId, const IntrinsicBase& intrinsic, int width, int height)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::shared_ptr<camera::UndistortionMap>& map = _maps[std::make_tuple(intrinsicId, width, height)];
+    if(map)
+      return map;
+
+    map = std::make_shared<camera::UndistortionMap>();
+
+    std::string mapPath;
+    if(!_mapsFolder.empty())
+    {
+      mapPath = (fs::path(_mapsFolder) / (std::to_string(intrinsic.hashValue()) + "_" + std::to_string(width) + "x" + std::to_string(height) + ".bin")).string();
+      if(fs::exists(mapPath) && map->load(mapPath) && map->isCompatible(intrinsic, width, height))
+      {
+        ALICEVISION_LOG_INFO("Undistortion map of intrinsic " << intrinsicId << " loaded from: " << mapPath);
+        return map;
+      }
+    }
+
+    map->compute(intrinsic, width, height);
+    ALICEVISION_LOG_INFO("Undistortion map of intrinsic " << intrinsicId << " computed (" << width << "x" << height << ", "
+                         << map->memorySize() / (1024 * 1024) << " MB).");
+
+    if(!mapPath.empty() && !map->save(mapPath))
+      ALICEVISION_LOG_WARNING("Cannot save the undistortion map: " << mapPath);
+
+    return map;
+  }
+
+private:
+  const std::string _mapsFolder;
+  std::mutex _mutex;
+  std::map<std::tuple<IndexT, int, int>, std::shared_ptr<camera::UndistortionMap>> _maps;
+};
+
 bool prepareDenseScene(const SfMData& sfmData,
                        const std::vector<std::string>& imagesFolders,
                        int beginIndex,
@@ -45,7 +100,9 @@ bool prepareDenseScene(const SfMData& sfmData,
                        image::EImageFileType outputFileType,
                        bool saveMetadata,
                        bool saveMatricesFiles,
-                       bool evCorrection)
+                       bool evCorrection,
+                       const std::string& undistortionMapsFolder,
+                       int maxThreads)
 {
   // defined view Ids
   std::set<IndexT> viewIds;
@@ -81,13 +138,67 @@ bool prepareDenseScene(const SfMData& sfmData,
   const float medianCameraExposure = sfmData.getMedianCameraExposureSetting();
   ALICEVISION_LOG_INFO("Median Camera Exposure: " << medianCameraExposure << ", Median EV: " << std::log2(1.0f/medianCameraExposure));
 
-#pragma omp parallel for num_threads(3)
-  for(int i = 0; i < viewIds.size(); ++i)
+  // each view is decoded, corrected, undistorted and encoded by a single thread:
+  // the views processed in parallel overlap the I/O and the computation,
+  // their number is bounded by the available memory
+  const std::vector<IndexT> viewIdsVec(viewIds.begin(), viewIds.end());
+  std::size_t jobMaxMemoryConsumption = 0;
+  std::set<IndexT> intrinsicIds;
+  for(const IndexT viewId : viewIdsVec)
   {
-    auto itView = viewIds.begin();
-    std::advance(itView, i);
+    const View& view = sfmData.getView(viewId);
+    // input image, undistorted image and encoding buffer
+    jobMaxMemoryConsumption = std::max(jobMaxMemoryConsumption, std::size_t(view.getWidth()) * view.getHeight() * sizeof(RGBfColor) * 3);
+    intrinsicIds.insert(view.getIntrinsicId());
+  }
 
-    const IndexT viewId = *itView;
+  std::size_t nbThreads = 1;
+  {
+    const system::MemoryInfo memoryInformation = system::getMemoryInfo();
+
+    // undistortion maps: 2 floats and 1 index per pixel for each intrinsic
+    const std::size_t mapsMemoryConsumption = intrinsicIds.size() * (jobMaxMemoryConsumption / (sizeof(RGBfColor) * 3)) * (2 * sizeof(float) + sizeof(int));
+    const std::size_t availableMemory = std::size_t(0.9 * memoryInformation.freeRam);
+
+    if(memoryInformation.freeRam == 0 || jobMaxMemoryConsumption == 0)
+    {
+      ALICEVISION_LOG_WARNING("Cannot find available system memory or image sizes, this can be due to OS limitations.\n"
+                              "Use only one thread to export the images.");
+    }
+    else if(availableMemory > mapsMemoryConsumption)
+    {
+      nbThreads = std::max<std::size_t>(1, (availableMemory - mapsMemoryConsumption) / jobMaxMemoryConsumption);
+    }
+
+    // nbThreads should not be higher than user maxThreads param
+    if(maxThreads > 0)
+      nbThreads = std::min(static_cast<std::size_t>(maxThreads), nbThreads);
+
+    // nbThreads should not be higher than the core number
+    nbThreads = std::min(static_cast<std::size_t>(omp_get_num_procs()), nbThreads);
+
+    // nbThreads should not be higher than the view number
+    nbThreads = std::max<std::size_t>(1, std::min(viewIdsVec.size(), nbThreads));
+
+    ALICEVISION_LOG_DEBUG("Job max memory consumption: " << jobMaxMemoryConsumption << " B");
+    ALICEVISION_LOG_DEBUG("Memory information: " << std::endl << memoryInformation);
+    ALICEVISION_LOG_INFO("Export the undistorted images with " << nbThreads << " thread(s).");
+  }
+
+  UndistortionMapsCache undistortionMaps(undistortionMapsFolder);
+
+  // remaining cores are used to undistort each image:
+  // the nested loops of the undistortion maps share the cores with the other views
+  const int nbInnerThreads = std::max(1, omp_get_num_procs() / static_cast<int>(nbThreads));
+  omp_set_nested(1);
+
+#pragma omp parallel for num_threads(nbThreads) schedule(dynamic)
+  for(int i = 0; i < viewIdsVec.size(); ++i)
+  {
+    // number of threads of the nested parallel regions started by this thread
+    omp_set_num_threads(nbInnerThreads);
+
+    const IndexT viewId = viewIdsVec[i];
     const View* view = sfmData.getViews().at(viewId).get();
 
     Intrinsics::const_iterator iterIntrinsic = sfmData.getIntrinsics().find(view->getIntrinsicId());
@@ -215,7 +326,9 @@ bool prepareDenseScene(const SfMData& sfmData,
       if(cam->isValid() && cam->have_disto())
       {
         // undistort the image and save it
-        UndistortImage(image, cam, image_ud, FBLACK);
+        const auto map = undistortionMaps.get(view->getIntrinsicId(), *cam, image.Width(), image.Height());
+        map->apply(image, image_ud, FBLACK);
+        image = Image<RGBfColor>(); // release the input image before encoding
         writeImage(dstColorImage, image_ud, image::EImageColorSpace::AUTO, metadata);
       }
       else
@@ -245,6 +358,8 @@ int main(int argc, char *argv[])
   bool saveMetadata = true;
   bool saveMatricesTxtFiles = false;
   bool evCorrection = false;
+  std::string undistortionMapsFolder;
+  int maxThreads = 0;
 
   po::options_description allParams("AliceVision prepareDenseScene");
 
@@ -271,7 +386,11 @@ int main(int argc, char *argv[])
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("evCorrection", po::value<bool>(&evCorrection)->default_value(evCorrection),
-      "Correct exposure value.");
+      "Correct exposure value.")
+    ("undistortionMapsFolder", po::value<std::string>(&undistortionMapsFolder)->default_value(undistortionMapsFolder),
+      "Folder to store the undistortion maps of each intrinsic, they are reused by the next runs (empty to keep them in memory only).")
+    ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+      "Specifies the maximum number of images exported simultaneously (0 for automatic mode, bounded by the available memory).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -348,8 +467,11 @@ int main(int argc, char *argv[])
     rangeStart = 0;
   }
 
+  if(!undistortionMapsFolder.empty() && !fs::exists(undistortionMapsFolder))
+    fs::create_directory(undistortionMapsFolder);
+
   // export
-  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection))
+  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection, undistortionMapsFolder, maxThreads))
     return EXIT_SUCCESS;
 
   return EXIT_FAILURE;
@@ -16,6 +16,7 @@
 #include <aliceVision/mvsUtils/ImagesCache.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/PerfTrace.hpp>
 #include <aliceVision/system/Timer.hpp>
 
 #include <boost/program_options.hpp>
@@ -111,7 +112,9 @@ int main(int argc, char* argv[])
             " * Push: For each vertex of the reconstruction, push the visibilities to the closest triangle in the input mesh.\n"
             " * PullPush: Combine results from Pull and Push results.'")
         ("subdivisionTargetRatio", po::value<float>(&texParams.subdivisionTargetRatio)->default_value(texParams.subdivisionTargetRatio),
-            "Percentage of the density of the reconstruction as the target for the subdivision (0: disable subdivision, 0.5: half density of the reconstruction, 1: full density of the reconstruction).");
+            "Percentage of the density of the reconstruction as the target for the subdivision (0: disable subdivision, 0.5: half density of the reconstruction, 1: full density of the reconstruction).")
+        ("maxMemory", po::value<std::size_t>(&texParams.maxMemory)->default_value(texParams.maxMemory),
+            "Memory budget (in MB) for the texture atlases and the images pyramids (0: use the free RAM).");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -153,6 +156,8 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    ALICEVISION_PERF_SESSION("texturing");
+
     texParams.visibilityRemappingMethod = mesh::EVisibilityRemappingMethod_stringToEnum(visibilityRemappingMethod);
     texParams.processColorspace = imageIO::EImageColorSpace_stringToEnum(processColorspaceName);
     // set output texture file type
@@ -0,0 +1,270 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics/stats.hpp>
+#include <boost/accumulators/statistics/mean.hpp>
+#include <boost/accumulators/statistics/median.hpp>
+#include <boost/accumulators/statistics/max.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace bacc = boost::accumulators;
+namespace po = boost::program_options;
+
+typedef bacc::accumulator_set<double, bacc::stats<bacc::tag::mean, bacc::tag::median, bacc::tag::max>> StatsAccumulator;
+
+/// speed and accuracy statistics of a localization algorithm
+struct AlgorithmStats
+{
+  explicit AlgorithmStats(localization::VoctreeLocalizer::Algorithm algorithm)
+    : algorithm(algorithm)
+  {}
+
+  void log(std::size_t nbQueries) const
+  {
+    ALICEVISION_LOG_INFO("Algorithm " << algorithm << ":" << std::endl
+      << "\t- localized: " << nbLocalized << "/" << nbQueries << std::endl
+      << "\t- time: mean " << bacc::mean(timeMs) << " ms, median " << bacc::median(timeMs) << " ms, max " << bacc::max(timeMs) << " ms" << std::endl
+      << "\t- inliers: mean " << bacc::mean(nbInliers) << std::endl
+      << "\t- position error: mean " << bacc::mean(positionError) << ", median " << bacc::median(positionError) << " (" << nbWithReference << " reference poses)" << std::endl
+      << "\t- rotation error: mean " << bacc::mean(rotationError) << " deg, median " << bacc::median(rotationError) << " deg");
+  }
+
+  localization::VoctreeLocalizer::Algorithm algorithm;
+  std::size_t nbLocalized = 0;
+  std::size_t nbWithReference = 0;
+  StatsAccumulator timeMs;
+  StatsAccumulator nbInliers;
+  StatsAccumulator positionError;
+  StatsAccumulator rotationError;
+};
+
+int main(int argc, char** argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilepath;
+  std::string descriptorsFolder;
+  std::string vocTreeFilepath;
+  std::string weightsFilepath;
+  std::string querySfmDataFilepath;
+  std::vector<std::string> queryFeaturesFolders;
+  std::string matchDescTypeNames = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  std::string landmarkIndexFilepath;
+  std::size_t landmarkIndexMaxLandmarks = 0;
+  std::size_t numResults = 4;
+  std::size_t maxResults = 10;
+  double resectionErrorMax = 4.0;
+  float distRatio = 0.8f;
+  std::size_t maxQueries = 0;
+
+  po::options_description allParams("This program compares the speed and the accuracy of the voctree-based "
+                                    "localization (AllResults) and of the direct 2D-3D localization with the "
+                                    "landmark descriptor index (LandmarkIndex) on a set of query views.\n"
+                                    "The poses of the query views, if any, are used as reference.\n"
+                                    "AliceVision localizationComparison");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilepath)->required(),
+      "SfMData file of the scene.")
+    ("voctree", po::value<std::string>(&vocTreeFilepath)->required(),
+      "Filename for the vocabulary tree.")
+    ("querySfmData", po::value<std::string>(&querySfmDataFilepath)->required(),
+      "SfMData file containing the query views.")
+    ("queryFeaturesFolders", po::value<std::vector<std::string>>(&queryFeaturesFolders)->multitoken()->required(),
+      "Path to folder(s) containing the extracted features of the query views.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("descriptorPath", po::value<std::string>(&descriptorsFolder),
+      "Folder containing the descriptors of the scene.")
+    ("voctreeWeights", po::value<std::string>(&weightsFilepath),
+      "Filename for the vocabulary tree weights.")
+    ("matchDescTypes", po::value<std::string>(&matchDescTypeNames)->default_value(matchDescTypeNames),
+      "The describer types to use for the matching.")
+    ("landmarkIndex", po::value<std::string>(&landmarkIndexFilepath),
+      "Filename of the landmark descriptor index. It is loaded if it exists, otherwise it is built and saved.")
+    ("landmarkIndexMaxLandmarks", po::value<std::size_t>(&landmarkIndexMaxLandmarks)->default_value(landmarkIndexMaxLandmarks),
+      "Maximum number of indexed landmarks per describer type, the most visible ones are kept. If 0 it is ignored.")
+    ("nbImageMatch", po::value<std::size_t>(&numResults)->default_value(numResults),
+      "[AllResults] Number of images to retrieve in database.")
+    ("maxResults", po::value<std::size_t>(&maxResults)->default_value(maxResults),
+      "[AllResults] It stops the image matching when this number of matched images is reached. If 0 it is ignored.")
+    ("distanceRatio", po::value<float>(&distRatio)->default_value(distRatio),
+      "Nearest neighbor distance ratio for the matching.")
+    ("reprojectionError", po::value<double>(&resectionErrorMax)->default_value(resectionErrorMax),
+      "Maximum reprojection error (in pixels) allowed for resectioning.")
+    ("maxQueries", po::value<std::size_t>(&maxQueries)->default_value(maxQueries),
+      "Maximum number of query views to localize. If 0 it is ignored.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  const std::vector<feature::EImageDescriberType> matchDescTypes = feature::EImageDescriberType_stringToEnums(matchDescTypeNames);
+
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmDataFilepath, sfmDataIO::ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmDataFilepath + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  sfmData::SfMData querySfmData;
+  if(!sfmDataIO::Load(querySfmData, querySfmDataFilepath, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::INTRINSICS|sfmDataIO::EXTRINSICS)))
+  {
+    ALICEVISION_LOG_ERROR("The query SfMData file '" + querySfmDataFilepath + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  localization::VoctreeLocalizer localizer(sfmData, descriptorsFolder, vocTreeFilepath, weightsFilepath, matchDescTypes);
+  if(!localizer.isInit())
+  {
+    ALICEVISION_LOG_ERROR("Unable to initialize the localizer.");
+    return EXIT_FAILURE;
+  }
+
+  if(!localizer.initLandmarkIndex(landmarkIndexFilepath, landmarkIndexMaxLandmarks))
+  {
+    ALICEVISION_LOG_ERROR("Unable to initialize the landmark descriptor index.");
+    return EXIT_FAILURE;
+  }
+
+  localization::VoctreeLocalizer::Parameters param;
+  param._numResults = numResults;
+  param._maxResults = maxResults;
+  param._fDistRatio = distRatio;
+  param._errorMax = resectionErrorMax;
+  // each query is localized independently
+  param._nbFrameBufferMatching = 0;
+
+  std::vector<AlgorithmStats> algorithmStats = {
+    AlgorithmStats(localization::VoctreeLocalizer::Algorithm::AllResults),
+    AlgorithmStats(localization::VoctreeLocalizer::Algorithm::LandmarkIndex)
+  };
+
+  std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
+  for(const feature::EImageDescriberType descType : matchDescTypes)
+    imageDescribers.push_back(feature::createImageDescriber(descType));
+
+  std::size_t nbQueries = 0;
+  for(const auto& viewIt : querySfmData.getViews())
+  {
+    if(maxQueries > 0 && nbQueries >= maxQueries)
+      break;
+
+    const sfmData::View& view = *viewIt.second;
+
+    feature::MapRegionsPerDesc queryRegions;
+    try
+    {
+      for(const auto& imageDescriber : imageDescribers)
+        queryRegions[imageDescriber->getDescriberType()] = sfm::loadRegions(queryFeaturesFolders, view.getViewId(), *imageDescriber);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_WARNING("Skip view " << view.getViewId() << ": " << e.what());
+      continue;
+    }
+    ++nbQueries;
+
+    const std::pair<std::size_t, std::size_t> imageSize(view.getWidth(), view.getHeight());
+
+    // use the calibration of the query view if it is known
+    const camera::PinholeRadialK3* viewIntrinsics = dynamic_cast<const camera::PinholeRadialK3*>(querySfmData.getIntrinsicPtr(view.getIntrinsicId()));
+    const bool hasReference = querySfmData.isPoseAndIntrinsicDefined(&view);
+
+    for(AlgorithmStats& stats : algorithmStats)
+    {
+      param._algorithm = stats.algorithm;
+
+      camera::PinholeRadialK3 queryIntrinsics = viewIntrinsics ? *viewIntrinsics : camera::PinholeRadialK3(imageSize.first, imageSize.second);
+      localization::LocalizationResult result;
+
+      const auto start = std::chrono::steady_clock::now();
+      const bool localized = localizer.localize(queryRegions, imageSize, &param, viewIntrinsics != nullptr, queryIntrinsics, result, view.getImagePath());
+      stats.timeMs(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+      if(!localized)
+        continue;
+
+      ++stats.nbLocalized;
+      stats.nbInliers(result.getInliers().size());
+
+      if(hasReference)
+      {
+        const geometry::Pose3& referencePose = querySfmData.getPose(view).getTransform();
+        ++stats.nbWithReference;
+        stats.positionError((result.getPose().center() - referencePose.center()).norm());
+        stats.rotationError(radianToDegree(getRotationMagnitude(result.getPose().rotation() * referencePose.rotation().transpose())));
+      }
+    }
+  }
+
+  for(const AlgorithmStats& stats : algorithmStats)
+    stats.log(nbQueries);
+
+  return EXIT_SUCCESS;
+}